@@ -54,6 +54,8 @@ AllocationPreference controls resizing behavior:
     DYNAMIC
         - Capacity grows using realloc()
         - Similar behavior to a vector / array list
+        - Growing moves the data: earlier pointers become invalid
+          (linear_arena.h never moves, for variable-size scratch memory)
 
 ------------------------------------------------------------------------------
 USAGE
@@ -115,6 +117,18 @@ THREADING NOTES
 #include <stddef.h>
 #include <stdint.h>
 
+// Where large buffers come from; a NULL backend means calloc / free.
+// alloc returns zero-filled memory aligned to at least 64 bytes.
+// (arenas/page_alloc.h provides a huge page / NUMA aware one)
+#ifndef MEM_BACKEND_DEFINED
+#define MEM_BACKEND_DEFINED
+typedef struct MemBackend_t {
+  void *(*alloc)(size_t size, void *ctx);
+  void (*release)(void *ptr, size_t size, void *ctx);
+  void *ctx;
+} MemBackend;
+#endif
+
 // Controls how the arena behaves when capacity is exceeded.
 typedef enum {
   DYNAMIC, // Arena grows using realloc()
@@ -128,6 +142,7 @@ typedef struct {
   _Atomic size_t count;
   size_t capacity;
   AllocationPreference preference;
+  const MemBackend *backend; // NULL = malloc / realloc / free
 } Arena;
 
 // Creates a new arena.
@@ -138,6 +153,13 @@ typedef struct {
 Arena arena_create(const size_t elem_size, const size_t starting_capacity,
                    AllocationPreference preference);
 
+// Same as arena_create, the buffer comes from `backend` (NULL = malloc).
+// Growing a DYNAMIC arena then allocates a new buffer and copies.
+// The backend must outlive the arena.
+Arena arena_create_opts(const size_t elem_size, const size_t starting_capacity,
+                        AllocationPreference preference,
+                        const MemBackend *backend);
+
 // Copies `val` into the arena.
 //
 // Returns:
@@ -185,16 +207,38 @@ void arena_reset(Arena *arena);
 
 Arena arena_create(const size_t elem_size, const size_t starting_capacity,
                    AllocationPreference preference) {
+  return arena_create_opts(elem_size, starting_capacity, preference, NULL);
+};
+
+Arena arena_create_opts(const size_t elem_size, const size_t starting_capacity,
+                        AllocationPreference preference,
+                        const MemBackend *backend) {
   Arena a;
   a.elem_size = elem_size;
   atomic_init(&a.count, 0);
   a.capacity = starting_capacity == 0 ? 8 : starting_capacity;
-  a.data = malloc(a.capacity * elem_size);
+  a.backend = backend;
+  a.data = backend ? backend->alloc(a.capacity * elem_size, backend->ctx)
+                   : malloc(a.capacity * elem_size);
   a.preference = preference;
 
   return a;
 };
 
+/* a backend can't realloc: new buffer, copy, release the old one */
+static void *_arena_grow(Arena *arena, size_t new_cap) {
+  if (!arena->backend) {
+    return realloc((uint8_t *)arena->data, new_cap * arena->elem_size);
+  }
+  const MemBackend *mem = arena->backend;
+  void *tmp = mem->alloc(new_cap * arena->elem_size, mem->ctx);
+  if (tmp) {
+    memcpy(tmp, arena->data, arena->capacity * arena->elem_size);
+    mem->release(arena->data, arena->capacity * arena->elem_size, mem->ctx);
+  }
+  return tmp;
+}
+
 int arena_add(Arena *arena, const void *val) {
   if (!arena) {
     return 1;
@@ -206,7 +250,7 @@ int arena_add(Arena *arena, const void *val) {
       return 2;
 
     size_t new_cap = arena->capacity * 1.5;
-    void *tmp = realloc((uint8_t *)arena->data, new_cap * arena->elem_size);
+    void *tmp = _arena_grow(arena, new_cap);
     if (!tmp)
       return 3;
 
@@ -277,7 +321,12 @@ int arena_pop(Arena *arena, void *out) {
 void arena_free(Arena *arena) {
   if (!arena)
     return;
-  free(arena->data);
+  if (arena->backend) {
+    arena->backend->release(arena->data, arena->capacity * arena->elem_size,
+                            arena->backend->ctx);
+  } else {
+    free(arena->data);
+  }
   arena->data = NULL;
   atomic_store_explicit(&arena->count, 0, memory_order_release);
   arena->capacity = 0;
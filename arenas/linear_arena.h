@@ -0,0 +1,351 @@
+// Copyright 2025 Seaker <seakerone@proton.me>
+
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+/*
+------------------------------------------------------------------------------
+LinearArena — Variable-size bump allocator with scratch scopes
+
+Arena and RegionArena hand out fixed-size elements and StringArena only
+stores strings. LinearArena is the plain linear allocator: any size, any
+(power of two) alignment, one pointer bump per allocation.
+
+- Memory comes in chained blocks: when the current block is full a new one
+  is linked in front of it, nothing is ever moved or reallocated, so every
+  pointer stays valid until it goes out of scope.
+- l_arena_save() / l_arena_restore() bracket a scratch scope: everything
+  pushed after the mark is released at once.
+- Blocks released by a restore are kept on a spare list and reused by the
+  next growth, so a steady workload stops calling malloc after warm-up.
+
+This arena is designed for:
+- per-request / per-frame scratch memory
+- temporary buffers of mixed types and sizes
+- replacing many short-lived malloc / free pairs
+
+------------------------------------------------------------------------------
+USAGE
+
+In exactly ONE source file:
+
+    #define LINEAR_ARENA_IMPLEMENTATION
+    #include "linear_arena.h"
+
+Create an arena (64KB blocks):
+
+    LinearArena scratch = l_arena_create(64 * 1024);
+
+Allocate:
+
+    Header *h = l_arena_push(&scratch, sizeof(Header), alignof(Header));
+    char *buf = l_arena_push(&scratch, len, 1);
+    float *v = l_arena_push_zero(&scratch, 16 * sizeof(float), 32);
+
+Scratch scope:
+
+    LArenaMark mark = l_arena_save(&scratch);
+    ... push as much as the request needs ...
+    l_arena_restore(&scratch, mark); // all of it released
+
+Reset (keeps every block) / free:
+
+    l_arena_reset(&scratch);
+    l_arena_free(&scratch);
+
+------------------------------------------------------------------------------
+THREADING NOTES
+
+- Single-threaded: use one LinearArena per thread (or per request).
+
+------------------------------------------------------------------------------
+*/
+#ifndef LINEAR_ARENA_H
+#define LINEAR_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Where large buffers come from; a NULL backend means calloc / free.
+// alloc returns zero-filled memory aligned to at least 64 bytes.
+// (arenas/page_alloc.h provides a huge page / NUMA aware one)
+#ifndef MEM_BACKEND_DEFINED
+#define MEM_BACKEND_DEFINED
+typedef struct MemBackend_t {
+  void *(*alloc)(size_t size, void *ctx);
+  void (*release)(void *ptr, size_t size, void *ctx);
+  void *ctx;
+} MemBackend;
+#endif
+
+#define LINEAR_ARENA_DEFAULT_BLOCK (64 * 1024)
+
+// One block of memory, its bytes follow the header.
+typedef struct LArenaBlock_t {
+  struct LArenaBlock_t *prev; // Older block (or next spare)
+  size_t size;                // Usable bytes
+  size_t used;                // Bytes handed out
+} LArenaBlock;
+
+typedef struct LinearArena_t {
+  LArenaBlock *current; // Block allocations come from, NULL until first push
+  LArenaBlock *spare;   // Blocks released by restore / reset, reused first
+  size_t block_size;    // Usable bytes of a regular block
+  const MemBackend *backend; // Block allocator, NULL = malloc / free
+} LinearArena;
+
+// Position in the arena, returned by l_arena_save.
+typedef struct LArenaMark_t {
+  LArenaBlock *block;
+  size_t used;
+} LArenaMark;
+
+/*-----------------------------------------------------------------------------
+  l_arena_create
+  Creates an empty arena, no memory is allocated before the first push.
+
+  block_size : usable bytes per block (0 = LINEAR_ARENA_DEFAULT_BLOCK)
+
+  Notes:
+    - Allocations larger than block_size get a block of their own.
+-----------------------------------------------------------------------------*/
+LinearArena l_arena_create(size_t block_size);
+
+/*-----------------------------------------------------------------------------
+  l_arena_create_opts
+  Same as l_arena_create, blocks come from backend (NULL = malloc / free).
+  The backend must outlive the arena.
+-----------------------------------------------------------------------------*/
+LinearArena l_arena_create_opts(size_t block_size, const MemBackend *backend);
+
+/*-----------------------------------------------------------------------------
+  l_arena_push
+  Allocates size bytes aligned to align.
+
+  align : power of two, 0 = alignof(max_align_t)
+
+  Returns a pointer to uninitialized memory, NULL if arena is NULL, align
+  is not a power of two or the block allocation failed.
+
+  Notes:
+    - size 0 returns a valid, aligned pointer that must not be dereferenced.
+-----------------------------------------------------------------------------*/
+void *l_arena_push(LinearArena *arena, size_t size, size_t align);
+
+/*-----------------------------------------------------------------------------
+  l_arena_push_zero
+  Same as l_arena_push, the memory is zero-filled.
+-----------------------------------------------------------------------------*/
+void *l_arena_push_zero(LinearArena *arena, size_t size, size_t align);
+
+/*-----------------------------------------------------------------------------
+  l_arena_save
+  Returns the current position, to be passed to l_arena_restore.
+-----------------------------------------------------------------------------*/
+LArenaMark l_arena_save(const LinearArena *arena);
+
+/*-----------------------------------------------------------------------------
+  l_arena_restore
+  Releases everything pushed since mark was saved.
+
+  Notes:
+    - Pointers pushed after the mark become invalid, earlier ones stay.
+    - Marks nest: restoring an outer mark also releases the inner scopes.
+      A mark is invalid once an older mark has been restored (or the arena
+      was reset) and must not be used anymore.
+    - Blocks emptied by the restore go to the spare list, not to free().
+-----------------------------------------------------------------------------*/
+void l_arena_restore(LinearArena *arena, LArenaMark mark);
+
+/*-----------------------------------------------------------------------------
+  l_arena_reset
+  Releases every allocation, keeping all blocks for reuse.
+-----------------------------------------------------------------------------*/
+void l_arena_reset(LinearArena *arena);
+
+/*-----------------------------------------------------------------------------
+  l_arena_free
+  Frees every block, including the spare ones. The arena can be used again
+  afterwards (it is empty, like a fresh l_arena_create).
+-----------------------------------------------------------------------------*/
+void l_arena_free(LinearArena *arena);
+
+#endif // !LINEAR_ARENA_H
+
+#if (defined(LINEAR_ARENA_IMPLEMENTATION))
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+
+// header rounded up so block data starts 64-byte aligned from a 64-byte
+// aligned block (or max_align_t aligned from malloc)
+#define _L_ARENA_HEADER                                                        \
+  ((sizeof(LArenaBlock) + 63) / 64 * 64)
+
+static inline uint8_t *_l_arena_data(LArenaBlock *block) {
+  return (uint8_t *)block + _L_ARENA_HEADER;
+}
+
+static LArenaBlock *_l_arena_block_new(LinearArena *arena, size_t size) {
+  LArenaBlock *block =
+      arena->backend
+          ? arena->backend->alloc(_L_ARENA_HEADER + size, arena->backend->ctx)
+          : malloc(_L_ARENA_HEADER + size);
+  if (!block) {
+    return NULL;
+  }
+  block->size = size;
+  return block;
+}
+
+static void _l_arena_block_free(LinearArena *arena, LArenaBlock *block) {
+  if (arena->backend) {
+    arena->backend->release(block, _L_ARENA_HEADER + block->size,
+                            arena->backend->ctx);
+  } else {
+    free(block);
+  }
+}
+
+// offset of the first byte aligned to align at or after block->used
+static inline size_t _l_arena_aligned(LArenaBlock *block, size_t align) {
+  uintptr_t at = (uintptr_t)_l_arena_data(block) + block->used;
+  uintptr_t aligned = (at + align - 1) & ~(uintptr_t)(align - 1);
+  return block->used + (size_t)(aligned - at);
+}
+
+LinearArena l_arena_create(size_t block_size) {
+  return l_arena_create_opts(block_size, NULL);
+}
+
+LinearArena l_arena_create_opts(size_t block_size, const MemBackend *backend) {
+  LinearArena arena;
+  arena.current = NULL;
+  arena.spare = NULL;
+  arena.block_size = block_size ? block_size : LINEAR_ARENA_DEFAULT_BLOCK;
+  arena.backend = backend;
+  return arena;
+}
+
+// links a block with room for size bytes at align in front of current:
+// the first spare block large enough, else a new one
+static LArenaBlock *_l_arena_grow(LinearArena *arena, size_t size,
+                                  size_t align) {
+  if (size > SIZE_MAX - _L_ARENA_HEADER - align) {
+    return NULL;
+  }
+  size_t need = size + align - 1;
+  LArenaBlock **link = &arena->spare;
+  while (*link && (*link)->size < need) {
+    link = &(*link)->prev;
+  }
+
+  LArenaBlock *block = *link;
+  if (block) {
+    *link = block->prev;
+  } else {
+    block = _l_arena_block_new(arena, need > arena->block_size
+                                          ? need
+                                          : arena->block_size);
+    if (!block) {
+      return NULL;
+    }
+  }
+  block->used = 0;
+  block->prev = arena->current;
+  arena->current = block;
+  return block;
+}
+
+void *l_arena_push(LinearArena *arena, size_t size, size_t align) {
+  if (!arena) {
+    return NULL;
+  }
+  if (align == 0) {
+    align = alignof(max_align_t);
+  }
+  if (align & (align - 1)) {
+    return NULL;
+  }
+
+  LArenaBlock *block = arena->current;
+  size_t offset = 0;
+  if (block) {
+    offset = _l_arena_aligned(block, align);
+  }
+  if (!block || offset > block->size || block->size - offset < size) {
+    block = _l_arena_grow(arena, size, align);
+    if (!block) {
+      return NULL;
+    }
+    offset = _l_arena_aligned(block, align);
+  }
+
+  block->used = offset + size;
+  return _l_arena_data(block) + offset;
+}
+
+void *l_arena_push_zero(LinearArena *arena, size_t size, size_t align) {
+  void *ptr = l_arena_push(arena, size, align);
+  if (ptr) {
+    memset(ptr, 0, size);
+  }
+  return ptr;
+}
+
+LArenaMark l_arena_save(const LinearArena *arena) {
+  LArenaMark mark = {NULL, 0};
+  if (arena && arena->current) {
+    mark.block = arena->current;
+    mark.used = arena->current->used;
+  }
+  return mark;
+}
+
+void l_arena_restore(LinearArena *arena, LArenaMark mark) {
+  if (!arena) {
+    return;
+  }
+  while (arena->current && arena->current != mark.block) {
+    LArenaBlock *block = arena->current;
+    arena->current = block->prev;
+    block->prev = arena->spare;
+    arena->spare = block;
+  }
+  if (arena->current) {
+    arena->current->used = mark.used;
+  }
+}
+
+void l_arena_reset(LinearArena *arena) {
+  LArenaMark empty = {NULL, 0};
+  l_arena_restore(arena, empty);
+}
+
+void l_arena_free(LinearArena *arena) {
+  if (!arena) {
+    return;
+  }
+  l_arena_reset(arena);
+  while (arena->spare) {
+    LArenaBlock *block = arena->spare;
+    arena->spare = block->prev;
+    _l_arena_block_free(arena, block);
+  }
+}
+#endif
@@ -0,0 +1,361 @@
+// Copyright 2025 Seaker <seakerone@proton.me>
+
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+/*
+------------------------------------------------------------------------------
+PageAlloc — mmap backend: huge pages, NUMA placement, pre-faulting
+
+malloc / calloc leave large buffers (a 4M-slot job channel, big arena
+regions) on whichever NUMA node touched them first, in 4KB pages. PageAlloc
+maps them directly:
+
+- huge pages: MAP_HUGETLB (reserved pool), or a 2MB aligned mapping with a
+  transparent huge page hint (MADV_HUGEPAGE)
+- placement: mbind() on a chosen NUMA node, preferred or strict
+- pre-faulting: every page is faulted in at allocation (on the chosen node),
+  the hot path never takes a page fault
+
+page_backend() wraps a set of options as a MemBackend, the allocation hook
+taken by RegionArena (r_arena_create_opts), Arena (arena_create_opts) and the
+channel ring buffers (ChannelOptions.memory).
+
+------------------------------------------------------------------------------
+USAGE
+
+In exactly ONE source file:
+
+    #define PAGE_ALLOC_IMPLEMENTATION
+    #include "page_alloc.h"
+
+Direct use:
+
+    PageAllocOptions opts = {.huge = PAGE_HUGE_THP,
+                             .numa = PAGE_NUMA_PREFERRED,
+                             .numa_node = 1,
+                             .prefault = 1};
+    void *buf = page_alloc(64 << 20, &opts);
+    page_free(buf, 64 << 20, &opts);
+
+As a backend (opts must outlive everything allocated through it):
+
+    MemBackend mem = page_backend(&opts);
+    RegionArena a = r_arena_create_opts(sizeof(Job), 4096, 1024, &mem);
+
+CPUs of a node, e.g. to pin the workers using that memory:
+
+    int cpus[256];
+    size_t n = page_numa_node_cpus(1, cpus, 256);
+
+------------------------------------------------------------------------------
+NOTES
+
+- Linux only for huge pages / NUMA / pre-faulting; on other systems
+  page_alloc falls back to calloc and ignores the options.
+- Memory is always zero-filled.
+- MAP_HUGETLB needs reserved huge pages (vm.nr_hugepages); when none are
+  available the mapping falls back to THP transparently.
+- page_free must get the same size and options as page_alloc: both round
+  the size the same way (4KB, or PAGE_HUGE_SIZE with huge pages).
+- mbind and madvise go through syscall(), no libnuma and no _GNU_SOURCE.
+
+------------------------------------------------------------------------------
+*/
+#ifndef PAGE_ALLOC_H
+#define PAGE_ALLOC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef PAGE_HUGE_SIZE
+#define PAGE_HUGE_SIZE ((size_t)2 << 20)
+#endif
+#define PAGE_NUMA_MAX_NODES 1024
+
+// Where large buffers come from; a NULL backend means calloc / free.
+// alloc returns zero-filled memory aligned to at least 64 bytes.
+#ifndef MEM_BACKEND_DEFINED
+#define MEM_BACKEND_DEFINED
+typedef struct MemBackend_t {
+  void *(*alloc)(size_t size, void *ctx);
+  void (*release)(void *ptr, size_t size, void *ctx);
+  void *ctx;
+} MemBackend;
+#endif
+
+typedef enum PageHugeMode_t {
+  PAGE_HUGE_NONE = 0, // regular pages
+  PAGE_HUGE_THP = 1,  // 2MB aligned, MADV_HUGEPAGE
+  PAGE_HUGE_TLB = 2   // MAP_HUGETLB, THP if the pool is empty
+} PageHugeMode;
+
+typedef enum PageNumaPolicy_t {
+  PAGE_NUMA_NONE = 0,      // first touch decides
+  PAGE_NUMA_PREFERRED = 1, // numa_node first, other nodes when it is full
+  PAGE_NUMA_BIND = 2       // numa_node only
+} PageNumaPolicy;
+
+// Zero-initialized options mean plain pages, no placement, no pre-faulting.
+typedef struct PageAllocOptions_t {
+  PageHugeMode huge;
+  PageNumaPolicy numa;
+  unsigned numa_node; // < PAGE_NUMA_MAX_NODES
+  uint8_t prefault;   // fault every page in at allocation
+} PageAllocOptions;
+
+/*-----------------------------------------------------------------------------
+  page_alloc
+  Maps size bytes (rounded up to the page size in use) of zeroed memory.
+
+  opts : NULL for the defaults
+
+  Returns the mapping, NULL on failure (size 0, mmap or strict mbind
+  failure).
+-----------------------------------------------------------------------------*/
+void *page_alloc(size_t size, const PageAllocOptions *opts);
+
+/*-----------------------------------------------------------------------------
+  page_free
+  Unmaps memory from page_alloc; size and opts must match the allocation.
+-----------------------------------------------------------------------------*/
+void page_free(void *ptr, size_t size, const PageAllocOptions *opts);
+
+/*-----------------------------------------------------------------------------
+  page_backend
+  Returns a MemBackend allocating through page_alloc with opts.
+
+  Notes:
+    - Only the pointer is kept: opts must stay alive (and unchanged) as
+      long as anything allocated through the backend.
+-----------------------------------------------------------------------------*/
+MemBackend page_backend(const PageAllocOptions *opts);
+
+/*-----------------------------------------------------------------------------
+  page_numa_node_cpus
+  Writes the CPUs of NUMA node node into cpus (at most max).
+
+  Returns the number of CPUs of the node (may exceed max), 0 if unknown.
+-----------------------------------------------------------------------------*/
+size_t page_numa_node_cpus(unsigned node, int *cpus, size_t max);
+
+#endif // !PAGE_ALLOC_H
+
+#if (defined(PAGE_ALLOC_IMPLEMENTATION))
+#include <stdio.h>
+#include <stdlib.h>
+
+static size_t _page_round(size_t size, const PageAllocOptions *opts) {
+  size_t unit = opts && opts->huge != PAGE_HUGE_NONE ? PAGE_HUGE_SIZE : 4096;
+  return (size + unit - 1) / unit * unit;
+}
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/* strict C11 hides the Linux extensions, the values are the generic ones */
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS 0x20
+#endif
+#ifndef MAP_HUGETLB
+#define MAP_HUGETLB 0x40000
+#endif
+#ifndef MADV_HUGEPAGE
+#define MADV_HUGEPAGE 14
+#endif
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+#define _PAGE_MPOL_PREFERRED 1
+#define _PAGE_MPOL_BIND 2
+
+extern long syscall(long number, ...);
+
+static void *_page_map(size_t bytes, int flags) {
+  void *ptr = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+  return ptr == MAP_FAILED ? NULL : ptr;
+}
+
+/* over-maps by one huge page and trims both ends, so THP can back every
+ * 2MB of the buffer */
+static void *_page_map_aligned(size_t bytes) {
+  uint8_t *raw = _page_map(bytes + PAGE_HUGE_SIZE, 0);
+  if (!raw) {
+    return NULL;
+  }
+  uintptr_t addr = (uintptr_t)raw;
+  uintptr_t aligned =
+      (addr + PAGE_HUGE_SIZE - 1) & ~(uintptr_t)(PAGE_HUGE_SIZE - 1);
+  size_t head = aligned - addr;
+  if (head) {
+    munmap(raw, head);
+  }
+  munmap((uint8_t *)aligned + bytes, PAGE_HUGE_SIZE - head);
+  return (void *)aligned;
+}
+
+static int _page_bind(void *ptr, size_t bytes, const PageAllocOptions *opts) {
+  unsigned long mask[PAGE_NUMA_MAX_NODES / (8 * sizeof(unsigned long))] = {0};
+  if (opts->numa_node >= PAGE_NUMA_MAX_NODES) {
+    return -1;
+  }
+  mask[opts->numa_node / (8 * sizeof(unsigned long))] |=
+      1ul << (opts->numa_node % (8 * sizeof(unsigned long)));
+  int mode = opts->numa == PAGE_NUMA_BIND ? _PAGE_MPOL_BIND
+                                          : _PAGE_MPOL_PREFERRED;
+  // the kernel reads maxnode - 1 bits
+  return (int)syscall(SYS_mbind, ptr, bytes, mode, mask,
+                      (unsigned long)PAGE_NUMA_MAX_NODES + 1, 0u);
+}
+
+static void _page_prefault(void *ptr, size_t bytes) {
+  if (syscall(SYS_madvise, ptr, bytes, MADV_POPULATE_WRITE) == 0) {
+    return;
+  }
+  // older kernels: touch every page, writing the zero already there
+  for (size_t off = 0; off < bytes; off += 4096) {
+    ((volatile uint8_t *)ptr)[off] = 0;
+  }
+}
+
+void *page_alloc(size_t size, const PageAllocOptions *opts) {
+  if (size == 0) {
+    return NULL;
+  }
+  PageAllocOptions defaults = {0};
+  if (!opts) {
+    opts = &defaults;
+  }
+  size_t bytes = _page_round(size, opts);
+
+  void *ptr = NULL;
+  if (opts->huge == PAGE_HUGE_TLB) {
+    ptr = _page_map(bytes, MAP_HUGETLB);
+  }
+  if (!ptr && opts->huge != PAGE_HUGE_NONE) {
+    ptr = _page_map_aligned(bytes);
+    if (ptr) {
+      syscall(SYS_madvise, ptr, bytes, MADV_HUGEPAGE);
+    }
+  } else if (!ptr) {
+    ptr = _page_map(bytes, 0);
+  }
+  if (!ptr) {
+    return NULL;
+  }
+
+  // placement before the first touch, pre-faulting then lands on the node
+  if (opts->numa != PAGE_NUMA_NONE && _page_bind(ptr, bytes, opts) != 0 &&
+      opts->numa == PAGE_NUMA_BIND) {
+    munmap(ptr, bytes);
+    return NULL;
+  }
+  if (opts->prefault) {
+    _page_prefault(ptr, bytes);
+  }
+  return ptr;
+}
+
+void page_free(void *ptr, size_t size, const PageAllocOptions *opts) {
+  if (!ptr) {
+    return;
+  }
+  munmap(ptr, _page_round(size, opts));
+}
+
+#else // !__linux__
+
+#include <string.h>
+
+#ifndef CACHELINE_SIZE
+#define CACHELINE_SIZE 64
+#endif
+
+void *page_alloc(size_t size, const PageAllocOptions *opts) {
+  if (!size) {
+    return NULL;
+  }
+  // calloc only guarantees max_align_t, backends promise a cache line;
+  // the size is a multiple of the page, so of the alignment too
+  size_t bytes = _page_round(size, opts);
+  void *ptr = aligned_alloc(CACHELINE_SIZE, bytes);
+  if (ptr) {
+    memset(ptr, 0, bytes);
+  }
+  return ptr;
+}
+
+void page_free(void *ptr, size_t size, const PageAllocOptions *opts) {
+  (void)size;
+  (void)opts;
+  free(ptr);
+}
+
+#endif
+
+static void *_page_backend_alloc(size_t size, void *ctx) {
+  return page_alloc(size, (const PageAllocOptions *)ctx);
+}
+
+static void _page_backend_release(void *ptr, size_t size, void *ctx) {
+  page_free(ptr, size, (const PageAllocOptions *)ctx);
+}
+
+MemBackend page_backend(const PageAllocOptions *opts) {
+  MemBackend backend = {.alloc = _page_backend_alloc,
+                        .release = _page_backend_release,
+                        .ctx = (void *)opts};
+  return backend;
+}
+
+size_t page_numa_node_cpus(unsigned node, int *cpus, size_t max) {
+  char path[64];
+  snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist",
+           node);
+  FILE *file = fopen(path, "r");
+  if (!file) {
+    return 0;
+  }
+  // "0-3,8-11"
+  size_t count = 0;
+  int first, last;
+  char sep;
+  while (fscanf(file, "%d", &first) == 1) {
+    last = first;
+    int read = fscanf(file, "%c", &sep);
+    if (read == 1 && sep == '-') {
+      if (fscanf(file, "%d", &last) != 1) {
+        break;
+      }
+      read = fscanf(file, "%c", &sep);
+    }
+    for (int cpu = first; cpu <= last; cpu++, count++) {
+      if (count < max) {
+        cpus[count] = cpu;
+      }
+    }
+    if (read != 1 || sep != ',') {
+      break;
+    }
+  }
+  fclose(file);
+  return count;
+}
+#endif
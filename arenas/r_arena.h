@@ -68,11 +68,31 @@ RegionArena uses an epoch counter to avoid clearing memory eagerly.
 
 This makes reset O(1), regardless of total allocated memory.
 
+The clear still costs a memset of the whole region inside whichever
+allocation first touches it. Callers that initialize every element they
+allocate can skip it with r_arena_reset_mode(arena, R_ARENA_RESET_DIRTY):
+regions are then reused as they are.
+
+------------------------------------------------------------------------------
+RELEASING MEMORY
+
+Regions are kept until r_arena_free(), so a burst pins its peak RSS.
+r_arena_trim() hands the pages of regions not used in the current epoch
+back to the OS with madvise, keeping the first keep_regions resident:
+
+- R_ARENA_TRIM_DONTNEED : pages are dropped now, the region reads back as
+                          zeros (no memset on its next use)
+- R_ARENA_TRIM_FREE     : MADV_FREE, the kernel reclaims the pages only
+                          under memory pressure (cheaper, contents undefined)
+
+The regions stay mapped: reusing one just faults fresh pages in.
+
 ------------------------------------------------------------------------------
 THREADING NOTES
 
 - Allocation uses atomic counters
-- Regions are created lazily and safely across threads
+- Regions are created lazily and safely across threads (a short lock is
+  taken only to add a region or clear it after a reset)
 - Element memory itself is NOT synchronized
 
 This allocator is safe for:
@@ -110,6 +130,10 @@ Append by value copy:
 
     r_arena_add(&arena, &job);
 
+Take a contiguous span (e.g. a per-thread chunk, see tl_arena.h):
+
+    Job *jobs = r_arena_alloc_span(&arena, 64);
+
 Access elements:
 
     int *j = (int *)r_arena_get(&arena, i);
@@ -118,6 +142,11 @@ Access elements:
 Reset arena (invalidates all previous references):
 
     r_arena_reset(&arena);
+    r_arena_reset_mode(&arena, R_ARENA_RESET_DIRTY); // no zeroing
+
+Give back the pages of a burst, keeping 8 regions warm:
+
+    r_arena_trim(&arena, 8, R_ARENA_TRIM_DONTNEED);
 
 Free arena memory:
 
@@ -128,7 +157,8 @@ LIMITS & WARNINGS
 
 - Exceeding max_regions will abort()
 - References become invalid after r_arena_reset()
-- RegionArena does not shrink memory
+- RegionArena does not shrink its region table, r_arena_trim only drops
+  pages
 - No bounds checks beyond region limits
 
 ------------------------------------------------------------------------------
@@ -139,11 +169,24 @@ LIMITS & WARNINGS
 #include <stddef.h>
 #include <stdint.h>
 
+// Where large buffers come from; a NULL backend means calloc / free.
+// alloc returns zero-filled memory aligned to at least 64 bytes.
+// (arenas/page_alloc.h provides a huge page / NUMA aware one)
+#ifndef MEM_BACKEND_DEFINED
+#define MEM_BACKEND_DEFINED
+typedef struct MemBackend_t {
+  void *(*alloc)(size_t size, void *ctx);
+  void (*release)(void *ptr, size_t size, void *ctx);
+  void *ctx;
+} MemBackend;
+#endif
+
 // Represents a single memory region (chunk).
 // Epoch is used to lazily reset region contents.
 typedef struct Region_t {
   uint8_t *data;
-  size_t epoch;
+  _Atomic size_t epoch;
+  uint8_t zeroed; // contents known to be zero since the last trim
 } Region;
 
 // Segmented arena allocator composed of multiple fixed-size regions.
@@ -152,13 +195,26 @@ typedef struct RegionArena_t {
   size_t rg_capacity; // Elements per region
 
   _Atomic size_t rgs_in_use; // Number of allocated regions
+  _Atomic uint8_t grow_lock; // Held while adding or clearing a region
   _Atomic size_t count; // Total allocated elements
 
   size_t max_rgs; // Maximum allowed regions
   _Atomic size_t current_epoch; // Region pointers
   Region **regions_handler;
+  const MemBackend *backend; // Region data allocator, NULL = calloc / free
+  uint8_t reuse_dirty; // Current epoch reuses regions without zeroing
 } RegionArena;
 
+typedef enum RArenaResetMode_t {
+  R_ARENA_RESET_ZERO = 0, // regions cleared on first use (default)
+  R_ARENA_RESET_DIRTY = 1 // regions reused with their old contents
+} RArenaResetMode;
+
+typedef enum RArenaTrimMode_t {
+  R_ARENA_TRIM_DONTNEED = 0, // drop pages now, they read back as zeros
+  R_ARENA_TRIM_FREE = 1      // lazy reclaim under memory pressure
+} RArenaTrimMode;
+
 // Creates a new RegionArena.
 //
 // elem_size        - size of each element
@@ -167,14 +223,28 @@ typedef struct RegionArena_t {
 RegionArena r_arena_create(const size_t elem_size, const size_t region_capacity,
                            const size_t max_regions);
 
+// Same as r_arena_create, region data comes from `backend` (NULL = calloc).
+// The backend must outlive the arena.
+RegionArena r_arena_create_opts(const size_t elem_size,
+                                const size_t region_capacity,
+                                const size_t max_regions,
+                                const MemBackend *backend);
+
 // Copies `val` into the arena at the next available slot.
 // Returns 0 on success, non-zero on error.
 int r_arena_add(RegionArena *arena, const void *val);
 
 // Allocates space for one element and returns a pointer to it.
-// Memory is zero-initialized on first use per epoch.
+// Memory is zero-initialized on first use per epoch (unless the epoch was
+// started by a R_ARENA_RESET_DIRTY reset).
 void *r_arena_alloc(RegionArena *arena);
 
+// Allocates n contiguous elements inside one region and returns a pointer
+// to the first. When the span does not fit in the rest of the current
+// region, that tail is skipped (it stays counted, reads back as zeroed
+// elements). Returns NULL if n is 0 or larger than region_capacity.
+void *r_arena_alloc_span(RegionArena *arena, size_t n);
+
 // Returns a pointer to element at index `i`.
 // Returns NULL if out of bounds.
 const void *r_arena_get(RegionArena *arena, size_t i);
@@ -183,13 +253,25 @@ const void *r_arena_get(RegionArena *arena, size_t i);
 // Returns NULL if the arena is empty.
 const void *r_arena_get_last(RegionArena *arena);
 
-// Resets the arena by advancing the epoch.
-// All previously returned pointers become invalid.
+// Frees all memory owned by the arena.
 void r_arena_free(RegionArena *arena);
 
-// Frees all memory owned by the arena.
+// Resets the arena by advancing the epoch.
+// All previously returned pointers become invalid.
 void r_arena_reset(RegionArena *arena);
 
+// Same as r_arena_reset. With R_ARENA_RESET_DIRTY, regions reused during
+// the new epoch keep whatever the previous epochs wrote: the caller must
+// initialize every element it allocates. Fresh regions are still zeroed.
+void r_arena_reset_mode(RegionArena *arena, RArenaResetMode mode);
+
+// Releases the pages of every region past the first keep_regions that
+// holds no element of the current epoch (madvise, see RELEASING MEMORY).
+// Same rules as r_arena_reset: no concurrent arena operation.
+// Returns the number of regions trimmed (always 0 outside Linux).
+size_t r_arena_trim(RegionArena *arena, size_t keep_regions,
+                    RArenaTrimMode mode);
+
 
 /*-------------------------------------------*/
 /*      Platform-dependent cpu_relax()       */
@@ -220,9 +302,43 @@ void r_arena_reset(RegionArena *arena);
 #include <stdlib.h>
 #include <string.h>
 
+// counters when stats/stats.h came first, nothing otherwise
+#if defined(STATS_H)
+#define _R_ARENA_STATS_NOW() stats_now_ns()
+#define _R_ARENA_STATS_ADD(c, n) stats_add((c), (n))
+#else
+#define _R_ARENA_STATS_NOW() 0
+#define _R_ARENA_STATS_ADD(c, n) ((void)0)
+#endif
+
+static inline uint8_t *_r_arena_data_alloc(const RegionArena *arena) {
+  if (arena->backend) {
+    return arena->backend->alloc(arena->rg_capacity * arena->elem_size,
+                                 arena->backend->ctx);
+  }
+  return calloc(arena->rg_capacity, arena->elem_size);
+}
+
+static inline void _r_arena_data_free(const RegionArena *arena, uint8_t *data) {
+  if (arena->backend) {
+    arena->backend->release(data, arena->rg_capacity * arena->elem_size,
+                            arena->backend->ctx);
+  } else {
+    free(data);
+  }
+}
+
 RegionArena r_arena_create(const size_t elem_size, const size_t region_capacity,
                            const size_t max_regions) {
+  return r_arena_create_opts(elem_size, region_capacity, max_regions, NULL);
+}
+
+RegionArena r_arena_create_opts(const size_t elem_size,
+                                const size_t region_capacity,
+                                const size_t max_regions,
+                                const MemBackend *backend) {
   RegionArena arena;
+  arena.backend = backend;
   arena.rg_capacity = region_capacity;
   arena.elem_size = elem_size;
   arena.max_rgs = max_regions == 0 ? 1024 : max_regions;
@@ -232,40 +348,66 @@ RegionArena r_arena_create(const size_t elem_size, const size_t region_capacity,
 
   arena.regions_handler = calloc(arena.max_rgs, sizeof(Region *));
   arena.regions_handler[0] = malloc(sizeof(Region));
-  arena.regions_handler[0]->data = calloc(arena.rg_capacity, arena.elem_size);
-  arena.regions_handler[0]->epoch =
-      atomic_load_explicit(&arena.current_epoch, memory_order_acquire);
+  arena.regions_handler[0]->data = _r_arena_data_alloc(&arena);
+  arena.regions_handler[0]->zeroed = 0;
+  atomic_init(&arena.regions_handler[0]->epoch,
+              atomic_load_explicit(&arena.current_epoch, memory_order_acquire));
+  atomic_init(&arena.grow_lock, 0);
+  arena.reuse_dirty = 0;
   return arena;
 };
 
+static inline void _r_arena_lock(RegionArena *arena) {
+  while (atomic_exchange_explicit(&arena->grow_lock, 1, memory_order_acquire)) {
+    cpu_relax();
+  }
+}
+
+static inline void _r_arena_unlock(RegionArena *arena) {
+  atomic_store_explicit(&arena->grow_lock, 0, memory_order_release);
+}
+
 static inline void _ensure_region(RegionArena *arena, const size_t region) {
-  size_t used = atomic_load_explicit(&arena->rgs_in_use, memory_order_acquire);
   if (region >= arena->max_rgs) {
     abort();
   }
-  if (region < used) {
-    if (arena->regions_handler[region]->epoch !=
-        atomic_load_explicit(&arena->current_epoch, memory_order_acquire)) {
-      arena->regions_handler[region]->epoch =
-          atomic_load_explicit(&arena->current_epoch, memory_order_acquire);
-      memset(arena->regions_handler[region]->data, 0,
-             arena->rg_capacity * arena->elem_size);
-    }
+  size_t epoch =
+      atomic_load_explicit(&arena->current_epoch, memory_order_acquire);
+
+  // fast path: region published and already cleared for this epoch
+  if (region < atomic_load_explicit(&arena->rgs_in_use, memory_order_acquire) &&
+      atomic_load_explicit(&arena->regions_handler[region]->epoch,
+                           memory_order_acquire) == epoch) {
     return;
   }
 
-  if (atomic_compare_exchange_strong(&arena->rgs_in_use, &used, region + 1)) {
-    arena->regions_handler[region] = malloc(sizeof(Region));
-    arena->regions_handler[region]->data =
-        calloc(arena->rg_capacity, arena->elem_size);
-    arena->regions_handler[region]->epoch =
-        atomic_load_explicit(&arena->current_epoch, memory_order_acquire);
-  } else {
-    while (atomic_load_explicit(&arena->rgs_in_use, memory_order_acquire) <=
-           region) {
-      cpu_relax();
+  // growing and clearing happen once, under the lock: regions are published
+  // in order, and nobody can wipe a slot another thread already handed out
+  _r_arena_lock(arena);
+  size_t used = atomic_load_explicit(&arena->rgs_in_use, memory_order_relaxed);
+  while (used <= region) {
+    Region *rg = malloc(sizeof(Region));
+    rg->data = _r_arena_data_alloc(arena);
+    rg->zeroed = 0;
+    atomic_init(&rg->epoch, epoch);
+    arena->regions_handler[used] = rg;
+    used++;
+    atomic_store_explicit(&arena->rgs_in_use, used, memory_order_release);
+  }
+
+  Region *rg = arena->regions_handler[region];
+  if (atomic_load_explicit(&rg->epoch, memory_order_relaxed) != epoch) {
+    if (!rg->zeroed && !arena->reuse_dirty) {
+      uint64_t t0 = _R_ARENA_STATS_NOW();
+      memset(rg->data, 0, arena->rg_capacity * arena->elem_size);
+      _R_ARENA_STATS_ADD(STATS_ARENA_CLEARS, 1);
+      _R_ARENA_STATS_ADD(STATS_ARENA_CLEAR_NS, _R_ARENA_STATS_NOW() - t0);
+      (void)t0;
     }
+    rg->zeroed = 0;
+    atomic_store_explicit(&rg->epoch, epoch, memory_order_release);
   }
+  _r_arena_unlock(arena);
 }
 
 int r_arena_add(RegionArena *arena, const void *val) {
@@ -303,6 +445,30 @@ void *r_arena_alloc(RegionArena *arena) {
          (index * arena->elem_size);
 };
 
+void *r_arena_alloc_span(RegionArena *arena, size_t n) {
+  if (!arena || n == 0 || n > arena->rg_capacity)
+    return NULL;
+
+  size_t count = atomic_load_explicit(&arena->count, memory_order_relaxed);
+  size_t start;
+  do {
+    start = count;
+    size_t index = start % arena->rg_capacity;
+    if (index + n > arena->rg_capacity) {
+      start += arena->rg_capacity - index;
+    }
+  } while (!atomic_compare_exchange_weak_explicit(&arena->count, &count,
+                                                  start + n,
+                                                  memory_order_acq_rel,
+                                                  memory_order_relaxed));
+
+  size_t region = start / arena->rg_capacity;
+  _ensure_region(arena, region);
+
+  return (uint8_t *)arena->regions_handler[region]->data +
+         ((start % arena->rg_capacity) * arena->elem_size);
+}
+
 const void *r_arena_get(RegionArena *arena, size_t i) {
   size_t count = atomic_load_explicit(&arena->count, memory_order_acquire);
   if (!arena || i >= count || count == 0) {
@@ -335,7 +501,7 @@ void r_arena_free(RegionArena *arena) {
   size_t num_regions =
       atomic_load_explicit(&arena->rgs_in_use, memory_order_acquire);
   for (size_t z = 0; z < num_regions; z++) {
-    free(arena->regions_handler[z]->data);
+    _r_arena_data_free(arena, arena->regions_handler[z]->data);
     free(arena->regions_handler[z]);
   }
   free(arena->regions_handler);
@@ -347,7 +513,95 @@ void r_arena_free(RegionArena *arena) {
 
 /* NOTE: User is responsible for use after-free on references  */
 void r_arena_reset(RegionArena *arena) {
+  r_arena_reset_mode(arena, R_ARENA_RESET_ZERO);
+};
+
+void r_arena_reset_mode(RegionArena *arena, RArenaResetMode mode) {
+  uint64_t t0 = _R_ARENA_STATS_NOW();
+  arena->reuse_dirty = mode == R_ARENA_RESET_DIRTY;
   atomic_fetch_add_explicit(&arena->current_epoch, 1, memory_order_acq_rel);
   atomic_store_explicit(&arena->count, 0, memory_order_release);
-};
+  _R_ARENA_STATS_ADD(STATS_ARENA_RESETS, 1);
+  _R_ARENA_STATS_ADD(STATS_ARENA_RESET_NS, _R_ARENA_STATS_NOW() - t0);
+  (void)t0;
+}
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+
+extern long syscall(long number, ...);
+
+/* strict C11 hides the Linux extensions, the values are the generic ones */
+#ifndef MADV_DONTNEED
+#define MADV_DONTNEED 4
+#endif
+#ifndef MADV_FREE
+#define MADV_FREE 8
+#endif
+
+#define R_ARENA_PAGE_SIZE 4096
+
+// madvise works on whole pages: the page-aligned middle of the region is
+// released, the partial pages at both ends stay (and are cleared by hand
+// for DONTNEED, so the whole region is known to be zero)
+static int _r_arena_trim_region(const RegionArena *arena, Region *rg,
+                                RArenaTrimMode mode) {
+  size_t bytes = arena->rg_capacity * arena->elem_size;
+  uintptr_t start = (uintptr_t)rg->data;
+  uintptr_t end = start + bytes;
+  uintptr_t first = (start + R_ARENA_PAGE_SIZE - 1) &
+                    ~(uintptr_t)(R_ARENA_PAGE_SIZE - 1);
+  uintptr_t last = end & ~(uintptr_t)(R_ARENA_PAGE_SIZE - 1);
+  if (first >= last) {
+    return 0;
+  }
+
+  int advice = mode == R_ARENA_TRIM_FREE ? MADV_FREE : MADV_DONTNEED;
+  if (syscall(SYS_madvise, (void *)first, last - first, advice) != 0) {
+    return 0;
+  }
+  if (mode == R_ARENA_TRIM_DONTNEED) {
+    memset(rg->data, 0, first - start);
+    memset((void *)last, 0, end - last);
+    rg->zeroed = 1;
+  } else {
+    rg->zeroed = 0;
+  }
+  return 1;
+}
+
+size_t r_arena_trim(RegionArena *arena, size_t keep_regions,
+                    RArenaTrimMode mode) {
+  if (!arena || !arena->regions_handler) {
+    return 0;
+  }
+  size_t epoch =
+      atomic_load_explicit(&arena->current_epoch, memory_order_acquire);
+  size_t count = atomic_load_explicit(&arena->count, memory_order_acquire);
+  size_t live = (count + arena->rg_capacity - 1) / arena->rg_capacity;
+  size_t used = atomic_load_explicit(&arena->rgs_in_use, memory_order_acquire);
+
+  size_t trimmed = 0;
+  for (size_t z = keep_regions > live ? keep_regions : live; z < used; z++) {
+    Region *rg = arena->regions_handler[z];
+    if (rg->zeroed && mode == R_ARENA_TRIM_DONTNEED) {
+      continue;
+    }
+    if (_r_arena_trim_region(arena, rg, mode)) {
+      // stale epoch: the next allocation goes through _ensure_region
+      atomic_store_explicit(&rg->epoch, epoch - 1, memory_order_relaxed);
+      trimmed++;
+    }
+  }
+  return trimmed;
+}
+#else
+size_t r_arena_trim(RegionArena *arena, size_t keep_regions,
+                    RArenaTrimMode mode) {
+  (void)arena;
+  (void)keep_regions;
+  (void)mode;
+  return 0;
+}
+#endif
 #endif
@@ -26,8 +26,8 @@ StringArena — Append-only string storage arena
 
 StringArena is a simple append-only arena for storing immutable strings.
 
-All strings are stored contiguously in a single character buffer, while
-a separate offsets array keeps track of where each string begins.
+Strings are copied into large character chunks, while a separate array of
+views keeps track of where each string starts and how long it is.
 
 This design is intended for:
 - storing many small strings
@@ -38,7 +38,7 @@ This design is intended for:
 Typical use cases:
 - asset names
 - identifiers
-- interned strings (manual)
+- interned strings (see hashmap_intern in data_structures/hashmap.h)
 - debug labels
 - scripting symbols
 
@@ -47,14 +47,17 @@ MEMORY MODEL
 
 Internally, StringArena maintains two buffers:
 
-1) data buffer:
-    [ "hello\0world\0foo\0bar\0..." ]
+1) a chain of chunks holding the characters:
+    chunk 0: [ "hello\0world\0foo\0" ]
+    chunk 1: [ "bar\0..." ]          (twice as large)
 
-2) offsets array:
-    [ 0, 6, 12, 16, ... ]
+2) views array:
+    [ {"hello", 5}, {"world", 5}, {"foo", 3}, {"bar", 3}, ... ]
 
-Each call to arena_addS() appends a null-terminated string to `data`
-and records its starting offset.
+Each call to arena_addS() appends a null-terminated string to the current
+chunk and records its view. When a string doesn't fit, a new chunk twice the
+size of the previous one (up to STRING_ARENA_MAX_CHUNK, or the string's
+size if larger) is started. Chunks never move: returned strings stay valid.
 
 Strings are immutable once added.
 
@@ -86,12 +89,12 @@ Create a string arena:
 Add strings:
 
     arena_addS(&arena, "hello");
-    arena_addS(&arena, "world");
+    StrView w = arena_addS_len(&arena, line + start, n); // no strlen
 
 Retrieve strings:
 
     const char *s0 = arena_getS(&arena, 0);
-    const char *s1 = arena_getS(&arena, 1);
+    StrView v1 = arena_getS_view(&arena, 1);
 
 Reset arena (keeps allocated memory):
 
@@ -104,10 +107,10 @@ Free arena memory:
 ------------------------------------------------------------------------------
 PERFORMANCE NOTES
 
-- Adding a string is amortized O(1)
+- Adding a string is amortized O(1), characters are copied once
 - Retrieval is O(1)
 - Memory grows but never shrinks unless freed
-- Uses realloc internally
+- Reset keeps every chunk for reuse
 
 ------------------------------------------------------------------------------
 LIMITS & WARNINGS
@@ -115,21 +118,45 @@ LIMITS & WARNINGS
 - No thread safety
 - No bounds checks beyond index validation
 - arena_s_reset() does NOT free memory
-- Strings must be null-terminated
-- realloc failure silently aborts insertion
+- Strings added with arena_addS must be null-terminated; arena_addS_len
+  copies exactly len bytes and appends the terminator itself
+- Allocation failure aborts the insertion (returned view has ptr NULL)
 
 ------------------------------------------------------------------------------
 */
 #include <stddef.h>
 
+#ifndef STRING_ARENA_MIN_CHUNK
+#define STRING_ARENA_MIN_CHUNK 4096 // first chunk size in bytes
+#endif
+
+#ifndef STRING_ARENA_MAX_CHUNK
+#define STRING_ARENA_MAX_CHUNK (1024 * 1024) // geometric growth stops here
+#endif
+
+// A string stored in the arena: ptr is null-terminated, len excludes it.
+typedef struct StrView_t {
+  const char *ptr;
+  size_t len;
+} StrView;
+
+// Character storage, chained newest first.
+typedef struct StringChunk_t {
+  struct StringChunk_t *prev; // Older chunk (or next spare chunk)
+  size_t size;                // Capacity in bytes
+  size_t used;                // Used bytes
+  char data[];
+} StringChunk;
+
 // Append-only string arena.
-// Stores all strings contiguously and indexes them via offsets.
+// Stores strings in stable chunks and indexes them via views.
 typedef struct {
-  char *data; // Contiguous string buffer
-  size_t size; // Used bytes in data buffer
-  size_t *offsets; // offsets into data buffer
-  size_t count; // Number of stored strings
-  size_t capacity; // Capacity of offsets array
+  StringChunk *chunks; // Current chunk, older ones through prev
+  StringChunk *spare;  // Chunks kept by arena_s_reset
+  size_t size;         // Used bytes over all chunks
+  StrView *views;      // View of each string
+  size_t count;        // Number of stored strings
+  size_t capacity;     // Capacity of views array
 } StringArena;
 
 // Creates a new, empty StringArena.
@@ -137,63 +164,115 @@ StringArena arena_s_create(void);
 
 // Appends a null-terminated string to the arena.
 // The string is copied into internal storage.
-void arena_addS(StringArena *arena, const char *val);
+// Returns the stored copy, ptr is NULL if allocation failed.
+StrView arena_addS(StringArena *arena, const char *val);
+
+// Appends the len bytes at val (need not be null-terminated) followed by a
+// terminator. Returns the stored copy, ptr is NULL if allocation failed.
+StrView arena_addS_len(StringArena *arena, const char *val, size_t len);
 
 // Returns the string at index `i`.
 // Returns NULL if index is out of bounds.
 const char *arena_getS(StringArena *arena, size_t i);
 
-// Resets the arena to empty state.
-// Allocated memory is kept for reuse.
-void arena_s_free(StringArena *arena);
+// Returns the string at index `i` with its length.
+// Returns {NULL, 0} if index is out of bounds.
+StrView arena_getS_view(StringArena *arena, size_t i);
 
 // Frees all memory owned by the arena.
 // The arena must not be used afterwards.
+void arena_s_free(StringArena *arena);
+
+// Resets the arena to empty state.
+// Allocated memory is kept for reuse.
 void arena_s_reset(StringArena *arena);
 #endif
 
 #if (defined(STRING_ARENA_IMPLEMENTATION))
-#include "string_arena.h"
 #include <stdlib.h>
 #include <string.h>
 
 StringArena arena_s_create() {
   StringArena a;
-  a.data = (void *)0; // NULL
+  a.chunks = (void *)0; // NULL
+  a.spare = (void *)0;  // NULL
   a.size = 0;
-  a.offsets = (void *)0; // NULL
+  a.views = (void *)0; // NULL
   a.count = 0;
   a.capacity = 0;
 
   return a;
 }
 
-void arena_addS(StringArena *arena, const char *val) {
-  size_t len = strlen(val) + 1;
+// Makes room for bytes in the current chunk: reuses a spare chunk or
+// allocates one twice the size of the current.
+static StringChunk *_arena_s_chunk_for(StringArena *arena, size_t bytes) {
+  StringChunk *chunk = arena->chunks;
+  if (chunk && chunk->size - chunk->used >= bytes) {
+    return chunk;
+  }
+
+  StringChunk **link = &arena->spare;
+  while (*link && (*link)->size < bytes) {
+    link = &(*link)->prev;
+  }
+  StringChunk *next = *link;
+  if (next) {
+    *link = next->prev;
+  } else {
+    size_t size = chunk ? chunk->size * 2 : STRING_ARENA_MIN_CHUNK;
+    if (size > STRING_ARENA_MAX_CHUNK) {
+      size = STRING_ARENA_MAX_CHUNK;
+    }
+    if (size < bytes) {
+      size = bytes;
+    }
+    next = malloc(sizeof(StringChunk) + size);
+    if (!next) {
+      return NULL;
+    }
+    next->size = size;
+  }
+  next->used = 0;
+  next->prev = chunk;
+  arena->chunks = next;
+  return next;
+}
+
+StrView arena_addS(StringArena *arena, const char *val) {
+  return arena_addS_len(arena, val, strlen(val));
+}
+
+StrView arena_addS_len(StringArena *arena, const char *val, size_t len) {
+  StrView view = {NULL, 0};
 
   if (arena->count == arena->capacity) {
     size_t new_cap = arena->capacity == 0 ? 4 : arena->capacity * 2;
-    void *tmp = realloc(arena->offsets, new_cap * sizeof(size_t));
+    void *tmp = realloc(arena->views, new_cap * sizeof(StrView));
 
     if (!tmp) {
-      return;
+      return view;
     }
-    arena->offsets = tmp;
+    arena->views = tmp;
     arena->capacity = new_cap;
   }
 
-  char *buf = realloc(arena->data, arena->size + len);
+  StringChunk *chunk = _arena_s_chunk_for(arena, len + 1);
+  if (!chunk)
+    return view;
 
-  if (!buf)
-    return;
+  char *dst = chunk->data + chunk->used;
+  memcpy(dst, val, len);
+  dst[len] = '\0';
+  chunk->used += len + 1;
 
-  arena->data = buf;
+  view.ptr = dst;
+  view.len = len;
+  arena->views[arena->count] = view;
 
-  arena->offsets[arena->count] = arena->size;
-  memcpy(arena->data + arena->size, val, len);
-
-  arena->size += len;
+  arena->size += len + 1;
   arena->count++;
+  return view;
 }
 
 const char *arena_getS(StringArena *arena, size_t i) {
@@ -201,15 +280,37 @@ const char *arena_getS(StringArena *arena, size_t i) {
     return NULL;
   }
 
-  return arena->data + arena->offsets[i];
+  return arena->views[i].ptr;
+}
+
+StrView arena_getS_view(StringArena *arena, size_t i) {
+  if (i >= arena->count) {
+    StrView none = {NULL, 0};
+    return none;
+  }
+
+  return arena->views[i];
 }
 
 void arena_s_free(StringArena *arena) {
-  free(arena->data);
-  free(arena->offsets);
+  arena_s_reset(arena);
+  while (arena->spare) {
+    StringChunk *chunk = arena->spare;
+    arena->spare = chunk->prev;
+    free(chunk);
+  }
+  free(arena->views);
+  arena->views = NULL;
+  arena->capacity = 0;
 }
 
 void arena_s_reset(StringArena *arena) {
+  while (arena->chunks) {
+    StringChunk *chunk = arena->chunks;
+    arena->chunks = chunk->prev;
+    chunk->prev = arena->spare;
+    arena->spare = chunk;
+  }
   arena->size = 0;
   arena->count = 0;
 }
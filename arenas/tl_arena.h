@@ -0,0 +1,214 @@
+// Copyright 2025 Seaker <seakerone@proton.me>
+
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+/*
+------------------------------------------------------------------------------
+TlArena — Thread-local bump front end for RegionArena
+
+r_arena_alloc() does an atomic fetch-add on the arena's shared count for
+every element, so threads allocating at the same time keep bouncing that
+cache line. TlArena takes a chunk of contiguous elements from a shared
+RegionArena at once and hands them out from a per-thread cache with a
+plain pointer bump: one atomic operation per chunk instead of per element.
+
+- The TlArena itself is shared (one per backing RegionArena).
+- Each thread owns a TlArenaCache, usually a _Thread_local variable.
+- tl_arena_reset() resets the backing arena and invalidates every cache's
+  current chunk in bulk: the next allocation of each thread takes a fresh
+  chunk.
+
+------------------------------------------------------------------------------
+USAGE
+
+Requires arenas/r_arena.h, included before.
+
+In exactly ONE source file:
+
+    #define TL_ARENA_IMPLEMENTATION
+    #include "tl_arena.h"
+
+Create the front end over a RegionArena:
+
+    RegionArena backing = r_arena_create(sizeof(Node), 4096, 1024);
+    TlArena nodes = tl_arena_create(&backing, 64);
+
+Allocate from any thread:
+
+    static _Thread_local TlArenaCache t_nodes;
+    Node *n = tl_arena_alloc(&nodes, &t_nodes);
+
+Reset (same rules as r_arena_reset, nobody may allocate meanwhile):
+
+    tl_arena_reset(&nodes);
+
+------------------------------------------------------------------------------
+THREADING NOTES
+
+- tl_arena_alloc() is safe from any thread as long as every thread passes
+  its own cache.
+- The fast path touches only the cache; the backing arena is used once per
+  chunk through r_arena_alloc_span().
+- The elements left in a thread's chunk stay unused until the next reset
+  (at most chunk - 1 per thread and arena).
+- Epochs are unique per process: a cache can't mistake a chunk of a freed
+  arena for one of a new arena at the same address.
+
+------------------------------------------------------------------------------
+*/
+#ifndef TL_ARENA_H
+#define TL_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct RegionArena_t RegionArena;
+
+#define TL_ARENA_DEFAULT_CHUNK 64
+
+// Shared front end over one RegionArena.
+typedef struct TlArena_t {
+  RegionArena *backing;
+  size_t chunk; // Elements taken from the backing arena at once
+  size_t epoch; // Changed by tl_arena_reset, invalidates cached chunks
+} TlArena;
+
+// Per-thread allocation state, zero-initialized before first use.
+typedef struct TlArenaCache_t {
+  const TlArena *arena; // Arena the current chunk belongs to
+  size_t epoch;
+  uint8_t *next;
+  uint8_t *end;
+} TlArenaCache;
+
+/*-----------------------------------------------------------------------------
+  tl_arena_create
+  Creates a thread-local front end over backing.
+
+  backing : RegionArena the chunks are carved from, must outlive the TlArena
+  chunk   : elements per chunk (0 = TL_ARENA_DEFAULT_CHUNK), clamped to the
+            backing arena's region capacity
+
+  Notes:
+    - The backing arena can still be used directly; both paths draw from
+      the same count.
+-----------------------------------------------------------------------------*/
+TlArena tl_arena_create(RegionArena *backing, size_t chunk);
+
+/*-----------------------------------------------------------------------------
+  tl_arena_alloc
+  Returns one element, zero-initialized on first use per epoch like
+  r_arena_alloc.
+
+  cache : the calling thread's cache, never shared between threads
+
+  Returns NULL if arena or cache is NULL.
+
+  Notes:
+    - Exceeding the backing arena's max_regions aborts (see r_arena.h).
+-----------------------------------------------------------------------------*/
+void *tl_arena_alloc(TlArena *arena, TlArenaCache *cache);
+
+/*-----------------------------------------------------------------------------
+  tl_arena_cache_drop
+  Forgets the cache's current chunk, its remaining elements are not reused
+  before the next reset. Call it before a thread gives up the cache for
+  good, optional otherwise.
+-----------------------------------------------------------------------------*/
+void tl_arena_cache_drop(TlArenaCache *cache);
+
+/*-----------------------------------------------------------------------------
+  tl_arena_reset
+  Resets the backing arena with r_arena_reset and invalidates every cached
+  chunk. Every pointer handed out before becomes invalid.
+
+  Notes:
+    - Not thread-safe: no thread may allocate from the arena meanwhile, and
+      threads must synchronize with the resetting thread (barrier, join)
+      before allocating again.
+-----------------------------------------------------------------------------*/
+void tl_arena_reset(TlArena *arena);
+
+#endif // !TL_ARENA_H
+
+#if (defined(TL_ARENA_IMPLEMENTATION))
+#include <stdatomic.h>
+
+// source of unique epochs across all TlArenas of the process
+static _Atomic size_t g_tl_arena_epochs = 0;
+
+TlArena tl_arena_create(RegionArena *backing, size_t chunk) {
+  TlArena arena;
+  arena.backing = backing;
+  arena.chunk = chunk == 0 ? TL_ARENA_DEFAULT_CHUNK : chunk;
+  if (backing && arena.chunk > backing->rg_capacity) {
+    arena.chunk = backing->rg_capacity;
+  }
+  arena.epoch =
+      atomic_fetch_add_explicit(&g_tl_arena_epochs, 1, memory_order_relaxed) +
+      1;
+  return arena;
+}
+
+/* slow path: one span from the backing arena */
+static int _tl_arena_refill(TlArena *arena, TlArenaCache *cache) {
+  uint8_t *chunk = (uint8_t *)r_arena_alloc_span(arena->backing, arena->chunk);
+  if (!chunk) {
+    return 0;
+  }
+  cache->arena = arena;
+  cache->epoch = arena->epoch;
+  cache->next = chunk;
+  cache->end = chunk + arena->chunk * arena->backing->elem_size;
+  return 1;
+}
+
+void *tl_arena_alloc(TlArena *arena, TlArenaCache *cache) {
+  if (!arena || !cache) {
+    return NULL;
+  }
+  if ((cache->next == cache->end || cache->arena != arena ||
+       cache->epoch != arena->epoch) &&
+      !_tl_arena_refill(arena, cache)) {
+    return NULL;
+  }
+  void *elem = cache->next;
+  cache->next += arena->backing->elem_size;
+  return elem;
+}
+
+void tl_arena_cache_drop(TlArenaCache *cache) {
+  if (!cache) {
+    return;
+  }
+  cache->arena = NULL;
+  cache->next = NULL;
+  cache->end = NULL;
+}
+
+void tl_arena_reset(TlArena *arena) {
+  if (!arena) {
+    return;
+  }
+  r_arena_reset(arena->backing);
+  arena->epoch =
+      atomic_fetch_add_explicit(&g_tl_arena_epochs, 1, memory_order_relaxed) +
+      1;
+}
+#endif
@@ -0,0 +1,259 @@
+/*
+------------------------------------------------------------------------------
+bench.h — Shared benchmark harness (timers, latency histogram, JSON output)
+
+Used by the benchmarks/bench_*.c programs:
+
+- bench_ticks() reads the TSC on x86-64 (rdtsc) and CLOCK_MONOTONIC
+  elsewhere; bench_ns_per_tick() calibrates it once against the clock.
+- BenchHist is a log-linear latency histogram in the spirit of HDR
+  Histogram: values below 32 are exact, above that every power of two is
+  split in 32 buckets (about 3% relative error). Recording is one add and
+  a count-leading-zeros, histograms of several threads merge exactly.
+- bench_report() prints one result as a single JSON object per line (JSON
+  Lines) on stdout, with the same keys for every benchmark, so runs can be
+  diffed and plotted without parsing human text. Progress goes to stderr.
+
+------------------------------------------------------------------------------
+USAGE
+
+In exactly ONE source file:
+
+    #define BENCH_IMPLEMENTATION
+    #include "bench.h"
+
+    BenchHist h;
+    bench_hist_reset(&h);
+    uint64_t t0 = bench_ticks();
+    work();
+    bench_hist_record(&h, bench_ticks_to_ns(bench_ticks() - t0));
+
+    BenchResult r = {.suite = "demo", .bench = "work", .ops = 1,
+                     .elapsed_ns = ..., .latency = &h};
+    bench_report(&r);
+
+Output line:
+
+    {"suite":"demo","bench":"work","mode":"","producers":0,"consumers":0,
+     "payload":0,"param":0,"ops":1,"elapsed_ns":...,"ns_per_op":...,
+     "mops":...,"p50_ns":...,"p90_ns":...,"p99_ns":...,"p999_ns":...,
+     "max_ns":...}
+
+The latency keys are null when the result has no histogram.
+
+------------------------------------------------------------------------------
+NOTES
+
+- Cross-thread latencies (stamp in one thread, read in another) rely on
+  an invariant TSC synchronized across cores, which every x86-64 CPU of
+  the last decade has. Build with -DBENCH_NO_TSC to use the clock instead.
+- percentiles report the highest value of their bucket, capped by the
+  largest recorded value.
+
+------------------------------------------------------------------------------
+*/
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef BENCH_HIST_SUB_BITS
+#define BENCH_HIST_SUB_BITS 5 // 32 buckets per power of two
+#endif
+#define BENCH_HIST_SUB (1u << BENCH_HIST_SUB_BITS)
+#define BENCH_HIST_BUCKETS ((64 - BENCH_HIST_SUB_BITS + 1) * BENCH_HIST_SUB)
+
+typedef struct BenchHist_t {
+  uint64_t counts[BENCH_HIST_BUCKETS];
+  uint64_t total;
+  uint64_t min;
+  uint64_t max;
+  double sum;
+} BenchHist;
+
+/*-----------------------------------------------------------------------------
+  BenchResult
+  One line of output. Unused counts stay 0, unused strings NULL ("").
+
+  suite      : program, e.g. "channels"
+  bench      : what ran, e.g. "mpmc"
+  mode       : variant, e.g. "throughput" / "rtt"
+  producers  : producer threads (or workers)
+  consumers  : consumer threads
+  payload    : bytes per element / allocation
+  param      : benchmark specific (chain depth, task count, ...)
+  ops        : operations timed
+  elapsed_ns : wall time of the ops
+  latency    : per-op histogram in ns, or NULL
+-----------------------------------------------------------------------------*/
+typedef struct BenchResult_t {
+  const char *suite;
+  const char *bench;
+  const char *mode;
+  size_t producers;
+  size_t consumers;
+  size_t payload;
+  size_t param;
+  uint64_t ops;
+  uint64_t elapsed_ns;
+  const BenchHist *latency;
+} BenchResult;
+
+uint64_t bench_now_ns(void);
+uint64_t bench_ticks(void);
+double bench_ns_per_tick(void);
+uint64_t bench_ticks_to_ns(uint64_t ticks);
+
+void bench_hist_reset(BenchHist *h);
+void bench_hist_record(BenchHist *h, uint64_t value);
+void bench_hist_merge(BenchHist *dst, const BenchHist *src);
+uint64_t bench_hist_percentile(const BenchHist *h, double percentile);
+
+void bench_report(const BenchResult *r);
+
+#endif // !BENCH_H
+
+#if (defined(BENCH_IMPLEMENTATION))
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+uint64_t bench_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+#if defined(__x86_64__) && !defined(BENCH_NO_TSC)
+uint64_t bench_ticks(void) {
+  uint32_t lo, hi;
+  __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+  return (uint64_t)hi << 32 | lo;
+}
+
+static double _bench_ns_per_tick = 0.0;
+
+double bench_ns_per_tick(void) {
+  if (_bench_ns_per_tick == 0.0) {
+    // 20 ms against the monotonic clock: well under 0.1% error
+    uint64_t n0 = bench_now_ns();
+    uint64_t t0 = bench_ticks();
+    while (bench_now_ns() - n0 < 20000000ull) {
+    }
+    uint64_t n1 = bench_now_ns();
+    uint64_t t1 = bench_ticks();
+    _bench_ns_per_tick = (double)(n1 - n0) / (double)(t1 - t0);
+  }
+  return _bench_ns_per_tick;
+}
+#else
+uint64_t bench_ticks(void) { return bench_now_ns(); }
+
+double bench_ns_per_tick(void) { return 1.0; }
+#endif
+
+uint64_t bench_ticks_to_ns(uint64_t ticks) {
+  return (uint64_t)((double)ticks * bench_ns_per_tick());
+}
+
+void bench_hist_reset(BenchHist *h) {
+  memset(h, 0, sizeof(*h));
+  h->min = UINT64_MAX;
+}
+
+static inline size_t _bench_hist_index(uint64_t v) {
+  if (v < BENCH_HIST_SUB) {
+    return (size_t)v;
+  }
+  unsigned msb = 63u - (unsigned)__builtin_clzll(v);
+  unsigned e = msb - BENCH_HIST_SUB_BITS;
+  // v >> e is in [SUB, 2 * SUB): the bucket within that power of two
+  return (size_t)e * BENCH_HIST_SUB + (size_t)(v >> e);
+}
+
+// highest value that lands in bucket i
+static inline uint64_t _bench_hist_upper(size_t i) {
+  if (i < 2 * BENCH_HIST_SUB) {
+    return (uint64_t)i;
+  }
+  unsigned e = (unsigned)(i / BENCH_HIST_SUB) - 1;
+  uint64_t sub = (uint64_t)(i % BENCH_HIST_SUB) + BENCH_HIST_SUB;
+  return ((sub + 1) << e) - 1;
+}
+
+void bench_hist_record(BenchHist *h, uint64_t value) {
+  h->counts[_bench_hist_index(value)]++;
+  h->total++;
+  h->sum += (double)value;
+  if (value < h->min) {
+    h->min = value;
+  }
+  if (value > h->max) {
+    h->max = value;
+  }
+}
+
+void bench_hist_merge(BenchHist *dst, const BenchHist *src) {
+  for (size_t i = 0; i < BENCH_HIST_BUCKETS; i++) {
+    dst->counts[i] += src->counts[i];
+  }
+  dst->total += src->total;
+  dst->sum += src->sum;
+  if (src->min < dst->min) {
+    dst->min = src->min;
+  }
+  if (src->max > dst->max) {
+    dst->max = src->max;
+  }
+}
+
+uint64_t bench_hist_percentile(const BenchHist *h, double percentile) {
+  if (h->total == 0) {
+    return 0;
+  }
+  uint64_t rank = (uint64_t)(percentile / 100.0 * (double)h->total + 0.5);
+  if (rank == 0) {
+    rank = 1;
+  }
+  uint64_t seen = 0;
+  for (size_t i = 0; i < BENCH_HIST_BUCKETS; i++) {
+    seen += h->counts[i];
+    if (seen >= rank) {
+      uint64_t v = _bench_hist_upper(i);
+      return v < h->max ? v : h->max;
+    }
+  }
+  return h->max;
+}
+
+void bench_report(const BenchResult *r) {
+  double ns_per_op = r->ops ? (double)r->elapsed_ns / (double)r->ops : 0.0;
+  double mops =
+      r->elapsed_ns ? (double)r->ops * 1e3 / (double)r->elapsed_ns : 0.0;
+
+  printf("{\"suite\":\"%s\",\"bench\":\"%s\",\"mode\":\"%s\","
+         "\"producers\":%zu,\"consumers\":%zu,\"payload\":%zu,\"param\":%zu,"
+         "\"ops\":%llu,\"elapsed_ns\":%llu,\"ns_per_op\":%.2f,\"mops\":%.3f,",
+         r->suite ? r->suite : "", r->bench ? r->bench : "",
+         r->mode ? r->mode : "", r->producers, r->consumers, r->payload,
+         r->param, (unsigned long long)r->ops,
+         (unsigned long long)r->elapsed_ns, ns_per_op, mops);
+
+  const BenchHist *h = r->latency;
+  if (h && h->total) {
+    printf("\"p50_ns\":%llu,\"p90_ns\":%llu,\"p99_ns\":%llu,"
+           "\"p999_ns\":%llu,\"max_ns\":%llu}\n",
+           (unsigned long long)bench_hist_percentile(h, 50.0),
+           (unsigned long long)bench_hist_percentile(h, 90.0),
+           (unsigned long long)bench_hist_percentile(h, 99.0),
+           (unsigned long long)bench_hist_percentile(h, 99.9),
+           (unsigned long long)h->max);
+  } else {
+    printf("\"p50_ns\":null,\"p90_ns\":null,\"p99_ns\":null,"
+           "\"p999_ns\":null,\"max_ns\":null}\n");
+  }
+  fflush(stdout);
+}
+
+#endif
@@ -0,0 +1,115 @@
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REGION_ARENA_IMPLEMENTATION
+#include "../arenas/r_arena.h"
+#define MYSTACK_IMPLEMENTATION
+#include "../data_structures/stack.h"
+#define BENCH_IMPLEMENTATION
+#include "bench.h"
+
+/*
+ * Region arena benchmark: one JSON line per run (see bench.h)
+ * -----------------------------
+ * BENCH_ALLOCS allocations of 16 / 64 / 256 bytes, one byte written to
+ * each, then everything released; BENCH_ROUNDS rounds after a warm-up:
+ *   "r_arena_alloc"       : r_arena_alloc, then r_arena_reset
+ *   "r_arena_alloc_dirty" : same, R_ARENA_RESET_DIRTY (no re-zeroing)
+ *   "obj_pool"            : obj_pool_get, then obj_pool_put in allocation
+ *                           order (one thread, magazines and depot)
+ *   "malloc"              : malloc, then free in allocation order
+ * ns_per_op includes the release, divided over the allocations.
+ * */
+
+#ifndef BENCH_ALLOCS
+#define BENCH_ALLOCS 1000000
+#endif
+#ifndef BENCH_ROUNDS
+#define BENCH_ROUNDS 10
+#endif
+#define REGION_CAPACITY 4096
+
+static const size_t sizes[] = {16, 64, 256};
+static void *ptrs[BENCH_ALLOCS];
+
+static void report(const char *bench, size_t size, uint64_t elapsed) {
+  BenchResult r = {.suite = "arena",
+                   .bench = bench,
+                   .payload = size,
+                   .param = BENCH_ROUNDS,
+                   .ops = (uint64_t)BENCH_ALLOCS * BENCH_ROUNDS,
+                   .elapsed_ns = elapsed};
+  bench_report(&r);
+}
+
+static void run_arena(size_t size, RArenaResetMode mode) {
+  RegionArena arena = r_arena_create(size, REGION_CAPACITY,
+                                     BENCH_ALLOCS / REGION_CAPACITY + 1);
+  uint64_t t0 = 0;
+  for (size_t round = 0; round <= BENCH_ROUNDS; round++) {
+    if (round == 1) {
+      t0 = bench_now_ns(); // round 0 allocated the regions
+    }
+    for (size_t i = 0; i < BENCH_ALLOCS; i++) {
+      uint8_t *p = r_arena_alloc(&arena);
+      *p = (uint8_t)i;
+    }
+    r_arena_reset_mode(&arena, mode);
+  }
+  report(mode == R_ARENA_RESET_DIRTY ? "r_arena_alloc_dirty" : "r_arena_alloc",
+         size, bench_now_ns() - t0);
+  r_arena_free(&arena);
+}
+
+static void run_pool(size_t size) {
+  ObjPool *pool = obj_pool_create(size, BENCH_ALLOCS);
+  ObjPoolCache cache = {0};
+  uint64_t t0 = 0;
+  for (size_t round = 0; round <= BENCH_ROUNDS; round++) {
+    if (round == 1) {
+      t0 = bench_now_ns();
+    }
+    for (size_t i = 0; i < BENCH_ALLOCS; i++) {
+      uint8_t *p = obj_pool_get(pool, &cache);
+      *p = (uint8_t)i;
+      ptrs[i] = p;
+    }
+    for (size_t i = 0; i < BENCH_ALLOCS; i++) {
+      obj_pool_put(pool, &cache, ptrs[i]);
+    }
+  }
+  report("obj_pool", size, bench_now_ns() - t0);
+  obj_pool_destroy(pool);
+}
+
+static void run_malloc(size_t size) {
+  uint64_t t0 = 0;
+  for (size_t round = 0; round <= BENCH_ROUNDS; round++) {
+    if (round == 1) {
+      t0 = bench_now_ns();
+    }
+    for (size_t i = 0; i < BENCH_ALLOCS; i++) {
+      uint8_t *p = malloc(size);
+      *p = (uint8_t)i;
+      ptrs[i] = p;
+    }
+    for (size_t i = 0; i < BENCH_ALLOCS; i++) {
+      free(ptrs[i]);
+    }
+  }
+  report("malloc", size, bench_now_ns() - t0);
+}
+
+int main(void) {
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    fprintf(stderr, "arena: %zu bytes\n", sizes[s]);
+    run_arena(sizes[s], R_ARENA_RESET_ZERO);
+    run_arena(sizes[s], R_ARENA_RESET_DIRTY);
+    run_pool(sizes[s]);
+    run_malloc(sizes[s]);
+  }
+  return 0;
+}
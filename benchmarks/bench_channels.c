@@ -0,0 +1,473 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHANNEL_BASICS_IMPLEMENTATION
+#include "../channels/channels.h"
+#define SPSC_IMPLEMENTATION
+#include "../channels/spsc.h"
+#define SPMC_IMPLEMENTATION
+#include "../channels/spmc.h"
+#define MPSC_IMPLEMENTATION
+#include "../channels/mpsc.h"
+#define MPMC_IMPLEMENTATION
+#include "../channels/mpmc.h"
+#define BENCH_IMPLEMENTATION
+#include "bench.h"
+
+/*
+ * Channel benchmark: one JSON line per run (see bench.h)
+ * -----------------------------
+ * mode "throughput": P producers push BENCH_MESSAGES elements in total
+ *   through one channel to C consumers, for every channel kind, P x C in
+ *   {1, 2, 4} (as far as the kind allows) and payloads of 8 / 64 / 512
+ *   bytes. Every BENCH_LAT_SAMPLE-th element carries the TSC at send; the
+ *   consumer records now - stamp, so the percentiles are send-to-receive
+ *   latencies under full load (queueing included).
+ * mode "rtt": one thread echoes every element back through a second
+ *   channel of the same kind; each round trip is timed on its own, on an
+ *   otherwise idle channel.
+ *
+ * BENCH_WAIT selects the channels' wait strategy (CHANNEL_WAIT_YIELD, so
+ * the runs with more threads than cores finish on small hosts); build
+ * with CHANNEL_WAIT_SPIN on a machine with a core per thread.
+ * SPSC has no strategy of its own, its loops back off the same way.
+ * */
+
+#ifndef BENCH_MESSAGES
+#define BENCH_MESSAGES 2000000
+#endif
+#ifndef BENCH_RTT_ROUNDS
+#define BENCH_RTT_ROUNDS 100000
+#endif
+#ifndef BENCH_CAPACITY
+#define BENCH_CAPACITY 4096
+#endif
+#ifndef BENCH_LAT_SAMPLE
+#define BENCH_LAT_SAMPLE 16 // stamp one element in 16
+#endif
+#ifndef BENCH_WAIT
+#define BENCH_WAIT CHANNEL_WAIT_YIELD
+#endif
+
+#define MAX_PAYLOAD 512
+#define MAX_THREADS 4
+
+static const size_t payloads[] = {8, 64, 512};
+static const size_t counts[] = {1, 2, 4};
+
+typedef struct {
+  uint64_t stamp; // bench_ticks() at send, 0 = not sampled
+  uint8_t bytes[MAX_PAYLOAD - sizeof(uint64_t)];
+} Msg;
+
+/*
+ * Every kind behind the same calls. send / recv wait until they succeed;
+ * recv returns CHANNEL_ERR_CLOSED once the channel is closed and drained.
+ * The bodies below take the table as a constant and are always inlined,
+ * so the calls resolve statically in each kind's thread functions.
+ * */
+typedef struct {
+  const char *name;
+  size_t max_producers;
+  size_t max_consumers;
+  void *(*create)(size_t elem_size);
+  void *(*sender)(void *chan);
+  void *(*receiver)(void *chan);
+  int (*send)(void *tx, const void *elem);
+  int (*recv)(void *chan, void *rx, void *out);
+  void (*sender_done)(void *tx);
+  void (*receiver_done)(void *rx);
+  void (*close)(void *chan);
+  void (*destroy)(void *chan);
+} ChanOps;
+
+static inline void backoff(uint32_t *round) {
+  ChanWaitStrategy w = BENCH_WAIT == CHANNEL_WAIT_SPIN ? CHANNEL_WAIT_SPIN
+                                                       : CHANNEL_WAIT_YIELD;
+  chan_wait_step(w, round);
+}
+
+static const ChannelOptions chan_opts = {.wait = BENCH_WAIT};
+
+/* ---------------- SPSC ---------------- */
+static void *spsc_b_create(size_t elem_size) {
+  return channel_create_spsc(BENCH_CAPACITY, elem_size);
+}
+static void *spsc_b_sender(void *c) { return spsc_get_sender(c); }
+static void *spsc_b_receiver(void *c) { return spsc_get_receiver(c); }
+static int spsc_b_send(void *tx, const void *e) {
+  uint32_t round = 0;
+  int r;
+  while ((r = spsc_try_send(tx, e)) == CHANNEL_ERR_FULL) {
+    backoff(&round);
+  }
+  return r;
+}
+static int spsc_b_recv(void *c, void *rx, void *out) {
+  uint32_t round = 0;
+  for (;;) {
+    if (spsc_recv(rx, out) == CHANNEL_OK) {
+      return CHANNEL_OK;
+    }
+    if (spsc_is_closed(c) == CLOSED) {
+      // the close comes after the last send: one more look drains it
+      return spsc_recv(rx, out) == CHANNEL_OK ? CHANNEL_OK
+                                              : CHANNEL_ERR_CLOSED;
+    }
+    backoff(&round);
+  }
+}
+static void spsc_b_close(void *c) { spsc_close(c); }
+static void spsc_b_destroy(void *c) { spsc_destroy(c); }
+
+/* ---------------- SPMC ---------------- */
+static void *spmc_b_create(size_t elem_size) {
+  return channel_create_spmc_opts(BENCH_CAPACITY, elem_size, &chan_opts);
+}
+static void *spmc_b_sender(void *c) { return spmc_get_sender(c); }
+static void *spmc_b_receiver(void *c) { return spmc_get_receiver(c); }
+static int spmc_b_send(void *tx, const void *e) { return spmc_send(tx, e); }
+static int spmc_b_recv(void *c, void *rx, void *out) {
+  (void)c;
+  return spmc_recv(rx, out);
+}
+static void spmc_b_receiver_done(void *rx) {
+  spmc_close_receiver(rx);
+  free(rx);
+}
+static void spmc_b_close(void *c) { spmc_close(c); }
+static void spmc_b_destroy(void *c) { spmc_destroy(c); }
+
+/* ---------------- MPSC ---------------- */
+static void *mpsc_b_create(size_t elem_size) {
+  return channel_create_mpsc_opts(BENCH_CAPACITY, elem_size, &chan_opts);
+}
+static void *mpsc_b_sender(void *c) { return mpsc_get_sender(c); }
+static void *mpsc_b_receiver(void *c) { return mpsc_get_receiver(c); }
+static int mpsc_b_send(void *tx, const void *e) { return mpsc_send(tx, e); }
+static int mpsc_b_recv(void *c, void *rx, void *out) {
+  uint32_t round = 0;
+  for (;;) {
+    if (mpsc_recv(rx, out) == CHANNEL_OK) {
+      return CHANNEL_OK;
+    }
+    if (mpsc_is_closed(c) == CLOSED) {
+      return mpsc_recv(rx, out) == CHANNEL_OK ? CHANNEL_OK
+                                              : CHANNEL_ERR_CLOSED;
+    }
+    backoff(&round);
+  }
+}
+static void mpsc_b_sender_done(void *tx) {
+  mpsc_close_sender(tx);
+  free(tx);
+}
+static void mpsc_b_close(void *c) { mpsc_close(c); }
+static void mpsc_b_destroy(void *c) { mpsc_destroy(c); }
+
+/* ---------------- MPMC ---------------- */
+static void *mpmc_b_create(size_t elem_size) {
+  return channel_create_mpmc_opts(BENCH_CAPACITY, elem_size, &chan_opts);
+}
+static void *mpmc_b_sender(void *c) { return mpmc_get_sender(c); }
+static void *mpmc_b_receiver(void *c) { return mpmc_get_receiver(c); }
+static int mpmc_b_send(void *tx, const void *e) { return mpmc_send(tx, e); }
+static int mpmc_b_recv(void *c, void *rx, void *out) {
+  (void)c;
+  return mpmc_recv(rx, out);
+}
+static void mpmc_b_sender_done(void *tx) {
+  mpmc_close_sender(tx);
+  free(tx);
+}
+static void mpmc_b_receiver_done(void *rx) {
+  mpmc_close_receiver(rx);
+  free(rx);
+}
+static void mpmc_b_close(void *c) { mpmc_close(c); }
+static void mpmc_b_destroy(void *c) { mpmc_destroy(c); }
+
+static const ChanOps spsc_ops = {.name = "spsc",
+                                 .max_producers = 1,
+                                 .max_consumers = 1,
+                                 .create = spsc_b_create,
+                                 .sender = spsc_b_sender,
+                                 .receiver = spsc_b_receiver,
+                                 .send = spsc_b_send,
+                                 .recv = spsc_b_recv,
+                                 .sender_done = free,
+                                 .receiver_done = free,
+                                 .close = spsc_b_close,
+                                 .destroy = spsc_b_destroy};
+static const ChanOps spmc_ops = {.name = "spmc",
+                                 .max_producers = 1,
+                                 .max_consumers = MAX_THREADS,
+                                 .create = spmc_b_create,
+                                 .sender = spmc_b_sender,
+                                 .receiver = spmc_b_receiver,
+                                 .send = spmc_b_send,
+                                 .recv = spmc_b_recv,
+                                 .sender_done = free,
+                                 .receiver_done = spmc_b_receiver_done,
+                                 .close = spmc_b_close,
+                                 .destroy = spmc_b_destroy};
+static const ChanOps mpsc_ops = {.name = "mpsc",
+                                 .max_producers = MAX_THREADS,
+                                 .max_consumers = 1,
+                                 .create = mpsc_b_create,
+                                 .sender = mpsc_b_sender,
+                                 .receiver = mpsc_b_receiver,
+                                 .send = mpsc_b_send,
+                                 .recv = mpsc_b_recv,
+                                 .sender_done = mpsc_b_sender_done,
+                                 .receiver_done = free,
+                                 .close = mpsc_b_close,
+                                 .destroy = mpsc_b_destroy};
+static const ChanOps mpmc_ops = {.name = "mpmc",
+                                 .max_producers = MAX_THREADS,
+                                 .max_consumers = MAX_THREADS,
+                                 .create = mpmc_b_create,
+                                 .sender = mpmc_b_sender,
+                                 .receiver = mpmc_b_receiver,
+                                 .send = mpmc_b_send,
+                                 .recv = mpmc_b_recv,
+                                 .sender_done = mpmc_b_sender_done,
+                                 .receiver_done = mpmc_b_receiver_done,
+                                 .close = mpmc_b_close,
+                                 .destroy = mpmc_b_destroy};
+
+/* ---------------- throughput ---------------- */
+typedef struct {
+  void *chan;
+  void *handle; // sender / receiver, made before the threads start
+  size_t payload;
+  size_t messages; // producer: to send
+  size_t received; // consumer: result
+  BenchHist hist;  // consumer: sampled latencies
+  pthread_barrier_t *start;
+} Worker;
+
+static inline __attribute__((always_inline)) void
+producer_body(const ChanOps *ops, Worker *w) {
+  Msg m;
+  memset(&m, 0xab, sizeof(m));
+  pthread_barrier_wait(w->start);
+  for (size_t i = 0; i < w->messages; i++) {
+    m.stamp = (i % BENCH_LAT_SAMPLE) == 0 ? bench_ticks() : 0;
+    ops->send(w->handle, &m);
+  }
+  ops->sender_done(w->handle);
+}
+
+static inline __attribute__((always_inline)) void
+consumer_body(const ChanOps *ops, Worker *w) {
+  Msg m;
+  size_t n = 0;
+  pthread_barrier_wait(w->start);
+  while (ops->recv(w->chan, w->handle, &m) == CHANNEL_OK) {
+    if (m.stamp) {
+      uint64_t now = bench_ticks();
+      bench_hist_record(&w->hist,
+                        now > m.stamp ? bench_ticks_to_ns(now - m.stamp) : 0);
+    }
+    n++;
+  }
+  w->received = n;
+  ops->receiver_done(w->handle);
+}
+
+#define KIND_THREADS(kind)                                                     \
+  static void *kind##_producer(void *arg) {                                    \
+    producer_body(&kind##_ops, arg);                                           \
+    return NULL;                                                               \
+  }                                                                            \
+  static void *kind##_consumer(void *arg) {                                    \
+    consumer_body(&kind##_ops, arg);                                           \
+    return NULL;                                                               \
+  }
+
+KIND_THREADS(spsc)
+KIND_THREADS(spmc)
+KIND_THREADS(mpsc)
+KIND_THREADS(mpmc)
+
+typedef struct {
+  const ChanOps *ops;
+  void *(*producer)(void *);
+  void *(*consumer)(void *);
+} Kind;
+
+static const Kind kinds[] = {
+    {&spsc_ops, spsc_producer, spsc_consumer},
+    {&spmc_ops, spmc_producer, spmc_consumer},
+    {&mpsc_ops, mpsc_producer, mpsc_consumer},
+    {&mpmc_ops, mpmc_producer, mpmc_consumer},
+};
+
+static Worker workers[2 * MAX_THREADS];
+
+static void run_throughput(const Kind *k, size_t np, size_t nc,
+                           size_t payload) {
+  const ChanOps *ops = k->ops;
+  void *chan = ops->create(payload);
+  pthread_barrier_t start;
+  pthread_barrier_init(&start, NULL, (unsigned)(np + nc + 1));
+  pthread_t threads[2 * MAX_THREADS];
+
+  for (size_t i = 0; i < np + nc; i++) {
+    Worker *w = &workers[i];
+    w->chan = chan;
+    w->payload = payload;
+    w->received = 0;
+    w->start = &start;
+    bench_hist_reset(&w->hist);
+    if (i < np) {
+      w->handle = ops->sender(chan);
+      w->messages = BENCH_MESSAGES / np + (i == 0 ? BENCH_MESSAGES % np : 0);
+    } else {
+      w->handle = ops->receiver(chan);
+      w->messages = 0;
+    }
+  }
+  for (size_t i = 0; i < np + nc; i++) {
+    pthread_create(&threads[i], NULL, i < np ? k->producer : k->consumer,
+                   &workers[i]);
+  }
+
+  pthread_barrier_wait(&start);
+  uint64_t t0 = bench_now_ns();
+  for (size_t i = 0; i < np; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  ops->close(chan);
+  for (size_t i = np; i < np + nc; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  uint64_t t1 = bench_now_ns();
+
+  static BenchHist hist;
+  bench_hist_reset(&hist);
+  size_t received = 0;
+  for (size_t i = np; i < np + nc; i++) {
+    received += workers[i].received;
+    bench_hist_merge(&hist, &workers[i].hist);
+  }
+  if (received != BENCH_MESSAGES) {
+    fprintf(stderr, "%s %zux%zu: received %zu of %d\n", ops->name, np, nc,
+            received, BENCH_MESSAGES);
+    exit(1);
+  }
+
+  BenchResult r = {.suite = "channels",
+                   .bench = ops->name,
+                   .mode = "throughput",
+                   .producers = np,
+                   .consumers = nc,
+                   .payload = payload,
+                   .ops = BENCH_MESSAGES,
+                   .elapsed_ns = t1 - t0,
+                   .latency = &hist};
+  bench_report(&r);
+
+  pthread_barrier_destroy(&start);
+  ops->destroy(chan);
+}
+
+/* ---------------- round trip ---------------- */
+typedef struct {
+  const ChanOps *ops;
+  void *req, *resp;
+  void *rx, *tx;
+} Echo;
+
+static void *echo_fn(void *arg) {
+  Echo *e = arg;
+  Msg m;
+  while (e->ops->recv(e->req, e->rx, &m) == CHANNEL_OK) {
+    e->ops->send(e->tx, &m);
+  }
+  e->ops->receiver_done(e->rx);
+  e->ops->sender_done(e->tx);
+  return NULL;
+}
+
+static void run_rtt(const ChanOps *ops, size_t payload) {
+  Echo e = {.ops = ops};
+  e.req = ops->create(payload);
+  e.resp = ops->create(payload);
+  e.rx = ops->receiver(e.req);
+  e.tx = ops->sender(e.resp);
+  void *tx = ops->sender(e.req);
+  void *rx = ops->receiver(e.resp);
+
+  pthread_t echo;
+  pthread_create(&echo, NULL, echo_fn, &e);
+
+  Msg m;
+  memset(&m, 0xcd, sizeof(m));
+  static BenchHist hist;
+  bench_hist_reset(&hist);
+  uint64_t t0 = bench_now_ns();
+  for (size_t i = 0; i < BENCH_RTT_ROUNDS; i++) {
+    uint64_t s = bench_ticks();
+    ops->send(tx, &m);
+    ops->recv(e.resp, rx, &m);
+    bench_hist_record(&hist, bench_ticks_to_ns(bench_ticks() - s));
+  }
+  uint64_t t1 = bench_now_ns();
+
+  ops->sender_done(tx);
+  ops->close(e.req);
+  pthread_join(echo, NULL);
+  ops->close(e.resp);
+  ops->receiver_done(rx);
+  ops->destroy(e.req);
+  ops->destroy(e.resp);
+
+  BenchResult r = {.suite = "channels",
+                   .bench = ops->name,
+                   .mode = "rtt",
+                   .producers = 1,
+                   .consumers = 1,
+                   .payload = payload,
+                   .ops = BENCH_RTT_ROUNDS,
+                   .elapsed_ns = t1 - t0,
+                   .latency = &hist};
+  bench_report(&r);
+}
+
+int main(void) {
+  bench_ns_per_tick(); // calibrate before any thread starts
+
+  for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+    const ChanOps *ops = kinds[k].ops;
+    for (size_t p = 0; p < sizeof(payloads) / sizeof(payloads[0]); p++) {
+      for (size_t a = 0; a < sizeof(counts) / sizeof(counts[0]); a++) {
+        for (size_t b = 0; b < sizeof(counts) / sizeof(counts[0]); b++) {
+          if (counts[a] > ops->max_producers ||
+              counts[b] > ops->max_consumers) {
+            continue;
+          }
+          fprintf(stderr, "channels: %s %zux%zu %zuB\n", ops->name, counts[a],
+                  counts[b], payloads[p]);
+          run_throughput(&kinds[k], counts[a], counts[b], payloads[p]);
+        }
+      }
+    }
+  }
+
+  for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+    for (size_t p = 0; p < sizeof(payloads) / sizeof(payloads[0]); p++) {
+      fprintf(stderr, "channels: %s rtt %zuB\n", kinds[k].ops->name,
+              payloads[p]);
+      run_rtt(kinds[k].ops, payloads[p]);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,168 @@
+#define _GNU_SOURCE
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define REGION_ARENA_IMPLEMENTATION
+#include "../arenas/r_arena.h"
+#define TL_ARENA_IMPLEMENTATION
+#include "../arenas/tl_arena.h"
+#define CHANNEL_BASICS_IMPLEMENTATION
+#include "../channels/channels.h"
+#define MPMC_IMPLEMENTATION
+#include "../channels/mpmc.h"
+#define WS_DEQUE_IMPLEMENTATION
+#include "../data_structures/ws_deque.h"
+#define THREADPOOL_IMPLEMENTATION
+#include "../threadpool/threadpool.h"
+#define JOBSYSTEM_IMPLEMENTATION
+#include "../job_system/jobsystem.h"
+#define BENCH_IMPLEMENTATION
+#include "bench.h"
+
+/*
+ * Job system benchmark: one JSON line per run (see bench.h)
+ * -----------------------------
+ * For 1 / 2 / 4 workers, shared queue and work-stealing mode:
+ *   "spawn"       : the main thread spawns BENCH_JOBS empty jobs and waits
+ *                   for all of them (spawn + schedule + run + complete)
+ *   "spawn_inner" : same, the jobs are spawned by a job running on a
+ *                   worker (local deques in work-stealing mode)
+ *   "chain"       : BENCH_JOBS jobs as job_chain_arr chains of depth
+ *                   `param`, all chains in flight at once
+ * And for the plain thread pool:
+ *   "threadpool_execute" : BENCH_JOBS threadpool_execute calls
+ *
+ * ns_per_op is wall time per job. BENCH_WAIT defaults to
+ * CHANNEL_WAIT_YIELD: with spinning, a threadpool_execute run whose
+ * worker shares the only core with the submitter takes minutes, the two
+ * just burn each other's time slices. Build with CHANNEL_WAIT_SPIN when
+ * every worker has a core of its own.
+ * */
+
+#ifndef BENCH_JOBS
+#define BENCH_JOBS 1000000
+#endif
+#ifndef BENCH_WAIT
+#define BENCH_WAIT CHANNEL_WAIT_YIELD
+#endif
+
+static const size_t worker_counts[] = {1, 2, 4};
+static const size_t depths[] = {1, 8, 64, 512, 4096};
+
+static const struct {
+  const char *name;
+  JobSchedulerMode mode;
+} modes[] = {{"shared", JOB_SCHEDULER_SHARED},
+             {"work_stealing", JOB_SCHEDULER_WORK_STEALING}};
+
+static volatile size_t sink;
+static JobHandle *chain_jobs[4096];
+
+static void empty_job(void *ctx) { sink = (size_t)(uintptr_t)ctx; }
+
+static void spawn_all(void *ctx) {
+  JobCounter *done = ctx;
+  for (size_t i = 0; i < BENCH_JOBS; i++) {
+    job_wait(job_spawn_counted(empty_job, (void *)(uintptr_t)i, done));
+  }
+}
+
+static void report(const char *bench, const char *mode, size_t workers,
+                   size_t param, uint64_t elapsed) {
+  BenchResult r = {.suite = "jobs",
+                   .bench = bench,
+                   .mode = mode,
+                   .producers = workers,
+                   .param = param,
+                   .ops = BENCH_JOBS,
+                   .elapsed_ns = elapsed};
+  bench_report(&r);
+}
+
+static void run_scheduler(size_t workers, size_t m) {
+  JobSchedulerOptions opts = {.mode = modes[m].mode, .wait = BENCH_WAIT};
+  ThreadPool *pool = threadpool_init_for_scheduler_opts(workers, &opts);
+  job_scheduler_spawn(pool);
+  JobCounter done;
+
+  // warm-up: grows the handle arenas and free lists to the peak once
+  job_counter_init(&done, 0);
+  spawn_all(&done);
+  job_wait_for(&done);
+
+  fprintf(stderr, "jobs: spawn %zu workers %s\n", workers, modes[m].name);
+  job_counter_init(&done, 0);
+  uint64_t t0 = bench_now_ns();
+  spawn_all(&done);
+  job_wait_for(&done);
+  report("spawn", modes[m].name, workers, 0, bench_now_ns() - t0);
+
+  fprintf(stderr, "jobs: spawn_inner %zu workers %s\n", workers,
+          modes[m].name);
+  job_counter_init(&done, 0);
+  JobCounter root_done;
+  job_counter_init(&root_done, 0);
+  t0 = bench_now_ns();
+  job_wait(job_spawn_counted(spawn_all, &done, &root_done));
+  job_wait_for(&root_done);
+  job_wait_for(&done);
+  report("spawn_inner", modes[m].name, workers, 0, bench_now_ns() - t0);
+
+  for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); d++) {
+    size_t depth = depths[d];
+    fprintf(stderr, "jobs: chain depth %zu, %zu workers %s\n", depth, workers,
+            modes[m].name);
+    job_counter_init(&done, 0);
+    t0 = bench_now_ns();
+    for (size_t c = 0; c < BENCH_JOBS / depth; c++) {
+      for (size_t i = 0; i < depth; i++) {
+        chain_jobs[i] = job_spawn_counted(empty_job, NULL, &done);
+      }
+      job_chain_arr(depth, chain_jobs);
+    }
+    job_wait_for(&done);
+    report("chain", modes[m].name, workers, depth, bench_now_ns() - t0);
+  }
+
+  job_scheduler_shutdown();
+}
+
+static atomic_size_t executed;
+
+static void *count_job(void *arg) {
+  (void)arg;
+  atomic_fetch_add_explicit(&executed, 1, memory_order_relaxed);
+  return NULL;
+}
+
+static void run_threadpool(size_t workers) {
+  fprintf(stderr, "jobs: threadpool_execute %zu workers\n", workers);
+  ThreadPoolOptions opts = {.wait = BENCH_WAIT};
+  ThreadPool *pool = threadpool_init_opts(workers, &opts);
+  atomic_store(&executed, 0);
+
+  uint64_t t0 = bench_now_ns();
+  for (size_t i = 0; i < BENCH_JOBS; i++) {
+    threadpool_execute(pool, count_job, NULL);
+  }
+  uint32_t round = 0;
+  while (atomic_load_explicit(&executed, memory_order_relaxed) < BENCH_JOBS) {
+    chan_wait_step(CHANNEL_WAIT_YIELD, &round);
+  }
+  report("threadpool_execute", "", workers, 0, bench_now_ns() - t0);
+
+  threadpool_shutdown(pool);
+}
+
+int main(void) {
+  for (size_t w = 0; w < sizeof(worker_counts) / sizeof(worker_counts[0]);
+       w++) {
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+      run_scheduler(worker_counts[w], m);
+    }
+    run_threadpool(worker_counts[w]);
+  }
+  return 0;
+}
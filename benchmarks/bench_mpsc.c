@@ -6,8 +6,10 @@
 #include <stdlib.h>
 #include <time.h>
 
-#include "../channels/mpsc.h"
+#define CHANNEL_BASICS_IMPLEMENTATION
+#include "../channels/channels.h"
 #define MPSC_IMPLEMENTATION
+#include "../channels/mpsc.h"
 
 /*
  * Time: 0.308 s
@@ -34,11 +36,17 @@
  * */
 
 #define NUM_PRODUCERS 4
+#ifndef MESSAGES_PER_PRODUCER
 #define MESSAGES_PER_PRODUCER 100000000
+#endif
 #define CHANNEL_CAPACITY 65535
+#ifndef BATCH_SIZE
+#define BATCH_SIZE 64 // elements per mpsc_send_batch / mpsc_recv_batch
+#endif
 
 ChannelMpsc *chan;
 atomic_size_t received = 0;
+int use_batch = 0;
 
 typedef struct {
   int id;
@@ -50,9 +58,24 @@ void *producer_fn(void *arg) {
 
   uint64_t value = parg->id;
 
-  for (size_t i = 0; i < MESSAGES_PER_PRODUCER; i++) {
-    while (mpsc_send(sender, &value) != CHANNEL_OK) {
-      // spin
+  if (use_batch) {
+    uint64_t values[BATCH_SIZE];
+    for (size_t x = 0; x < BATCH_SIZE; x++) {
+      values[x] = value;
+    }
+    for (size_t i = 0; i < MESSAGES_PER_PRODUCER;) {
+      size_t n = MESSAGES_PER_PRODUCER - i;
+      n = n < BATCH_SIZE ? n : BATCH_SIZE;
+      int sent = mpsc_send_batch(sender, values, n);
+      if (sent > 0) {
+        i += (size_t)sent;
+      }
+    }
+  } else {
+    for (size_t i = 0; i < MESSAGES_PER_PRODUCER; i++) {
+      while (mpsc_send(sender, &value) != CHANNEL_OK) {
+        // spin
+      }
     }
   }
 
@@ -66,10 +89,18 @@ void *consumer_fn(void *arg) {
   ReceiverMpsc *receiver = mpsc_get_receiver(chan);
 
   uint64_t value;
+  uint64_t values[BATCH_SIZE];
   size_t total = NUM_PRODUCERS * MESSAGES_PER_PRODUCER;
 
   while (atomic_load_explicit(&received, memory_order_acquire) < total) {
-    if (mpsc_recv(receiver, &value) == CHANNEL_OK) {
+    if (use_batch) {
+      int got = mpsc_recv_batch(receiver, values, BATCH_SIZE);
+      if (got > 0) {
+        atomic_fetch_add_explicit(&received, (size_t)got, memory_order_release);
+      } else {
+        cpu_relax();
+      }
+    } else if (mpsc_recv(receiver, &value) == CHANNEL_OK) {
       atomic_fetch_add_explicit(&received, 1, memory_order_release);
     } else {
       cpu_relax();
@@ -84,7 +115,9 @@ static inline double timespec_diff_sec(struct timespec a, struct timespec b) {
   return (b.tv_sec - a.tv_sec) + (b.tv_nsec - a.tv_nsec) / 1e9;
 }
 
-int main(void) {
+static void run_bench(int batch) {
+  use_batch = batch;
+  atomic_store(&received, 0);
   chan = channel_create_mpsc(CHANNEL_CAPACITY, sizeof(uint64_t));
 
   pthread_t producers[NUM_PRODUCERS];
@@ -133,7 +166,11 @@ int main(void) {
   printf("Time: %.3f s\n", elapsed);
   printf("Throughput: %.2f M msgs/s\n", (total_msgs / elapsed) / 1e6);
 
-  printf("MPSC Benchmark\n");
+  if (batch) {
+    printf("MPSC Benchmark (batch of %d)\n", BATCH_SIZE);
+  } else {
+    printf("MPSC Benchmark\n");
+  }
   printf("-----------------------------\n");
   printf("Producers:        %d\n", NUM_PRODUCERS);
   printf("Messages/prod:    %d\n", MESSAGES_PER_PRODUCER);
@@ -142,5 +179,10 @@ int main(void) {
   printf("Message size:     %zu bytes\n\n", sizeof(uint64_t));
 
   mpsc_destroy(chan);
+}
+
+int main(void) {
+  run_bench(0);
+  run_bench(1);
   return 0;
 }
@@ -0,0 +1,112 @@
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+
+#define STACK_POOL_IMPLEMENTATION
+#include "../yield/stack_pool.h"
+#define CONTEXT_IMPLEMENTATION
+#include "../yield/context.h"
+#define YIELD_IMPLEMENTATION
+#include "../yield/yield.h"
+#define BENCH_IMPLEMENTATION
+#include "bench.h"
+
+/*
+ * Context switch benchmark (x86-64, 1 core VM, gcc -O3)
+ * -----------------------------
+ * swap_context ping-pong:      32.0 ns/switch
+ * yield() over    2 tasks:     43.9 ns/switch
+ * yield() over 1000 tasks:     28.4 ns/switch
+ * ucontext swapcontext:       558.5 ns/switch
+ *
+ * One JSON line per run (see bench.h), ops = switches.
+ * */
+
+#ifndef SWITCHES
+#define SWITCHES 10000000
+#endif
+
+static CoContext main_ctx, task_ctx;
+static ucontext_t main_uc, task_uc;
+static volatile size_t sink;
+
+static void report(const char *bench, size_t tasks, uint64_t switches,
+                   uint64_t elapsed) {
+  BenchResult r = {.suite = "switch",
+                   .bench = bench,
+                   .param = tasks,
+                   .ops = switches,
+                   .elapsed_ns = elapsed};
+  bench_report(&r);
+}
+
+static void ping(void *arg) {
+  (void)arg;
+  for (;;) {
+    swap_context(&task_ctx, &main_ctx);
+  }
+}
+
+static void uc_ping(void) {
+  for (;;) {
+    swapcontext(&task_uc, &main_uc);
+  }
+}
+
+static void yielder(void *arg) {
+  size_t rounds = *(size_t *)arg;
+  for (size_t i = 0; i < rounds; i++) {
+    sink = i;
+    yield();
+  }
+}
+
+static void bench_swap(void) {
+  CoStack *s = stack_pool_acquire(NULL, 64 * 1024);
+  context_make(&task_ctx, s->top, ping, NULL);
+  uint64_t t0 = bench_now_ns();
+  for (size_t i = 0; i < SWITCHES / 2; i++) {
+    swap_context(&main_ctx, &task_ctx); // there and back: 2 switches
+  }
+  report("swap_context", 1, SWITCHES / 2 * 2, bench_now_ns() - t0);
+  stack_pool_release(NULL, s);
+}
+
+static void bench_yield(size_t tasks) {
+  size_t rounds = SWITCHES / (tasks + 1);
+  g_anchor_init();
+  for (size_t i = 0; i < tasks; i++) {
+    task_run(yielder, &rounds);
+  }
+  uint64_t t0 = bench_now_ns();
+  wait_for_tasks();
+  // every round switches through all tasks and the main context
+  report("yield", tasks, (uint64_t)rounds * (tasks + 1), bench_now_ns() - t0);
+  g_anchor_free();
+}
+
+static void bench_ucontext(void) {
+  size_t n = SWITCHES / 10; // one sigprocmask syscall per switch
+  char *stack = malloc(64 * 1024);
+  getcontext(&task_uc);
+  task_uc.uc_stack.ss_sp = stack;
+  task_uc.uc_stack.ss_size = 64 * 1024;
+  task_uc.uc_link = NULL;
+  makecontext(&task_uc, uc_ping, 0);
+  uint64_t t0 = bench_now_ns();
+  for (size_t i = 0; i < n / 2; i++) {
+    swapcontext(&main_uc, &task_uc);
+  }
+  report("ucontext", 1, n / 2 * 2, bench_now_ns() - t0);
+  free(stack);
+}
+
+int main(void) {
+  bench_swap();
+  bench_yield(2);
+  bench_yield(1000);
+  bench_ucontext();
+  return 0;
+}
@@ -0,0 +1,934 @@
+// Copyright 2025 Seaker <seakerone@proton.me>
+
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+/*
+------------------------------------------------------------------------------
+broadcast.h — Single-Producer broadcast (fan-out) ring
+
+Every receiver sees every element, in send order:
+
+- exactly one producer
+- up to max_receivers independent consumers, each with its own cursor
+- fixed-capacity ring buffer, shared by all receivers
+- busy-wait synchronization by default, optional yield/futex parking
+
+An element is written once into the ring, whatever the number of receivers
+(N SPSC channels would copy it N times). The producer is gated by the
+slowest receiver: it waits while that receiver is a full ring behind.
+
+------------------------------------------------------------------------------
+PROPERTIES
+
+- Wait-free for the producer while the slowest receiver keeps up
+- Receivers never write shared state but their own cursor
+- Every receiver cursor sits in its own cache line
+- No dynamic allocation during send/recv
+- Zero-copy reads: broadcast_recv_peek / broadcast_recv_release
+
+------------------------------------------------------------------------------
+DESIGN
+
+The ring is a plain element array (no per-slot sequence): head is published
+by the producer, and receiver i owns tail[i]. Element t may be overwritten
+once every receiver's tail is past t.
+
+The producer keeps a cached copy of the slowest tail (in its sender handle)
+and only scans the receiver cursors when the cache says the ring is full, so
+a send that has room touches no receiver cache line. Receivers likewise cache
+head and load it again only once they caught up with the cached value.
+
+A receiver that joins starts at the current head: it sees the elements sent
+after broadcast_get_receiver returned. A receiver that closes stops gating
+the producer. With no receiver attached, sends never block and the elements
+are dropped.
+
+------------------------------------------------------------------------------
+LIFETIME
+
+1. channel_create_broadcast()
+2. broadcast_get_sender()
+3. broadcast_get_receiver() (up to max_receivers times)
+4. broadcast_send() / broadcast_recv()
+5. broadcast_close()
+6. broadcast_close_receiver() for each receiver
+7. broadcast_destroy()
+
+Receivers and senders must be freed by the user.
+
+------------------------------------------------------------------------------
+USAGE
+
+channels.h must be included first. In exactly ONE source file:
+
+    #define BROADCAST_IMPLEMENTATION
+    #include "broadcast.h"
+
+    ChannelBroadcast *chan = channel_create_broadcast(1024, sizeof(Quote), 4);
+    SenderBroadcast *tx = broadcast_get_sender(chan);
+    ReceiverBroadcast *rx = broadcast_get_receiver(chan); // one per consumer
+
+    broadcast_send(tx, &quote);
+
+    const Quote *q;
+    int n = broadcast_recv_peek(rx, (const void **)&q, 64);
+    for (int i = 0; i < n; i++) handle(&q[i]);
+    broadcast_recv_release(rx, (size_t)n);
+
+------------------------------------------------------------------------------
+*/
+#ifndef BROADCAST_CHANNEL_H
+#define BROADCAST_CHANNEL_H
+
+/*-------------------------------------------*/
+/*      Platform-dependent cpu_relax()       */
+/*-------------------------------------------*/
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+#define cpu_relax() _mm_pause()
+/*-------------------------------------------*/
+#elif defined(__aarch64__) || defined(__arm__)
+
+#define cpu_relax() __asm__ __volatile__("yield")
+/*-------------------------------------------*/
+#elif defined(__riscv)
+
+#define cpu_relax() __asm__ __volatile__("pause")
+/*-------------------------------------------*/
+#else
+#define cpu_relax() ((void)0)
+#endif
+/*-------------------------------------------*/
+
+#include <stddef.h>
+
+typedef struct ChannelBroadcast_t ChannelBroadcast;
+typedef enum ChanState_t ChanState;
+
+/*-----------------------------------------------------------------------------
+  channel_create_broadcast
+  Allocates and initializes a broadcast ring with a fixed capacity.
+
+  capacity      : number of elements in the ring
+  elem_size     : size in bytes of each element
+  max_receivers : number of receiver cursors (receivers attached at once)
+
+  Returns a pointer to ChannelBroadcast on success, NULL on allocation
+  failure or if capacity, elem_size or max_receivers is 0.
+
+  Notes:
+    - Only one producer is supported.
+    - Elements are stored back to back, without padding.
+-----------------------------------------------------------------------------*/
+ChannelBroadcast *channel_create_broadcast(const size_t capacity,
+                                           const size_t elem_size,
+                                           const size_t max_receivers);
+
+/*-----------------------------------------------------------------------------
+  channel_create_broadcast_opts
+  Same as channel_create_broadcast, with explicit options.
+
+  opts : creation options, NULL for the defaults
+
+  Notes:
+    - opts->wait selects how blocked operations wait (see channels.h).
+    - opts->memory allocates the ring; opts->layout is ignored.
+-----------------------------------------------------------------------------*/
+ChannelBroadcast *channel_create_broadcast_opts(const size_t capacity,
+                                                const size_t elem_size,
+                                                const size_t max_receivers,
+                                                const ChannelOptions *opts);
+
+/*-----------------------------------------------------------------------------
+  broadcast_close
+  Marks the channel as closed.
+
+  chan : pointer to the channel to close
+
+  Notes:
+    - After closing, sends return CHANNEL_ERR_CLOSED.
+    - Every receiver may still drain what was sent before.
+-----------------------------------------------------------------------------*/
+void broadcast_close(ChannelBroadcast *chan);
+
+/*-----------------------------------------------------------------------------
+  broadcast_is_closed
+  Checks whether the channel has been closed.
+
+  Returns OPEN or CLOSED.
+-----------------------------------------------------------------------------*/
+ChanState broadcast_is_closed(const ChannelBroadcast *chan);
+
+/*-----------------------------------------------------------------------------
+  broadcast_destroy
+  Closes the channel, waits for every receiver to be closed, then frees it.
+
+  Notes:
+    - Blocks until all receivers called broadcast_close_receiver.
+    - After this call, the channel pointer becomes invalid.
+-----------------------------------------------------------------------------*/
+void broadcast_destroy(ChannelBroadcast *chan);
+
+typedef struct SenderBroadcast_t SenderBroadcast;
+typedef struct ReceiverBroadcast_t ReceiverBroadcast;
+
+/*-----------------------------------------------------------------------------
+  broadcast_get_sender
+  Allocates and returns the sender handle of the channel.
+
+  Returns a pointer to SenderBroadcast on success, NULL on failure.
+
+  Notes:
+    - Only one sender may be created per channel.
+    - The returned sender must be freed by the user when no longer needed.
+-----------------------------------------------------------------------------*/
+SenderBroadcast *broadcast_get_sender(ChannelBroadcast *chan);
+
+/*-----------------------------------------------------------------------------
+  broadcast_get_receiver
+  Attaches a new receiver to the channel.
+
+  Returns a pointer to ReceiverBroadcast on success, NULL on allocation
+  failure or when max_receivers receivers are attached already.
+
+  Notes:
+    - The receiver starts at the current head: it gets every element sent
+      after this call returned, none sent before.
+    - Each receiver must call broadcast_close_receiver before freeing; its
+      cursor is then free for a later broadcast_get_receiver.
+-----------------------------------------------------------------------------*/
+ReceiverBroadcast *broadcast_get_receiver(ChannelBroadcast *chan);
+
+/*-----------------------------------------------------------------------------
+  broadcast_close_receiver
+  Detaches a receiver: the producer no longer waits for it.
+
+  Notes:
+    - Must be called once per receiver before freeing.
+    - After this call, recv functions return CHANNEL_ERR_CLOSED.
+-----------------------------------------------------------------------------*/
+void broadcast_close_receiver(ReceiverBroadcast *receiver);
+
+/*-----------------------------------------------------------------------------
+  broadcast_try_send
+  Sends an element to every receiver, without waiting.
+
+  Returns:
+    - CHANNEL_OK          on success
+    - CHANNEL_ERR_NULL    if sender or element is NULL
+    - CHANNEL_ERR_FULL    if the slowest receiver is a full ring behind
+    - CHANNEL_ERR_CLOSED  if the channel is closed
+
+  Notes:
+    - Copies elem_size bytes from element into the ring, once.
+-----------------------------------------------------------------------------*/
+int broadcast_try_send(SenderBroadcast *sender, const void *element);
+
+/*-----------------------------------------------------------------------------
+  broadcast_send
+  Sends an element to every receiver.
+
+  Returns:
+    - CHANNEL_OK          on success
+    - CHANNEL_ERR_NULL    if sender or element is NULL
+    - CHANNEL_ERR_CLOSED  if the channel is closed
+
+  Notes:
+    - Waits (channel strategy) while the slowest receiver is a full ring
+      behind.
+-----------------------------------------------------------------------------*/
+int broadcast_send(SenderBroadcast *sender, const void *element);
+
+/*-----------------------------------------------------------------------------
+  broadcast_send_batch
+  Sends n contiguous elements to every receiver.
+
+  Returns:
+    - number of elements sent (n unless the channel closed mid-batch)
+    - CHANNEL_ERR_NULL    if sender or elems is NULL
+    - CHANNEL_ERR_CLOSED  if channel is closed and nothing was sent
+
+  Notes:
+    - Whatever room there is gets filled (at most two memcpy calls, split at
+      the ring wrap point) and published with a single store of head.
+    - Waits (channel strategy) only when the ring is full.
+    - n is clamped to INT_MAX.
+-----------------------------------------------------------------------------*/
+int broadcast_send_batch(SenderBroadcast *sender, const void *elems, size_t n);
+
+/*-----------------------------------------------------------------------------
+  broadcast_try_recv
+  Receives the next element of this receiver, without waiting.
+
+  Returns:
+    - CHANNEL_OK          on success
+    - CHANNEL_ERR_NULL    if receiver or out is NULL
+    - CHANNEL_ERR_EMPTY   if no new element was sent yet
+    - CHANNEL_ERR_CLOSED  if the receiver is closed, or the channel is
+                          closed and this receiver has drained it
+-----------------------------------------------------------------------------*/
+int broadcast_try_recv(ReceiverBroadcast *receiver, void *out);
+
+/*-----------------------------------------------------------------------------
+  broadcast_recv
+  Receives the next element of this receiver.
+
+  Returns CHANNEL_OK, CHANNEL_ERR_NULL or CHANNEL_ERR_CLOSED (see
+  broadcast_try_recv).
+
+  Notes:
+    - Waits (channel strategy) until the producer sends.
+-----------------------------------------------------------------------------*/
+int broadcast_recv(ReceiverBroadcast *receiver, void *out);
+
+/*-----------------------------------------------------------------------------
+  broadcast_recv_batch
+  Receives up to max elements with a single update of this receiver's tail.
+
+  Returns:
+    - number of elements received (>= 1)
+    - CHANNEL_ERR_NULL    if receiver or out is NULL
+    - CHANNEL_ERR_CLOSED  if the receiver is closed, or the channel is
+                          closed and drained
+
+  Notes:
+    - Waits like broadcast_recv for the first element, then takes whatever
+      else is already published.
+    - max is clamped to INT_MAX.
+-----------------------------------------------------------------------------*/
+int broadcast_recv_batch(ReceiverBroadcast *receiver, void *out, size_t max);
+
+/*-----------------------------------------------------------------------------
+  broadcast_recv_peek
+  Exposes the next published elements of this receiver in place.
+
+  receiver : pointer to a valid ReceiverBroadcast
+  elems    : set to the first element, inside the ring
+  max      : maximum number of elements to expose
+
+  Returns:
+    - number of contiguous elements at *elems (>= 1)
+    - CHANNEL_ERR_NULL    if receiver or elems is NULL
+    - CHANNEL_ERR_EMPTY   if no new element was sent yet
+    - CHANNEL_ERR_CLOSED  if the receiver is closed, or the channel is
+                          closed and drained
+
+  Notes:
+    - Never waits. Stops at the ring wrap point: peek again after the
+      release to get the rest.
+    - The elements stay valid, and are not overwritten by the producer,
+      until broadcast_recv_release.
+    - max is clamped to INT_MAX.
+-----------------------------------------------------------------------------*/
+int broadcast_recv_peek(ReceiverBroadcast *receiver, const void **elems,
+                        size_t max);
+
+/*-----------------------------------------------------------------------------
+  broadcast_recv_release
+  Consumes n elements exposed by the last broadcast_recv_peek.
+
+  Returns CHANNEL_OK, or CHANNEL_ERR_NULL if receiver is NULL.
+
+  Notes:
+    - n larger than what is published is clamped.
+    - The producer may overwrite the released elements right away.
+-----------------------------------------------------------------------------*/
+int broadcast_recv_release(ReceiverBroadcast *receiver, size_t n);
+
+#endif
+
+#if (defined(BROADCAST_IMPLEMENTATION))
+#include <limits.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define _BROADCAST_FREE 0
+#define _BROADCAST_ATTACHED 1
+
+// One receiver position, written by that receiver only.
+// state: _BROADCAST_FREE or _BROADCAST_ATTACHED
+typedef struct BroadcastCursor_t {
+  alignas(CACHELINE_SIZE) _Atomic size_t tail;
+  _Atomic uint32_t state;
+  char _pad[CACHELINE_SIZE - sizeof(size_t) - sizeof(uint32_t)];
+} BroadcastCursor;
+
+// parker: the producer waiting for the slowest receiver (full ring)
+typedef struct BroadcastGate_t {
+  alignas(CACHELINE_SIZE) ChanParker parker;
+  char _pad[CACHELINE_SIZE - sizeof(ChanParker)];
+} BroadcastGate;
+
+typedef struct ChannelBroadcast_t {
+  ProducerCursor producer; // parker: receivers waiting for head to move
+  BroadcastGate gate;
+
+  uint8_t *buffer;
+  const MemBackend *memory; // ring buffer allocator, NULL = aligned_alloc
+  size_t capacity;          // number of elements
+  size_t elem_size;         // sizeof(T)
+  ChanWaitStrategy wait;
+
+  BroadcastCursor *cursors;
+  size_t max_receivers;
+
+  _Atomic size_t receivers; // attached receivers
+  _Atomic ChanState state;  // 0 -> Open | 1 -> Closed
+} ChannelBroadcast;
+
+typedef struct SenderBroadcast_t {
+  uint8_t *buffer;
+  size_t inner_c_cap;
+  size_t elem_size;
+  ChanWaitStrategy wait;
+
+  _Atomic size_t *head;
+  size_t slowest; // cached: every attached tail was >= slowest
+
+  BroadcastCursor *cursors;
+  size_t max_receivers;
+
+  _Atomic ChanState *chan_state;
+  ChanParker *consumers; // parked receivers, woken on send
+  ChanParker *producers; // parked sender, woken on recv
+} SenderBroadcast;
+
+typedef struct ReceiverBroadcast_t {
+  uint8_t *buffer;
+  size_t inner_c_cap;
+  size_t elem_size;
+  ChanWaitStrategy wait;
+
+  _Atomic size_t *head;
+  size_t head_seen; // cached head, reloaded once tail reaches it
+  BroadcastCursor *cursor;
+
+  ChanParker *consumers;
+  ChanParker *producers;
+
+  _Atomic ChanState receiver_state;
+  _Atomic ChanState *chan_state;
+  _Atomic size_t *chan_receivers;
+} ReceiverBroadcast;
+
+ChannelBroadcast *channel_create_broadcast(const size_t capacity,
+                                           const size_t elem_size,
+                                           const size_t max_receivers) {
+  return channel_create_broadcast_opts(capacity, elem_size, max_receivers,
+                                       NULL);
+}
+
+static inline size_t _broadcast_ring_bytes(size_t capacity, size_t elem_size) {
+  size_t bytes = capacity * elem_size;
+  return (bytes + CACHELINE_SIZE - 1) / CACHELINE_SIZE * CACHELINE_SIZE;
+}
+
+ChannelBroadcast *channel_create_broadcast_opts(const size_t capacity,
+                                                const size_t elem_size,
+                                                const size_t max_receivers,
+                                                const ChannelOptions *opts) {
+  if (capacity == 0 || elem_size == 0 || max_receivers == 0) {
+    return NULL;
+  }
+  ChannelBroadcast *chan =
+      aligned_alloc(CACHELINE_SIZE, sizeof(ChannelBroadcast));
+  if (!chan) {
+    return NULL;
+  }
+
+  chan->memory = opts ? opts->memory : NULL;
+  size_t bytes = _broadcast_ring_bytes(capacity, elem_size);
+  chan->buffer = chan->memory ? chan->memory->alloc(bytes, chan->memory->ctx)
+                              : aligned_alloc(CACHELINE_SIZE, bytes);
+  chan->cursors = aligned_alloc(CACHELINE_SIZE,
+                                max_receivers * sizeof(BroadcastCursor));
+  if (!chan->buffer || !chan->cursors) {
+    if (chan->buffer && chan->memory) {
+      chan->memory->release(chan->buffer, bytes, chan->memory->ctx);
+    } else {
+      free(chan->buffer);
+    }
+    free(chan->cursors);
+    free(chan);
+    return NULL;
+  }
+
+  for (size_t i = 0; i < max_receivers; i++) {
+    atomic_init(&chan->cursors[i].tail, 0);
+    atomic_init(&chan->cursors[i].state, _BROADCAST_FREE);
+  }
+  chan->capacity = capacity;
+  chan->elem_size = elem_size;
+  chan->max_receivers = max_receivers;
+  chan->wait = opts ? opts->wait : CHANNEL_WAIT_SPIN;
+  chan->producer.head = 0;
+  chan_parker_init(&chan->producer.parker);
+  chan_parker_init(&chan->gate.parker);
+  chan->receivers = 0;
+  chan->state = OPEN;
+
+  return chan;
+}
+
+void broadcast_close(ChannelBroadcast *chan) {
+  atomic_store_explicit(&chan->state, CLOSED, memory_order_seq_cst);
+  chan_parker_close(&chan->producer.parker);
+  chan_parker_close(&chan->gate.parker);
+}
+
+ChanState broadcast_is_closed(const ChannelBroadcast *chan) {
+  return atomic_load_explicit(&chan->state, memory_order_acquire);
+}
+
+void broadcast_destroy(ChannelBroadcast *chan) {
+  if (!chan) {
+    return;
+  }
+
+  broadcast_close(chan);
+  while (atomic_load_explicit(&chan->receivers, memory_order_acquire) != 0) {
+    cpu_relax();
+  }
+
+  size_t bytes = _broadcast_ring_bytes(chan->capacity, chan->elem_size);
+  if (chan->memory) {
+    chan->memory->release(chan->buffer, bytes, chan->memory->ctx);
+  } else {
+    free(chan->buffer);
+  }
+  free(chan->cursors);
+  free(chan);
+}
+
+SenderBroadcast *broadcast_get_sender(ChannelBroadcast *chan) {
+  if (!chan) {
+    return NULL;
+  }
+  SenderBroadcast *sender = malloc(sizeof(SenderBroadcast));
+  if (!sender) {
+    return NULL;
+  }
+
+  sender->buffer = chan->buffer;
+  sender->inner_c_cap = chan->capacity;
+  sender->elem_size = chan->elem_size;
+  sender->wait = chan->wait;
+  sender->head = &chan->producer.head;
+  sender->slowest = atomic_load_explicit(&chan->producer.head,
+                                         memory_order_relaxed);
+  sender->cursors = chan->cursors;
+  sender->max_receivers = chan->max_receivers;
+  sender->chan_state = &chan->state;
+  sender->consumers = &chan->producer.parker;
+  sender->producers = &chan->gate.parker;
+
+  return sender;
+}
+
+ReceiverBroadcast *broadcast_get_receiver(ChannelBroadcast *chan) {
+  if (!chan) {
+    return NULL;
+  }
+  ReceiverBroadcast *receiver = malloc(sizeof(ReceiverBroadcast));
+  if (!receiver) {
+    return NULL;
+  }
+
+  BroadcastCursor *cursor = NULL;
+  for (size_t i = 0; i < chan->max_receivers && !cursor; i++) {
+    uint32_t expected = _BROADCAST_FREE;
+    if (atomic_compare_exchange_strong_explicit(
+            &chan->cursors[i].state, &expected, _BROADCAST_ATTACHED,
+            memory_order_seq_cst, memory_order_relaxed)) {
+      cursor = &chan->cursors[i];
+    }
+  }
+  if (!cursor) {
+    free(receiver);
+    return NULL;
+  }
+
+  // Start at a head loaded after the cursor is attached. A producer scan
+  // that missed the attach came before this load, so it allowed overwrites
+  // only below this head. The stale tail a scan may see meanwhile is lower
+  // than any real position: it only holds the producer back.
+  size_t head =
+      atomic_load_explicit(&chan->producer.head, memory_order_seq_cst);
+  atomic_store_explicit(&cursor->tail, head, memory_order_seq_cst);
+
+  receiver->buffer = chan->buffer;
+  receiver->inner_c_cap = chan->capacity;
+  receiver->elem_size = chan->elem_size;
+  receiver->wait = chan->wait;
+  receiver->head = &chan->producer.head;
+  receiver->head_seen = head;
+  receiver->cursor = cursor;
+  receiver->consumers = &chan->producer.parker;
+  receiver->producers = &chan->gate.parker;
+  receiver->receiver_state = OPEN;
+  receiver->chan_state = &chan->state;
+
+  atomic_fetch_add_explicit(&chan->receivers, 1, memory_order_release);
+  receiver->chan_receivers = &chan->receivers;
+  return receiver;
+}
+
+void broadcast_close_receiver(ReceiverBroadcast *receiver) {
+  atomic_store_explicit(&receiver->receiver_state, CLOSED,
+                        memory_order_release);
+  atomic_store_explicit(&receiver->cursor->state, _BROADCAST_FREE,
+                        memory_order_seq_cst);
+  // a producer parked on this receiver's position may go on
+  chan_unpark(receiver->producers, 0);
+  atomic_fetch_sub_explicit(receiver->chan_receivers, 1, memory_order_release);
+}
+
+/* free slots left for the producer, rescanning the receivers when the cached
+   slowest tail says the ring is full */
+static size_t _broadcast_room(SenderBroadcast *sender, size_t head) {
+  size_t cap = sender->inner_c_cap;
+  if (head - sender->slowest < cap) {
+    return cap - (head - sender->slowest);
+  }
+
+  // seq_cst: orders the published head before the cursor loads (attaching
+  // receivers) and the sleeper count before them (parked producer)
+  atomic_thread_fence(memory_order_seq_cst);
+  size_t slowest = head;
+  for (size_t i = 0; i < sender->max_receivers; i++) {
+    BroadcastCursor *c = &sender->cursors[i];
+    if (atomic_load_explicit(&c->state, memory_order_acquire) ==
+        _BROADCAST_FREE) {
+      continue;
+    }
+    size_t tail = atomic_load_explicit(&c->tail, memory_order_acquire);
+    if (head - tail > head - slowest) {
+      slowest = tail;
+    }
+  }
+  sender->slowest = slowest;
+  // a receiver attaching right now may still show its previous owner's tail
+  size_t lag = head - slowest;
+  return lag < cap ? cap - lag : 0;
+}
+
+static inline void _broadcast_publish(SenderBroadcast *sender, size_t head) {
+  if (sender->wait == CHANNEL_WAIT_PARK) {
+    // seq_cst: pairs with the sleeper count of parked receivers
+    atomic_store_explicit(sender->head, head, memory_order_seq_cst);
+    chan_unpark(sender->consumers, 1);
+  } else {
+    atomic_store_explicit(sender->head, head, memory_order_release);
+  }
+}
+
+/* waits (channel strategy) until there is room, 0 once the channel closed */
+static size_t _broadcast_wait_room(SenderBroadcast *sender, size_t head) {
+  uint32_t round = 0;
+  size_t room;
+  while ((room = _broadcast_room(sender, head)) == 0) {
+    if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
+        CLOSED) {
+      return 0;
+    }
+    if (chan_wait_step(sender->wait, &round)) {
+      uint32_t token = chan_park_begin(sender->producers);
+      room = _broadcast_room(sender, head);
+      chan_park_end(sender->producers, token, room == 0);
+    }
+  }
+  return room;
+}
+
+/* copies n elements in / out of the ring from logical index `from`, split at
+   the wrap */
+static inline void _broadcast_copy_in(uint8_t *ring, const uint8_t *src,
+                                      size_t cap, size_t elem_size,
+                                      size_t from, size_t n) {
+  size_t index = from % cap;
+  size_t first = cap - index < n ? cap - index : n;
+  memcpy(ring + index * elem_size, src, first * elem_size);
+  memcpy(ring, src + first * elem_size, (n - first) * elem_size);
+}
+
+static inline void _broadcast_copy_out(uint8_t *dst, const uint8_t *ring,
+                                       size_t cap, size_t elem_size,
+                                       size_t from, size_t n) {
+  size_t index = from % cap;
+  size_t first = cap - index < n ? cap - index : n;
+  memcpy(dst, ring + index * elem_size, first * elem_size);
+  memcpy(dst + first * elem_size, ring, (n - first) * elem_size);
+}
+
+int broadcast_try_send(SenderBroadcast *sender, const void *element) {
+  if (!sender || !element) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+
+  size_t head = atomic_load_explicit(sender->head, memory_order_relaxed);
+  if (_broadcast_room(sender, head) == 0) {
+    return CHANNEL_ERR_FULL;
+  }
+
+  memcpy(sender->buffer + (head % sender->inner_c_cap) * sender->elem_size,
+         element, sender->elem_size);
+  _broadcast_publish(sender, head + 1);
+  return CHANNEL_OK;
+}
+
+int broadcast_send(SenderBroadcast *sender, const void *element) {
+  if (!sender || !element) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+
+  size_t head = atomic_load_explicit(sender->head, memory_order_relaxed);
+  if (_broadcast_wait_room(sender, head) == 0) {
+    return CHANNEL_ERR_CLOSED;
+  }
+
+  memcpy(sender->buffer + (head % sender->inner_c_cap) * sender->elem_size,
+         element, sender->elem_size);
+  _broadcast_publish(sender, head + 1);
+  return CHANNEL_OK;
+}
+
+int broadcast_send_batch(SenderBroadcast *sender, const void *elems,
+                         size_t n) {
+  if (!sender || !elems) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+  if (n > INT_MAX) {
+    n = INT_MAX;
+  }
+
+  const uint8_t *src = elems;
+  size_t head = atomic_load_explicit(sender->head, memory_order_relaxed);
+  size_t sent = 0;
+  while (sent < n) {
+    size_t room = _broadcast_wait_room(sender, head);
+    if (room == 0) {
+      break;
+    }
+    size_t k = n - sent < room ? n - sent : room;
+    _broadcast_copy_in(sender->buffer, src + sent * sender->elem_size,
+                       sender->inner_c_cap, sender->elem_size, head, k);
+    head += k;
+    sent += k;
+    _broadcast_publish(sender, head);
+  }
+
+  if (n == 0) {
+    return 0;
+  }
+  return sent ? (int)sent : CHANNEL_ERR_CLOSED;
+}
+
+/* elements published past tail (0 if none), reloading head only when the
+   cached value is used up */
+static inline size_t _broadcast_avail(ReceiverBroadcast *receiver,
+                                      size_t tail, memory_order order) {
+  if (receiver->head_seen == tail) {
+    receiver->head_seen = atomic_load_explicit(receiver->head, order);
+  }
+  return receiver->head_seen - tail;
+}
+
+/* CHANNEL_ERR_CLOSED if the channel closed and tail caught up, else
+   CHANNEL_ERR_EMPTY */
+static int _broadcast_empty(ReceiverBroadcast *receiver, size_t tail) {
+  if (atomic_load_explicit(receiver->chan_state, memory_order_acquire) !=
+      CLOSED) {
+    return CHANNEL_ERR_EMPTY;
+  }
+  // a send may have published right before the close
+  return _broadcast_avail(receiver, tail, memory_order_acquire)
+             ? CHANNEL_ERR_EMPTY
+             : CHANNEL_ERR_CLOSED;
+}
+
+static inline void _broadcast_consume(ReceiverBroadcast *receiver,
+                                      size_t tail) {
+  if (receiver->wait == CHANNEL_WAIT_PARK) {
+    // seq_cst: pairs with the sleeper count of the parked producer
+    atomic_store_explicit(&receiver->cursor->tail, tail, memory_order_seq_cst);
+    chan_unpark(receiver->producers, 0);
+  } else {
+    atomic_store_explicit(&receiver->cursor->tail, tail, memory_order_release);
+  }
+}
+
+int broadcast_try_recv(ReceiverBroadcast *receiver, void *out) {
+  if (!receiver || !out) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(&receiver->receiver_state, memory_order_relaxed) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+
+  size_t tail =
+      atomic_load_explicit(&receiver->cursor->tail, memory_order_relaxed);
+  if (_broadcast_avail(receiver, tail, memory_order_acquire) == 0) {
+    return _broadcast_empty(receiver, tail);
+  }
+
+  memcpy(out,
+         receiver->buffer + (tail % receiver->inner_c_cap) * receiver->elem_size,
+         receiver->elem_size);
+  _broadcast_consume(receiver, tail + 1);
+  return CHANNEL_OK;
+}
+
+/* waits (channel strategy) until something is published past tail */
+static int _broadcast_wait_avail(ReceiverBroadcast *receiver, size_t tail) {
+  uint32_t round = 0;
+  while (_broadcast_avail(receiver, tail, memory_order_acquire) == 0) {
+    int rc = _broadcast_empty(receiver, tail);
+    if (rc != CHANNEL_ERR_EMPTY) {
+      return rc;
+    }
+    if (chan_wait_step(receiver->wait, &round)) {
+      // empty: wait for the producer to publish ticket tail
+      chan_park_until(receiver->consumers, receiver->head, 0, tail);
+    }
+  }
+  return CHANNEL_OK;
+}
+
+int broadcast_recv(ReceiverBroadcast *receiver, void *out) {
+  if (!receiver || !out) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(&receiver->receiver_state, memory_order_relaxed) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+
+  size_t tail =
+      atomic_load_explicit(&receiver->cursor->tail, memory_order_relaxed);
+  int rc = _broadcast_wait_avail(receiver, tail);
+  if (rc != CHANNEL_OK) {
+    return rc;
+  }
+
+  memcpy(out,
+         receiver->buffer + (tail % receiver->inner_c_cap) * receiver->elem_size,
+         receiver->elem_size);
+  _broadcast_consume(receiver, tail + 1);
+  return CHANNEL_OK;
+}
+
+int broadcast_recv_batch(ReceiverBroadcast *receiver, void *out, size_t max) {
+  if (!receiver || !out) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(&receiver->receiver_state, memory_order_relaxed) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+  if (max == 0) {
+    return 0;
+  }
+  if (max > INT_MAX) {
+    max = INT_MAX;
+  }
+
+  size_t tail =
+      atomic_load_explicit(&receiver->cursor->tail, memory_order_relaxed);
+  int rc = _broadcast_wait_avail(receiver, tail);
+  if (rc != CHANNEL_OK) {
+    return rc;
+  }
+
+  size_t n = receiver->head_seen - tail;
+  if (n > max) {
+    n = max;
+  }
+  _broadcast_copy_out(out, receiver->buffer, receiver->inner_c_cap,
+                      receiver->elem_size, tail, n);
+  _broadcast_consume(receiver, tail + n);
+  return (int)n;
+}
+
+int broadcast_recv_peek(ReceiverBroadcast *receiver, const void **elems,
+                        size_t max) {
+  if (!receiver || !elems) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(&receiver->receiver_state, memory_order_relaxed) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+  if (max == 0) {
+    return 0;
+  }
+  if (max > INT_MAX) {
+    max = INT_MAX;
+  }
+
+  size_t tail =
+      atomic_load_explicit(&receiver->cursor->tail, memory_order_relaxed);
+  size_t n = _broadcast_avail(receiver, tail, memory_order_acquire);
+  if (n == 0) {
+    return _broadcast_empty(receiver, tail);
+  }
+
+  size_t index = tail % receiver->inner_c_cap;
+  if (n > receiver->inner_c_cap - index) {
+    n = receiver->inner_c_cap - index;
+  }
+  if (n > max) {
+    n = max;
+  }
+  *elems = receiver->buffer + index * receiver->elem_size;
+  return (int)n;
+}
+
+int broadcast_recv_release(ReceiverBroadcast *receiver, size_t n) {
+  if (!receiver) {
+    return CHANNEL_ERR_NULL;
+  }
+  size_t tail =
+      atomic_load_explicit(&receiver->cursor->tail, memory_order_relaxed);
+  size_t avail = receiver->head_seen - tail;
+  if (n > avail) {
+    n = avail;
+  }
+  if (n) {
+    _broadcast_consume(receiver, tail + n);
+  }
+  return CHANNEL_OK;
+}
+#endif
@@ -29,8 +29,9 @@ It does NOT implement any specific channel.
 Instead, it provides:
 - common return codes
 - cache-line aligned cursor structures
-- slot metadata
+- slot metadata and slot buffer layout
 - platform-specific cpu_relax()
+- wait strategies and the parking primitive shared by blocking channels
 
 All channel implementations depend on this header.
 
@@ -76,6 +77,25 @@ Each cursor:
 
 This is critical for high-performance concurrent queues.
 
+------------------------------------------------------------------------------
+SLOT LAYOUT
+
+Slot-sequence channels (SPMC, MPSC, MPMC) store every element inline, next to
+its sequence number, in a single contiguous buffer:
+
+    | seq | payload ... | seq | payload ... | ...
+
+The distance between two slots depends on ChannelOptions.layout:
+
+    CHANNEL_SLOT_PADDED  each slot is rounded up to a cache line (default)
+                         no false sharing between neighbouring slots
+    CHANNEL_SLOT_PACKED  each slot is rounded up to 8 bytes
+                         several small slots share a line, 4x less memory
+                         for 8-byte payloads (job queues, handles)
+
+In both layouts a payload of up to CACHELINE_SIZE - 8 bytes lives in the same
+cache line as its sequence number, and the buffer is one allocation.
+
 ------------------------------------------------------------------------------
 CPU RELAX
 
@@ -92,6 +112,48 @@ The instruction varies by architecture:
 - RISC-V    → PAUSE
 - Fallback  → no-op
 
+------------------------------------------------------------------------------
+WAIT STRATEGIES
+
+Blocking operations (full buffer on send, empty slot on recv) wait according
+to the strategy the channel was created with (ChannelOptions.wait):
+
+    CHANNEL_WAIT_SPIN   cpu_relax() forever (default, lowest latency)
+    CHANNEL_WAIT_YIELD  spin CHANNEL_SPIN_LIMIT rounds, then sched_yield()
+    CHANNEL_WAIT_PARK   spin, yield CHANNEL_YIELD_LIMIT rounds, then sleep on
+                        a futex until the other side makes progress
+
+Parking is built on ChanParker, a sleeper count plus a futex word stored in
+the same cache line as the cursor the other side already writes. A waker only
+loads the sleeper count right after its own seq_cst head/tail update, so a
+send or recv costs nothing extra while nobody is parked.
+
+On non-Linux platforms CHANNEL_WAIT_PARK degrades to CHANNEL_WAIT_YIELD.
+
+------------------------------------------------------------------------------
+AWAIT (user-level schedulers)
+
+A ChanParker also holds a FIFO of ChanWaiters: a callback each, that lets a
+user-level scheduler (green.h) park a task on a channel instead of parking
+the thread. chan_unpark fires the oldest live waiter (one wake per
+operation, not a wake of every waiter), chan_parker_close fires all of
+them. The channel await functions pass the wake on to the next waiter when
+they succeed and more elements (or room) are left, so batches wake as many
+waiters as they need.
+
+chan_await(p, attempt, arg) retries attempt(arg) until it reports
+CHAN_AWAIT_DONE:
+
+- CHAN_AWAIT_PARK  : nothing to do until the other side makes progress
+- CHAN_AWAIT_RETRY : progress is pending (e.g. a slot is claimed but not
+                     published yet), so poll again shortly instead of
+                     sleeping
+
+Between attempts the calling thread's await hook (chan_set_await_hook)
+decides how to wait: green.h installs one on its workers that parks the
+running green thread off the run queue. Without a hook the thread itself
+parks on the futex. spsc_*_await and mpmc_*_await are built on this.
+
 ------------------------------------------------------------------------------
 USAGE
 
@@ -120,6 +182,80 @@ In exactly ONE source file:
 // Channel lifecycle state.
 typedef enum ChanState_t ChanState;
 
+#define CHANNEL_SPIN_LIMIT 64  // cpu_relax rounds before yielding
+#define CHANNEL_YIELD_LIMIT 16 // sched_yield rounds before parking
+
+// How blocking operations wait.
+typedef enum ChanWaitStrategy_t {
+  CHANNEL_WAIT_SPIN = 0,
+  CHANNEL_WAIT_YIELD = 1,
+  CHANNEL_WAIT_PARK = 2
+} ChanWaitStrategy;
+
+// How slots are laid out in the ring buffer.
+typedef enum ChanSlotLayout_t {
+  CHANNEL_SLOT_PADDED = 0,
+  CHANNEL_SLOT_PACKED = 1
+} ChanSlotLayout;
+
+// Where large buffers come from; a NULL backend means calloc / free.
+// alloc returns zero-filled memory aligned to at least 64 bytes.
+// (arenas/page_alloc.h provides a huge page / NUMA aware one)
+#ifndef MEM_BACKEND_DEFINED
+#define MEM_BACKEND_DEFINED
+typedef struct MemBackend_t {
+  void *(*alloc)(size_t size, void *ctx);
+  void (*release)(void *ptr, size_t size, void *ctx);
+  void *ctx;
+} MemBackend;
+#endif
+
+// Creation options, pass NULL to any *_opts constructor for the defaults.
+typedef struct ChannelOptions_t {
+  ChanWaitStrategy wait;
+  ChanSlotLayout layout; // ignored by SPSC (plain element array)
+  // ring buffer allocator (NULL = aligned_alloc), must outlive the channel;
+  // ignored by SPSC
+  const MemBackend *memory;
+} ChannelOptions;
+
+// Callback registered on a parker, fired once by chan_unpark or
+// chan_parker_close. The owner keeps it alive until then. wake returns 0 if
+// the waiter was stale (gave up waiting), so the next one gets the wake.
+typedef struct ChanWaiter_t {
+  struct ChanWaiter_t *next;
+  int (*wake)(struct ChanWaiter_t *waiter);
+} ChanWaiter;
+
+// Sleeping threads of one side of a channel (or of any other wait point).
+// - sleepers : number of threads between chan_park_begin and chan_park_end
+// - wake     : futex word, bumped by every chan_unpark
+// - closed   : set once by chan_parker_close, parking is then a no-op
+// - waiters  : registered ChanWaiters (green threads), FIFO through
+//              waiters_tail, both guarded by waiters_lock
+typedef struct ChanParker_t {
+  _Atomic uint32_t sleepers;
+  _Atomic uint32_t wake;
+  _Atomic uint32_t closed;
+  _Atomic uint32_t waiters_lock;
+  _Atomic(ChanWaiter *) waiters;
+  ChanWaiter *waiters_tail;
+} ChanParker;
+
+/* chan_await attempt results */
+#define CHAN_AWAIT_DONE 0
+#define CHAN_AWAIT_PARK 1
+#define CHAN_AWAIT_RETRY 2
+
+typedef int (*ChanAttemptFn)(void *arg);
+
+// Waits between two attempts of chan_await. result is what the last attempt
+// returned (CHAN_AWAIT_PARK or CHAN_AWAIT_RETRY). Returns CHAN_AWAIT_DONE if
+// an attempt it made itself succeeded, -1 if it cannot wait here (the
+// thread then parks), anything else to attempt again.
+typedef int (*ChanAwaitHook)(ChanParker *p, ChanAttemptFn attempt, void *arg,
+                             int result);
+
 /* Return codes */
 #define CHANNEL_OK 0
 #define CHANNEL_ERR_NULL -1
@@ -139,8 +275,8 @@ typedef struct ProducerCursor_t ProducerCursor;
 
 // Slot metadata used by channel buffers.
 // Each slot stores:
-// - pointer to element storage
 // - sequence number for synchronization
+// - the element itself, inline
 typedef struct Slot_t Slot;
 
 /*-------------------------------------------*/
@@ -164,26 +300,393 @@ typedef struct Slot_t Slot;
 #endif
 /*-------------------------------------------*/
 
+/*-----------------------------------------------------------------------------
+  chan_parker_init
+  Resets a parker: no sleepers, open.
+-----------------------------------------------------------------------------*/
+void chan_parker_init(ChanParker *p);
+
+/*-----------------------------------------------------------------------------
+  chan_wait_step
+  One backoff step of a waiting loop.
+
+  wait  : strategy of the channel
+  round : per-wait counter, must start at 0
+
+  Returns 1 when the caller should park (CHANNEL_WAIT_PARK only, once the spin
+  and yield budgets are exhausted), 0 otherwise.
+-----------------------------------------------------------------------------*/
+int chan_wait_step(ChanWaitStrategy wait, uint32_t *round);
+
+/*-----------------------------------------------------------------------------
+  chan_park_begin / chan_park_end
+  Two-phase park, for callers with their own wake-up condition.
+
+    uint32_t token = chan_park_begin(p);
+    // re-check the condition here
+    chan_park_end(p, token, still_nothing_to_do);
+
+  Notes:
+    - Whoever makes the condition true must order that write before its
+      chan_unpark (seq_cst RMW or fence), and the re-check must be ordered
+      after chan_park_begin the same way.
+    - chan_park_end only sleeps if sleep != 0, no chan_unpark happened since
+      chan_park_begin and the parker is not closed.
+-----------------------------------------------------------------------------*/
+uint32_t chan_park_begin(ChanParker *p);
+void chan_park_end(ChanParker *p, uint32_t token, int sleep);
+
+/*-----------------------------------------------------------------------------
+  chan_park_until
+  Parks while (*progress + offset) <= ticket.
+
+  Used by channels: a receiver holding ticket t waits for head > t, a sender
+  holding ticket h waits for tail + capacity > h.
+-----------------------------------------------------------------------------*/
+void chan_park_until(ChanParker *p, _Atomic size_t *progress, size_t offset,
+                     size_t ticket);
+
+/*-----------------------------------------------------------------------------
+  chan_unpark
+  Wakes parked threads if there are any.
+
+  all : wake every sleeper (1) or a single one (0)
+
+  Notes:
+    - Two loads when nobody is parked.
+    - Fires one live registered waiter, whatever all says.
+-----------------------------------------------------------------------------*/
+void chan_unpark(ChanParker *p, int all);
+
+/*-----------------------------------------------------------------------------
+  chan_parker_close
+  Wakes every sleeper and turns any further park into a no-op.
+-----------------------------------------------------------------------------*/
+void chan_parker_close(ChanParker *p);
+
+/*-----------------------------------------------------------------------------
+  chan_parker_add_waiter
+  Appends w to the waiters of p: a later chan_unpark or chan_parker_close on
+  p calls w->wake(w), then forgets it.
+
+  Notes:
+    - Like chan_park_begin: re-check the wake-up condition after this call,
+      a wake that happened before it is not replayed.
+    - On a closed parker w fires right away (from this call).
+    - There is no way to unregister: w stays valid until it fired.
+-----------------------------------------------------------------------------*/
+void chan_parker_add_waiter(ChanParker *p, ChanWaiter *w);
+
+/*-----------------------------------------------------------------------------
+  chan_set_await_hook
+  Sets the calling thread's await hook (NULL = park the thread).
+-----------------------------------------------------------------------------*/
+void chan_set_await_hook(ChanAwaitHook hook);
+
+/*-----------------------------------------------------------------------------
+  chan_await
+  Calls attempt(arg) until it returns CHAN_AWAIT_DONE, waiting on p in
+  between (see AWAIT).
+
+  Notes:
+    - attempt must re-check the condition with loads ordered after a seq_cst
+      operation, and whoever makes it true must chan_unpark(p) after a
+      seq_cst update (same contract as chan_park_begin / chan_park_end).
+-----------------------------------------------------------------------------*/
+void chan_await(ChanParker *p, ChanAttemptFn attempt, void *arg);
+
+/*-----------------------------------------------------------------------------
+  chan_futex_wait / chan_futex_wake
+  Raw futex on a 32-bit word, for callers that keep their own wait state.
+
+  chan_futex_wait sleeps while *addr == val (spurious wake-ups possible).
+  chan_futex_wake wakes one (all = 0) or every (all = 1) sleeper on addr.
+
+  Notes:
+    - chan_futex_wake only hands addr to the kernel and never touches the
+      word, so it is safe on memory its owner may already be releasing.
+    - Without futex support wait yields and wake does nothing.
+-----------------------------------------------------------------------------*/
+void chan_futex_wait(_Atomic uint32_t *addr, uint32_t val);
+void chan_futex_wake(_Atomic uint32_t *addr, int all);
+
 #endif // !CHANNELS_H
 
 #if (defined (CHANNEL_BASICS_IMPLEMENTATION))
 /* Channel state */
 typedef enum ChanState_t { OPEN = 0, CLOSED = 1 } ChanState;
 
+// parker: producers waiting for tail to move (full buffer)
 typedef struct ConsumerCursor_t {
   alignas(CACHELINE_SIZE) _Atomic size_t tail;
-  char _pad[CACHELINE_SIZE - sizeof(size_t)];
+  ChanParker parker;
+  char _pad[CACHELINE_SIZE - sizeof(size_t) - sizeof(ChanParker)];
 } ConsumerCursor;
 
+// parker: consumers waiting for head to move (empty slot)
 typedef struct ProducerCursor_t {
   alignas(CACHELINE_SIZE) _Atomic size_t head;
-  char _pad[CACHELINE_SIZE - sizeof(size_t)];
+  ChanParker parker;
+  char _pad[CACHELINE_SIZE - sizeof(size_t) - sizeof(ChanParker)];
 } ProducerCursor;
 
 typedef struct Slot_t {
-  alignas(CACHELINE_SIZE) uint8_t *data;
   _Atomic size_t seq;
+  uint8_t data[]; // elem_size bytes
 } Slot;
 
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// bytes between two consecutive slots
+static inline size_t chan_slot_stride(size_t elem_size, ChanSlotLayout layout) {
+  size_t unit = layout == CHANNEL_SLOT_PACKED ? sizeof(size_t) : CACHELINE_SIZE;
+  size_t bytes = sizeof(Slot) + elem_size;
+  return (bytes + unit - 1) / unit * unit;
+}
+
+static inline Slot *chan_slot(uint8_t *buffer, size_t stride, size_t index) {
+  return (Slot *)(buffer + index * stride);
+}
+
+static inline size_t chan_slots_bytes(size_t capacity, size_t stride) {
+  size_t bytes = capacity * stride;
+  bytes = (bytes + CACHELINE_SIZE - 1) / CACHELINE_SIZE * CACHELINE_SIZE;
+  return bytes ? bytes : CACHELINE_SIZE;
+}
+
+// one cache-line aligned block for every slot, seq[i] = i
+static inline uint8_t *chan_slots_alloc(size_t capacity, size_t stride,
+                                        const MemBackend *memory) {
+  size_t bytes = chan_slots_bytes(capacity, stride);
+  uint8_t *buffer = memory ? memory->alloc(bytes, memory->ctx)
+                           : aligned_alloc(CACHELINE_SIZE, bytes);
+  if (!buffer) {
+    return NULL;
+  }
+  for (size_t i = 0; i < capacity; i++) {
+    atomic_init(&chan_slot(buffer, stride, i)->seq, i);
+  }
+  return buffer;
+}
+
+static inline void chan_slots_free(uint8_t *buffer, size_t capacity,
+                                   size_t stride, const MemBackend *memory) {
+  if (memory) {
+    memory->release(buffer, chan_slots_bytes(capacity, stride), memory->ctx);
+  } else {
+    free(buffer);
+  }
+}
+
+#if defined(__linux__)
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+extern long syscall(long number, ...);
+
+static void _chan_futex_wait(_Atomic uint32_t *addr, uint32_t val) {
+  syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static void _chan_futex_wake(_Atomic uint32_t *addr, int all) {
+  syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAKE_PRIVATE, all ? INT_MAX : 1,
+          NULL, NULL, 0);
+}
+#else
+// no futex: a parked thread just yields and re-checks
+static void _chan_futex_wait(_Atomic uint32_t *addr, uint32_t val) {
+  (void)addr;
+  (void)val;
+  sched_yield();
+}
+
+static void _chan_futex_wake(_Atomic uint32_t *addr, int all) {
+  (void)addr;
+  (void)all;
+}
+#endif
+
+void chan_futex_wait(_Atomic uint32_t *addr, uint32_t val) {
+  _chan_futex_wait(addr, val);
+}
+
+void chan_futex_wake(_Atomic uint32_t *addr, int all) {
+  _chan_futex_wake(addr, all);
+}
+
+void chan_parker_init(ChanParker *p) {
+  atomic_init(&p->sleepers, 0);
+  atomic_init(&p->wake, 0);
+  atomic_init(&p->closed, 0);
+  atomic_init(&p->waiters_lock, 0);
+  atomic_init(&p->waiters, NULL);
+  p->waiters_tail = NULL;
+}
+
+static void _chan_waiters_lock(ChanParker *p) {
+  while (atomic_exchange_explicit(&p->waiters_lock, 1, memory_order_acquire)) {
+    while (atomic_load_explicit(&p->waiters_lock, memory_order_relaxed)) {
+      cpu_relax();
+    }
+  }
+}
+
+static void _chan_waiters_unlock(ChanParker *p) {
+  atomic_store_explicit(&p->waiters_lock, 0, memory_order_release);
+}
+
+// Takes the oldest waiter (all = 0) or every waiter (all = 1). The list is
+// never seen empty while a waiter is still on it, so a concurrent waker
+// finds the next one instead of assuming nobody waits.
+static ChanWaiter *_chan_take_waiters(ChanParker *p, int all) {
+  _chan_waiters_lock(p);
+  ChanWaiter *w = atomic_load_explicit(&p->waiters, memory_order_relaxed);
+  if (w) {
+    ChanWaiter *rest = all ? NULL : w->next;
+    if (!rest) {
+      p->waiters_tail = NULL;
+    }
+    if (!all) {
+      w->next = NULL;
+    }
+    atomic_store_explicit(&p->waiters, rest, memory_order_relaxed);
+  }
+  _chan_waiters_unlock(p);
+  return w;
+}
+
+static void _chan_fire_waiters(ChanParker *p, int all) {
+  ChanWaiter *w;
+  while ((w = _chan_take_waiters(p, all))) {
+    int woke = 0;
+    while (w) {
+      ChanWaiter *next = w->next; // w may be gone once it fired
+      woke |= w->wake(w);
+      w = next;
+    }
+    if (all || woke) {
+      return;
+    }
+  }
+}
+
+int chan_wait_step(ChanWaitStrategy wait, uint32_t *round) {
+  uint32_t r = *round;
+  if (r < UINT32_MAX) {
+    *round = r + 1;
+  }
+
+  if (wait == CHANNEL_WAIT_SPIN || r < CHANNEL_SPIN_LIMIT) {
+    cpu_relax();
+    return 0;
+  }
+  if (wait == CHANNEL_WAIT_YIELD ||
+      r < CHANNEL_SPIN_LIMIT + CHANNEL_YIELD_LIMIT) {
+    sched_yield();
+    return 0;
+  }
+  return 1;
+}
+
+uint32_t chan_park_begin(ChanParker *p) {
+  atomic_fetch_add_explicit(&p->sleepers, 1, memory_order_seq_cst);
+  return atomic_load_explicit(&p->wake, memory_order_seq_cst);
+}
+
+void chan_park_end(ChanParker *p, uint32_t token, int sleep) {
+  if (sleep && atomic_load_explicit(&p->closed, memory_order_seq_cst) == 0) {
+    _chan_futex_wait(&p->wake, token);
+  } else if (!sleep) {
+    // woken for progress that is not published yet (claimed ticket)
+    sched_yield();
+  }
+  atomic_fetch_sub_explicit(&p->sleepers, 1, memory_order_relaxed);
+}
+
+void chan_park_until(ChanParker *p, _Atomic size_t *progress, size_t offset,
+                     size_t ticket) {
+  uint32_t token = chan_park_begin(p);
+  size_t seen = atomic_load_explicit(progress, memory_order_seq_cst);
+  chan_park_end(p, token, seen + offset <= ticket);
+}
+
+void chan_unpark(ChanParker *p, int all) {
+  if (atomic_load_explicit(&p->waiters, memory_order_seq_cst) != NULL) {
+    _chan_fire_waiters(p, 0);
+  }
+  if (atomic_load_explicit(&p->sleepers, memory_order_seq_cst) == 0) {
+    return;
+  }
+  atomic_fetch_add_explicit(&p->wake, 1, memory_order_seq_cst);
+  _chan_futex_wake(&p->wake, all);
+}
+
+void chan_parker_close(ChanParker *p) {
+  atomic_store_explicit(&p->closed, 1, memory_order_seq_cst);
+  atomic_fetch_add_explicit(&p->wake, 1, memory_order_seq_cst);
+  if (atomic_load_explicit(&p->sleepers, memory_order_seq_cst) != 0) {
+    _chan_futex_wake(&p->wake, 1);
+  }
+  _chan_fire_waiters(p, 1);
+}
+
+void chan_parker_add_waiter(ChanParker *p, ChanWaiter *w) {
+  w->next = NULL;
+  _chan_waiters_lock(p);
+  if (p->waiters_tail) {
+    p->waiters_tail->next = w;
+  } else {
+    atomic_store_explicit(&p->waiters, w, memory_order_relaxed);
+  }
+  p->waiters_tail = w;
+  _chan_waiters_unlock(p);
+  // seq_cst: the re-check after this call, or a waker's load of waiters
+  // after its own update, sees the other side
+  atomic_thread_fence(memory_order_seq_cst);
+  // closed after its last drain: nobody else will fire w
+  if (atomic_load_explicit(&p->closed, memory_order_seq_cst) != 0) {
+    _chan_fire_waiters(p, 1);
+  }
+}
+
+static _Thread_local ChanAwaitHook t_chan_await_hook = NULL;
+
+void chan_set_await_hook(ChanAwaitHook hook) { t_chan_await_hook = hook; }
+
+// noinline: a green thread may come back on another thread between two calls
+static ChanAwaitHook __attribute__((noinline)) _chan_await_hook(void) {
+  return t_chan_await_hook;
+}
+
+void chan_await(ChanParker *p, ChanAttemptFn attempt, void *arg) {
+  uint32_t round = 0;
+  int r;
+  while ((r = attempt(arg)) != CHAN_AWAIT_DONE) {
+    ChanAwaitHook hook = _chan_await_hook();
+    if (hook) {
+      int h = hook(p, attempt, arg, r);
+      if (h == CHAN_AWAIT_DONE) {
+        return;
+      }
+      if (h != -1) {
+        continue;
+      }
+    }
+    if (r == CHAN_AWAIT_RETRY) {
+      chan_wait_step(CHANNEL_WAIT_YIELD, &round);
+      continue;
+    }
+    uint32_t token = chan_park_begin(p);
+    r = attempt(arg);
+    chan_park_end(p, token, r == CHAN_AWAIT_PARK);
+    if (r == CHAN_AWAIT_DONE) {
+      return;
+    }
+  }
+}
+
 #endif // !CHANNELS_H
 
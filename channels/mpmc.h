@@ -26,7 +26,7 @@ This channel supports:
 - multiple producers
 - multiple consumers
 - fixed-capacity ring buffer
-- busy-wait synchronization (no blocking, no syscalls)
+- busy-wait synchronization by default, optional yield/futex parking
 
 The implementation is lock-free and cache-line aware.
 
@@ -55,8 +55,10 @@ Senders and receivers must be freed by the user.
 ------------------------------------------------------------------------------
 WARNING
 
-This channel uses busy-waiting.
+By default this channel uses busy-waiting.
 It is intended for short-lived waits (job systems, engine internals).
+Long-lived idle consumers should use channel_create_mpmc_opts with
+CHANNEL_WAIT_YIELD or CHANNEL_WAIT_PARK (see channels.h).
 ------------------------------------------------------------------------------
 */
 #ifndef MPMC_CHANNEL_H
@@ -98,10 +100,25 @@ channel.
 
   Notes:
     - Multiple producers and multiple consumers can safely operate concurrently.
-    - Allocates internal memory for slots and element buffers.
+    - Allocates every slot, element storage included, in one block.
 -----------------------------------------------------------------------------*/
 ChannelMpmc *channel_create_mpmc(const size_t capacity, const size_t elem_size);
 
+/*-----------------------------------------------------------------------------
+  channel_create_mpmc_opts
+  Same as channel_create_mpmc, with explicit options.
+
+  opts : creation options, NULL for the defaults
+
+  Notes:
+    - opts->wait selects how blocked mpmc_send / mpmc_recv wait.
+    - With CHANNEL_WAIT_PARK, send and recv wake parked threads on the other
+      side; that costs a single load when nobody is parked.
+-----------------------------------------------------------------------------*/
+ChannelMpmc *channel_create_mpmc_opts(const size_t capacity,
+                                      const size_t elem_size,
+                                      const ChannelOptions *opts);
+
 /*-----------------------------------------------------------------------------
   mpmc_close
   Marks the channel as closed.
@@ -111,6 +128,7 @@ ChannelMpmc *channel_create_mpmc(const size_t capacity, const size_t elem_size);
   Notes:
     - After closing, mpmc_send will return CHANNEL_ERR_CLOSED.
     - Consumers may continue to drain the channel until empty.
+    - Wakes every parked sender and receiver.
 -----------------------------------------------------------------------------*/
 void mpmc_close(ChannelMpmc *chan);
 
@@ -139,7 +157,6 @@ consumers to finish.
   Notes:
     - Blocks until all active producers call mpmc_close_sender and all consumers
 call mpmc_close_receiver.
-    - Also frees element buffers.
     - After this call, the channel pointer becomes invalid.
 -----------------------------------------------------------------------------*/
 void mpmc_destroy(ChannelMpmc *chan);
@@ -213,7 +230,7 @@ void mpmc_close_sender(SenderMpmc *sender);
     - CHANNEL_ERR_CLOSED  if channel is closed
 
   Notes:
-    - Busy-waits if the ring buffer slot is not available.
+    - Waits (channel strategy) if the ring buffer slot is not available.
     - Lock-free and wait-free for each producer.
     - Copies elem_size bytes from element to the internal buffer.
 -----------------------------------------------------------------------------*/
@@ -232,15 +249,170 @@ int mpmc_send(SenderMpmc *sender, const void *element);
     - CHANNEL_ERR_CLOSED  if channel or receiver is closed
 
   Notes:
-    - Busy-waits until an element becomes available or the channel closes.
+    - Waits (channel strategy) until an element becomes available or the
+      channel closes.
+    - Elements sent before the close are still delivered: receivers looping
+      until CHANNEL_ERR_CLOSED drain the channel.
     - Lock-free for the consumer.
     - Copies elem_size bytes into the memory pointed to by out.
 -----------------------------------------------------------------------------*/
 int mpmc_recv(ReceiverMpmc *receiver, void *out);
 
+/*-----------------------------------------------------------------------------
+  mpmc_try_send
+  Sends an element to the channel without blocking.
+
+  sender  : pointer to a valid SenderMpmc
+  element : pointer to the element data to send
+
+  Returns:
+    - CHANNEL_OK          on success
+    - CHANNEL_ERR_NULL    if sender is NULL
+    - CHANNEL_ERR_FULL    if the next slot is still occupied
+    - CHANNEL_ERR_CLOSED  if channel is closed
+
+  Notes:
+    - The slot is claimed with a CAS only once it is free, so a full channel
+      never consumes a ticket (unlike mpmc_send).
+    - Can be freely mixed with mpmc_send on the same channel.
+-----------------------------------------------------------------------------*/
+int mpmc_try_send(SenderMpmc *sender, const void *element);
+
+/*-----------------------------------------------------------------------------
+  mpmc_try_recv
+  Receives an element from the channel without blocking.
+
+  receiver : pointer to a valid ReceiverMpmc
+  out      : pointer to memory where the element will be copied
+
+  Returns:
+    - CHANNEL_OK          on success
+    - CHANNEL_ERR_NULL    if receiver is NULL
+    - CHANNEL_ERR_EMPTY   if no element is ready
+    - CHANNEL_ERR_CLOSED  if the channel is closed and no element is ready
+
+  Notes:
+    - The slot is claimed with a CAS only once it holds data, so an empty
+      channel never consumes a ticket (unlike mpmc_recv).
+    - Can be freely mixed with mpmc_recv on the same channel.
+-----------------------------------------------------------------------------*/
+int mpmc_try_recv(ReceiverMpmc *receiver, void *out);
+
+/*-----------------------------------------------------------------------------
+  mpmc_send_batch
+  Sends n contiguous elements with a single claim on head.
+
+  sender : pointer to a valid SenderMpmc
+  elems  : pointer to n elements of elem_size bytes
+  n      : number of elements
+
+  Returns:
+    - number of elements sent (n unless the channel closed mid-batch)
+    - CHANNEL_ERR_NULL    if sender or elems is NULL
+    - CHANNEL_ERR_CLOSED  if channel is closed and nothing was sent
+
+  Notes:
+    - One fetch_add reserves n consecutive slots; each slot is then filled
+      and published in order, waiting (channel strategy) only when full.
+    - Parked receivers are woken for the published elements before the
+      sender waits for room, and once more at the end: one receiver for a
+      single element, all of them for more.
+    - n is clamped to INT_MAX.
+-----------------------------------------------------------------------------*/
+int mpmc_send_batch(SenderMpmc *sender, const void *elems, size_t n);
+
+/*-----------------------------------------------------------------------------
+  mpmc_recv_batch
+  Receives up to max elements with a single claim on tail.
+
+  receiver : pointer to a valid ReceiverMpmc
+  out      : pointer to room for max elements
+  max      : maximum number of elements to receive
+
+  Returns:
+    - number of elements received (>= 1)
+    - CHANNEL_ERR_NULL    if receiver or out is NULL
+    - CHANNEL_ERR_CLOSED  if channel or receiver is closed
+
+  Notes:
+    - Claims every already published slot from tail (up to max) with one CAS.
+    - If none is ready, waits like mpmc_recv for one element and then takes
+      whatever else became ready.
+    - Elements are written to out in channel order.
+-----------------------------------------------------------------------------*/
+int mpmc_recv_batch(ReceiverMpmc *receiver, void *out, size_t max);
+
+/*-----------------------------------------------------------------------------
+  mpmc_send_await / mpmc_recv_await
+  Like mpmc_try_send / mpmc_try_recv, but wait while the channel is full /
+  empty through chan_await: inside a green thread (green.h) the task is
+  parked off its worker's run queue until a receiver / sender makes
+  progress, elsewhere the thread parks.
+
+  Returns:
+    - CHANNEL_OK          on success
+    - CHANNEL_ERR_NULL    if the handle is NULL
+    - CHANNEL_ERR_CLOSED  if the channel is (or gets) closed
+
+  Notes:
+    - Wake-ups need a channel created with CHANNEL_WAIT_PARK. With another
+      strategy the wait degrades to polling (yield between attempts).
+    - Never consumes a ticket, can be mixed with every other operation.
+-----------------------------------------------------------------------------*/
+int mpmc_send_await(SenderMpmc *sender, const void *element);
+int mpmc_recv_await(ReceiverMpmc *receiver, void *out);
+
+/*-----------------------------------------------------------------------------
+  mpmc_send_reserve / mpmc_send_commit
+  Two-phase send: reserve claims the next slot and exposes its storage, the
+  caller writes the element in place, commit publishes it.
+
+  sender : pointer to a valid SenderMpmc
+  elem   : set to elem_size writable bytes inside the ring
+
+  Returns:
+    - CHANNEL_OK          on success
+    - CHANNEL_ERR_NULL    if sender or elem is NULL, or (commit) nothing is
+                          reserved
+    - CHANNEL_ERR_CLOSED  if channel is closed
+
+  Notes:
+    - reserve waits (channel strategy) like mpmc_send, but copies nothing.
+    - One reservation per sender at a time: commit before reserving again.
+    - The receiver holding that ticket waits until the commit, so keep the
+      window between the two calls short.
+-----------------------------------------------------------------------------*/
+int mpmc_send_reserve(SenderMpmc *sender, void **elem);
+int mpmc_send_commit(SenderMpmc *sender);
+
+/*-----------------------------------------------------------------------------
+  mpmc_recv_peek / mpmc_recv_release
+  Zero-copy receive: peek claims the next element for this receiver and
+  exposes it in place, release hands its slot back to the senders.
+
+  receiver : pointer to a valid ReceiverMpmc
+  elem     : set to the claimed element, inside the ring
+
+  Returns:
+    - CHANNEL_OK          on success
+    - CHANNEL_ERR_NULL    if receiver or elem is NULL, or (release) nothing
+                          is peeked
+    - CHANNEL_ERR_CLOSED  if channel or receiver is closed
+
+  Notes:
+    - peek waits (channel strategy) like mpmc_recv. The element is this
+      receiver's: no other receiver gets it.
+    - The element stays valid until mpmc_recv_release; peeking again before
+      that returns the same element.
+    - The sender that wraps around onto the slot waits for the release.
+-----------------------------------------------------------------------------*/
+int mpmc_recv_peek(ReceiverMpmc *receiver, const void **elem);
+int mpmc_recv_release(ReceiverMpmc *receiver);
+
 #endif
 
 #if (defined(MPMC_IMPLEMENTATION))
+#include <limits.h>
 #include <stdalign.h>
 #include <stdatomic.h>
 #include <stddef.h>
@@ -248,12 +420,31 @@ int mpmc_recv(ReceiverMpmc *receiver, void *out);
 #include <stdlib.h>
 #include <string.h>
 
+// counters when stats/stats.h came first, nothing otherwise
+#if defined(STATS_H)
+#define _MPMC_STATS_ADD(c, n) stats_add((c), (n))
+#define _MPMC_STATS_MAX(c, v) stats_max((c), (v))
+
+// elements queued once ticket head is filled; tail runs ahead of head while
+// receivers wait on an empty ring
+static inline size_t _mpmc_depth(_Atomic size_t *tail, size_t head) {
+  size_t t = atomic_load_explicit(tail, memory_order_relaxed);
+  return head + 1 > t ? head + 1 - t : 0;
+}
+#else
+#define _MPMC_STATS_ADD(c, n) ((void)0)
+#define _MPMC_STATS_MAX(c, v) ((void)0)
+#endif
+
 typedef struct ChannelMpmc_t {
-  Slot *buffer;
+  uint8_t *buffer;
+  size_t stride; // bytes between two slots
+  const MemBackend *memory; // ring buffer allocator, NULL = aligned_alloc
   _Atomic ChanState state; // 0 -> Open | 1 -> Closed
 
   size_t capacity;  // number of elements
   size_t elem_size; // sizeof(T)
+  ChanWaitStrategy wait;
   ProducerCursor producer;
   ConsumerCursor consumer;
 
@@ -264,23 +455,34 @@ typedef struct ChannelMpmc_t {
 
 ChannelMpmc *channel_create_mpmc(const size_t capacity,
                                  const size_t elem_size) {
+  return channel_create_mpmc_opts(capacity, elem_size, NULL);
+}
+
+ChannelMpmc *channel_create_mpmc_opts(const size_t capacity,
+                                      const size_t elem_size,
+                                      const ChannelOptions *opts) {
   ChannelMpmc *chan = malloc(sizeof(ChannelMpmc));
 
   if (!chan) {
     return NULL;
   }
 
-  chan->buffer = malloc(capacity * sizeof(Slot));
-
-  for (size_t i = 0; i < capacity; i++) {
-    chan->buffer[i].seq = i;
-    chan->buffer[i].data = malloc(elem_size);
+  chan->stride = chan_slot_stride(
+      elem_size, opts ? opts->layout : CHANNEL_SLOT_PADDED);
+  chan->memory = opts ? opts->memory : NULL;
+  chan->buffer = chan_slots_alloc(capacity, chan->stride, chan->memory);
+  if (!chan->buffer) {
+    free(chan);
+    return NULL;
   }
 
   chan->capacity = capacity;
   chan->elem_size = elem_size;
+  chan->wait = opts ? opts->wait : CHANNEL_WAIT_SPIN;
   chan->producer.head = 0;
   chan->consumer.tail = 0;
+  chan_parker_init(&chan->producer.parker);
+  chan_parker_init(&chan->consumer.parker);
   chan->cons_cont = 0;
   chan->prod_cont = 0;
   chan->state = OPEN;
@@ -289,7 +491,9 @@ ChannelMpmc *channel_create_mpmc(const size_t capacity,
 };
 
 void mpmc_close(ChannelMpmc *chan) {
-  atomic_store_explicit(&chan->state, CLOSED, memory_order_release);
+  atomic_store_explicit(&chan->state, CLOSED, memory_order_seq_cst);
+  chan_parker_close(&chan->producer.parker);
+  chan_parker_close(&chan->consumer.parker);
 };
 
 ChanState mpmc_is_closed(const ChannelMpmc *chan) {
@@ -310,35 +514,49 @@ void mpmc_destroy(ChannelMpmc *chan) {
     prod_cont = atomic_load_explicit(&chan->prod_cont, memory_order_acquire);
   } while (cons_cont != 0 || prod_cont != 0);
 
-  for (size_t x = 0; x < chan->capacity; x++) {
-    free(chan->buffer[x].data);
-  }
-  free(chan->buffer);
+  chan_slots_free(chan->buffer, chan->capacity, chan->stride, chan->memory);
   free(chan);
 };
 
 typedef struct SenderMpmc_t {
-  Slot *buffer;
+  uint8_t *buffer;
+  size_t stride; // bytes between two slots
   size_t inner_c_cap;
   size_t elem_size;
+  ChanWaitStrategy wait;
 
   _Atomic ChanState sender_state;
   _Atomic ChanState *chan_state;
   _Atomic size_t *head;
+  _Atomic size_t *tail;
   _Atomic size_t *chan_prod_count;
+
+  ChanParker *consumers; // parked receivers, woken on send
+  ChanParker *producers; // parked senders, woken on recv
+
+  Slot *reserved; // slot claimed by mpmc_send_reserve, NULL if none
+  size_t reserved_ticket;
 } SenderMpmc;
 
 typedef struct ReceiverMpmc_t {
-  Slot *buffer;
+  uint8_t *buffer;
+  size_t stride; // bytes between two slots
   size_t inner_c_cap;
   size_t elem_size;
+  ChanWaitStrategy wait;
 
   _Atomic size_t *head;
   _Atomic size_t *tail;
 
+  ChanParker *consumers; // parked receivers, woken on send
+  ChanParker *producers; // parked senders, woken on recv
+
   _Atomic ChanState receiver_state;
   _Atomic ChanState *chan_state;
   _Atomic size_t *chan_cons_count;
+
+  Slot *peeked; // slot claimed by mpmc_recv_peek, NULL if none
+  size_t peeked_ticket;
 } ReceiverMpmc;
 
 SenderMpmc *mpmc_get_sender(ChannelMpmc *chan) {
@@ -348,11 +566,17 @@ SenderMpmc *mpmc_get_sender(ChannelMpmc *chan) {
   SenderMpmc *sender = malloc(sizeof(SenderMpmc));
 
   sender->buffer = chan->buffer;
+  sender->stride = chan->stride;
   sender->inner_c_cap = chan->capacity;
   sender->head = &chan->producer.head;
+  sender->tail = &chan->consumer.tail;
   sender->elem_size = chan->elem_size;
+  sender->wait = chan->wait;
+  sender->consumers = &chan->producer.parker;
+  sender->producers = &chan->consumer.parker;
   sender->chan_state = &chan->state;
   sender->sender_state = OPEN;
+  sender->reserved = NULL;
 
   atomic_fetch_add_explicit(&chan->prod_cont, 1, memory_order_release);
   sender->chan_prod_count = &chan->prod_cont;
@@ -366,12 +590,17 @@ ReceiverMpmc *mpmc_get_receiver(ChannelMpmc *chan) {
   ReceiverMpmc *receiver = malloc(sizeof(ReceiverMpmc));
 
   receiver->buffer = chan->buffer;
+  receiver->stride = chan->stride;
   receiver->inner_c_cap = chan->capacity;
   receiver->tail = &chan->consumer.tail;
   receiver->head = &chan->producer.head;
   receiver->elem_size = chan->elem_size;
+  receiver->wait = chan->wait;
+  receiver->consumers = &chan->producer.parker;
+  receiver->producers = &chan->consumer.parker;
   receiver->receiver_state = OPEN;
   receiver->chan_state = &chan->state;
+  receiver->peeked = NULL;
 
   atomic_fetch_add_explicit(&chan->cons_cont, 1, memory_order_release);
   receiver->chan_cons_count = &chan->cons_cont;
@@ -389,6 +618,91 @@ void mpmc_close_sender(SenderMpmc *sender) {
   atomic_store_explicit(&sender->sender_state, CLOSED, memory_order_release);
 };
 
+/* claims the next send ticket and waits for its slot, NULL once the
+   channel closed */
+static inline Slot *_mpmc_claim_send(SenderMpmc *sender, size_t *ticket) {
+  // seq_cst: pairs with the sleeper count of parked receivers
+  size_t head =
+      atomic_fetch_add_explicit(sender->head, 1, memory_order_seq_cst);
+  Slot *slot = chan_slot(sender->buffer, sender->stride,
+                         head % sender->inner_c_cap);
+
+  uint32_t round = 0;
+  while (atomic_load_explicit(&slot->seq, memory_order_acquire) != head) {
+    if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
+        CLOSED) {
+      return NULL;
+    }
+    if (chan_wait_step(sender->wait, &round)) {
+      // full: wait for the consumer of ticket (head - cap) to claim it
+      chan_park_until(sender->producers, sender->tail, sender->inner_c_cap,
+                      head);
+    }
+  }
+  if (round) {
+    _MPMC_STATS_ADD(STATS_MPMC_FULL, 1);
+    _MPMC_STATS_ADD(STATS_MPMC_SEND_SPINS, round);
+  }
+  _MPMC_STATS_MAX(STATS_MPMC_DEPTH_MAX, _mpmc_depth(sender->tail, head));
+  *ticket = head;
+  return slot;
+}
+
+static inline void _mpmc_publish(SenderMpmc *sender, Slot *slot,
+                                 size_t ticket) {
+  // set slot for consumer
+  atomic_store_explicit(&slot->seq, ticket + 1, memory_order_release);
+
+  if (sender->wait == CHANNEL_WAIT_PARK) {
+    chan_unpark(sender->consumers, 1);
+  }
+}
+
+/* claims the next receive ticket and waits for its slot to be published,
+   NULL once the channel closed */
+static inline Slot *_mpmc_claim_recv(ReceiverMpmc *receiver, size_t *ticket) {
+  // seq_cst: pairs with the sleeper count of parked senders
+  size_t tail =
+      atomic_fetch_add_explicit(receiver->tail, 1, memory_order_seq_cst);
+
+  Slot *slot = chan_slot(receiver->buffer, receiver->stride,
+                         tail % receiver->inner_c_cap);
+
+  uint32_t round = 0;
+  while (atomic_load_explicit(&slot->seq, memory_order_acquire) != tail + 1) {
+    if (atomic_load_explicit(receiver->chan_state, memory_order_acquire) ==
+        CLOSED) {
+      // the slot may have been published just before the close: still
+      // deliver it, so a closed channel drains completely
+      if (atomic_load_explicit(&slot->seq, memory_order_acquire) == tail + 1) {
+        break;
+      }
+      return NULL;
+    }
+    if (chan_wait_step(receiver->wait, &round)) {
+      // empty: wait for a producer to claim ticket tail
+      chan_park_until(receiver->consumers, receiver->head, 0, tail);
+    }
+  }
+  if (round) {
+    _MPMC_STATS_ADD(STATS_MPMC_EMPTY, 1);
+    _MPMC_STATS_ADD(STATS_MPMC_RECV_SPINS, round);
+  }
+  *ticket = tail;
+  return slot;
+}
+
+static inline void _mpmc_release(ReceiverMpmc *receiver, Slot *slot,
+                                 size_t ticket) {
+  // set slot for next future cycle
+  atomic_store_explicit(&slot->seq, ticket + receiver->inner_c_cap,
+                        memory_order_release);
+
+  if (receiver->wait == CHANNEL_WAIT_PARK) {
+    chan_unpark(receiver->producers, 1);
+  }
+}
+
 int mpmc_send(SenderMpmc *sender, const void *element) {
   if (!sender) {
     return CHANNEL_ERR_NULL;
@@ -400,27 +714,84 @@ int mpmc_send(SenderMpmc *sender, const void *element) {
     return CHANNEL_ERR_CLOSED;
   }
 
-  size_t head =
-      atomic_fetch_add_explicit(sender->head, 1, memory_order_acq_rel);
-  Slot *slot = &sender->buffer[head % sender->inner_c_cap];
+  size_t head;
+  Slot *slot = _mpmc_claim_send(sender, &head);
+  if (!slot) {
+    return CHANNEL_ERR_CLOSED;
+  }
 
-  while (atomic_load_explicit(&slot->seq, memory_order_acquire) != head) {
-    if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
-        CLOSED) {
-      return CHANNEL_ERR_CLOSED;
+  memcpy(slot->data, element, sender->elem_size);
+  _mpmc_publish(sender, slot, head);
+  return CHANNEL_OK;
+};
+
+int mpmc_recv(ReceiverMpmc *receiver, void *out) {
+  if (!receiver) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(&receiver->receiver_state, memory_order_acquire) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+
+  size_t tail;
+  Slot *slot = _mpmc_claim_recv(receiver, &tail);
+  if (!slot) {
+    return CHANNEL_ERR_CLOSED;
+  }
+
+  memcpy(out, slot->data, receiver->elem_size);
+  _mpmc_release(receiver, slot, tail);
+  return CHANNEL_OK;
+};
+
+int mpmc_try_send(SenderMpmc *sender, const void *element) {
+  if (!sender) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+
+  size_t head = atomic_load_explicit(sender->head, memory_order_relaxed);
+  Slot *slot;
+  while (1) {
+    slot = chan_slot(sender->buffer, sender->stride,
+                     head % sender->inner_c_cap);
+    size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    intptr_t dif = (intptr_t)seq - (intptr_t)head;
+
+    if (dif == 0) {
+      // seq_cst: pairs with the sleeper count of parked receivers
+      if (atomic_compare_exchange_weak_explicit(sender->head, &head, head + 1,
+                                                memory_order_seq_cst,
+                                                memory_order_relaxed)) {
+        break;
+      }
+    } else if (dif < 0) {
+      // previous cycle not consumed yet -> full
+      _MPMC_STATS_ADD(STATS_MPMC_FULL, 1);
+      return CHANNEL_ERR_FULL;
+    } else {
+      // another producer took it, reload
+      head = atomic_load_explicit(sender->head, memory_order_relaxed);
     }
-    cpu_relax();
   }
 
   memcpy(slot->data, element, sender->elem_size);
+  _MPMC_STATS_MAX(STATS_MPMC_DEPTH_MAX, _mpmc_depth(sender->tail, head));
 
   // set slot for consumer
   atomic_store_explicit(&slot->seq, head + 1, memory_order_release);
 
+  if (sender->wait == CHANNEL_WAIT_PARK) {
+    chan_unpark(sender->consumers, 1);
+  }
   return CHANNEL_OK;
 };
 
-int mpmc_recv(ReceiverMpmc *receiver, void *out) {
+int mpmc_try_recv(ReceiverMpmc *receiver, void *out) {
   if (!receiver) {
     return CHANNEL_ERR_NULL;
   }
@@ -428,23 +799,309 @@ int mpmc_recv(ReceiverMpmc *receiver, void *out) {
       CLOSED) {
     return CHANNEL_ERR_CLOSED;
   }
-  size_t tail =
-      atomic_fetch_add_explicit(receiver->tail, 1, memory_order_acq_rel);
 
-  Slot *slot = &receiver->buffer[tail % receiver->inner_c_cap];
-
-  while (atomic_load_explicit(&slot->seq, memory_order_acquire) != tail + 1) {
-    if (atomic_load_explicit(receiver->chan_state, memory_order_acquire) ==
-        CLOSED) {
-      return CHANNEL_ERR_CLOSED;
+  size_t tail = atomic_load_explicit(receiver->tail, memory_order_relaxed);
+  Slot *slot;
+  while (1) {
+    slot = chan_slot(receiver->buffer, receiver->stride,
+                     tail % receiver->inner_c_cap);
+    size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    intptr_t dif = (intptr_t)seq - (intptr_t)(tail + 1);
+
+    if (dif == 0) {
+      if (atomic_compare_exchange_weak_explicit(receiver->tail, &tail,
+                                                tail + 1, memory_order_seq_cst,
+                                                memory_order_relaxed)) {
+        break;
+      }
+    } else if (dif < 0) {
+      // slot not published yet -> empty
+      if (atomic_load_explicit(receiver->chan_state, memory_order_acquire) ==
+          CLOSED) {
+        return CHANNEL_ERR_CLOSED;
+      }
+      _MPMC_STATS_ADD(STATS_MPMC_EMPTY, 1);
+      return CHANNEL_ERR_EMPTY;
+    } else {
+      // another consumer took it, reload
+      tail = atomic_load_explicit(receiver->tail, memory_order_relaxed);
     }
-    cpu_relax();
   }
   memcpy(out, slot->data, receiver->elem_size);
 
   // set slot for next future cycle
   atomic_store_explicit(&slot->seq, tail + receiver->inner_c_cap,
                         memory_order_release);
+
+  if (receiver->wait == CHANNEL_WAIT_PARK) {
+    chan_unpark(receiver->producers, 1);
+  }
   return CHANNEL_OK;
 };
+
+int mpmc_send_batch(SenderMpmc *sender, const void *elems, size_t n) {
+  if (!sender || !elems) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+  if (n == 0) {
+    return 0;
+  }
+  if (n > INT_MAX) {
+    n = INT_MAX;
+  }
+
+  // seq_cst: pairs with the sleeper count of parked receivers
+  size_t head =
+      atomic_fetch_add_explicit(sender->head, n, memory_order_seq_cst);
+  const uint8_t *src = elems;
+
+  size_t sent = 0;
+  size_t woken = 0; // published elements receivers were told about
+  ChanState state = OPEN;
+  while (sent < n && state == OPEN) {
+    size_t ticket = head + sent;
+    Slot *slot = chan_slot(sender->buffer, sender->stride,
+                           ticket % sender->inner_c_cap);
+
+    uint32_t round = 0;
+    while (atomic_load_explicit(&slot->seq, memory_order_acquire) != ticket) {
+      state = atomic_load_explicit(sender->chan_state, memory_order_acquire);
+      if (state == CLOSED) {
+        break;
+      }
+      if (chan_wait_step(sender->wait, &round)) {
+        // the room comes from receivers: they must hear of what is out
+        // already, or a parked one never frees it
+        if (sent > woken) {
+          chan_unpark(sender->consumers, sent - woken > 1);
+          woken = sent;
+        }
+        chan_park_until(sender->producers, sender->tail, sender->inner_c_cap,
+                        ticket);
+      }
+    }
+    if (state == CLOSED) {
+      break;
+    }
+
+    memcpy(slot->data, src + sent * sender->elem_size, sender->elem_size);
+    atomic_store_explicit(&slot->seq, ticket + 1, memory_order_release);
+    sent++;
+  }
+
+  if (sender->wait == CHANNEL_WAIT_PARK && sent > woken) {
+    chan_unpark(sender->consumers, sent - woken > 1);
+  }
+  return sent ? (int)sent : CHANNEL_ERR_CLOSED;
+};
+
+/* claims the run of published slots starting at tail, 0 if none is ready */
+static size_t _mpmc_claim_ready(ReceiverMpmc *receiver, size_t max,
+                                size_t *first) {
+  size_t tail = atomic_load_explicit(receiver->tail, memory_order_relaxed);
+  while (1) {
+    size_t ready = 0;
+    while (ready < max) {
+      Slot *slot = chan_slot(receiver->buffer, receiver->stride,
+                             (tail + ready) % receiver->inner_c_cap);
+      if (atomic_load_explicit(&slot->seq, memory_order_acquire) !=
+          tail + ready + 1) {
+        break;
+      }
+      ready++;
+    }
+    if (ready == 0) {
+      return 0;
+    }
+    if (atomic_compare_exchange_weak_explicit(receiver->tail, &tail,
+                                              tail + ready,
+                                              memory_order_seq_cst,
+                                              memory_order_relaxed)) {
+      *first = tail;
+      return ready;
+    }
+  }
+}
+
+int mpmc_recv_batch(ReceiverMpmc *receiver, void *out, size_t max) {
+  if (!receiver || !out) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(&receiver->receiver_state, memory_order_acquire) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+  if (max == 0) {
+    return 0;
+  }
+  if (max > INT_MAX) {
+    max = INT_MAX;
+  }
+
+  uint8_t *dst = out;
+  size_t got = 0;
+  size_t first;
+  size_t ready = _mpmc_claim_ready(receiver, max, &first);
+
+  if (ready == 0) {
+    // nothing published yet: block for one, then take what followed it
+    int rc = mpmc_recv(receiver, dst);
+    if (rc != CHANNEL_OK) {
+      return rc;
+    }
+    got = 1;
+    if (max == 1) {
+      return 1;
+    }
+    ready = _mpmc_claim_ready(receiver, max - 1, &first);
+  }
+
+  for (size_t x = 0; x < ready; x++) {
+    size_t ticket = first + x;
+    Slot *slot = chan_slot(receiver->buffer, receiver->stride,
+                           ticket % receiver->inner_c_cap);
+    memcpy(dst + (got + x) * receiver->elem_size, slot->data,
+           receiver->elem_size);
+    atomic_store_explicit(&slot->seq, ticket + receiver->inner_c_cap,
+                          memory_order_release);
+  }
+
+  if (ready && receiver->wait == CHANNEL_WAIT_PARK) {
+    chan_unpark(receiver->producers, 1);
+  }
+  return (int)(got + ready);
+};
+typedef struct _MpmcAwait_t {
+  void *handle;
+  void *elem;
+  int rc;
+} _MpmcAwait;
+
+// A channel only wakes waiters after its seq_cst claim on head / tail, so
+// a claim seen here whose slot is not published yet may already be past
+// its wake-up: poll instead of parking on it.
+static int _mpmc_send_attempt(void *arg) {
+  _MpmcAwait *a = arg;
+  SenderMpmc *sender = a->handle;
+  a->rc = mpmc_try_send(sender, a->elem);
+  if (a->rc != CHANNEL_ERR_FULL) {
+    return CHAN_AWAIT_DONE;
+  }
+  size_t head = atomic_load_explicit(sender->head, memory_order_seq_cst);
+  size_t tail = atomic_load_explicit(sender->tail, memory_order_seq_cst);
+  if (sender->wait != CHANNEL_WAIT_PARK ||
+      (intptr_t)(head - tail) < (intptr_t)sender->inner_c_cap) {
+    return CHAN_AWAIT_RETRY;
+  }
+  return CHAN_AWAIT_PARK;
+}
+
+static int _mpmc_recv_attempt(void *arg) {
+  _MpmcAwait *a = arg;
+  ReceiverMpmc *receiver = a->handle;
+  a->rc = mpmc_try_recv(receiver, a->elem);
+  if (a->rc != CHANNEL_ERR_EMPTY) {
+    return CHAN_AWAIT_DONE;
+  }
+  size_t head = atomic_load_explicit(receiver->head, memory_order_seq_cst);
+  size_t tail = atomic_load_explicit(receiver->tail, memory_order_seq_cst);
+  if (receiver->wait != CHANNEL_WAIT_PARK || (intptr_t)(head - tail) > 0) {
+    return CHAN_AWAIT_RETRY;
+  }
+  return CHAN_AWAIT_PARK;
+}
+
+int mpmc_send_await(SenderMpmc *sender, const void *element) {
+  if (!sender) {
+    return CHANNEL_ERR_NULL;
+  }
+  _MpmcAwait a = {sender, (void *)element, CHANNEL_ERR_FULL};
+  chan_await(sender->producers, _mpmc_send_attempt, &a);
+  if (a.rc == CHANNEL_OK) {
+    // room left: hand the wake on to the next waiting sender
+    size_t head = atomic_load_explicit(sender->head, memory_order_seq_cst);
+    size_t tail = atomic_load_explicit(sender->tail, memory_order_seq_cst);
+    if ((intptr_t)(head - tail) < (intptr_t)sender->inner_c_cap) {
+      chan_unpark(sender->producers, 0);
+    }
+  }
+  return a.rc;
+}
+
+int mpmc_recv_await(ReceiverMpmc *receiver, void *out) {
+  if (!receiver) {
+    return CHANNEL_ERR_NULL;
+  }
+  _MpmcAwait a = {receiver, out, CHANNEL_ERR_EMPTY};
+  chan_await(receiver->consumers, _mpmc_recv_attempt, &a);
+  if (a.rc == CHANNEL_OK) {
+    // more elements left: hand the wake on to the next waiting receiver
+    size_t head = atomic_load_explicit(receiver->head, memory_order_seq_cst);
+    size_t tail = atomic_load_explicit(receiver->tail, memory_order_seq_cst);
+    if ((intptr_t)(head - tail) > 0) {
+      chan_unpark(receiver->consumers, 0);
+    }
+  }
+  return a.rc;
+}
+
+int mpmc_send_reserve(SenderMpmc *sender, void **elem) {
+  if (!sender || !elem) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+
+  Slot *slot = _mpmc_claim_send(sender, &sender->reserved_ticket);
+  if (!slot) {
+    return CHANNEL_ERR_CLOSED;
+  }
+  sender->reserved = slot;
+  *elem = slot->data;
+  return CHANNEL_OK;
+}
+
+int mpmc_send_commit(SenderMpmc *sender) {
+  if (!sender || !sender->reserved) {
+    return CHANNEL_ERR_NULL;
+  }
+  Slot *slot = sender->reserved;
+  sender->reserved = NULL;
+  _mpmc_publish(sender, slot, sender->reserved_ticket);
+  return CHANNEL_OK;
+}
+
+int mpmc_recv_peek(ReceiverMpmc *receiver, const void **elem) {
+  if (!receiver || !elem) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (!receiver->peeked) {
+    if (atomic_load_explicit(&receiver->receiver_state,
+                             memory_order_acquire) == CLOSED) {
+      return CHANNEL_ERR_CLOSED;
+    }
+    receiver->peeked = _mpmc_claim_recv(receiver, &receiver->peeked_ticket);
+    if (!receiver->peeked) {
+      return CHANNEL_ERR_CLOSED;
+    }
+  }
+  *elem = receiver->peeked->data;
+  return CHANNEL_OK;
+}
+
+int mpmc_recv_release(ReceiverMpmc *receiver) {
+  if (!receiver || !receiver->peeked) {
+    return CHANNEL_ERR_NULL;
+  }
+  Slot *slot = receiver->peeked;
+  receiver->peeked = NULL;
+  _mpmc_release(receiver, slot, receiver->peeked_ticket);
+  return CHANNEL_OK;
+}
 #endif
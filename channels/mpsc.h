@@ -26,7 +26,7 @@ This channel supports:
 - multiple producers
 - exactly one consumer
 - fixed-capacity ring buffer
-- busy-wait synchronization (no blocking, no syscalls)
+- busy-wait synchronization by default, optional yield/futex parking
 
 The implementation is lock-free and cache-line aware.
 
@@ -55,8 +55,10 @@ Senders and receiver must be freed by the user.
 ------------------------------------------------------------------------------
 WARNING
 
-This channel uses busy-waiting.
+By default this channel uses busy-waiting.
 It is intended for short-lived waits (job systems, engine internals).
+Use channel_create_mpsc_opts with CHANNEL_WAIT_YIELD or CHANNEL_WAIT_PARK
+(see channels.h) when waits can be long.
 ------------------------------------------------------------------------------
 */
 #ifndef MPSC_CHANNEL_H
@@ -99,10 +101,23 @@ typedef enum ChanState_t ChanState;
   Notes:
     - Multiple producers can safely send concurrently.
     - Only one consumer is supported.
-    - Allocates internal memory for slots and element buffers.
+    - Allocates every slot, element storage included, in one block.
 -----------------------------------------------------------------------------*/
 ChannelMpsc *channel_create_mpsc(const size_t capacity, const size_t elem_size);
 
+/*-----------------------------------------------------------------------------
+  channel_create_mpsc_opts
+  Same as channel_create_mpsc, with explicit options.
+
+  opts : creation options, NULL for the defaults
+
+  Notes:
+    - opts->wait selects how blocked operations wait (see channels.h).
+-----------------------------------------------------------------------------*/
+ChannelMpsc *channel_create_mpsc_opts(const size_t capacity,
+                                      const size_t elem_size,
+                                      const ChannelOptions *opts);
+
 /*-----------------------------------------------------------------------------
   mpsc_close
   Marks the channel as closed.
@@ -139,7 +154,6 @@ ChanState mpsc_is_closed(const ChannelMpsc *chan);
 
   Notes:
     - Blocks until all active producers call mpsc_close_sender.
-    - Also frees element buffers.
     - After this call, the channel pointer becomes invalid.
 -----------------------------------------------------------------------------*/
 void mpsc_destroy(ChannelMpsc *chan);
@@ -200,12 +214,32 @@ void mpsc_close_sender(SenderMpsc *sender);
     - CHANNEL_ERR_CLOSED  if channel is closed
 
   Notes:
-    - Busy-waits if the ring buffer slot is not available.
+    - Waits (channel strategy) if the ring buffer slot is not available.
     - Lock-free and wait-free for each producer.
     - Copies elem_size bytes from element to the internal buffer.
 -----------------------------------------------------------------------------*/
 int mpsc_send(SenderMpsc *sender, const void *element);
 
+/*-----------------------------------------------------------------------------
+  mpsc_try_send
+  Sends an element to the channel without blocking.
+
+  sender  : pointer to a valid SenderMpsc
+  element : pointer to the element data to send
+
+  Returns:
+    - CHANNEL_OK          on success
+    - CHANNEL_ERR_NULL    if sender is NULL
+    - CHANNEL_ERR_FULL    if the next slot is still occupied
+    - CHANNEL_ERR_CLOSED  if channel is closed
+
+  Notes:
+    - The slot is claimed with a CAS only once it is free, so a full channel
+      never consumes a ticket (unlike mpsc_send).
+    - Can be freely mixed with mpsc_send on the same channel.
+-----------------------------------------------------------------------------*/
+int mpsc_try_send(SenderMpsc *sender, const void *element);
+
 /*-----------------------------------------------------------------------------
   mpsc_recv
   Receives an element from the channel.
@@ -221,13 +255,122 @@ int mpsc_send(SenderMpsc *sender, const void *element);
   Notes:
     - Only one consumer is supported.
     - Lock-free for the consumer.
+    - Never waits, so only senders are ever parked on this channel.
     - Copies elem_size bytes into the memory pointed to by out.
 -----------------------------------------------------------------------------*/
 int mpsc_recv(ReceiverMpsc *receiver, void *out);
 
+/*-----------------------------------------------------------------------------
+  mpsc_try_recv
+  Receives an element from the channel without blocking.
+
+  receiver : pointer to a valid ReceiverMpsc
+  out      : pointer to memory where the element will be copied
+
+  Returns:
+    - CHANNEL_OK          on success
+    - CHANNEL_ERR_NULL    if receiver is NULL
+    - CHANNEL_ERR_EMPTY   if no new element is available
+    - CHANNEL_ERR_CLOSED  if the channel is closed and drained
+
+  Notes:
+    - Same as mpsc_recv (which never waits either), but reports a closed and
+      drained channel so a polling loop knows when to stop.
+    - Check order is "empty, then closed": a send racing with the close may
+      still be reported as CHANNEL_ERR_CLOSED.
+-----------------------------------------------------------------------------*/
+int mpsc_try_recv(ReceiverMpsc *receiver, void *out);
+
+/*-----------------------------------------------------------------------------
+  mpsc_send_batch
+  Sends n contiguous elements with a single claim on head.
+
+  sender : pointer to a valid SenderMpsc
+  elems  : pointer to n elements of elem_size bytes
+  n      : number of elements
+
+  Returns:
+    - number of elements sent (n unless the channel closed mid-batch)
+    - CHANNEL_ERR_NULL    if sender or elems is NULL
+    - CHANNEL_ERR_CLOSED  if channel is closed and nothing was sent
+
+  Notes:
+    - One fetch_add reserves n consecutive slots; each slot is then filled
+      and published in order, waiting (channel strategy) only when full.
+    - n is clamped to INT_MAX.
+-----------------------------------------------------------------------------*/
+int mpsc_send_batch(SenderMpsc *sender, const void *elems, size_t n);
+
+/*-----------------------------------------------------------------------------
+  mpsc_recv_batch
+  Receives up to max elements with a single update of tail.
+
+  receiver : pointer to a valid ReceiverMpsc
+  out      : pointer to room for max elements
+  max      : maximum number of elements to receive
+
+  Returns:
+    - number of elements received (>= 1)
+    - CHANNEL_ERR_NULL    if receiver or out is NULL
+    - CHANNEL_ERR_EMPTY   if no new element is available
+
+  Notes:
+    - Only one consumer is supported.
+    - Never waits, takes the run of published slots starting at tail.
+    - max is clamped to INT_MAX.
+-----------------------------------------------------------------------------*/
+int mpsc_recv_batch(ReceiverMpsc *receiver, void *out, size_t max);
+
+/*-----------------------------------------------------------------------------
+  mpsc_send_reserve / mpsc_send_commit
+  Two-phase send: reserve claims the next slot and exposes its storage, the
+  caller writes the element in place, commit publishes it.
+
+  sender : pointer to a valid SenderMpsc
+  elem   : set to elem_size writable bytes inside the ring
+
+  Returns:
+    - CHANNEL_OK          on success
+    - CHANNEL_ERR_NULL    if sender or elem is NULL, or (commit) nothing is
+                          reserved
+    - CHANNEL_ERR_CLOSED  if channel is closed
+
+  Notes:
+    - reserve waits (channel strategy) like mpsc_send, but copies nothing.
+    - One reservation per sender at a time: commit before reserving again.
+    - The receiver reads slots in order and stops at a reserved one until it
+      is committed, so keep the window between the two calls short.
+-----------------------------------------------------------------------------*/
+int mpsc_send_reserve(SenderMpsc *sender, void **elem);
+int mpsc_send_commit(SenderMpsc *sender);
+
+/*-----------------------------------------------------------------------------
+  mpsc_recv_peek / mpsc_recv_release
+  Zero-copy receive: peek exposes the next element in place, release hands
+  its slot back to the senders.
+
+  receiver : pointer to a valid ReceiverMpsc
+  elem     : set to the next element, inside the ring
+
+  Returns:
+    - CHANNEL_OK          on success
+    - CHANNEL_ERR_NULL    if receiver or elem is NULL
+    - CHANNEL_ERR_EMPTY   if no new element is available (release: nothing
+                          to release)
+    - CHANNEL_ERR_CLOSED  if the channel is closed and drained (peek only)
+
+  Notes:
+    - Never waits, like mpsc_try_recv.
+    - The element stays valid until mpsc_recv_release; peeking again before
+      that returns the same element.
+-----------------------------------------------------------------------------*/
+int mpsc_recv_peek(ReceiverMpsc *receiver, const void **elem);
+int mpsc_recv_release(ReceiverMpsc *receiver);
+
 #endif
 
 #if (defined(MPSC_IMPLEMENTATION))
+#include <limits.h>
 #include <stdalign.h>
 #include <stdatomic.h>
 #include <stddef.h>
@@ -236,9 +379,12 @@ int mpsc_recv(ReceiverMpsc *receiver, void *out);
 #include <string.h>
 
 typedef struct ChannelMpsc_t {
-  Slot *buffer;
+  uint8_t *buffer;
+  size_t stride; // bytes between two slots
+  const MemBackend *memory; // ring buffer allocator, NULL = aligned_alloc
   size_t capacity;  // number of elements
   size_t elem_size; // sizeof(T)
+  ChanWaitStrategy wait;
   ProducerCursor producer;
   ConsumerCursor consumer;
 
@@ -248,36 +394,34 @@ typedef struct ChannelMpsc_t {
 
 ChannelMpsc *channel_create_mpsc(const size_t capacity,
                                  const size_t elem_size) {
+  return channel_create_mpsc_opts(capacity, elem_size, NULL);
+}
+
+ChannelMpsc *channel_create_mpsc_opts(const size_t capacity,
+                                      const size_t elem_size,
+                                      const ChannelOptions *opts) {
   ChannelMpsc *chan = malloc(sizeof(ChannelMpsc));
 
   if (!chan) {
     return NULL;
   }
 
-  chan->buffer = (void *)0;
-
-  void *tmp = realloc(chan->buffer, (capacity * sizeof(Slot)));
-  if (!tmp) {
+  chan->stride = chan_slot_stride(
+      elem_size, opts ? opts->layout : CHANNEL_SLOT_PADDED);
+  chan->memory = opts ? opts->memory : NULL;
+  chan->buffer = chan_slots_alloc(capacity, chan->stride, chan->memory);
+  if (!chan->buffer) {
     free(chan);
     return NULL;
   }
 
-  chan->buffer = tmp;
-
-  for (size_t i = 0; i < capacity; i++) {
-    chan->buffer[i].seq = i;
-    chan->buffer[i].data = (void *)0;
-    void *tmp = realloc(chan->buffer[i].data, elem_size);
-    if (!tmp) {
-      return NULL;
-    }
-    chan->buffer[i].data = tmp;
-  }
-
   chan->capacity = capacity;
   chan->elem_size = elem_size;
+  chan->wait = opts ? opts->wait : CHANNEL_WAIT_SPIN;
   chan->producer.head = 0;
   chan->consumer.tail = 0;
+  chan_parker_init(&chan->producer.parker);
+  chan_parker_init(&chan->consumer.parker);
   chan->prod_cont = 0;
   chan->state = OPEN;
 
@@ -285,7 +429,9 @@ ChannelMpsc *channel_create_mpsc(const size_t capacity,
 };
 
 void mpsc_close(ChannelMpsc *chan) {
-  atomic_store_explicit(&chan->state, CLOSED, memory_order_release);
+  atomic_store_explicit(&chan->state, CLOSED, memory_order_seq_cst);
+  chan_parker_close(&chan->producer.parker);
+  chan_parker_close(&chan->consumer.parker);
 }
 
 ChanState mpsc_is_closed(const ChannelMpsc *chan) {
@@ -306,32 +452,39 @@ void mpsc_destroy(ChannelMpsc *chan) {
     chan_state = atomic_load_explicit(&chan->state, memory_order_acquire);
   } while (prod_cont != 0);
 
-  for (size_t x = 0; x < chan->capacity; x++) {
-    free(chan->buffer[x].data);
-  }
-  free(chan->buffer);
+  chan_slots_free(chan->buffer, chan->capacity, chan->stride, chan->memory);
   free(chan);
 }
 
 typedef struct SenderMpsc_t {
-  Slot *buffer;
+  uint8_t *buffer;
+  size_t stride; // bytes between two slots
   size_t inner_c_cap;
   size_t elem_size;
+  ChanWaitStrategy wait;
+  ChanParker *producers; // parked senders, woken on recv
 
   _Atomic size_t *head;
   _Atomic size_t *tail;
   _Atomic size_t *chan_prod_count;
   _Atomic ChanState *chan_state;
   _Atomic ChanState sender_state;
+
+  Slot *reserved; // slot claimed by mpsc_send_reserve, NULL if none
+  size_t reserved_ticket;
 } SenderMpsc;
 
 typedef struct ReceiverMpsc_t {
-  Slot *buffer;
+  uint8_t *buffer;
+  size_t stride; // bytes between two slots
   size_t inner_c_cap;
   size_t elem_size;
+  ChanWaitStrategy wait;
+  ChanParker *producers; // parked senders, woken on recv
 
   _Atomic size_t *head;
   _Atomic size_t *tail;
+  _Atomic ChanState *chan_state;
 } ReceiverMpsc;
 
 SenderMpsc *mpsc_get_sender(ChannelMpsc *chan) {
@@ -341,12 +494,16 @@ SenderMpsc *mpsc_get_sender(ChannelMpsc *chan) {
   SenderMpsc *sender = malloc(sizeof(SenderMpsc));
 
   sender->buffer = chan->buffer;
+  sender->stride = chan->stride;
   sender->inner_c_cap = chan->capacity;
   sender->head = &chan->producer.head;
   sender->tail = &chan->consumer.tail;
   sender->elem_size = chan->elem_size;
+  sender->wait = chan->wait;
+  sender->producers = &chan->consumer.parker;
   sender->chan_state = &chan->state;
   sender->sender_state = OPEN;
+  sender->reserved = NULL;
 
   atomic_fetch_add_explicit(&chan->prod_cont, 1, memory_order_release);
   sender->chan_prod_count = &chan->prod_cont;
@@ -361,10 +518,14 @@ ReceiverMpsc *mpsc_get_receiver(ChannelMpsc *chan) {
   ReceiverMpsc *receiver = malloc(sizeof(ReceiverMpsc));
 
   receiver->buffer = chan->buffer;
+  receiver->stride = chan->stride;
   receiver->inner_c_cap = chan->capacity;
   receiver->tail = &chan->consumer.tail;
   receiver->head = &chan->producer.head;
   receiver->elem_size = chan->elem_size;
+  receiver->wait = chan->wait;
+  receiver->producers = &chan->consumer.parker;
+  receiver->chan_state = &chan->state;
 
   return receiver;
 }
@@ -374,6 +535,31 @@ void mpsc_close_sender(SenderMpsc *sender) {
   atomic_store_explicit(&sender->sender_state, CLOSED, memory_order_release);
 }
 
+/* claims the next ticket and waits for its slot, NULL once the channel
+   closed */
+static inline Slot *_mpsc_claim_slot(SenderMpsc *sender, size_t *ticket) {
+  // seq_cst: pairs with the sleeper count of parked receivers
+  size_t head =
+      atomic_fetch_add_explicit(sender->head, 1, memory_order_seq_cst);
+  Slot *slot = chan_slot(sender->buffer, sender->stride,
+                         head % sender->inner_c_cap);
+
+  uint32_t round = 0;
+  while (atomic_load_explicit(&slot->seq, memory_order_acquire) != head) {
+    if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
+        CLOSED) {
+      return NULL;
+    }
+    if (chan_wait_step(sender->wait, &round)) {
+      // full: wait for the consumer of ticket (head - cap) to claim it
+      chan_park_until(sender->producers, sender->tail, sender->inner_c_cap,
+                      head);
+    }
+  }
+  *ticket = head;
+  return slot;
+}
+
 int mpsc_send(SenderMpsc *sender, const void *element) {
   if (!sender) {
     return CHANNEL_ERR_NULL;
@@ -385,16 +571,10 @@ int mpsc_send(SenderMpsc *sender, const void *element) {
     return CHANNEL_ERR_CLOSED;
   }
 
-  size_t head =
-      atomic_fetch_add_explicit(sender->head, 1, memory_order_acq_rel);
-  Slot *slot = &sender->buffer[head % sender->inner_c_cap];
-
-  while (atomic_load_explicit(&slot->seq, memory_order_acquire) != head) {
-    if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
-        CLOSED) {
-      return CHANNEL_ERR_CLOSED;
-    }
-    cpu_relax();
+  size_t head;
+  Slot *slot = _mpsc_claim_slot(sender, &head);
+  if (!slot) {
+    return CHANNEL_ERR_CLOSED;
   }
 
   memcpy(slot->data, element, sender->elem_size);
@@ -414,7 +594,8 @@ int mpsc_recv(ReceiverMpsc *receiver, void *out) {
   if (tail == head) {
     return CHANNEL_ERR_EMPTY;
   }
-  Slot *slot = &receiver->buffer[tail % receiver->inner_c_cap];
+  Slot *slot = chan_slot(receiver->buffer, receiver->stride,
+                         tail % receiver->inner_c_cap);
   if (atomic_load_explicit(&slot->seq, memory_order_acquire) != tail + 1) {
     return CHANNEL_ERR_EMPTY;
   }
@@ -424,7 +605,218 @@ int mpsc_recv(ReceiverMpsc *receiver, void *out) {
   // set slot for next future cycle
   atomic_store_explicit(&slot->seq, tail + receiver->inner_c_cap,
                         memory_order_release);
-  atomic_fetch_add_explicit(receiver->tail, 1, memory_order_relaxed);
+  // seq_cst: pairs with the sleeper count of parked senders
+  atomic_fetch_add_explicit(receiver->tail, 1, memory_order_seq_cst);
+
+  if (receiver->wait == CHANNEL_WAIT_PARK) {
+    chan_unpark(receiver->producers, 1);
+  }
+  return CHANNEL_OK;
+}
+
+int mpsc_try_send(SenderMpsc *sender, const void *element) {
+  if (!sender) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+
+  size_t head = atomic_load_explicit(sender->head, memory_order_relaxed);
+  Slot *slot;
+  while (1) {
+    slot = chan_slot(sender->buffer, sender->stride,
+                     head % sender->inner_c_cap);
+    size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    intptr_t dif = (intptr_t)seq - (intptr_t)head;
+
+    if (dif == 0) {
+      if (atomic_compare_exchange_weak_explicit(sender->head, &head, head + 1,
+                                                memory_order_seq_cst,
+                                                memory_order_relaxed)) {
+        break;
+      }
+    } else if (dif < 0) {
+      // previous cycle not consumed yet -> full
+      return CHANNEL_ERR_FULL;
+    } else {
+      // another producer took it, reload
+      head = atomic_load_explicit(sender->head, memory_order_relaxed);
+    }
+  }
+
+  memcpy(slot->data, element, sender->elem_size);
+
+  // set slot for consumer
+  atomic_store_explicit(&slot->seq, head + 1, memory_order_release);
+  return CHANNEL_OK;
+};
+
+int mpsc_try_recv(ReceiverMpsc *receiver, void *out) {
+  int rc = mpsc_recv(receiver, out);
+  if (rc == CHANNEL_ERR_EMPTY &&
+      atomic_load_explicit(receiver->chan_state, memory_order_acquire) ==
+          CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+  return rc;
+}
+
+int mpsc_send_batch(SenderMpsc *sender, const void *elems, size_t n) {
+  if (!sender || !elems) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+  if (n == 0) {
+    return 0;
+  }
+  if (n > INT_MAX) {
+    n = INT_MAX;
+  }
+
+  size_t head =
+      atomic_fetch_add_explicit(sender->head, n, memory_order_seq_cst);
+  const uint8_t *src = elems;
+
+  size_t sent = 0;
+  ChanState state = OPEN;
+  while (sent < n && state == OPEN) {
+    size_t ticket = head + sent;
+    Slot *slot = chan_slot(sender->buffer, sender->stride,
+                           ticket % sender->inner_c_cap);
+
+    uint32_t round = 0;
+    while (atomic_load_explicit(&slot->seq, memory_order_acquire) != ticket) {
+      state = atomic_load_explicit(sender->chan_state, memory_order_acquire);
+      if (state == CLOSED) {
+        break;
+      }
+      if (chan_wait_step(sender->wait, &round)) {
+        chan_park_until(sender->producers, sender->tail, sender->inner_c_cap,
+                        ticket);
+      }
+    }
+    if (state == CLOSED) {
+      break;
+    }
+
+    memcpy(slot->data, src + sent * sender->elem_size, sender->elem_size);
+    atomic_store_explicit(&slot->seq, ticket + 1, memory_order_release);
+    sent++;
+  }
+
+  return sent ? (int)sent : CHANNEL_ERR_CLOSED;
+};
+
+int mpsc_recv_batch(ReceiverMpsc *receiver, void *out, size_t max) {
+  if (!receiver || !out) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (max > INT_MAX) {
+    max = INT_MAX;
+  }
+  size_t tail = atomic_load_explicit(receiver->tail, memory_order_relaxed);
+  uint8_t *dst = out;
+
+  size_t got = 0;
+  while (got < max) {
+    Slot *slot = chan_slot(receiver->buffer, receiver->stride,
+                           (tail + got) % receiver->inner_c_cap);
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) !=
+        tail + got + 1) {
+      break;
+    }
+    memcpy(dst + got * receiver->elem_size, slot->data, receiver->elem_size);
+
+    // set slot for next future cycle
+    atomic_store_explicit(&slot->seq, tail + got + receiver->inner_c_cap,
+                          memory_order_release);
+    got++;
+  }
+  if (got == 0) {
+    return max ? CHANNEL_ERR_EMPTY : 0;
+  }
+
+  // seq_cst: pairs with the sleeper count of parked senders
+  atomic_fetch_add_explicit(receiver->tail, got, memory_order_seq_cst);
+
+  if (receiver->wait == CHANNEL_WAIT_PARK) {
+    chan_unpark(receiver->producers, 1);
+  }
+  return (int)got;
+}
+
+int mpsc_send_reserve(SenderMpsc *sender, void **elem) {
+  if (!sender || !elem) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+
+  Slot *slot = _mpsc_claim_slot(sender, &sender->reserved_ticket);
+  if (!slot) {
+    return CHANNEL_ERR_CLOSED;
+  }
+  sender->reserved = slot;
+  *elem = slot->data;
+  return CHANNEL_OK;
+}
+
+int mpsc_send_commit(SenderMpsc *sender) {
+  if (!sender || !sender->reserved) {
+    return CHANNEL_ERR_NULL;
+  }
+  // set slot for consumer
+  atomic_store_explicit(&sender->reserved->seq, sender->reserved_ticket + 1,
+                        memory_order_release);
+  sender->reserved = NULL;
+  return CHANNEL_OK;
+}
+
+int mpsc_recv_peek(ReceiverMpsc *receiver, const void **elem) {
+  if (!receiver || !elem) {
+    return CHANNEL_ERR_NULL;
+  }
+  size_t tail = atomic_load_explicit(receiver->tail, memory_order_relaxed);
+  Slot *slot = chan_slot(receiver->buffer, receiver->stride,
+                         tail % receiver->inner_c_cap);
+  if (atomic_load_explicit(&slot->seq, memory_order_acquire) != tail + 1) {
+    if (atomic_load_explicit(receiver->chan_state, memory_order_acquire) ==
+        CLOSED) {
+      return CHANNEL_ERR_CLOSED;
+    }
+    return CHANNEL_ERR_EMPTY;
+  }
+  *elem = slot->data;
+  return CHANNEL_OK;
+}
+
+int mpsc_recv_release(ReceiverMpsc *receiver) {
+  if (!receiver) {
+    return CHANNEL_ERR_NULL;
+  }
+  size_t tail = atomic_load_explicit(receiver->tail, memory_order_relaxed);
+  Slot *slot = chan_slot(receiver->buffer, receiver->stride,
+                         tail % receiver->inner_c_cap);
+  if (atomic_load_explicit(&slot->seq, memory_order_relaxed) != tail + 1) {
+    return CHANNEL_ERR_EMPTY;
+  }
+
+  // set slot for next future cycle
+  atomic_store_explicit(&slot->seq, tail + receiver->inner_c_cap,
+                        memory_order_release);
+  // seq_cst: pairs with the sleeper count of parked senders
+  atomic_fetch_add_explicit(receiver->tail, 1, memory_order_seq_cst);
+
+  if (receiver->wait == CHANNEL_WAIT_PARK) {
+    chan_unpark(receiver->producers, 1);
+  }
   return CHANNEL_OK;
 }
 #endif
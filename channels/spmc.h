@@ -26,7 +26,7 @@ This channel supports:
 - exactly one producer
 - multiple concurrent consumers
 - fixed-capacity ring buffer
-- busy-wait synchronization (no blocking, no syscalls)
+- busy-wait synchronization by default, optional yield/futex parking
 
 The implementation is lock-free and cache-line aware.
 
@@ -55,8 +55,10 @@ Receivers and senders must be freed by the user.
 ------------------------------------------------------------------------------
 WARNING
 
-This channel uses busy-waiting.
+By default this channel uses busy-waiting.
 It is intended for short-lived waits (job systems, engine internals).
+Use channel_create_spmc_opts with CHANNEL_WAIT_YIELD or CHANNEL_WAIT_PARK
+(see channels.h) when waits can be long.
 
 ------------------------------------------------------------------------------
 */
@@ -99,10 +101,23 @@ typedef enum ChanState_t ChanState;
   Notes:
     - Only one producer is supported.
     - Multiple receivers can be attached.
-    - Allocates internal memory for slots and element buffers.
+    - Allocates every slot, element storage included, in one block.
 -----------------------------------------------------------------------------*/
 ChannelSpmc *channel_create_spmc(const size_t capacity, const size_t elem_size);
 
+/*-----------------------------------------------------------------------------
+  channel_create_spmc_opts
+  Same as channel_create_spmc, with explicit options.
+
+  opts : creation options, NULL for the defaults
+
+  Notes:
+    - opts->wait selects how blocked operations wait (see channels.h).
+-----------------------------------------------------------------------------*/
+ChannelSpmc *channel_create_spmc_opts(const size_t capacity,
+                                      const size_t elem_size,
+                                      const ChannelOptions *opts);
+
 /*-----------------------------------------------------------------------------
   spmc_close
   Marks the channel as closed.
@@ -139,7 +154,6 @@ ChanState spmc_is_closed(const ChannelSpmc *chan);
 
   Notes:
     - Blocks until all active receivers call spmc_close_receiver.
-    - Also frees element buffers.
     - After this call, the channel pointer becomes invalid.
 -----------------------------------------------------------------------------*/
 void spmc_destroy(ChannelSpmc *chan);
@@ -202,7 +216,7 @@ void spmc_close_receiver(ReceiverSpmc *sender);
     - CHANNEL_ERR_CLOSED  if channel is closed
 
   Notes:
-    - Busy-waits if the ring buffer slot is not available.
+    - Waits (channel strategy) if the ring buffer slot is not available.
     - Lock-free and wait-free for the producer.
     - Copies elem_size bytes from element to the internal buffer.
 -----------------------------------------------------------------------------*/
@@ -221,16 +235,63 @@ int spmc_send(SenderSpmc *sender, const void *element);
     - CHANNEL_ERR_CLOSED  if receiver or channel is closed
 
   Notes:
-    - Busy-waits if no new element is available.
+    - Waits (channel strategy) if no new element is available.
+    - Elements sent before the close are still delivered: receivers looping
+      until CHANNEL_ERR_CLOSED drain the channel.
     - Lock-free for multiple consumers.
     - Copies elem_size bytes into the memory pointed to by out.
     - Each receiver independently consumes elements.
 -----------------------------------------------------------------------------*/
 int spmc_recv(ReceiverSpmc *receiver, void *out);
 
+/*-----------------------------------------------------------------------------
+  spmc_send_batch
+  Sends n contiguous elements with a single claim on head.
+
+  sender : pointer to a valid SenderSpmc
+  elems  : pointer to n elements of elem_size bytes
+  n      : number of elements
+
+  Returns:
+    - number of elements sent (n unless the channel closed mid-batch)
+    - CHANNEL_ERR_NULL    if sender or elems is NULL
+    - CHANNEL_ERR_CLOSED  if channel is closed and nothing was sent
+
+  Notes:
+    - One fetch_add reserves n consecutive slots; each slot is then filled
+      and published in order, waiting (channel strategy) only when full.
+    - Parked receivers are woken for the published elements before the
+      sender waits for room, and once more at the end: one receiver for a
+      single element, all of them for more.
+    - n is clamped to INT_MAX.
+-----------------------------------------------------------------------------*/
+int spmc_send_batch(SenderSpmc *sender, const void *elems, size_t n);
+
+/*-----------------------------------------------------------------------------
+  spmc_recv_batch
+  Receives up to max elements with a single claim on tail.
+
+  receiver : pointer to a valid ReceiverSpmc
+  out      : pointer to room for max elements
+  max      : maximum number of elements to receive
+
+  Returns:
+    - number of elements received (>= 1)
+    - CHANNEL_ERR_NULL    if receiver or out is NULL
+    - CHANNEL_ERR_CLOSED  if channel or receiver is closed
+
+  Notes:
+    - Claims every already published slot from tail (up to max) with one CAS.
+    - If none is ready, waits like spmc_recv for one element and then takes
+      whatever else became ready.
+    - Elements are written to out in channel order.
+-----------------------------------------------------------------------------*/
+int spmc_recv_batch(ReceiverSpmc *receiver, void *out, size_t max);
+
 #endif
 
 #if (defined(SPMC_IMPLEMENTATION))
+#include <limits.h>
 #include <stdalign.h>
 #include <stdatomic.h>
 #include <stddef.h>
@@ -239,9 +300,12 @@ int spmc_recv(ReceiverSpmc *receiver, void *out);
 #include <string.h>
 
 typedef struct ChannelSpmc_t {
-  Slot *buffer;
+  uint8_t *buffer;
+  size_t stride; // bytes between two slots
+  const MemBackend *memory; // ring buffer allocator, NULL = aligned_alloc
   size_t capacity;  // number of elements
   size_t elem_size; // sizeof(T)
+  ChanWaitStrategy wait;
   ProducerCursor producer;
   ConsumerCursor consumer;
 
@@ -252,23 +316,34 @@ typedef struct ChannelSpmc_t {
 
 ChannelSpmc *channel_create_spmc(const size_t capacity,
                                  const size_t elem_size) {
+  return channel_create_spmc_opts(capacity, elem_size, NULL);
+}
+
+ChannelSpmc *channel_create_spmc_opts(const size_t capacity,
+                                      const size_t elem_size,
+                                      const ChannelOptions *opts) {
   ChannelSpmc *chan = malloc(sizeof(ChannelSpmc));
 
   if (!chan) {
     return NULL;
   }
 
-  chan->buffer = malloc(capacity * sizeof(Slot));
-
-  for (size_t i = 0; i < capacity; i++) {
-    chan->buffer[i].seq = i;
-    chan->buffer[i].data = malloc(elem_size);
+  chan->stride = chan_slot_stride(
+      elem_size, opts ? opts->layout : CHANNEL_SLOT_PADDED);
+  chan->memory = opts ? opts->memory : NULL;
+  chan->buffer = chan_slots_alloc(capacity, chan->stride, chan->memory);
+  if (!chan->buffer) {
+    free(chan);
+    return NULL;
   }
 
   chan->capacity = capacity;
   chan->elem_size = elem_size;
+  chan->wait = opts ? opts->wait : CHANNEL_WAIT_SPIN;
   chan->producer.head = 0;
   chan->consumer.tail = 0;
+  chan_parker_init(&chan->producer.parker);
+  chan_parker_init(&chan->consumer.parker);
   chan->cons_cont = 0;
   chan->state = OPEN;
 
@@ -276,7 +351,9 @@ ChannelSpmc *channel_create_spmc(const size_t capacity,
 };
 
 void spmc_close(ChannelSpmc *chan) {
-  atomic_store_explicit(&chan->state, CLOSED, memory_order_release);
+  atomic_store_explicit(&chan->state, CLOSED, memory_order_seq_cst);
+  chan_parker_close(&chan->producer.parker);
+  chan_parker_close(&chan->consumer.parker);
 };
 
 ChanState spmc_is_closed(const ChannelSpmc *chan) {
@@ -295,30 +372,38 @@ void spmc_destroy(ChannelSpmc *chan) {
     cons_cont = atomic_load_explicit(&chan->cons_cont, memory_order_acquire);
   } while (cons_cont != 0);
 
-  for (size_t x = 0; x < chan->capacity; x++) {
-    free(chan->buffer[x].data);
-  }
-  free(chan->buffer);
+  chan_slots_free(chan->buffer, chan->capacity, chan->stride, chan->memory);
   free(chan);
 };
 
 typedef struct SenderSpmc_t {
-  Slot *buffer;
+  uint8_t *buffer;
+  size_t stride; // bytes between two slots
   size_t inner_c_cap;
   size_t elem_size;
+  ChanWaitStrategy wait;
 
   _Atomic ChanState *chan_state;
   _Atomic size_t *head;
+  _Atomic size_t *tail;
+
+  ChanParker *consumers; // parked receivers, woken on send
+  ChanParker *producers; // parked sender, woken on recv
 } SenderSpmc;
 
 typedef struct ReceiverSpmc_t {
-  Slot *buffer;
+  uint8_t *buffer;
+  size_t stride; // bytes between two slots
   size_t inner_c_cap;
   size_t elem_size;
+  ChanWaitStrategy wait;
 
   _Atomic size_t *head;
   _Atomic size_t *tail;
 
+  ChanParker *consumers; // parked receivers, woken on send
+  ChanParker *producers; // parked sender, woken on recv
+
   _Atomic ChanState receiver_state;
   _Atomic ChanState *chan_state;
   _Atomic size_t *chan_cons_count;
@@ -331,9 +416,14 @@ SenderSpmc *spmc_get_sender(ChannelSpmc *chan) {
   SenderSpmc *sender = malloc(sizeof(SenderSpmc));
 
   sender->buffer = chan->buffer;
+  sender->stride = chan->stride;
   sender->inner_c_cap = chan->capacity;
   sender->head = &chan->producer.head;
+  sender->tail = &chan->consumer.tail;
   sender->elem_size = chan->elem_size;
+  sender->wait = chan->wait;
+  sender->consumers = &chan->producer.parker;
+  sender->producers = &chan->consumer.parker;
   sender->chan_state = &chan->state;
 
   return sender;
@@ -346,10 +436,14 @@ ReceiverSpmc *spmc_get_receiver(ChannelSpmc *chan) {
   ReceiverSpmc *receiver = malloc(sizeof(ReceiverSpmc));
 
   receiver->buffer = chan->buffer;
+  receiver->stride = chan->stride;
   receiver->inner_c_cap = chan->capacity;
   receiver->tail = &chan->consumer.tail;
   receiver->head = &chan->producer.head;
   receiver->elem_size = chan->elem_size;
+  receiver->wait = chan->wait;
+  receiver->consumers = &chan->producer.parker;
+  receiver->producers = &chan->consumer.parker;
   receiver->receiver_state = OPEN;
   receiver->chan_state = &chan->state;
 
@@ -375,16 +469,23 @@ int spmc_send(SenderSpmc *sender, const void *element) {
     return CHANNEL_ERR_CLOSED;
   }
 
+  // seq_cst: pairs with the sleeper count of parked receivers
   size_t head =
-      atomic_fetch_add_explicit(sender->head, 1, memory_order_acq_rel);
-  Slot *slot = &sender->buffer[head % sender->inner_c_cap];
+      atomic_fetch_add_explicit(sender->head, 1, memory_order_seq_cst);
+  Slot *slot = chan_slot(sender->buffer, sender->stride,
+                         head % sender->inner_c_cap);
 
+  uint32_t round = 0;
   while (atomic_load_explicit(&slot->seq, memory_order_acquire) != head) {
     if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
         CLOSED) {
       return CHANNEL_ERR_CLOSED;
     }
-    cpu_relax();
+    if (chan_wait_step(sender->wait, &round)) {
+      // full: wait for the consumer of ticket (head - cap) to claim it
+      chan_park_until(sender->producers, sender->tail, sender->inner_c_cap,
+                      head);
+    }
   }
 
   memcpy(slot->data, element, sender->elem_size);
@@ -392,6 +493,10 @@ int spmc_send(SenderSpmc *sender, const void *element) {
   // set slot for consumer
   atomic_store_explicit(&slot->seq, head + 1, memory_order_release);
 
+  if (sender->wait == CHANNEL_WAIT_PARK) {
+    chan_unpark(sender->consumers, 1);
+  }
+
   return CHANNEL_OK;
 };
 
@@ -403,23 +508,175 @@ int spmc_recv(ReceiverSpmc *receiver, void *out) {
       CLOSED) {
     return CHANNEL_ERR_CLOSED;
   }
+  // seq_cst: pairs with the sleeper count of the parked sender
   size_t tail =
-      atomic_fetch_add_explicit(receiver->tail, 1, memory_order_acq_rel);
+      atomic_fetch_add_explicit(receiver->tail, 1, memory_order_seq_cst);
 
-  Slot *slot = &receiver->buffer[tail % receiver->inner_c_cap];
+  Slot *slot = chan_slot(receiver->buffer, receiver->stride,
+                         tail % receiver->inner_c_cap);
 
+  uint32_t round = 0;
   while (atomic_load_explicit(&slot->seq, memory_order_acquire) != tail + 1) {
     if (atomic_load_explicit(receiver->chan_state, memory_order_acquire) ==
         CLOSED) {
+      // the slot may have been published just before the close: still
+      // deliver it, so a closed channel drains completely
+      if (atomic_load_explicit(&slot->seq, memory_order_acquire) == tail + 1) {
+        break;
+      }
       return CHANNEL_ERR_CLOSED;
     }
-    cpu_relax();
+    if (chan_wait_step(receiver->wait, &round)) {
+      // empty: wait for the producer to claim ticket tail
+      chan_park_until(receiver->consumers, receiver->head, 0, tail);
+    }
   }
   memcpy(out, slot->data, receiver->elem_size);
 
   // set slot for next future cycle
   atomic_store_explicit(&slot->seq, tail + receiver->inner_c_cap,
                         memory_order_release);
+
+  if (receiver->wait == CHANNEL_WAIT_PARK) {
+    chan_unpark(receiver->producers, 1);
+  }
   return CHANNEL_OK;
 };
+
+int spmc_send_batch(SenderSpmc *sender, const void *elems, size_t n) {
+  if (!sender || !elems) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+  if (n == 0) {
+    return 0;
+  }
+  if (n > INT_MAX) {
+    n = INT_MAX;
+  }
+
+  // seq_cst: pairs with the sleeper count of parked receivers
+  size_t head =
+      atomic_fetch_add_explicit(sender->head, n, memory_order_seq_cst);
+  const uint8_t *src = elems;
+
+  size_t sent = 0;
+  size_t woken = 0; // published elements receivers were told about
+  ChanState state = OPEN;
+  while (sent < n && state == OPEN) {
+    size_t ticket = head + sent;
+    Slot *slot = chan_slot(sender->buffer, sender->stride,
+                           ticket % sender->inner_c_cap);
+
+    uint32_t round = 0;
+    while (atomic_load_explicit(&slot->seq, memory_order_acquire) != ticket) {
+      state = atomic_load_explicit(sender->chan_state, memory_order_acquire);
+      if (state == CLOSED) {
+        break;
+      }
+      if (chan_wait_step(sender->wait, &round)) {
+        // the room comes from receivers: they must hear of what is out
+        // already, or a parked one never frees it
+        if (sent > woken) {
+          chan_unpark(sender->consumers, sent - woken > 1);
+          woken = sent;
+        }
+        chan_park_until(sender->producers, sender->tail, sender->inner_c_cap,
+                        ticket);
+      }
+    }
+    if (state == CLOSED) {
+      break;
+    }
+
+    memcpy(slot->data, src + sent * sender->elem_size, sender->elem_size);
+    atomic_store_explicit(&slot->seq, ticket + 1, memory_order_release);
+    sent++;
+  }
+
+  if (sender->wait == CHANNEL_WAIT_PARK && sent > woken) {
+    chan_unpark(sender->consumers, sent - woken > 1);
+  }
+  return sent ? (int)sent : CHANNEL_ERR_CLOSED;
+};
+
+/* claims the run of published slots starting at tail, 0 if none is ready */
+static size_t _spmc_claim_ready(ReceiverSpmc *receiver, size_t max,
+                                size_t *first) {
+  size_t tail = atomic_load_explicit(receiver->tail, memory_order_relaxed);
+  while (1) {
+    size_t ready = 0;
+    while (ready < max) {
+      Slot *slot = chan_slot(receiver->buffer, receiver->stride,
+                             (tail + ready) % receiver->inner_c_cap);
+      if (atomic_load_explicit(&slot->seq, memory_order_acquire) !=
+          tail + ready + 1) {
+        break;
+      }
+      ready++;
+    }
+    if (ready == 0) {
+      return 0;
+    }
+    if (atomic_compare_exchange_weak_explicit(receiver->tail, &tail,
+                                              tail + ready,
+                                              memory_order_seq_cst,
+                                              memory_order_relaxed)) {
+      *first = tail;
+      return ready;
+    }
+  }
+}
+
+int spmc_recv_batch(ReceiverSpmc *receiver, void *out, size_t max) {
+  if (!receiver || !out) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(&receiver->receiver_state, memory_order_acquire) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+  if (max == 0) {
+    return 0;
+  }
+  if (max > INT_MAX) {
+    max = INT_MAX;
+  }
+
+  uint8_t *dst = out;
+  size_t got = 0;
+  size_t first;
+  size_t ready = _spmc_claim_ready(receiver, max, &first);
+
+  if (ready == 0) {
+    // nothing published yet: block for one, then take what followed it
+    int rc = spmc_recv(receiver, dst);
+    if (rc != CHANNEL_OK) {
+      return rc;
+    }
+    got = 1;
+    if (max == 1) {
+      return 1;
+    }
+    ready = _spmc_claim_ready(receiver, max - 1, &first);
+  }
+
+  for (size_t x = 0; x < ready; x++) {
+    size_t ticket = first + x;
+    Slot *slot = chan_slot(receiver->buffer, receiver->stride,
+                           ticket % receiver->inner_c_cap);
+    memcpy(dst + (got + x) * receiver->elem_size, slot->data,
+           receiver->elem_size);
+    atomic_store_explicit(&slot->seq, ticket + receiver->inner_c_cap,
+                          memory_order_release);
+  }
+
+  if (ready && receiver->wait == CHANNEL_WAIT_PARK) {
+    chan_unpark(receiver->producers, 1);
+  }
+  return (int)(got + ready);
+};
 #endif
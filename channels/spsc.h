@@ -140,9 +140,73 @@ int spsc_try_send(SenderSpsc *sender, const void *element);
  */
 int spsc_recv(ReceiverSpsc *receiver, void *out);
 
+/**
+ * Sends up to n elements with a single update of head.
+ * Copies as many elements as there is free room for (at most two memcpy
+ * calls, split at the ring wrap point) and never waits.
+ * @param sender Pointer to the sender handle
+ * @param elems Pointer to n contiguous elements
+ * @param n Number of elements (clamped to INT_MAX)
+ * @return number of elements sent (>= 1), SPSC_ERR_NULL if sender or elems
+ *         is NULL, SPSC_ERR_FULL if channel is full, SPSC_ERR_CLOSED if the
+ *         channel is closed
+ */
+int spsc_send_batch(SenderSpsc *sender, const void *elems, size_t n);
+
+/**
+ * Receives up to max elements with a single update of tail.
+ * Never waits.
+ * @param receiver Pointer to the receiver handle
+ * @param out Pointer to room for max elements
+ * @param max Maximum number of elements (clamped to INT_MAX)
+ * @return number of elements received (>= 1), SPSC_ERR_NULL if receiver or
+ *         out is NULL, SPSC_ERR_EMPTY if channel is empty
+ */
+int spsc_recv_batch(ReceiverSpsc *receiver, void *out, size_t max);
+
+/**
+ * Sends / receives one element, waiting while the channel is full / empty
+ * through chan_await (channels.h): inside a green thread (green.h) the task
+ * is parked off its worker's run queue until the other side makes progress,
+ * elsewhere the thread parks on a futex.
+ * @return CHANNEL_OK on success, CHANNEL_ERR_NULL if the handle is NULL,
+ *         CHANNEL_ERR_CLOSED once the channel is closed (and, for recv,
+ *         drained)
+ */
+int spsc_send_await(SenderSpsc *sender, const void *element);
+int spsc_recv_await(ReceiverSpsc *receiver, void *out);
+
+/**
+ * Zero-copy send, in two steps. spsc_send_reserve exposes the next free
+ * slot, the caller writes the element there, spsc_send_commit publishes it.
+ * Never waits.
+ * @param sender Pointer to the sender handle
+ * @param elem Set to elem_size writable bytes inside the ring
+ * @return CHANNEL_OK on success, CHANNEL_ERR_NULL if sender or elem is NULL
+ *         (commit: nothing reserved), CHANNEL_ERR_FULL if channel is full,
+ *         CHANNEL_ERR_CLOSED if the channel is closed
+ */
+int spsc_send_reserve(SenderSpsc *sender, void **elem);
+int spsc_send_commit(SenderSpsc *sender);
+
+/**
+ * Zero-copy receive, in two steps. spsc_recv_peek exposes the next element
+ * in place, spsc_recv_release hands its slot back to the sender. The element
+ * stays valid until the release. Never waits.
+ * @param receiver Pointer to the receiver handle
+ * @param elem Set to the next element, inside the ring
+ * @return CHANNEL_OK on success, CHANNEL_ERR_NULL if receiver or elem is
+ *         NULL, CHANNEL_ERR_EMPTY if channel is empty (release: nothing to
+ *         release), CHANNEL_ERR_CLOSED if the channel is closed and drained
+ *         (peek only)
+ */
+int spsc_recv_peek(ReceiverSpsc *receiver, const void **elem);
+int spsc_recv_release(ReceiverSpsc *receiver);
+
 #endif
 
 #if (defined (SPSC_IMPLEMENTATION))
+#include <limits.h>
 #include <stdalign.h>
 #include <stdlib.h>
 #include <string.h>
@@ -177,13 +241,17 @@ ChannelSpsc *channel_create_spsc(const size_t capacity,const size_t elem_size) {
   chan->elem_size = elem_size;
   chan->producer.head = 0;
   chan->consumer.tail = 0;
+  chan_parker_init(&chan->producer.parker);
+  chan_parker_init(&chan->consumer.parker);
   chan->state = OPEN;
 
   return chan;
 };
 
 void spsc_close(ChannelSpsc *chan) {
-  atomic_store_explicit(&chan->state, CLOSED, memory_order_release);
+  atomic_store_explicit(&chan->state, CLOSED, memory_order_seq_cst);
+  chan_parker_close(&chan->producer.parker);
+  chan_parker_close(&chan->consumer.parker);
 }
 
 ChanState spsc_is_closed(const ChannelSpsc *chan) {
@@ -207,6 +275,11 @@ typedef struct SenderSpsc_t {
   _Atomic size_t *head;
   _Atomic size_t *tail;
   _Atomic ChanState *chan_state;
+
+  ChanParker *consumers; // awaiting receiver, woken on send
+  ChanParker *producers; // awaiting sender, woken on recv
+
+  uint8_t *reserved; // slot exposed by spsc_send_reserve, NULL if none
 } SenderSpsc;
 
 typedef struct ReceiverSpsc_t {
@@ -216,6 +289,10 @@ typedef struct ReceiverSpsc_t {
 
   _Atomic size_t *head;
   _Atomic size_t *tail;
+  _Atomic ChanState *chan_state;
+
+  ChanParker *consumers;
+  ChanParker *producers;
 } ReceiverSpsc;
 
 SenderSpsc *spsc_get_sender(ChannelSpsc *chan) {
@@ -230,6 +307,9 @@ SenderSpsc *spsc_get_sender(ChannelSpsc *chan) {
   sender->tail = &chan->consumer.tail;
   sender->elem_size = chan->elem_size;
   sender->chan_state = &chan->state;
+  sender->consumers = &chan->producer.parker;
+  sender->producers = &chan->consumer.parker;
+  sender->reserved = NULL;
 
   return sender;
 }
@@ -245,6 +325,9 @@ ReceiverSpsc *spsc_get_receiver(ChannelSpsc *chan) {
   receiver->tail = &chan->consumer.tail;
   receiver->head = &chan->producer.head;
   receiver->elem_size = chan->elem_size;
+  receiver->chan_state = &chan->state;
+  receiver->consumers = &chan->producer.parker;
+  receiver->producers = &chan->consumer.parker;
 
   return receiver;
 }
@@ -271,7 +354,9 @@ int spsc_try_send(SenderSpsc *sender, const void *element) {
   memcpy(sender->buffer + (index * sender->elem_size), element,
          sender->elem_size);
 
-  atomic_fetch_add_explicit(sender->head, 1, memory_order_release);
+  // seq_cst: pairs with the waiter list of an awaiting receiver
+  atomic_fetch_add_explicit(sender->head, 1, memory_order_seq_cst);
+  chan_unpark(sender->consumers, 1);
 
   return CHANNEL_OK;
 }
@@ -290,7 +375,211 @@ int spsc_recv(ReceiverSpsc *receiver, void *out) {
 
   memcpy(out, receiver->buffer + (index * receiver->elem_size),
          receiver->elem_size);
-  atomic_fetch_add_explicit(receiver->tail, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(receiver->tail, 1, memory_order_seq_cst);
+  chan_unpark(receiver->producers, 1);
+  return CHANNEL_OK;
+}
+
+/* copies n ring elements starting at logical index `from`, split at the wrap */
+static inline void _spsc_copy_out(uint8_t *dst, const uint8_t *ring,
+                                  size_t cap, size_t elem_size, size_t from,
+                                  size_t n) {
+  size_t index = from % cap;
+  size_t first = cap - index < n ? cap - index : n;
+  memcpy(dst, ring + index * elem_size, first * elem_size);
+  memcpy(dst + first * elem_size, ring, (n - first) * elem_size);
+}
+
+static inline void _spsc_copy_in(uint8_t *ring, const uint8_t *src,
+                                 size_t cap, size_t elem_size, size_t from,
+                                 size_t n) {
+  size_t index = from % cap;
+  size_t first = cap - index < n ? cap - index : n;
+  memcpy(ring + index * elem_size, src, first * elem_size);
+  memcpy(ring, src + first * elem_size, (n - first) * elem_size);
+}
+
+int spsc_send_batch(SenderSpsc *sender, const void *elems, size_t n) {
+  if (!sender || !elems) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+  if (n == 0) {
+    return 0;
+  }
+
+  size_t head = atomic_load_explicit(sender->head, memory_order_relaxed);
+  size_t tail = atomic_load_explicit(sender->tail, memory_order_acquire);
+  size_t room = sender->inner_c_cap - (head - tail);
+  if (room == 0) {
+    return CHANNEL_ERR_FULL;
+  }
+  if (n > room) {
+    n = room;
+  }
+  if (n > INT_MAX) {
+    n = INT_MAX;
+  }
+
+  _spsc_copy_in(sender->buffer, elems, sender->inner_c_cap, sender->elem_size,
+                head, n);
+  atomic_fetch_add_explicit(sender->head, n, memory_order_seq_cst);
+  chan_unpark(sender->consumers, 1);
+  return (int)n;
+}
+
+int spsc_recv_batch(ReceiverSpsc *receiver, void *out, size_t max) {
+  if (!receiver || !out) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (max == 0) {
+    return 0;
+  }
+
+  size_t tail = atomic_load_explicit(receiver->tail, memory_order_relaxed);
+  size_t head = atomic_load_explicit(receiver->head, memory_order_acquire);
+  size_t avail = head - tail;
+  if (avail == 0) {
+    return CHANNEL_ERR_EMPTY;
+  }
+  if (max > avail) {
+    max = avail;
+  }
+  if (max > INT_MAX) {
+    max = INT_MAX;
+  }
+
+  _spsc_copy_out(out, receiver->buffer, receiver->inner_c_cap,
+                 receiver->elem_size, tail, max);
+  atomic_fetch_add_explicit(receiver->tail, max, memory_order_seq_cst);
+  chan_unpark(receiver->producers, 1);
+  return (int)max;
+}
+
+typedef struct _SpscAwait_t {
+  void *handle;
+  void *elem;
+  int rc;
+} _SpscAwait;
+
+static int _spsc_send_attempt(void *arg) {
+  _SpscAwait *a = arg;
+  SenderSpsc *sender = a->handle;
+  a->rc = spsc_try_send(sender, a->elem);
+  if (a->rc != CHANNEL_ERR_FULL) {
+    return CHAN_AWAIT_DONE;
+  }
+  // seq_cst re-check, ordered after the waiter registration
+  size_t head = atomic_load_explicit(sender->head, memory_order_relaxed);
+  size_t tail = atomic_load_explicit(sender->tail, memory_order_seq_cst);
+  return head - tail < sender->inner_c_cap ? CHAN_AWAIT_RETRY
+                                           : CHAN_AWAIT_PARK;
+}
+
+static int _spsc_recv_attempt(void *arg) {
+  _SpscAwait *a = arg;
+  ReceiverSpsc *receiver = a->handle;
+  a->rc = spsc_recv(receiver, a->elem);
+  if (a->rc != CHANNEL_ERR_EMPTY) {
+    return CHAN_AWAIT_DONE;
+  }
+  size_t tail = atomic_load_explicit(receiver->tail, memory_order_relaxed);
+  size_t head = atomic_load_explicit(receiver->head, memory_order_seq_cst);
+  if (head != tail) {
+    return CHAN_AWAIT_RETRY;
+  }
+  if (atomic_load_explicit(receiver->chan_state, memory_order_seq_cst) ==
+      CLOSED) {
+    a->rc = CHANNEL_ERR_CLOSED;
+    return CHAN_AWAIT_DONE;
+  }
+  return CHAN_AWAIT_PARK;
+}
+
+int spsc_send_await(SenderSpsc *sender, const void *element) {
+  if (!sender) {
+    return CHANNEL_ERR_NULL;
+  }
+  _SpscAwait a = {sender, (void *)element, CHANNEL_ERR_FULL};
+  chan_await(sender->producers, _spsc_send_attempt, &a);
+  return a.rc;
+}
+
+int spsc_recv_await(ReceiverSpsc *receiver, void *out) {
+  if (!receiver) {
+    return CHANNEL_ERR_NULL;
+  }
+  _SpscAwait a = {receiver, out, CHANNEL_ERR_EMPTY};
+  chan_await(receiver->consumers, _spsc_recv_attempt, &a);
+  return a.rc;
+}
+
+int spsc_send_reserve(SenderSpsc *sender, void **elem) {
+  if (!sender || !elem) {
+    return CHANNEL_ERR_NULL;
+  }
+  if (atomic_load_explicit(sender->chan_state, memory_order_acquire) ==
+      CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+
+  size_t head = atomic_load_explicit(sender->head, memory_order_relaxed);
+  size_t tail = atomic_load_explicit(sender->tail, memory_order_acquire);
+  if (head - tail == sender->inner_c_cap) {
+    return CHANNEL_ERR_FULL;
+  }
+
+  sender->reserved =
+      sender->buffer + (head % sender->inner_c_cap) * sender->elem_size;
+  *elem = sender->reserved;
+  return CHANNEL_OK;
+}
+
+int spsc_send_commit(SenderSpsc *sender) {
+  if (!sender || !sender->reserved) {
+    return CHANNEL_ERR_NULL;
+  }
+  sender->reserved = NULL;
+  // seq_cst: pairs with the waiter list of an awaiting receiver
+  atomic_fetch_add_explicit(sender->head, 1, memory_order_seq_cst);
+  chan_unpark(sender->consumers, 1);
+  return CHANNEL_OK;
+}
+
+int spsc_recv_peek(ReceiverSpsc *receiver, const void **elem) {
+  if (!receiver || !elem) {
+    return CHANNEL_ERR_NULL;
+  }
+  size_t tail = atomic_load_explicit(receiver->tail, memory_order_relaxed);
+  size_t head = atomic_load_explicit(receiver->head, memory_order_acquire);
+  if (tail == head) {
+    if (atomic_load_explicit(receiver->chan_state, memory_order_acquire) ==
+        CLOSED) {
+      return CHANNEL_ERR_CLOSED;
+    }
+    return CHANNEL_ERR_EMPTY;
+  }
+
+  *elem = receiver->buffer + (tail % receiver->inner_c_cap) *
+                                 receiver->elem_size;
+  return CHANNEL_OK;
+}
+
+int spsc_recv_release(ReceiverSpsc *receiver) {
+  if (!receiver) {
+    return CHANNEL_ERR_NULL;
+  }
+  size_t tail = atomic_load_explicit(receiver->tail, memory_order_relaxed);
+  size_t head = atomic_load_explicit(receiver->head, memory_order_acquire);
+  if (tail == head) {
+    return CHANNEL_ERR_EMPTY;
+  }
+
+  atomic_fetch_add_explicit(receiver->tail, 1, memory_order_seq_cst);
+  chan_unpark(receiver->producers, 1);
   return CHANNEL_OK;
 }
 #endif
@@ -0,0 +1,519 @@
+// Copyright 2025 Seaker <seakerone@proton.me>
+
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+/*
+------------------------------------------------------------------------------
+umpsc.h — Unbounded Multi-Producer Single-Consumer lock-free channel
+
+This channel supports:
+- multiple producers
+- exactly one consumer
+- unbounded capacity: a linked list of fixed-size segments
+- producers never wait for room, only for a segment being linked in
+
+Segments hold UMPSC_SEGMENT_CAPACITY elements each and are allocated from a
+RegionArena. When the consumer drains a segment it pushes it on a freelist,
+and the next segment a producer needs is taken from there before the arena
+grows. Memory therefore follows the deepest the queue has ever been, not a
+worst-case capacity chosen up front.
+
+------------------------------------------------------------------------------
+PROPERTIES
+
+- Lock-free for producers (one CAS per send)
+- Wait-free for the consumer
+- Dynamic allocation only when the queue grows past its previous peak
+- Requires arenas/r_arena.h and channels/channels.h
+- Cross-platform (x86, ARM, RISC-V)
+
+------------------------------------------------------------------------------
+LIFETIME
+
+1. channel_create_umpsc()
+2. umpsc_get_sender() (N times)
+3. umpsc_get_receiver() (exactly once)
+4. umpsc_send() / umpsc_recv()
+5. umpsc_close()
+6. umpsc_close_sender() for each sender
+7. umpsc_destroy()
+
+Senders and receiver must be freed by the user.
+
+------------------------------------------------------------------------------
+HOW IT WORKS
+
+Producers claim positions with a CAS on a single index. Each segment spans
+UMPSC_SEGMENT_CAPACITY + 1 positions: the last one is never handed out and
+marks "next segment is being linked". The producer that claims the final slot
+of a segment takes a segment from the freelist (or the arena), links it, and
+moves the index past the marker; other producers spin only for that window.
+
+Because only that one producer ever pops the freelist and only the consumer
+pushes to it, the freelist cannot suffer from ABA.
+
+Slots reuse the per-slot sequence of the bounded channels: a slot is ready
+when its sequence equals its global position + 1, so recycled segments never
+need clearing.
+
+------------------------------------------------------------------------------
+USAGE
+
+Include the dependencies first, then in exactly ONE source file:
+
+    #define UMPSC_IMPLEMENTATION
+    #include "umpsc.h"
+
+    ChannelUmpsc *chan = channel_create_umpsc(sizeof(int));
+    SenderUmpsc *tx = umpsc_get_sender(chan);
+    ReceiverUmpsc *rx = umpsc_get_receiver(chan);
+
+    int v = 42;
+    umpsc_send(tx, &v);
+
+    int out;
+    if (umpsc_recv(rx, &out) == CHANNEL_OK) { ... }
+
+------------------------------------------------------------------------------
+*/
+#ifndef UMPSC_CHANNEL_H
+#define UMPSC_CHANNEL_H
+
+#include <stddef.h>
+
+#ifndef UMPSC_SEGMENT_CAPACITY
+#define UMPSC_SEGMENT_CAPACITY 256 // elements per segment
+#endif
+
+#ifndef UMPSC_SEGMENTS_PER_REGION
+#define UMPSC_SEGMENTS_PER_REGION 16 // segments per RegionArena region
+#endif
+
+#ifndef UMPSC_MAX_REGIONS
+#define UMPSC_MAX_REGIONS 4096 // RegionArena region limit
+#endif
+
+typedef struct ChannelUmpsc_t ChannelUmpsc;
+typedef enum ChanState_t ChanState;
+
+/*-----------------------------------------------------------------------------
+  channel_create_umpsc
+  Allocates and initializes a new unbounded channel.
+
+  elem_size : size in bytes of each element
+
+  Returns a pointer to ChannelUmpsc on success, NULL on allocation failure.
+
+  Notes:
+    - Only the first segment is allocated up front.
+    - The queue can hold at most
+      UMPSC_SEGMENT_CAPACITY * UMPSC_SEGMENTS_PER_REGION * UMPSC_MAX_REGIONS
+      elements at once; the arena aborts past that.
+-----------------------------------------------------------------------------*/
+ChannelUmpsc *channel_create_umpsc(const size_t elem_size);
+
+/*-----------------------------------------------------------------------------
+  umpsc_close
+  Marks the channel as closed.
+
+  chan : pointer to the channel to close
+
+  Notes:
+    - After closing, umpsc_send will return CHANNEL_ERR_CLOSED.
+    - Consumer may continue to drain the channel until empty.
+-----------------------------------------------------------------------------*/
+void umpsc_close(ChannelUmpsc *chan);
+
+/*-----------------------------------------------------------------------------
+  umpsc_is_closed
+  Checks whether the channel has been closed.
+
+  chan : pointer to the channel
+
+  Returns:
+    - OPEN   if the channel is still open
+    - CLOSED if the channel has been closed
+
+  Notes:
+    - Non-blocking, safe to call concurrently.
+-----------------------------------------------------------------------------*/
+ChanState umpsc_is_closed(const ChannelUmpsc *chan);
+
+/*-----------------------------------------------------------------------------
+  umpsc_destroy
+  Frees all memory associated with the channel and waits for all producers
+  to finish.
+
+  chan : pointer to the channel
+
+  Notes:
+    - Blocks until all active producers call umpsc_close_sender.
+    - Frees every segment, including the recycled ones.
+    - After this call, the channel pointer becomes invalid.
+-----------------------------------------------------------------------------*/
+void umpsc_destroy(ChannelUmpsc *chan);
+
+typedef struct SenderUmpsc_t SenderUmpsc;
+typedef struct ReceiverUmpsc_t ReceiverUmpsc;
+
+/*-----------------------------------------------------------------------------
+  umpsc_get_sender
+  Allocates and returns a producer handle for the given channel.
+
+  chan : pointer to a valid ChannelUmpsc
+
+  Returns a pointer to SenderUmpsc on success, NULL on failure.
+
+  Notes:
+    - Multiple senders can be attached.
+    - Each sender must call umpsc_close_sender before freeing.
+-----------------------------------------------------------------------------*/
+SenderUmpsc *umpsc_get_sender(ChannelUmpsc *chan);
+
+/*-----------------------------------------------------------------------------
+  umpsc_get_receiver
+  Allocates and returns a consumer handle for the given channel.
+
+  chan : pointer to a valid ChannelUmpsc
+
+  Returns a pointer to ReceiverUmpsc on success, NULL on failure.
+
+  Notes:
+    - Only one receiver is supported.
+    - The receiver does not need to close explicitly.
+-----------------------------------------------------------------------------*/
+ReceiverUmpsc *umpsc_get_receiver(ChannelUmpsc *chan);
+
+/*-----------------------------------------------------------------------------
+  umpsc_close_sender
+  Marks a sender as closed and decrements the channel's producer count.
+
+  sender : pointer to a valid SenderUmpsc
+
+  Notes:
+    - Must be called once per sender before freeing.
+    - After this call, umpsc_send will return CHANNEL_ERR_CLOSED for this
+      sender.
+-----------------------------------------------------------------------------*/
+void umpsc_close_sender(SenderUmpsc *sender);
+
+/*-----------------------------------------------------------------------------
+  umpsc_send
+  Sends an element into the channel.
+
+  sender : pointer to a valid SenderUmpsc
+  elem   : pointer to the element to send
+
+  Returns:
+    - CHANNEL_OK          on success
+    - CHANNEL_ERR_NULL    if sender or elem is NULL
+    - CHANNEL_ERR_CLOSED  if the sender or channel is closed
+    - CHANNEL_ERR_FULL    if a new segment was needed and none could be
+                          allocated (nothing was sent)
+
+  Notes:
+    - Never fails because the channel is full; a new segment is linked in.
+    - Only spins while another producer is linking the next segment.
+-----------------------------------------------------------------------------*/
+int umpsc_send(SenderUmpsc *sender, const void *elem);
+
+/*-----------------------------------------------------------------------------
+  umpsc_recv
+  Receives an element from the channel.
+
+  receiver : pointer to a valid ReceiverUmpsc
+  out      : pointer to memory to copy the received element
+
+  Returns:
+    - CHANNEL_OK          on success
+    - CHANNEL_ERR_NULL    if receiver or out is NULL
+    - CHANNEL_ERR_EMPTY   if no element is ready
+    - CHANNEL_ERR_CLOSED  if the channel is closed and fully drained
+
+  Notes:
+    - Non-blocking.
+    - A drained segment goes back to the freelist for producers to reuse.
+-----------------------------------------------------------------------------*/
+int umpsc_recv(ReceiverUmpsc *receiver, void *out);
+
+#endif // !UMPSC_CHANNEL_H
+
+#if (defined(UMPSC_IMPLEMENTATION))
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// positions per segment: UMPSC_SEGMENT_CAPACITY slots + 1 link marker
+#define UMPSC_LAP (UMPSC_SEGMENT_CAPACITY + 1)
+
+typedef struct UmpscSegment_t {
+  _Atomic(struct UmpscSegment_t *) next; // next segment in the queue
+  struct UmpscSegment_t *next_free;      // freelist link
+  alignas(8) uint8_t slots[];            // UMPSC_SEGMENT_CAPACITY slots
+} UmpscSegment;
+
+typedef struct ChannelUmpsc_t {
+  RegionArena segments; // backing storage for every segment
+  size_t stride;        // bytes between two slots
+  size_t elem_size;     // sizeof(T)
+
+  ProducerCursor producer; // next position to claim
+  alignas(CACHELINE_SIZE) _Atomic(UmpscSegment *) head_segment; // producers
+
+  ConsumerCursor consumer;    // next position to read
+  UmpscSegment *tail_segment; // consumer only
+
+  alignas(CACHELINE_SIZE) _Atomic(UmpscSegment *) free_list;
+
+  _Atomic size_t prod_cont; // Number of active producers
+  _Atomic ChanState state;  // 0 -> Open | 1 -> Closed
+} ChannelUmpsc;
+
+ChannelUmpsc *channel_create_umpsc(const size_t elem_size) {
+  ChannelUmpsc *chan = aligned_alloc(CACHELINE_SIZE, sizeof(ChannelUmpsc));
+
+  if (!chan) {
+    return NULL;
+  }
+
+  chan->elem_size = elem_size;
+  chan->stride = chan_slot_stride(elem_size, CHANNEL_SLOT_PACKED);
+  chan->segments = r_arena_create(sizeof(UmpscSegment) +
+                                      UMPSC_SEGMENT_CAPACITY * chan->stride,
+                                  UMPSC_SEGMENTS_PER_REGION, UMPSC_MAX_REGIONS);
+
+  // arena memory is zeroed: every seq is 0, which no position expects
+  UmpscSegment *first = r_arena_alloc(&chan->segments);
+  if (!first) {
+    r_arena_free(&chan->segments);
+    free(chan);
+    return NULL;
+  }
+  atomic_init(&first->next, NULL);
+
+  atomic_init(&chan->producer.head, 0);
+  atomic_init(&chan->consumer.tail, 0);
+  chan_parker_init(&chan->producer.parker);
+  chan_parker_init(&chan->consumer.parker);
+  atomic_init(&chan->head_segment, first);
+  chan->tail_segment = first;
+  atomic_init(&chan->free_list, NULL);
+  chan->prod_cont = 0;
+  chan->state = OPEN;
+
+  return chan;
+}
+
+void umpsc_close(ChannelUmpsc *chan) {
+  atomic_store_explicit(&chan->state, CLOSED, memory_order_seq_cst);
+}
+
+ChanState umpsc_is_closed(const ChannelUmpsc *chan) {
+  return atomic_load_explicit(&chan->state, memory_order_acquire);
+}
+
+void umpsc_destroy(ChannelUmpsc *chan) {
+  if (!chan) {
+    return;
+  }
+
+  umpsc_close(chan);
+  while (atomic_load_explicit(&chan->prod_cont, memory_order_acquire) != 0) {
+    cpu_relax();
+  }
+
+  r_arena_free(&chan->segments);
+  free(chan);
+}
+
+typedef struct SenderUmpsc_t {
+  ChannelUmpsc *chan;
+  _Atomic ChanState sender_state;
+} SenderUmpsc;
+
+typedef struct ReceiverUmpsc_t {
+  ChannelUmpsc *chan;
+} ReceiverUmpsc;
+
+SenderUmpsc *umpsc_get_sender(ChannelUmpsc *chan) {
+  if (!chan) {
+    return NULL;
+  }
+  SenderUmpsc *sender = malloc(sizeof(SenderUmpsc));
+  if (!sender) {
+    return NULL;
+  }
+
+  sender->chan = chan;
+  sender->sender_state = OPEN;
+  atomic_fetch_add_explicit(&chan->prod_cont, 1, memory_order_release);
+
+  return sender;
+}
+
+ReceiverUmpsc *umpsc_get_receiver(ChannelUmpsc *chan) {
+  if (!chan) {
+    return NULL;
+  }
+  ReceiverUmpsc *receiver = malloc(sizeof(ReceiverUmpsc));
+  if (!receiver) {
+    return NULL;
+  }
+
+  receiver->chan = chan;
+
+  return receiver;
+}
+
+void umpsc_close_sender(SenderUmpsc *sender) {
+  if (!sender) {
+    return;
+  }
+  ChanState expected = OPEN;
+  if (atomic_compare_exchange_strong_explicit(&sender->sender_state, &expected,
+                                              CLOSED, memory_order_acq_rel,
+                                              memory_order_relaxed)) {
+    atomic_fetch_sub_explicit(&sender->chan->prod_cont, 1,
+                              memory_order_release);
+  }
+}
+
+// Only the producer that claimed the last slot of the current segment calls
+// this, so there is never more than one popper on the freelist.
+// Returns NULL if the freelist is empty and the arena can't grow.
+static UmpscSegment *_umpsc_segment_take(ChannelUmpsc *chan) {
+  UmpscSegment *seg =
+      atomic_load_explicit(&chan->free_list, memory_order_acquire);
+  while (seg && !atomic_compare_exchange_weak_explicit(
+                    &chan->free_list, &seg, seg->next_free,
+                    memory_order_acquire, memory_order_acquire)) {
+  }
+  if (!seg) {
+    seg = r_arena_alloc(&chan->segments);
+    if (!seg) {
+      return NULL;
+    }
+  }
+  atomic_store_explicit(&seg->next, NULL, memory_order_relaxed);
+  return seg;
+}
+
+// Consumer side: the segment is fully drained and no producer can still
+// write to it.
+static void _umpsc_segment_recycle(ChannelUmpsc *chan, UmpscSegment *seg) {
+  UmpscSegment *top =
+      atomic_load_explicit(&chan->free_list, memory_order_relaxed);
+  do {
+    seg->next_free = top;
+  } while (!atomic_compare_exchange_weak_explicit(&chan->free_list, &top, seg,
+                                                  memory_order_release,
+                                                  memory_order_relaxed));
+}
+
+int umpsc_send(SenderUmpsc *sender, const void *elem) {
+  if (!sender || !elem) {
+    return CHANNEL_ERR_NULL;
+  }
+  ChannelUmpsc *chan = sender->chan;
+  if (atomic_load_explicit(&sender->sender_state, memory_order_acquire) ==
+          CLOSED ||
+      atomic_load_explicit(&chan->state, memory_order_acquire) == CLOSED) {
+    return CHANNEL_ERR_CLOSED;
+  }
+
+  size_t pos = atomic_load_explicit(&chan->producer.head, memory_order_acquire);
+  for (;;) {
+    size_t offset = pos % UMPSC_LAP;
+    if (offset == UMPSC_SEGMENT_CAPACITY) {
+      // next segment is being linked in
+      cpu_relax();
+      pos = atomic_load_explicit(&chan->producer.head, memory_order_acquire);
+      continue;
+    }
+
+    UmpscSegment *seg =
+        atomic_load_explicit(&chan->head_segment, memory_order_acquire);
+    if (!atomic_compare_exchange_weak_explicit(&chan->producer.head, &pos,
+                                               pos + 1, memory_order_acq_rel,
+                                               memory_order_acquire)) {
+      continue;
+    }
+
+    if (offset + 1 == UMPSC_SEGMENT_CAPACITY) {
+      // claimed the last slot: link the next segment, then skip the marker
+      UmpscSegment *next = _umpsc_segment_take(chan);
+      if (!next) {
+        // undo the claim: the other producers spin on the marker, so head
+        // is still ours, and the slot is claimed again by the next send
+        atomic_store_explicit(&chan->producer.head, pos, memory_order_release);
+        return CHANNEL_ERR_FULL;
+      }
+      atomic_store_explicit(&seg->next, next, memory_order_release);
+      atomic_store_explicit(&chan->head_segment, next, memory_order_release);
+      atomic_fetch_add_explicit(&chan->producer.head, 1, memory_order_release);
+    }
+
+    Slot *slot = chan_slot(seg->slots, chan->stride, offset);
+    memcpy(slot->data, elem, chan->elem_size);
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return CHANNEL_OK;
+  }
+}
+
+int umpsc_recv(ReceiverUmpsc *receiver, void *out) {
+  if (!receiver || !out) {
+    return CHANNEL_ERR_NULL;
+  }
+  ChannelUmpsc *chan = receiver->chan;
+
+  size_t pos = atomic_load_explicit(&chan->consumer.tail, memory_order_relaxed);
+  size_t offset = pos % UMPSC_LAP;
+  UmpscSegment *seg = chan->tail_segment;
+  Slot *slot = chan_slot(seg->slots, chan->stride, offset);
+
+  if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + 1) {
+    // a claimed but unwritten slot keeps head ahead of pos
+    if (atomic_load_explicit(&chan->state, memory_order_acquire) == CLOSED &&
+        atomic_load_explicit(&chan->producer.head, memory_order_acquire) ==
+            pos) {
+      return CHANNEL_ERR_CLOSED;
+    }
+    return CHANNEL_ERR_EMPTY;
+  }
+
+  memcpy(out, slot->data, chan->elem_size);
+
+  if (offset + 1 == UMPSC_SEGMENT_CAPACITY) {
+    // the writer of this slot linked seg->next before publishing it
+    chan->tail_segment =
+        atomic_load_explicit(&seg->next, memory_order_acquire);
+    _umpsc_segment_recycle(chan, seg);
+    pos += 2;
+  } else {
+    pos += 1;
+  }
+  atomic_store_explicit(&chan->consumer.tail, pos, memory_order_relaxed);
+
+  return CHANNEL_OK;
+}
+
+#endif // UMPSC_IMPLEMENTATION
@@ -0,0 +1,581 @@
+// Copyright 2025 Seaker <seakerone@proton.me>
+
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+/*
+------------------------------------------------------------------------------
+btree.h — Cache-conscious B+tree (uint64_t keys -> uint64_t values)
+
+An ordered map for point lookups and range scans, e.g. time-series indexes.
+
+- Every node is BTREE_NODE_SIZE (512) bytes: 8 cache lines, 31 keys.
+- Keys inside a node are searched with AVX2 (4 keys per compare) when
+  available, with a branchless counting loop otherwise.
+- Values live only in the leaves; leaves are linked left to right, so a range
+  scan walks them sequentially without going back up the tree.
+- Nodes are allocated from a RegionArena: no per-node malloc/free, freeing
+  the tree is a single r_arena_free.
+- btree_bulk_load builds the tree bottom-up from sorted input with full
+  leaves stored back to back in the arena.
+- Inserting past the largest key splits the rightmost nodes at the end, so
+  ascending inserts (timestamps) also produce full nodes.
+
+Removal does not rebalance: leaves may become underfull or empty and are
+skipped by iteration. Nodes are reclaimed with btree_clear / btree_free.
+
+------------------------------------------------------------------------------
+USAGE
+
+Include arenas/r_arena.h first, then in exactly ONE source file:
+
+    #define BTREE_IMPLEMENTATION
+    #include "btree.h"
+
+    BTree t = btree_create(0);
+    btree_insert(&t, ts, offset);
+
+    uint64_t v;
+    if (btree_get(&t, ts, &v) == BTREE_OK) { ... }
+
+    BTreeIter it = btree_range(&t, from, to);
+    uint64_t k;
+    while (btree_iter_next(&it, &k, &v) == BTREE_OK) { ... }
+
+    btree_free(&t);
+
+------------------------------------------------------------------------------
+*/
+#ifndef BTREE_H
+#define BTREE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BTREE_NODE_SIZE 512
+#define BTREE_NODE_KEYS 31 // keys per leaf and per inner node
+
+#ifndef BTREE_NODES_PER_REGION
+#define BTREE_NODES_PER_REGION 256 // 128KB regions
+#endif
+
+#define BTREE_OK 0
+#define BTREE_ERR_NULL -1
+#define BTREE_ERR_NOT_FOUND -2
+#define BTREE_ERR_UNSORTED -3
+#define BTREE_ERR_NOT_EMPTY -4
+
+typedef struct BTree_t {
+  RegionArena nodes; // every node of the tree
+  void *root;
+  void *first_leaf;
+  size_t height; // 1 when the root is a leaf
+  size_t count;  // number of keys
+} BTree;
+
+typedef struct BTreeIter_t {
+  const void *leaf;
+  uint32_t pos;
+  uint64_t hi; // inclusive upper bound
+} BTreeIter;
+
+/*-----------------------------------------------------------------------------
+  btree_create
+  Creates an empty tree.
+
+  max_regions : RegionArena region limit (0 for the arena default)
+
+  Notes:
+    - The tree holds at most max_regions * BTREE_NODES_PER_REGION nodes;
+      the arena aborts past that.
+-----------------------------------------------------------------------------*/
+BTree btree_create(size_t max_regions);
+
+/*-----------------------------------------------------------------------------
+  btree_insert
+  Inserts key -> value, or overwrites the value if key is present.
+
+  Returns:
+    - BTREE_OK        on success
+    - BTREE_ERR_NULL  if tree is NULL
+-----------------------------------------------------------------------------*/
+int btree_insert(BTree *tree, uint64_t key, uint64_t value);
+
+/*-----------------------------------------------------------------------------
+  btree_get
+  Looks up key and writes its value to out.
+
+  Returns:
+    - BTREE_OK            on success
+    - BTREE_ERR_NULL      if tree or out is NULL
+    - BTREE_ERR_NOT_FOUND if key is absent
+-----------------------------------------------------------------------------*/
+int btree_get(const BTree *tree, uint64_t key, uint64_t *out);
+
+/*-----------------------------------------------------------------------------
+  btree_remove
+  Removes key from its leaf.
+
+  Returns:
+    - BTREE_OK            on success
+    - BTREE_ERR_NULL      if tree is NULL
+    - BTREE_ERR_NOT_FOUND if key is absent
+
+  Notes:
+    - No merging or rebalancing; inner separators are left as they are.
+-----------------------------------------------------------------------------*/
+int btree_remove(BTree *tree, uint64_t key);
+
+/*-----------------------------------------------------------------------------
+  btree_bulk_load
+  Builds the tree from n key/value pairs sorted by strictly ascending key.
+
+  Returns:
+    - BTREE_OK            on success
+    - BTREE_ERR_NULL      if tree, keys or values is NULL
+    - BTREE_ERR_NOT_EMPTY if the tree already holds keys
+    - BTREE_ERR_UNSORTED  if keys are not strictly ascending (tree untouched)
+
+  Notes:
+    - Leaves are filled completely and allocated consecutively.
+-----------------------------------------------------------------------------*/
+int btree_bulk_load(BTree *tree, const uint64_t *keys, const uint64_t *values,
+                    size_t n);
+
+/*-----------------------------------------------------------------------------
+  btree_range
+  Returns an iterator over keys in [lo, hi], in ascending order.
+
+  Notes:
+    - The iterator is invalidated by any insert / remove / clear.
+-----------------------------------------------------------------------------*/
+BTreeIter btree_range(const BTree *tree, uint64_t lo, uint64_t hi);
+
+/*-----------------------------------------------------------------------------
+  btree_iter_next
+  Advances the iterator.
+
+  Returns:
+    - BTREE_OK            with key/value written (either may be NULL)
+    - BTREE_ERR_NOT_FOUND when the range is exhausted
+-----------------------------------------------------------------------------*/
+int btree_iter_next(BTreeIter *it, uint64_t *key, uint64_t *value);
+
+/*-----------------------------------------------------------------------------
+  btree_len
+  Returns the number of keys in the tree.
+-----------------------------------------------------------------------------*/
+size_t btree_len(const BTree *tree);
+
+/*-----------------------------------------------------------------------------
+  btree_clear
+  Removes every key. Node memory is kept and reused (r_arena_reset).
+-----------------------------------------------------------------------------*/
+void btree_clear(BTree *tree);
+
+/*-----------------------------------------------------------------------------
+  btree_free
+  Frees every node with a single r_arena_free.
+-----------------------------------------------------------------------------*/
+void btree_free(BTree *tree);
+
+#endif // !BTREE_H
+
+#if (defined(BTREE_IMPLEMENTATION))
+#include <stdatomic.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+typedef struct BTreeLeaf_t {
+  uint32_t count;
+  uint32_t is_leaf;
+  struct BTreeLeaf_t *next;
+  uint64_t keys[BTREE_NODE_KEYS];
+  uint64_t values[BTREE_NODE_KEYS];
+} BTreeLeaf;
+
+typedef struct BTreeInner_t {
+  uint32_t count; // number of keys, children = count + 1
+  uint32_t is_leaf;
+  uint64_t keys[BTREE_NODE_KEYS]; // keys[i] = smallest key under children[i+1]
+  void *children[BTREE_NODE_KEYS + 1];
+} BTreeInner;
+
+_Static_assert(sizeof(BTreeLeaf) == BTREE_NODE_SIZE, "leaf size");
+_Static_assert(sizeof(BTreeInner) == BTREE_NODE_SIZE, "inner size");
+
+#define BTREE_MAX_HEIGHT 24
+
+// Number of keys[0..n) strictly below key. Keys are sorted, so this is also
+// the lower-bound position.
+static inline uint32_t _bt_count_lt(const uint64_t *keys, uint32_t n,
+                                    uint64_t key) {
+  uint32_t i = 0;
+  uint32_t c = 0;
+#if defined(__AVX2__)
+  // unsigned compare through the signed one: flip the sign bits
+  const __m256i bias = _mm256_set1_epi64x((long long)0x8000000000000000ull);
+  const __m256i k = _mm256_xor_si256(_mm256_set1_epi64x((long long)key), bias);
+  for (; i + 4 <= n; i += 4) {
+    __m256i v = _mm256_xor_si256(
+        _mm256_loadu_si256((const __m256i *)(keys + i)), bias);
+    __m256i gt = _mm256_cmpgt_epi64(k, v);
+    c += (uint32_t)__builtin_popcount(
+        (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(gt)));
+  }
+#endif
+  for (; i < n; i++) {
+    c += keys[i] < key;
+  }
+  return c;
+}
+
+// Number of keys[0..n) less than or equal to key: the child to descend into.
+static inline uint32_t _bt_count_le(const uint64_t *keys, uint32_t n,
+                                    uint64_t key) {
+  return key == UINT64_MAX ? n : _bt_count_lt(keys, n, key + 1);
+}
+
+static inline void *_bt_node_alloc(BTree *tree, int leaf) {
+  // arena memory comes back zeroed
+  uint32_t *node = r_arena_alloc(&tree->nodes);
+  node[1] = (uint32_t)leaf;
+  return node;
+}
+
+static inline int _bt_is_leaf(const void *node) {
+  return ((const BTreeLeaf *)node)->is_leaf != 0;
+}
+
+static const BTreeLeaf *_bt_find_leaf(const BTree *tree, uint64_t key) {
+  const void *node = tree->root;
+  while (!_bt_is_leaf(node)) {
+    const BTreeInner *in = node;
+    node = in->children[_bt_count_le(in->keys, in->count, key)];
+  }
+  return node;
+}
+
+BTree btree_create(size_t max_regions) {
+  BTree tree;
+  tree.nodes =
+      r_arena_create(BTREE_NODE_SIZE, BTREE_NODES_PER_REGION, max_regions);
+  tree.root = _bt_node_alloc(&tree, 1);
+  tree.first_leaf = tree.root;
+  tree.height = 1;
+  tree.count = 0;
+  return tree;
+}
+
+int btree_get(const BTree *tree, uint64_t key, uint64_t *out) {
+  if (!tree || !out) {
+    return BTREE_ERR_NULL;
+  }
+  const BTreeLeaf *leaf = _bt_find_leaf(tree, key);
+  uint32_t pos = _bt_count_lt(leaf->keys, leaf->count, key);
+  if (pos < leaf->count && leaf->keys[pos] == key) {
+    *out = leaf->values[pos];
+    return BTREE_OK;
+  }
+  return BTREE_ERR_NOT_FOUND;
+}
+
+// Inserts (key, right) into a non-full inner node at position pos.
+static void _bt_inner_put(BTreeInner *in, uint32_t pos, uint64_t key,
+                          void *right) {
+  memmove(&in->keys[pos + 1], &in->keys[pos],
+          (in->count - pos) * sizeof(uint64_t));
+  memmove(&in->children[pos + 2], &in->children[pos + 1],
+          (in->count - pos) * sizeof(void *));
+  in->keys[pos] = key;
+  in->children[pos + 1] = right;
+  in->count++;
+}
+
+int btree_insert(BTree *tree, uint64_t key, uint64_t value) {
+  if (!tree) {
+    return BTREE_ERR_NULL;
+  }
+
+  // descend, remembering the path for splits
+  BTreeInner *path[BTREE_MAX_HEIGHT];
+  uint32_t slots[BTREE_MAX_HEIGHT];
+  size_t depth = 0;
+  void *node = tree->root;
+  while (!_bt_is_leaf(node)) {
+    BTreeInner *in = node;
+    uint32_t c = _bt_count_le(in->keys, in->count, key);
+    path[depth] = in;
+    slots[depth] = c;
+    depth++;
+    node = in->children[c];
+  }
+
+  BTreeLeaf *leaf = node;
+  uint32_t pos = _bt_count_lt(leaf->keys, leaf->count, key);
+  if (pos < leaf->count && leaf->keys[pos] == key) {
+    leaf->values[pos] = value;
+    return BTREE_OK;
+  }
+  tree->count++;
+
+  if (leaf->count < BTREE_NODE_KEYS) {
+    memmove(&leaf->keys[pos + 1], &leaf->keys[pos],
+            (leaf->count - pos) * sizeof(uint64_t));
+    memmove(&leaf->values[pos + 1], &leaf->values[pos],
+            (leaf->count - pos) * sizeof(uint64_t));
+    leaf->keys[pos] = key;
+    leaf->values[pos] = value;
+    leaf->count++;
+    return BTREE_OK;
+  }
+
+  // split the leaf; appending to the last leaf keeps the left one full
+  BTreeLeaf *right = _bt_node_alloc(tree, 1);
+  int append = pos == leaf->count && !leaf->next;
+  uint32_t split = append ? BTREE_NODE_KEYS : (BTREE_NODE_KEYS + 1) / 2;
+  uint64_t keys[BTREE_NODE_KEYS + 1];
+  uint64_t values[BTREE_NODE_KEYS + 1];
+  memcpy(keys, leaf->keys, pos * sizeof(uint64_t));
+  memcpy(values, leaf->values, pos * sizeof(uint64_t));
+  keys[pos] = key;
+  values[pos] = value;
+  memcpy(&keys[pos + 1], &leaf->keys[pos],
+         (BTREE_NODE_KEYS - pos) * sizeof(uint64_t));
+  memcpy(&values[pos + 1], &leaf->values[pos],
+         (BTREE_NODE_KEYS - pos) * sizeof(uint64_t));
+
+  leaf->count = split;
+  memcpy(leaf->keys, keys, split * sizeof(uint64_t));
+  memcpy(leaf->values, values, split * sizeof(uint64_t));
+  right->count = BTREE_NODE_KEYS + 1 - split;
+  memcpy(right->keys, &keys[split], right->count * sizeof(uint64_t));
+  memcpy(right->values, &values[split], right->count * sizeof(uint64_t));
+  right->next = leaf->next;
+  leaf->next = right;
+
+  // push the separator up, splitting full inner nodes on the way
+  uint64_t sep = right->keys[0];
+  void *new_child = right;
+  while (depth > 0) {
+    depth--;
+    BTreeInner *in = path[depth];
+    uint32_t c = slots[depth];
+    if (in->count < BTREE_NODE_KEYS) {
+      _bt_inner_put(in, c, sep, new_child);
+      return BTREE_OK;
+    }
+
+    BTreeInner *rin = _bt_node_alloc(tree, 0);
+    if (append && c == BTREE_NODE_KEYS) {
+      // appending: keep this node full, start a new rightmost one
+      rin->children[0] = new_child;
+      new_child = rin;
+      continue;
+    }
+
+    uint64_t ikeys[BTREE_NODE_KEYS + 1];
+    void *ichildren[BTREE_NODE_KEYS + 2];
+    memcpy(ikeys, in->keys, c * sizeof(uint64_t));
+    ikeys[c] = sep;
+    memcpy(&ikeys[c + 1], &in->keys[c],
+           (BTREE_NODE_KEYS - c) * sizeof(uint64_t));
+    memcpy(ichildren, in->children, (c + 1) * sizeof(void *));
+    ichildren[c + 1] = new_child;
+    memcpy(&ichildren[c + 2], &in->children[c + 1],
+           (BTREE_NODE_KEYS - c) * sizeof(void *));
+
+    // left keeps mid keys, ikeys[mid] moves up, right takes the rest
+    const uint32_t mid = (BTREE_NODE_KEYS + 1) / 2;
+    in->count = mid;
+    memcpy(in->keys, ikeys, mid * sizeof(uint64_t));
+    memcpy(in->children, ichildren, (mid + 1) * sizeof(void *));
+    rin->count = BTREE_NODE_KEYS - mid;
+    memcpy(rin->keys, &ikeys[mid + 1], rin->count * sizeof(uint64_t));
+    memcpy(rin->children, &ichildren[mid + 1],
+           (rin->count + 1) * sizeof(void *));
+
+    sep = ikeys[mid];
+    new_child = rin;
+  }
+
+  // the root was split
+  BTreeInner *root = _bt_node_alloc(tree, 0);
+  root->count = 1;
+  root->keys[0] = sep;
+  root->children[0] = tree->root;
+  root->children[1] = new_child;
+  tree->root = root;
+  tree->height++;
+  return BTREE_OK;
+}
+
+int btree_remove(BTree *tree, uint64_t key) {
+  if (!tree) {
+    return BTREE_ERR_NULL;
+  }
+  BTreeLeaf *leaf = (BTreeLeaf *)_bt_find_leaf(tree, key);
+  uint32_t pos = _bt_count_lt(leaf->keys, leaf->count, key);
+  if (pos >= leaf->count || leaf->keys[pos] != key) {
+    return BTREE_ERR_NOT_FOUND;
+  }
+  memmove(&leaf->keys[pos], &leaf->keys[pos + 1],
+          (leaf->count - pos - 1) * sizeof(uint64_t));
+  memmove(&leaf->values[pos], &leaf->values[pos + 1],
+          (leaf->count - pos - 1) * sizeof(uint64_t));
+  leaf->count--;
+  tree->count--;
+  return BTREE_OK;
+}
+
+int btree_bulk_load(BTree *tree, const uint64_t *keys, const uint64_t *values,
+                    size_t n) {
+  if (!tree || !keys || !values) {
+    return BTREE_ERR_NULL;
+  }
+  if (tree->count != 0) {
+    return BTREE_ERR_NOT_EMPTY;
+  }
+  for (size_t i = 1; i < n; i++) {
+    if (keys[i - 1] >= keys[i]) {
+      return BTREE_ERR_UNSORTED;
+    }
+  }
+  if (n == 0) {
+    return BTREE_OK;
+  }
+
+  // start over so the leaves are the first nodes of the arena, back to back
+  r_arena_reset(&tree->nodes);
+
+  size_t nodes = (n + BTREE_NODE_KEYS - 1) / BTREE_NODE_KEYS;
+  BTreeLeaf *prev = NULL;
+  void *first = NULL;
+  for (size_t i = 0, start = 0; i < nodes; i++) {
+    // spread the remainder so every leaf is at least half full
+    size_t end = n * (i + 1) / nodes;
+    BTreeLeaf *leaf = _bt_node_alloc(tree, 1);
+    leaf->count = (uint32_t)(end - start);
+    memcpy(leaf->keys, &keys[start], leaf->count * sizeof(uint64_t));
+    memcpy(leaf->values, &values[start], leaf->count * sizeof(uint64_t));
+    if (prev) {
+      prev->next = leaf;
+    } else {
+      first = leaf;
+    }
+    prev = leaf;
+    start = end;
+  }
+  tree->first_leaf = first;
+  tree->count = n;
+  tree->height = 1;
+
+  // build inner levels above the previous one; nodes of a level are
+  // consecutive in the arena, starting at index base
+  size_t base = 0;
+  while (nodes > 1) {
+    size_t parents = (nodes + BTREE_NODE_KEYS) / (BTREE_NODE_KEYS + 1);
+    size_t next_base = atomic_load(&tree->nodes.count);
+    for (size_t p = 0, start = 0; p < parents; p++) {
+      size_t end = nodes * (p + 1) / parents;
+      BTreeInner *in = _bt_node_alloc(tree, 0);
+      in->count = (uint32_t)(end - start - 1);
+      for (size_t c = start; c < end; c++) {
+        void *child = (void *)r_arena_get(&tree->nodes, base + c);
+        in->children[c - start] = child;
+        if (c > start) {
+          // smallest key below child: follow the leftmost path
+          const void *down = child;
+          while (!_bt_is_leaf(down)) {
+            down = ((const BTreeInner *)down)->children[0];
+          }
+          in->keys[c - start - 1] = ((const BTreeLeaf *)down)->keys[0];
+        }
+      }
+      start = end;
+    }
+    base = next_base;
+    nodes = parents;
+    tree->height++;
+  }
+  tree->root = (void *)r_arena_get(&tree->nodes, base);
+  return BTREE_OK;
+}
+
+BTreeIter btree_range(const BTree *tree, uint64_t lo, uint64_t hi) {
+  BTreeIter it = {NULL, 0, hi};
+  if (!tree || lo > hi) {
+    return it;
+  }
+  const BTreeLeaf *leaf = _bt_find_leaf(tree, lo);
+  it.leaf = leaf;
+  it.pos = _bt_count_lt(leaf->keys, leaf->count, lo);
+  return it;
+}
+
+int btree_iter_next(BTreeIter *it, uint64_t *key, uint64_t *value) {
+  if (!it) {
+    return BTREE_ERR_NULL;
+  }
+  const BTreeLeaf *leaf = it->leaf;
+  while (leaf && it->pos >= leaf->count) {
+    leaf = leaf->next;
+    it->pos = 0;
+  }
+  it->leaf = leaf;
+  if (!leaf || leaf->keys[it->pos] > it->hi) {
+    it->leaf = NULL;
+    return BTREE_ERR_NOT_FOUND;
+  }
+  if (key) {
+    *key = leaf->keys[it->pos];
+  }
+  if (value) {
+    *value = leaf->values[it->pos];
+  }
+  it->pos++;
+  return BTREE_OK;
+}
+
+size_t btree_len(const BTree *tree) { return tree ? tree->count : 0; }
+
+void btree_clear(BTree *tree) {
+  if (!tree) {
+    return;
+  }
+  r_arena_reset(&tree->nodes);
+  tree->root = _bt_node_alloc(tree, 1);
+  tree->first_leaf = tree->root;
+  tree->height = 1;
+  tree->count = 0;
+}
+
+void btree_free(BTree *tree) {
+  if (!tree) {
+    return;
+  }
+  r_arena_free(&tree->nodes);
+  tree->root = NULL;
+  tree->first_leaf = NULL;
+  tree->count = 0;
+}
+
+#endif // BTREE_IMPLEMENTATION
@@ -0,0 +1,1327 @@
+// Copyright 2025 Seaker <seakerone@proton.me>
+
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+/*
+------------------------------------------------------------------------------
+hashmap.h — Open-addressing hash maps (single-threaded and concurrent)
+
+Two maps sharing the same probing scheme:
+
+- HashMap            : single-threaded, SwissTable-style
+- ConcurrentHashMap  : sharded, lock-free reads, per-shard writers,
+                       incremental resize
+
+Both use one control byte per slot (empty / deleted / 7 bits of the hash) and
+probe the table one group of HASHMAP_GROUP_WIDTH control bytes at a time. On
+x86 a group is matched with a single SSE2 compare; elsewhere a scalar loop
+does the same. Keys and values are only touched when the 7-bit tag matches.
+
+------------------------------------------------------------------------------
+HashMap
+
+- Keys and values live in a dense Arena of entries (hash, key, value) in
+  insertion order; the table itself only stores a control byte and a 32-bit
+  entry index per slot.
+- A rehash rebuilds the index from the stored hashes: keys and values never
+  move, no key is hashed twice.
+- Removing swaps the last entry into the hole, so entries stay dense and
+  iteration is a linear scan (hashmap_entry_at).
+- Fixed-size keys are compared with memcmp. When string_arena.h is included
+  before this header, a string-keyed variant stores keys in a StringArena and
+  keeps only their index in the entry; keys are compared by length first.
+- The same string map interns strings (hashmap_intern): every distinct
+  string is stored once, equal strings share one pointer.
+
+Pointers returned by hashmap_get are valid until the next put / remove.
+
+------------------------------------------------------------------------------
+ConcurrentHashMap
+
+- The key space is split across a power-of-two number of shards.
+- Writers take a short per-shard spinlock; shards never block each other.
+- Readers take no lock and never wait for a writer. Every write bumps a
+  per-shard sequence (seqlock), and every entry has its own sequence. A hit
+  counts once its entry is still linked and unchanged after the copy, a miss
+  once the shard sequence is even and unchanged across the probe; anything
+  else retries, so a reader never returns a torn value or a stale miss.
+- Entries are allocated from a per-shard RegionArena and never move; the
+  table only holds pointers to them. Removed entries are reused by later
+  inserts into the same shard.
+- Growing a shard allocates the new table and then moves
+  CHM_MIGRATE_STEP slots of the old one on each following write, so no
+  single write pays for a whole rehash. Readers look in both tables while a
+  migration is in flight.
+- A shard whose table is mostly tombstones is cleaned up in place instead
+  (one pass over the table, under the shard lock).
+- Tables replaced by a larger one are kept until chm_destroy, because a
+  reader may still be probing them; capacities double, so they add at most
+  one current table worth of memory.
+
+------------------------------------------------------------------------------
+USAGE
+
+Include the dependencies first (arenas/arena.h, arenas/r_arena.h, and
+optionally arenas/string_arena.h), then in exactly ONE source file:
+
+    #define HASHMAP_IMPLEMENTATION
+    #include "hashmap.h"
+
+Single-threaded:
+
+    HashMap m = hashmap_create(sizeof(uint64_t), sizeof(Item), 0);
+    hashmap_put(&m, &id, &item);
+    Item *it = hashmap_get(&m, &id);
+    hashmap_free(&m);
+
+String keys:
+
+    StringArena names = arena_s_create();
+    HashMap m = hashmap_create_str(&names, sizeof(int), 0);
+    hashmap_put_str(&m, "player", &v);
+    int *p = hashmap_get_str(&m, "player");
+
+Interning (string map without values):
+
+    HashMap names = hashmap_create_str(&strings, 0, 0);
+    StrView a = hashmap_intern(&names, hdr, hdr_len);
+    StrView b = hashmap_intern(&names, "content-type", 12);
+    if (a.ptr == b.ptr) { ... } // same string
+
+Concurrent:
+
+    ConcurrentHashMap *c = chm_create(sizeof(uint64_t), sizeof(Item), 0);
+    chm_put(c, &id, &item);          // any thread
+    Item out;
+    if (chm_get(c, &id, &out) == HASHMAP_OK) { ... } // any thread
+    chm_destroy(c);
+
+------------------------------------------------------------------------------
+*/
+#ifndef HASHMAP_H
+#define HASHMAP_H
+
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef CACHELINE_SIZE
+#define CACHELINE_SIZE 64
+#endif
+
+#define HASHMAP_GROUP_WIDTH 16
+
+#define HASHMAP_OK 0
+#define HASHMAP_ERR_NULL -1
+#define HASHMAP_ERR_NOT_FOUND -2
+#define HASHMAP_ERR_ALLOC -3
+
+#ifndef CHM_DEFAULT_SHARDS
+#define CHM_DEFAULT_SHARDS 64
+#endif
+
+#ifndef CHM_MIGRATE_STEP
+#define CHM_MIGRATE_STEP 64 // old slots moved per write during a resize
+#endif
+
+#ifndef CHM_ENTRIES_PER_REGION
+#define CHM_ENTRIES_PER_REGION 256 // RegionArena region size per shard
+#endif
+
+#ifndef CHM_MAX_REGIONS
+#define CHM_MAX_REGIONS 4096 // RegionArena region limit per shard
+#endif
+
+/*-----------------------------------------------------------------------------
+  hashmap_hash_bytes
+  Hashes len bytes of key.
+
+  Notes:
+    - 64-bit multiply-mix hash, 8 bytes per step.
+    - Used by both maps; exposed for callers that want to pre-hash or shard.
+-----------------------------------------------------------------------------*/
+uint64_t hashmap_hash_bytes(const void *key, size_t len);
+
+typedef struct HashMap_t {
+  uint8_t *ctrl;       // capacity + HASHMAP_GROUP_WIDTH control bytes
+  uint32_t *index;     // entry index per slot
+  size_t capacity;     // number of slots (power of two)
+  size_t growth_left;  // inserts into empty slots before the next rehash
+
+  Arena entries;       // dense (hash, key, value) records
+  uint8_t *scratch;    // one entry, used to build inserts
+  size_t key_size;     // sizeof(K), sizeof(size_t) for string keys
+  size_t value_size;   // sizeof(V)
+  size_t value_offset; // value offset inside an entry
+
+  void *strings;       // StringArena * for string keys, NULL otherwise
+} HashMap;
+
+/*-----------------------------------------------------------------------------
+  hashmap_create
+  Creates a single-threaded map with fixed-size keys.
+
+  key_size   : size in bytes of each key (compared with memcmp)
+  value_size : size in bytes of each value
+  capacity   : expected number of entries (0 for a small default)
+
+  Returns the map by value; ctrl is NULL if allocation failed.
+-----------------------------------------------------------------------------*/
+HashMap hashmap_create(size_t key_size, size_t value_size, size_t capacity);
+
+/*-----------------------------------------------------------------------------
+  hashmap_put
+  Inserts key -> value, or overwrites the value if key is present.
+
+  Returns:
+    - HASHMAP_OK        on success
+    - HASHMAP_ERR_NULL  if an argument is NULL
+    - HASHMAP_ERR_ALLOC if growing the table or the entries failed
+-----------------------------------------------------------------------------*/
+int hashmap_put(HashMap *map, const void *key, const void *value);
+
+/*-----------------------------------------------------------------------------
+  hashmap_get
+  Looks up key.
+
+  Returns a pointer to the stored value, NULL if key is absent.
+
+  Notes:
+    - The pointer is invalidated by the next put / remove.
+-----------------------------------------------------------------------------*/
+void *hashmap_get(const HashMap *map, const void *key);
+
+/*-----------------------------------------------------------------------------
+  hashmap_remove
+  Removes key from the map.
+
+  Returns:
+    - HASHMAP_OK            on success
+    - HASHMAP_ERR_NULL      if an argument is NULL
+    - HASHMAP_ERR_NOT_FOUND if key is absent
+
+  Notes:
+    - The last entry is moved into the freed position (entry order changes).
+-----------------------------------------------------------------------------*/
+int hashmap_remove(HashMap *map, const void *key);
+
+/*-----------------------------------------------------------------------------
+  hashmap_len
+  Returns the number of entries in the map.
+-----------------------------------------------------------------------------*/
+size_t hashmap_len(const HashMap *map);
+
+/*-----------------------------------------------------------------------------
+  hashmap_entry_at
+  Reads the i-th entry (0 <= i < hashmap_len) for iteration.
+
+  key   : receives a pointer to the key (const char * data for string maps)
+  value : receives a pointer to the value
+
+  Returns HASHMAP_OK, or HASHMAP_ERR_NOT_FOUND if i is out of range.
+-----------------------------------------------------------------------------*/
+int hashmap_entry_at(const HashMap *map, size_t i, const void **key,
+                     void **value);
+
+/*-----------------------------------------------------------------------------
+  hashmap_clear
+  Removes every entry. Memory is kept for reuse.
+-----------------------------------------------------------------------------*/
+void hashmap_clear(HashMap *map);
+
+/*-----------------------------------------------------------------------------
+  hashmap_free
+  Frees all memory owned by the map (not the StringArena of string maps).
+-----------------------------------------------------------------------------*/
+void hashmap_free(HashMap *map);
+
+#ifdef STRING_ARENA_H
+/*-----------------------------------------------------------------------------
+  hashmap_create_str
+  Creates a single-threaded map keyed by null-terminated strings.
+
+  strings    : StringArena that stores the keys (owned by the caller)
+  value_size : size in bytes of each value
+  capacity   : expected number of entries (0 for a small default)
+
+  Notes:
+    - New keys are appended to strings; removing a key does not remove its
+      string (the arena is append-only).
+    - Entries store the string index, so arena reallocation is harmless.
+    - Use hashmap_put_str / hashmap_get_str / hashmap_remove_str.
+-----------------------------------------------------------------------------*/
+HashMap hashmap_create_str(StringArena *strings, size_t value_size,
+                           size_t capacity);
+
+int hashmap_put_str(HashMap *map, const char *key, const void *value);
+void *hashmap_get_str(const HashMap *map, const char *key);
+int hashmap_remove_str(HashMap *map, const char *key);
+
+/*-----------------------------------------------------------------------------
+  hashmap_intern
+  Returns the map's copy of the len bytes at s, adding it to the map's
+  StringArena the first time it is seen.
+
+  map : string map created with a value_size of 0
+
+  Returns the stored view: interning equal strings returns the same ptr, so
+  interned strings compare by pointer. {NULL, 0} on allocation failure or if
+  map is not a value-less string map.
+
+  Notes:
+    - s need not be null-terminated; the stored copy is.
+    - Views stay valid until the StringArena is reset or freed.
+-----------------------------------------------------------------------------*/
+StrView hashmap_intern(HashMap *map, const char *s, size_t len);
+#endif
+
+typedef struct ConcurrentHashMap_t ConcurrentHashMap;
+
+/*-----------------------------------------------------------------------------
+  chm_create
+  Creates a concurrent map with fixed-size keys.
+
+  key_size   : size in bytes of each key (compared with memcmp)
+  value_size : size in bytes of each value
+  shards     : number of shards, rounded up to a power of two
+               (0 for CHM_DEFAULT_SHARDS)
+
+  Returns a pointer to ConcurrentHashMap, NULL on allocation failure.
+
+  Notes:
+    - Each shard holds at most
+      CHM_ENTRIES_PER_REGION * CHM_MAX_REGIONS entries plus reused ones;
+      its RegionArena aborts past that.
+-----------------------------------------------------------------------------*/
+ConcurrentHashMap *chm_create(size_t key_size, size_t value_size,
+                              size_t shards);
+
+/*-----------------------------------------------------------------------------
+  chm_put
+  Inserts key -> value, or overwrites the value if key is present.
+
+  Returns:
+    - HASHMAP_OK        on success
+    - HASHMAP_ERR_NULL  if an argument is NULL
+    - HASHMAP_ERR_ALLOC if growing the shard table failed
+
+  Notes:
+    - Safe from any thread; serialized per shard.
+    - While the shard is resizing, also moves CHM_MIGRATE_STEP old slots.
+-----------------------------------------------------------------------------*/
+int chm_put(ConcurrentHashMap *map, const void *key, const void *value);
+
+/*-----------------------------------------------------------------------------
+  chm_get
+  Copies the value stored for key into out.
+
+  Returns:
+    - HASHMAP_OK            on success
+    - HASHMAP_ERR_NULL      if an argument is NULL
+    - HASHMAP_ERR_NOT_FOUND if key is absent
+
+  Notes:
+    - Lock-free, never waits for a writer; retries if a writer touches the
+      entry (or, for a miss, the shard) while it is being read.
+-----------------------------------------------------------------------------*/
+int chm_get(ConcurrentHashMap *map, const void *key, void *out);
+
+/*-----------------------------------------------------------------------------
+  chm_remove
+  Removes key from the map.
+
+  Returns:
+    - HASHMAP_OK            on success
+    - HASHMAP_ERR_NULL      if an argument is NULL
+    - HASHMAP_ERR_NOT_FOUND if key is absent
+-----------------------------------------------------------------------------*/
+int chm_remove(ConcurrentHashMap *map, const void *key);
+
+/*-----------------------------------------------------------------------------
+  chm_len
+  Returns the number of entries.
+
+  Notes:
+    - Only a snapshot; may be stale by the time it is read.
+-----------------------------------------------------------------------------*/
+size_t chm_len(ConcurrentHashMap *map);
+
+/*-----------------------------------------------------------------------------
+  chm_destroy
+  Frees the map, every table and every entry.
+
+  Notes:
+    - No thread may use the map during or after this call.
+-----------------------------------------------------------------------------*/
+void chm_destroy(ConcurrentHashMap *map);
+
+#endif // !HASHMAP_H
+
+#if (defined(HASHMAP_IMPLEMENTATION))
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define HM_CTRL_EMPTY ((uint8_t)0x80)
+#define HM_CTRL_DELETED ((uint8_t)0xFE)
+#define HM_MIN_CAPACITY 16
+
+/*-------------------------------------------*/
+/*              Hashing                      */
+/*-------------------------------------------*/
+static inline uint64_t _hm_mix(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t r = (__uint128_t)a * b;
+  return (uint64_t)r ^ (uint64_t)(r >> 64);
+#else
+  uint64_t r = (a ^ (a >> 32)) * b;
+  return r ^ (r >> 29);
+#endif
+}
+
+uint64_t hashmap_hash_bytes(const void *key, size_t len) {
+  const uint8_t *p = key;
+  uint64_t h = 0x9E3779B97F4A7C15ull ^ (len * 0xA0761D6478BD642Full);
+
+  while (len >= 8) {
+    uint64_t w;
+    memcpy(&w, p, 8);
+    h = _hm_mix(h ^ w, 0xE7037ED1A0B428DBull);
+    p += 8;
+    len -= 8;
+  }
+  if (len > 0) {
+    uint64_t w = 0;
+    memcpy(&w, p, len);
+    h = _hm_mix(h ^ w, 0x8EBC6AF09C88C6E3ull);
+  }
+  return _hm_mix(h, 0x589965CC75374CC3ull);
+}
+
+/*-------------------------------------------*/
+/*         Control byte groups               */
+/*-------------------------------------------*/
+// Each function returns a bitmask, bit i set when ctrl[i] matches.
+#if defined(__SSE2__)
+static inline uint32_t _hm_group_match(const uint8_t *ctrl, uint8_t tag) {
+  __m128i g = _mm_loadu_si128((const __m128i *)ctrl);
+  return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8((char)tag)));
+}
+
+// empty or deleted: both have the high bit set
+static inline uint32_t _hm_group_match_free(const uint8_t *ctrl) {
+  return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)ctrl));
+}
+#else
+static inline uint32_t _hm_group_match(const uint8_t *ctrl, uint8_t tag) {
+  uint32_t mask = 0;
+  for (int i = 0; i < HASHMAP_GROUP_WIDTH; i++) {
+    mask |= (uint32_t)(ctrl[i] == tag) << i;
+  }
+  return mask;
+}
+
+static inline uint32_t _hm_group_match_free(const uint8_t *ctrl) {
+  uint32_t mask = 0;
+  for (int i = 0; i < HASHMAP_GROUP_WIDTH; i++) {
+    mask |= (uint32_t)(ctrl[i] >> 7) << i;
+  }
+  return mask;
+}
+#endif
+
+static inline uint32_t _hm_group_match_empty(const uint8_t *ctrl) {
+  return _hm_group_match(ctrl, HM_CTRL_EMPTY);
+}
+
+static inline uint8_t _hm_tag(uint64_t hash) { return (uint8_t)(hash & 0x7F); }
+
+static inline size_t _hm_start(uint64_t hash, size_t mask) {
+  return (size_t)(hash >> 7) & mask;
+}
+
+// Writes a control byte and its mirror past the end, so a group load at any
+// position reads valid bytes without wrapping.
+static inline void _hm_set_ctrl(uint8_t *ctrl, size_t mask, size_t i,
+                                uint8_t v) {
+  ctrl[i] = v;
+  ctrl[((i - (HASHMAP_GROUP_WIDTH - 1)) & mask) + (HASHMAP_GROUP_WIDTH - 1)] =
+      v;
+}
+
+static inline size_t _hm_capacity_for(size_t n) {
+  size_t cap = HM_MIN_CAPACITY;
+  while (cap - cap / 8 < n) {
+    cap <<= 1;
+  }
+  return cap;
+}
+
+static inline int _hm_ctz(uint32_t m) { return __builtin_ctz(m); }
+
+// First empty or deleted slot on the probe sequence of hash.
+static size_t _hm_find_free(const uint8_t *ctrl, size_t mask, uint64_t hash) {
+  size_t pos = _hm_start(hash, mask);
+  size_t stride = 0;
+  for (;;) {
+    uint32_t m = _hm_group_match_free(ctrl + pos);
+    if (m) {
+      return (pos + (size_t)_hm_ctz(m)) & mask;
+    }
+    stride += HASHMAP_GROUP_WIDTH;
+    pos = (pos + stride) & mask;
+  }
+}
+
+/*-------------------------------------------*/
+/*               HashMap                     */
+/*-------------------------------------------*/
+static inline uint8_t *_hm_entry(const HashMap *map, size_t i) {
+  return map->entries.data + i * map->entries.elem_size;
+}
+
+static inline uint64_t _hm_entry_hash(const uint8_t *entry) {
+  uint64_t h;
+  memcpy(&h, entry, sizeof(h));
+  return h;
+}
+
+static inline uint8_t *_hm_entry_key(uint8_t *entry) {
+  return entry + sizeof(uint64_t);
+}
+
+static int _hm_key_eq(const HashMap *map, const uint8_t *entry,
+                      const void *key) {
+  const uint8_t *stored = entry + sizeof(uint64_t);
+#ifdef STRING_ARENA_H
+  // string maps look up by StrView
+  if (map->strings) {
+    size_t idx;
+    memcpy(&idx, stored, sizeof(idx));
+    StrView have = arena_getS_view(map->strings, idx);
+    const StrView *want = key;
+    return have.len == want->len &&
+           memcmp(have.ptr, want->ptr, want->len) == 0;
+  }
+#endif
+  return memcmp(stored, key, map->key_size) == 0;
+}
+
+// Slot holding key, or SIZE_MAX.
+static size_t _hm_find(const HashMap *map, uint64_t hash, const void *key) {
+  size_t mask = map->capacity - 1;
+  size_t pos = _hm_start(hash, mask);
+  size_t stride = 0;
+  uint8_t tag = _hm_tag(hash);
+
+  for (;;) {
+    const uint8_t *group = map->ctrl + pos;
+    uint32_t m = _hm_group_match(group, tag);
+    while (m) {
+      size_t slot = (pos + (size_t)_hm_ctz(m)) & mask;
+      const uint8_t *entry = _hm_entry(map, map->index[slot]);
+      if (_hm_entry_hash(entry) == hash && _hm_key_eq(map, entry, key)) {
+        return slot;
+      }
+      m &= m - 1;
+    }
+    if (_hm_group_match_empty(group)) {
+      return SIZE_MAX;
+    }
+    stride += HASHMAP_GROUP_WIDTH;
+    pos = (pos + stride) & mask;
+  }
+}
+
+// Slot whose index is entry_idx (the entry is known to be present).
+static size_t _hm_find_index(const HashMap *map, uint64_t hash,
+                             uint32_t entry_idx) {
+  size_t mask = map->capacity - 1;
+  size_t pos = _hm_start(hash, mask);
+  size_t stride = 0;
+  uint8_t tag = _hm_tag(hash);
+
+  for (;;) {
+    uint32_t m = _hm_group_match(map->ctrl + pos, tag);
+    while (m) {
+      size_t slot = (pos + (size_t)_hm_ctz(m)) & mask;
+      if (map->index[slot] == entry_idx) {
+        return slot;
+      }
+      m &= m - 1;
+    }
+    stride += HASHMAP_GROUP_WIDTH;
+    pos = (pos + stride) & mask;
+  }
+}
+
+static int _hm_alloc_table(HashMap *map, size_t capacity) {
+  uint8_t *ctrl = malloc(capacity + HASHMAP_GROUP_WIDTH);
+  uint32_t *index = malloc(capacity * sizeof(uint32_t));
+  if (!ctrl || !index) {
+    free(ctrl);
+    free(index);
+    return HASHMAP_ERR_ALLOC;
+  }
+  memset(ctrl, HM_CTRL_EMPTY, capacity + HASHMAP_GROUP_WIDTH);
+
+  free(map->ctrl);
+  free(map->index);
+  map->ctrl = ctrl;
+  map->index = index;
+  map->capacity = capacity;
+  map->growth_left = capacity - capacity / 8;
+  return HASHMAP_OK;
+}
+
+// Rebuilds the index from the stored hashes. Entries are not touched.
+static int _hm_rehash(HashMap *map, size_t capacity) {
+  if (_hm_alloc_table(map, capacity) != HASHMAP_OK) {
+    return HASHMAP_ERR_ALLOC;
+  }
+  size_t mask = capacity - 1;
+  size_t count = map->entries.count;
+  for (size_t i = 0; i < count; i++) {
+    uint64_t hash = _hm_entry_hash(_hm_entry(map, i));
+    size_t slot = _hm_find_free(map->ctrl, mask, hash);
+    _hm_set_ctrl(map->ctrl, mask, slot, _hm_tag(hash));
+    map->index[slot] = (uint32_t)i;
+  }
+  map->growth_left -= count;
+  return HASHMAP_OK;
+}
+
+static HashMap _hm_create(size_t key_size, size_t value_size,
+                          size_t capacity, void *strings) {
+  HashMap map;
+  memset(&map, 0, sizeof(map));
+
+  size_t value_offset = (sizeof(uint64_t) + key_size + 7) & ~(size_t)7;
+  size_t entry_size = (value_offset + value_size + 7) & ~(size_t)7;
+
+  map.key_size = key_size;
+  map.value_size = value_size;
+  map.value_offset = value_offset;
+  map.strings = strings;
+  map.entries = arena_create(entry_size, capacity < 8 ? 8 : capacity, DYNAMIC);
+  map.scratch = malloc(entry_size);
+
+  if (!map.entries.data || !map.scratch ||
+      _hm_alloc_table(&map, _hm_capacity_for(capacity)) != HASHMAP_OK) {
+    arena_free(&map.entries);
+    free(map.scratch);
+    map.scratch = NULL;
+  }
+  return map;
+}
+
+HashMap hashmap_create(size_t key_size, size_t value_size, size_t capacity) {
+  return _hm_create(key_size, value_size, capacity, NULL);
+}
+
+// key_bytes: what the entry stores (the key, or the string index)
+static int _hm_put(HashMap *map, uint64_t hash, const void *key,
+                   const void *key_bytes, const void *value) {
+  size_t slot = _hm_find(map, hash, key);
+  if (slot != SIZE_MAX) {
+    memcpy(_hm_entry(map, map->index[slot]) + map->value_offset, value,
+           map->value_size);
+    return HASHMAP_OK;
+  }
+
+  size_t mask = map->capacity - 1;
+  slot = _hm_find_free(map->ctrl, mask, hash);
+  if (map->growth_left == 0 && map->ctrl[slot] == HM_CTRL_EMPTY) {
+    // mostly tombstones: rehash in place, otherwise grow
+    size_t count = map->entries.count;
+    size_t cap = count * 2 < map->capacity - map->capacity / 8
+                     ? map->capacity
+                     : map->capacity * 2;
+    if (_hm_rehash(map, cap) != HASHMAP_OK) {
+      return HASHMAP_ERR_ALLOC;
+    }
+    mask = map->capacity - 1;
+    slot = _hm_find_free(map->ctrl, mask, hash);
+  }
+
+  uint8_t *entry = map->scratch;
+  memcpy(entry, &hash, sizeof(hash));
+  memcpy(_hm_entry_key(entry), key_bytes, map->key_size);
+  memcpy(entry + map->value_offset, value, map->value_size);
+  size_t idx = map->entries.count;
+  if (arena_add(&map->entries, entry) != 0) {
+    return HASHMAP_ERR_ALLOC;
+  }
+
+  if (map->ctrl[slot] == HM_CTRL_EMPTY) {
+    map->growth_left--;
+  }
+  _hm_set_ctrl(map->ctrl, mask, slot, _hm_tag(hash));
+  map->index[slot] = (uint32_t)idx;
+  return HASHMAP_OK;
+}
+
+static int _hm_remove(HashMap *map, uint64_t hash, const void *key) {
+  size_t slot = _hm_find(map, hash, key);
+  if (slot == SIZE_MAX) {
+    return HASHMAP_ERR_NOT_FOUND;
+  }
+  size_t mask = map->capacity - 1;
+  uint32_t idx = map->index[slot];
+  _hm_set_ctrl(map->ctrl, mask, slot, HM_CTRL_DELETED);
+
+  // keep entries dense: move the last one into the hole
+  uint32_t last = (uint32_t)(map->entries.count - 1);
+  if (idx != last) {
+    uint8_t *moved = _hm_entry(map, last);
+    map->index[_hm_find_index(map, _hm_entry_hash(moved), last)] = idx;
+    memcpy(_hm_entry(map, idx), moved, map->entries.elem_size);
+  }
+  arena_pop(&map->entries, map->scratch);
+  return HASHMAP_OK;
+}
+
+int hashmap_put(HashMap *map, const void *key, const void *value) {
+  if (!map || !map->ctrl || !key || !value) {
+    return HASHMAP_ERR_NULL;
+  }
+  return _hm_put(map, hashmap_hash_bytes(key, map->key_size), key, key,
+                 value);
+}
+
+void *hashmap_get(const HashMap *map, const void *key) {
+  if (!map || !map->ctrl || !key) {
+    return NULL;
+  }
+  size_t slot = _hm_find(map, hashmap_hash_bytes(key, map->key_size), key);
+  if (slot == SIZE_MAX) {
+    return NULL;
+  }
+  return _hm_entry(map, map->index[slot]) + map->value_offset;
+}
+
+int hashmap_remove(HashMap *map, const void *key) {
+  if (!map || !map->ctrl || !key) {
+    return HASHMAP_ERR_NULL;
+  }
+  return _hm_remove(map, hashmap_hash_bytes(key, map->key_size), key);
+}
+
+size_t hashmap_len(const HashMap *map) {
+  return map ? map->entries.count : 0;
+}
+
+int hashmap_entry_at(const HashMap *map, size_t i, const void **key,
+                     void **value) {
+  if (!map || i >= map->entries.count) {
+    return HASHMAP_ERR_NOT_FOUND;
+  }
+  uint8_t *entry = _hm_entry(map, i);
+  if (key) {
+#ifdef STRING_ARENA_H
+    if (map->strings) {
+      size_t idx;
+      memcpy(&idx, _hm_entry_key(entry), sizeof(idx));
+      *key = arena_getS(map->strings, idx);
+    } else
+#endif
+      *key = _hm_entry_key(entry);
+  }
+  if (value) {
+    *value = entry + map->value_offset;
+  }
+  return HASHMAP_OK;
+}
+
+void hashmap_clear(HashMap *map) {
+  if (!map || !map->ctrl) {
+    return;
+  }
+  memset(map->ctrl, HM_CTRL_EMPTY, map->capacity + HASHMAP_GROUP_WIDTH);
+  map->growth_left = map->capacity - map->capacity / 8;
+  arena_reset(&map->entries);
+}
+
+void hashmap_free(HashMap *map) {
+  if (!map) {
+    return;
+  }
+  free(map->ctrl);
+  free(map->index);
+  free(map->scratch);
+  if (map->entries.data) {
+    arena_free(&map->entries);
+  }
+  map->ctrl = NULL;
+  map->index = NULL;
+  map->scratch = NULL;
+  map->capacity = 0;
+}
+
+#ifdef STRING_ARENA_H
+HashMap hashmap_create_str(StringArena *strings, size_t value_size,
+                           size_t capacity) {
+  return _hm_create(sizeof(size_t), value_size, capacity, strings);
+}
+
+int hashmap_put_str(HashMap *map, const char *key, const void *value) {
+  if (!map || !map->ctrl || !map->strings || !key || !value) {
+    return HASHMAP_ERR_NULL;
+  }
+  StrView want = {key, strlen(key)};
+  uint64_t hash = hashmap_hash_bytes(want.ptr, want.len);
+  size_t slot = _hm_find(map, hash, &want);
+  if (slot != SIZE_MAX) {
+    memcpy(_hm_entry(map, map->index[slot]) + map->value_offset, value,
+           map->value_size);
+    return HASHMAP_OK;
+  }
+
+  StringArena *strings = map->strings;
+  size_t idx = strings->count;
+  if (!arena_addS_len(strings, want.ptr, want.len).ptr) {
+    return HASHMAP_ERR_ALLOC;
+  }
+  return _hm_put(map, hash, &want, &idx, value);
+}
+
+void *hashmap_get_str(const HashMap *map, const char *key) {
+  if (!map || !map->ctrl || !map->strings || !key) {
+    return NULL;
+  }
+  StrView want = {key, strlen(key)};
+  size_t slot =
+      _hm_find(map, hashmap_hash_bytes(want.ptr, want.len), &want);
+  if (slot == SIZE_MAX) {
+    return NULL;
+  }
+  return _hm_entry(map, map->index[slot]) + map->value_offset;
+}
+
+int hashmap_remove_str(HashMap *map, const char *key) {
+  if (!map || !map->ctrl || !map->strings || !key) {
+    return HASHMAP_ERR_NULL;
+  }
+  StrView want = {key, strlen(key)};
+  return _hm_remove(map, hashmap_hash_bytes(want.ptr, want.len), &want);
+}
+
+StrView hashmap_intern(HashMap *map, const char *s, size_t len) {
+  StrView none = {NULL, 0};
+  if (!map || !map->ctrl || !map->strings || map->value_size != 0 ||
+      (!s && len)) {
+    return none;
+  }
+  StrView want = {s ? s : "", len};
+  uint64_t hash = hashmap_hash_bytes(want.ptr, want.len);
+  size_t slot = _hm_find(map, hash, &want);
+  size_t idx;
+  if (slot != SIZE_MAX) {
+    memcpy(&idx, _hm_entry_key(_hm_entry(map, map->index[slot])),
+           sizeof(idx));
+    return arena_getS_view(map->strings, idx);
+  }
+
+  StringArena *strings = map->strings;
+  idx = strings->count;
+  StrView stored = arena_addS_len(strings, want.ptr, want.len);
+  if (!stored.ptr || _hm_put(map, hash, &want, &idx, "") != HASHMAP_OK) {
+    return none;
+  }
+  return stored;
+}
+#endif
+
+/*-------------------------------------------*/
+/*           ConcurrentHashMap               */
+/*-------------------------------------------*/
+typedef struct ChmEntry_t {
+  _Atomic uint32_t seq; // odd while a writer changes the entry
+  uint32_t _pad;
+  uint64_t hash;
+  struct ChmEntry_t *next_free; // shard freelist, writer only
+  alignas(8) uint8_t data[];    // key, then value at value_offset
+} ChmEntry;
+
+typedef struct ChmTable_t {
+  size_t capacity; // number of slots (power of two)
+  size_t growth_left;
+  _Atomic(ChmEntry *) *slots;
+  uint8_t *ctrl; // capacity + HASHMAP_GROUP_WIDTH control bytes
+} ChmTable;
+
+typedef struct ChmShard_t {
+  alignas(CACHELINE_SIZE) atomic_flag lock; // writers
+  _Atomic uint32_t seq;                     // odd while a writer is active
+
+  _Atomic(ChmTable *) table; // inserts go here
+  _Atomic(ChmTable *) old;   // being migrated into table, or NULL
+  size_t migrate_pos;        // next slot of old to move
+
+  _Atomic size_t count;
+  ChmEntry *free_entries; // removed entries, reused by inserts
+  RegionArena entries;    // every entry ever allocated by this shard
+  Arena retired;          // ChmTable * kept alive for readers
+} ChmShard;
+
+typedef struct ConcurrentHashMap_t {
+  ChmShard *shards;
+  size_t shard_mask;
+  size_t key_size;
+  size_t value_size;
+  size_t value_offset; // inside ChmEntry.data
+} ConcurrentHashMap;
+
+static ChmTable *_chm_table_new(size_t capacity) {
+  ChmTable *t = malloc(sizeof(ChmTable));
+  _Atomic(ChmEntry *) *slots = calloc(capacity, sizeof(*slots));
+  uint8_t *ctrl = malloc(capacity + HASHMAP_GROUP_WIDTH);
+  if (!t || !slots || !ctrl) {
+    free(t);
+    free(slots);
+    free(ctrl);
+    return NULL;
+  }
+  memset(ctrl, HM_CTRL_EMPTY, capacity + HASHMAP_GROUP_WIDTH);
+  t->capacity = capacity;
+  t->growth_left = capacity - capacity / 8;
+  t->slots = slots;
+  t->ctrl = ctrl;
+  return t;
+}
+
+static void _chm_table_free(ChmTable *t) {
+  if (!t) {
+    return;
+  }
+  free(t->slots);
+  free(t->ctrl);
+  free(t);
+}
+
+static inline ChmShard *_chm_shard(ConcurrentHashMap *map, uint64_t hash) {
+  return &map->shards[(size_t)(hash >> 40) & map->shard_mask];
+}
+
+ConcurrentHashMap *chm_create(size_t key_size, size_t value_size,
+                              size_t shards) {
+  size_t n = 1;
+  while (n < (shards == 0 ? CHM_DEFAULT_SHARDS : shards)) {
+    n <<= 1;
+  }
+
+  ConcurrentHashMap *map = malloc(sizeof(ConcurrentHashMap));
+  if (!map) {
+    return NULL;
+  }
+  map->shards = aligned_alloc(CACHELINE_SIZE, n * sizeof(ChmShard));
+  if (!map->shards) {
+    free(map);
+    return NULL;
+  }
+  map->shard_mask = n - 1;
+  map->key_size = key_size;
+  map->value_size = value_size;
+  map->value_offset = (key_size + 7) & ~(size_t)7;
+  size_t entry_size =
+      (sizeof(ChmEntry) + map->value_offset + value_size + 7) & ~(size_t)7;
+
+  for (size_t i = 0; i < n; i++) {
+    ChmShard *s = &map->shards[i];
+    ChmTable *t = _chm_table_new(HM_MIN_CAPACITY);
+    Arena retired = arena_create(sizeof(ChmTable *), 8, DYNAMIC);
+    if (!t || !retired.data) {
+      _chm_table_free(t);
+      free(retired.data);
+      // unwind the shards set up so far
+      for (size_t j = 0; j < i; j++) {
+        ChmShard *done = &map->shards[j];
+        _chm_table_free(
+            atomic_load_explicit(&done->table, memory_order_relaxed));
+        arena_free(&done->retired);
+        r_arena_free(&done->entries);
+      }
+      free(map->shards);
+      free(map);
+      return NULL;
+    }
+    atomic_flag_clear(&s->lock);
+    atomic_init(&s->seq, 0);
+    atomic_init(&s->table, t);
+    atomic_init(&s->old, NULL);
+    s->migrate_pos = 0;
+    atomic_init(&s->count, 0);
+    s->free_entries = NULL;
+    s->entries =
+        r_arena_create(entry_size, CHM_ENTRIES_PER_REGION, CHM_MAX_REGIONS);
+    s->retired = retired;
+  }
+  return map;
+}
+
+static inline void _chm_lock(ChmShard *s) {
+  while (atomic_flag_test_and_set_explicit(&s->lock, memory_order_acquire)) {
+    cpu_relax();
+  }
+  uint32_t seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+  atomic_store_explicit(&s->seq, seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+}
+
+static inline void _chm_unlock(ChmShard *s) {
+  uint32_t seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+  atomic_store_explicit(&s->seq, seq + 1, memory_order_release);
+  atomic_flag_clear_explicit(&s->lock, memory_order_release);
+}
+
+// Writer-side lookup (shard locked): slot of key in t, or SIZE_MAX.
+static size_t _chm_find(const ConcurrentHashMap *map, const ChmTable *t,
+                        uint64_t hash, const void *key) {
+  size_t mask = t->capacity - 1;
+  size_t pos = _hm_start(hash, mask);
+  size_t stride = 0;
+  uint8_t tag = _hm_tag(hash);
+
+  for (;;) {
+    const uint8_t *group = t->ctrl + pos;
+    uint32_t m = _hm_group_match(group, tag);
+    while (m) {
+      size_t slot = (pos + (size_t)_hm_ctz(m)) & mask;
+      ChmEntry *e = atomic_load_explicit(&t->slots[slot], memory_order_relaxed);
+      if (e && e->hash == hash && memcmp(e->data, key, map->key_size) == 0) {
+        return slot;
+      }
+      m &= m - 1;
+    }
+    if (_hm_group_match_empty(group)) {
+      return SIZE_MAX;
+    }
+    stride += HASHMAP_GROUP_WIDTH;
+    pos = (pos + stride) & mask;
+  }
+}
+
+// Publishes e in t. The slot pointer goes first so a reader that sees the tag
+// also finds the entry.
+static void _chm_link(ChmTable *t, ChmEntry *e) {
+  size_t mask = t->capacity - 1;
+  size_t slot = _hm_find_free(t->ctrl, mask, e->hash);
+  if (t->ctrl[slot] == HM_CTRL_EMPTY) {
+    t->growth_left--;
+  }
+  atomic_store_explicit(&t->slots[slot], e, memory_order_release);
+  _hm_set_ctrl(t->ctrl, mask, slot, _hm_tag(e->hash));
+}
+
+static void _chm_unlink(ChmTable *t, size_t slot) {
+  _hm_set_ctrl(t->ctrl, t->capacity - 1, slot, HM_CTRL_DELETED);
+  atomic_store_explicit(&t->slots[slot], NULL, memory_order_release);
+}
+
+// Moves up to budget slots of the old table into the current one.
+static void _chm_migrate(ChmShard *s, size_t budget) {
+  ChmTable *old = atomic_load_explicit(&s->old, memory_order_relaxed);
+  if (!old) {
+    return;
+  }
+  ChmTable *t = atomic_load_explicit(&s->table, memory_order_relaxed);
+
+  while (budget-- > 0 && s->migrate_pos < old->capacity) {
+    size_t i = s->migrate_pos++;
+    ChmEntry *e = atomic_load_explicit(&old->slots[i], memory_order_relaxed);
+    if (e) {
+      _chm_link(t, e);
+      _chm_unlink(old, i);
+    }
+  }
+
+  if (s->migrate_pos == old->capacity) {
+    atomic_store_explicit(&s->old, NULL, memory_order_release);
+    arena_add(&s->retired, &old);
+  }
+}
+
+/* Drops the tombstones of t in place (shard locked, no migration running).
+ * Readers probing meanwhile see entries vanish and come back: their hits
+ * fail the slot check and their misses the shard sequence, so they retry. */
+static int _chm_compact(ChmShard *s, ChmTable *t) {
+  size_t live = atomic_load_explicit(&s->count, memory_order_relaxed);
+  ChmEntry **keep = malloc((live ? live : 1) * sizeof(*keep));
+  if (!keep) {
+    return HASHMAP_ERR_ALLOC;
+  }
+  size_t n = 0;
+  for (size_t i = 0; i < t->capacity; i++) {
+    ChmEntry *e = atomic_load_explicit(&t->slots[i], memory_order_relaxed);
+    if (e) {
+      keep[n++] = e;
+      atomic_store_explicit(&t->slots[i], NULL, memory_order_relaxed);
+    }
+  }
+  memset(t->ctrl, HM_CTRL_EMPTY, t->capacity + HASHMAP_GROUP_WIDTH);
+  t->growth_left = t->capacity - t->capacity / 8;
+  for (size_t i = 0; i < n; i++) {
+    _chm_link(t, keep[i]);
+  }
+  free(keep);
+  return HASHMAP_OK;
+}
+
+// Makes room for one more insert into the current table.
+static int _chm_reserve(ChmShard *s) {
+  ChmTable *t = atomic_load_explicit(&s->table, memory_order_relaxed);
+  if (t->growth_left > 0) {
+    return HASHMAP_OK;
+  }
+  // never stack two migrations: finish the running one first
+  _chm_migrate(s, SIZE_MAX);
+  if (t->growth_left > 0) {
+    return HASHMAP_OK;
+  }
+
+  // mostly tombstones: clean up in place, a new table of the same size
+  // could only be retired, never freed, while readers run
+  size_t live = atomic_load_explicit(&s->count, memory_order_relaxed);
+  if (live * 2 < t->capacity - t->capacity / 8) {
+    return _chm_compact(s, t);
+  }
+  ChmTable *next = _chm_table_new(t->capacity * 2);
+  if (!next) {
+    return HASHMAP_ERR_ALLOC;
+  }
+  s->migrate_pos = 0;
+  atomic_store_explicit(&s->old, t, memory_order_release);
+  atomic_store_explicit(&s->table, next, memory_order_release);
+  _chm_migrate(s, CHM_MIGRATE_STEP);
+  return HASHMAP_OK;
+}
+
+static ChmEntry *_chm_entry_new(ChmShard *s) {
+  ChmEntry *e = s->free_entries;
+  if (e) {
+    s->free_entries = e->next_free;
+    return e;
+  }
+  return r_arena_alloc(&s->entries);
+}
+
+int chm_put(ConcurrentHashMap *map, const void *key, const void *value) {
+  if (!map || !key || !value) {
+    return HASHMAP_ERR_NULL;
+  }
+  uint64_t hash = hashmap_hash_bytes(key, map->key_size);
+  ChmShard *s = _chm_shard(map, hash);
+  _chm_lock(s);
+  _chm_migrate(s, CHM_MIGRATE_STEP);
+
+  ChmTable *t = atomic_load_explicit(&s->table, memory_order_relaxed);
+  ChmTable *old = atomic_load_explicit(&s->old, memory_order_relaxed);
+  size_t slot = _chm_find(map, t, hash, key);
+  ChmEntry *e = NULL;
+  if (slot != SIZE_MAX) {
+    e = atomic_load_explicit(&t->slots[slot], memory_order_relaxed);
+  } else if (old && (slot = _chm_find(map, old, hash, key)) != SIZE_MAX) {
+    e = atomic_load_explicit(&old->slots[slot], memory_order_relaxed);
+  }
+
+  if (e) {
+    // update in place, readers retry on the odd sequence
+    uint32_t seq = atomic_load_explicit(&e->seq, memory_order_relaxed);
+    atomic_store_explicit(&e->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(e->data + map->value_offset, value, map->value_size);
+    atomic_store_explicit(&e->seq, seq + 2, memory_order_release);
+    _chm_unlock(s);
+    return HASHMAP_OK;
+  }
+
+  if (_chm_reserve(s) != HASHMAP_OK) {
+    _chm_unlock(s);
+    return HASHMAP_ERR_ALLOC;
+  }
+  e = _chm_entry_new(s);
+  if (!e) {
+    _chm_unlock(s);
+    return HASHMAP_ERR_ALLOC;
+  }
+  uint32_t seq = atomic_load_explicit(&e->seq, memory_order_relaxed);
+  atomic_store_explicit(&e->seq, seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  e->hash = hash;
+  memcpy(e->data, key, map->key_size);
+  memcpy(e->data + map->value_offset, value, map->value_size);
+  atomic_store_explicit(&e->seq, seq + 2, memory_order_release);
+
+  _chm_link(atomic_load_explicit(&s->table, memory_order_relaxed), e);
+  atomic_fetch_add_explicit(&s->count, 1, memory_order_relaxed);
+  _chm_unlock(s);
+  return HASHMAP_OK;
+}
+
+// Reader probe of one table.
+// Returns 1 on a hit (value copied), 0 on a miss, -1 if an entry changed
+// under the reader. A hit is only reported if the entry was still linked
+// in its slot, unchanged, after the value was copied.
+static int _chm_probe(const ConcurrentHashMap *map, const ChmTable *t,
+                      uint64_t hash, const void *key, void *out) {
+  size_t mask = t->capacity - 1;
+  size_t pos = _hm_start(hash, mask);
+  size_t stride = 0;
+  uint8_t tag = _hm_tag(hash);
+
+  for (;;) {
+    const uint8_t *group = t->ctrl + pos;
+    uint32_t m = _hm_group_match(group, tag);
+    while (m) {
+      size_t slot = (pos + (size_t)_hm_ctz(m)) & mask;
+      m &= m - 1;
+      ChmEntry *e = atomic_load_explicit(&t->slots[slot], memory_order_acquire);
+      if (!e) {
+        continue;
+      }
+      uint32_t seq = atomic_load_explicit(&e->seq, memory_order_acquire);
+      if (seq & 1) {
+        return -1;
+      }
+      int match = e->hash == hash && memcmp(e->data, key, map->key_size) == 0;
+      if (match) {
+        memcpy(out, e->data + map->value_offset, map->value_size);
+      }
+      atomic_thread_fence(memory_order_acquire);
+      // a hit racing a remove or a migration: the slot must still hold e
+      if (match &&
+          atomic_load_explicit(&t->slots[slot], memory_order_relaxed) != e) {
+        return -1;
+      }
+      if (atomic_load_explicit(&e->seq, memory_order_relaxed) != seq) {
+        return -1;
+      }
+      if (match) {
+        return 1;
+      }
+    }
+    if (_hm_group_match_empty(group)) {
+      return 0;
+    }
+    stride += HASHMAP_GROUP_WIDTH;
+    if (stride >= t->capacity) {
+      // every group seen without an empty byte: only mid-compaction
+      return -1;
+    }
+    pos = (pos + stride) & mask;
+  }
+}
+
+int chm_get(ConcurrentHashMap *map, const void *key, void *out) {
+  if (!map || !key || !out) {
+    return HASHMAP_ERR_NULL;
+  }
+  uint64_t hash = hashmap_hash_bytes(key, map->key_size);
+  ChmShard *s = _chm_shard(map, hash);
+
+  for (;;) {
+    // optimistic: probe even while a writer is active, validate afterwards
+    uint32_t seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+    // old first: migration links into table before unlinking from old
+    ChmTable *old = atomic_load_explicit(&s->old, memory_order_acquire);
+    ChmTable *t = atomic_load_explicit(&s->table, memory_order_acquire);
+    int r = old ? _chm_probe(map, old, hash, key, out) : 0;
+    if (r == 0) {
+      r = _chm_probe(map, t, hash, key, out);
+    }
+    if (r == 1) {
+      return HASHMAP_OK;
+    }
+    if (r == 0 && !(seq & 1)) {
+      // a miss only counts if no writer ran during the probe
+      atomic_thread_fence(memory_order_acquire);
+      if (atomic_load_explicit(&s->seq, memory_order_relaxed) == seq) {
+        return HASHMAP_ERR_NOT_FOUND;
+      }
+    }
+    cpu_relax();
+  }
+}
+
+int chm_remove(ConcurrentHashMap *map, const void *key) {
+  if (!map || !key) {
+    return HASHMAP_ERR_NULL;
+  }
+  uint64_t hash = hashmap_hash_bytes(key, map->key_size);
+  ChmShard *s = _chm_shard(map, hash);
+  _chm_lock(s);
+  _chm_migrate(s, CHM_MIGRATE_STEP);
+
+  ChmTable *t = atomic_load_explicit(&s->table, memory_order_relaxed);
+  size_t slot = _chm_find(map, t, hash, key);
+  if (slot == SIZE_MAX) {
+    t = atomic_load_explicit(&s->old, memory_order_relaxed);
+    slot = t ? _chm_find(map, t, hash, key) : SIZE_MAX;
+  }
+  if (slot == SIZE_MAX) {
+    _chm_unlock(s);
+    return HASHMAP_ERR_NOT_FOUND;
+  }
+
+  ChmEntry *e = atomic_load_explicit(&t->slots[slot], memory_order_relaxed);
+  _chm_unlink(t, slot);
+  // the contents stay intact until reuse bumps the sequence
+  e->next_free = s->free_entries;
+  s->free_entries = e;
+  atomic_fetch_sub_explicit(&s->count, 1, memory_order_relaxed);
+  _chm_unlock(s);
+  return HASHMAP_OK;
+}
+
+size_t chm_len(ConcurrentHashMap *map) {
+  if (!map) {
+    return 0;
+  }
+  size_t n = 0;
+  for (size_t i = 0; i <= map->shard_mask; i++) {
+    n += atomic_load_explicit(&map->shards[i].count, memory_order_relaxed);
+  }
+  return n;
+}
+
+void chm_destroy(ConcurrentHashMap *map) {
+  if (!map) {
+    return;
+  }
+  for (size_t i = 0; i <= map->shard_mask; i++) {
+    ChmShard *s = &map->shards[i];
+    _chm_table_free(atomic_load_explicit(&s->table, memory_order_relaxed));
+    _chm_table_free(atomic_load_explicit(&s->old, memory_order_relaxed));
+    for (size_t r = 0; r < s->retired.count; r++) {
+      ChmTable *t;
+      memcpy(&t, arena_get(&s->retired, r), sizeof(t));
+      _chm_table_free(t);
+    }
+    arena_free(&s->retired);
+    r_arena_free(&s->entries);
+  }
+  free(map->shards);
+  free(map);
+}
+
+#endif // HASHMAP_IMPLEMENTATION
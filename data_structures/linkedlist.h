@@ -19,43 +19,107 @@
 // OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
 // WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+#ifndef LINKEDLIST_H
+#define LINKEDLIST_H
+
+#include <stdalign.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifndef LL_POOL_CHUNK_NODES
+#define LL_POOL_CHUNK_NODES 64 // nodes per pool chunk
+#endif
+
 typedef struct LlNode_t LlNode;
 
+// The element is stored inline right after the node header; elem points to
+// it.
 typedef struct LlNode_t {
   uintptr_t next;
   uintptr_t prev;
   void *elem;
 } LlNode;
 
+// Freelist pool of nodes with inline elements, carved from chunks of
+// chunk_nodes nodes (one malloc per chunk). Single-threaded; may be shared by
+// several lists with the same elem_size.
+typedef struct LlPool_t {
+  size_t elem_size;
+  size_t node_size;   // header + inline element, rounded up
+  size_t chunk_nodes; // nodes per chunk
+  LlNode *free;       // recycled nodes, linked through next
+  void *chunks;       // every chunk, linked through its first word
+  uint8_t *bump;      // unused part of the newest chunk
+  size_t bump_left;   // nodes left at bump
+} LlPool;
+
 typedef struct LinkedList_t {
   uintptr_t head;
   uintptr_t tail;
   size_t count;
   size_t elem_size;
+  LlPool *pool; // NULL: one malloc per node
 } LinkedList;
 
 #define NODE(ptr) ((LlNode *)ptr)
 
+// Offset of the inline element inside a node.
+#define LL_ELEM_OFFSET                                                         \
+  ((sizeof(LlNode) + alignof(max_align_t) - 1) &                               \
+   ~(alignof(max_align_t) - 1))
+
 /*-----------------------------------------------------------------------------
   linkedlist_new
   Creates a new linked list.
 
   elem_size : size in bytes of each element
 
-  Returns a LinkedList with head/tail initialized.
+  Returns an empty LinkedList.
 
   Notes:
-    - Allocates a dummy node for head/tail.
+    - Each node is one malloc holding the header and the element.
     - Caller must call ll_free to release all memory.
 -----------------------------------------------------------------------------*/
 LinkedList linkedlist_new(size_t elem_size);
 
+/*-----------------------------------------------------------------------------
+  linkedlist_new_pooled
+  Creates a new linked list whose nodes come from pool.
+
+  pool : pointer to a valid LlPool (its elem_size is used)
+
+  Returns an empty LinkedList.
+
+  Notes:
+    - Pushing takes a node from the pool, popping / removing gives it back.
+    - ll_free returns every node to the pool; the pool must outlive the list.
+-----------------------------------------------------------------------------*/
+LinkedList linkedlist_new_pooled(LlPool *pool);
+
+/*-----------------------------------------------------------------------------
+  ll_pool_new
+  Creates a node pool.
+
+  elem_size   : size in bytes of each element
+  chunk_nodes : nodes allocated at once when the pool is empty
+                (0 for LL_POOL_CHUNK_NODES)
+
+  Returns an empty LlPool; no memory is allocated until the first push.
+-----------------------------------------------------------------------------*/
+LlPool ll_pool_new(size_t elem_size, size_t chunk_nodes);
+
+/*-----------------------------------------------------------------------------
+  ll_pool_free
+  Frees every chunk of the pool.
+
+  Notes:
+    - Every list using the pool becomes invalid; no need to ll_free them.
+-----------------------------------------------------------------------------*/
+void ll_pool_free(LlPool *pool);
+
 /*-----------------------------------------------------------------------------
   ll_append / ll_push_front
   Adds an element to the front (head) of the list.
@@ -65,10 +129,10 @@ LinkedList linkedlist_new(size_t elem_size);
 
   Returns:
     - 0  on success
-    - -1 if ll is NULL
+    - -1 if ll is NULL (or node allocation failed)
 
   Notes:
-    - Copies elem_size bytes from elem to newly allocated node.
+    - Copies elem_size bytes from elem into a new node.
     - ll_push_front is an alias for ll_append.
 -----------------------------------------------------------------------------*/
 int ll_append(LinkedList *ll, const void *elem);
@@ -83,10 +147,10 @@ int ll_push_front(LinkedList *ll, const void *elem);
 
   Returns:
     - 0  on success
-    - -1 if ll is NULL
+    - -1 if ll is NULL (or node allocation failed)
 
   Notes:
-    - Copies elem_size bytes from elem to newly allocated node.
+    - Copies elem_size bytes from elem into a new node.
 -----------------------------------------------------------------------------*/
 int ll_push_back(LinkedList *ll, const void *elem);
 
@@ -99,12 +163,12 @@ int ll_push_back(LinkedList *ll, const void *elem);
 
   Returns:
     - 0  on success
-    - -1 if ll->head is NULL
+    - -1 if ll is NULL
     - -2 if list is empty
 
   Notes:
     - Copies elem_size bytes into out.
-    - Frees the node.
+    - Frees the node (or returns it to the pool).
 -----------------------------------------------------------------------------*/
 int ll_pop(LinkedList *ll, void *out);
 int ll_pop_front(LinkedList *ll, void *out);
@@ -118,12 +182,12 @@ int ll_pop_front(LinkedList *ll, void *out);
 
   Returns:
     - 0  on success
-    - -1 if ll->tail is NULL
+    - -1 if ll is NULL
     - -2 if list is empty
 
   Notes:
     - Copies elem_size bytes into out.
-    - Frees the node.
+    - Frees the node (or returns it to the pool).
 -----------------------------------------------------------------------------*/
 int ll_pop_back(LinkedList *ll, void *out);
 
@@ -166,7 +230,7 @@ int ll_is_empty(LinkedList *ll);
 
   Notes:
     - Comparison uses memcmp for elem_size bytes.
-    - Frees node and its element memory.
+    - Frees the node (or returns it to the pool).
 -----------------------------------------------------------------------------*/
 int ll_remove(LinkedList *ll, const void *elem);
 
@@ -241,24 +305,103 @@ int ll_contains_secure(LinkedList *ll, const void *elem);
   ll : pointer to a valid LinkedList
 
   Notes:
-    - Frees every node and its element memory.
+    - Frees every node (or returns them to the pool).
     - After calling, list is empty and count is zero.
 -----------------------------------------------------------------------------*/
 void ll_free(LinkedList *ll);
 
+#endif // !LINKEDLIST_H
+
 #if (defined(LINKEDLIST_IMPLEMENTATION))
+LlPool ll_pool_new(size_t elem_size, size_t chunk_nodes) {
+  LlPool pool;
+  const size_t align = alignof(max_align_t);
+  pool.elem_size = elem_size;
+  pool.node_size = (LL_ELEM_OFFSET + elem_size + align - 1) & ~(align - 1);
+  pool.chunk_nodes = chunk_nodes == 0 ? LL_POOL_CHUNK_NODES : chunk_nodes;
+  pool.free = NULL;
+  pool.chunks = NULL;
+  pool.bump = NULL;
+  pool.bump_left = 0;
+  return pool;
+}
+
+void ll_pool_free(LlPool *pool) {
+  if (!pool)
+    return;
+
+  void *chunk = pool->chunks;
+  while (chunk) {
+    void *prev = *(void **)chunk;
+    free(chunk);
+    chunk = prev;
+  }
+  pool->chunks = NULL;
+  pool->free = NULL;
+  pool->bump = NULL;
+  pool->bump_left = 0;
+}
+
+static LlNode *_ll_pool_take(LlPool *pool) {
+  LlNode *node = pool->free;
+  if (node) {
+    pool->free = NODE(node->next);
+    return node;
+  }
+
+  if (pool->bump_left == 0) {
+    // the first max_align_t slot links the chunks together
+    uint8_t *chunk =
+        malloc(alignof(max_align_t) + pool->chunk_nodes * pool->node_size);
+    if (!chunk)
+      return NULL;
+    *(void **)chunk = pool->chunks;
+    pool->chunks = chunk;
+    pool->bump = chunk + alignof(max_align_t);
+    pool->bump_left = pool->chunk_nodes;
+  }
+
+  node = (LlNode *)pool->bump;
+  pool->bump += pool->node_size;
+  pool->bump_left -= 1;
+  return node;
+}
+
+static LlNode *_ll_node_new(LinkedList *ll, const void *elem) {
+  LlNode *node = ll->pool ? _ll_pool_take(ll->pool)
+                          : malloc(LL_ELEM_OFFSET + ll->elem_size);
+  if (!node)
+    return NULL;
+
+  node->next = 0;
+  node->prev = 0;
+  node->elem = (uint8_t *)node + LL_ELEM_OFFSET;
+  memcpy((uint8_t *)node->elem, (uint8_t *)elem, ll->elem_size);
+  return node;
+}
+
+static void _ll_node_release(LinkedList *ll, LlNode *node) {
+  if (ll->pool) {
+    node->next = (uintptr_t)ll->pool->free;
+    ll->pool->free = node;
+  } else {
+    free(node);
+  }
+}
+
 LinkedList linkedlist_new(size_t elem_size) {
   LinkedList ll;
   ll.elem_size = elem_size;
   ll.count = 0;
+  ll.head = 0;
+  ll.tail = 0;
+  ll.pool = NULL;
+  return ll;
+}
 
-  LlNode *node = malloc(sizeof(LlNode));
-
-  node->next = 0;
-  node->prev = 0;
-  node->elem = NULL;
-  ll.head = (uintptr_t)node;
-  ll.tail = (uintptr_t)node;
+LinkedList linkedlist_new_pooled(LlPool *pool) {
+  LinkedList ll = linkedlist_new(pool ? pool->elem_size : 0);
+  ll.pool = pool;
   return ll;
 }
 
@@ -266,19 +409,16 @@ int ll_push_back(LinkedList *ll, const void *elem) {
   if (!ll)
     return -1;
 
-  if (NODE(ll->tail)->elem == NULL) {
-    NODE(ll->tail)->elem = malloc(ll->elem_size);
-    memcpy((uint8_t *)(NODE(ll->tail)->elem), (uint8_t *)elem, ll->elem_size);
-  } else {
-    LlNode *node_tail = malloc(sizeof(LlNode));
-    node_tail->elem = malloc(ll->elem_size);
-    memcpy((uint8_t *)node_tail->elem, (uint8_t *)elem, ll->elem_size);
+  LlNode *node_tail = _ll_node_new(ll, elem);
+  if (!node_tail)
+    return -1;
 
-    node_tail->next = ll->tail;
-    node_tail->prev = 0;
+  node_tail->next = ll->tail;
+  if (ll->tail != 0)
     NODE(ll->tail)->prev = (uintptr_t)node_tail;
-    ll->tail = (uintptr_t)node_tail;
-  }
+  else
+    ll->head = (uintptr_t)node_tail;
+  ll->tail = (uintptr_t)node_tail;
 
   ll->count += 1;
   return 0;
@@ -288,19 +428,16 @@ int ll_append(LinkedList *ll, const void *elem) {
   if (!ll)
     return -1;
 
-  if (NODE(ll->head)->elem == NULL) {
-    NODE(ll->head)->elem = malloc(ll->elem_size);
-    memcpy((uint8_t *)(NODE(ll->head)->elem), (uint8_t *)elem, ll->elem_size);
-  } else {
-    LlNode *node_head = malloc(sizeof(LlNode));
-    node_head->elem = malloc(ll->elem_size);
-    memcpy((uint8_t *)node_head->elem, (uint8_t *)elem, ll->elem_size);
+  LlNode *node_head = _ll_node_new(ll, elem);
+  if (!node_head)
+    return -1;
 
-    node_head->next = 0;
-    node_head->prev = ll->head;
+  node_head->prev = ll->head;
+  if (ll->head != 0)
     NODE(ll->head)->next = (uintptr_t)node_head;
-    ll->head = (uintptr_t)node_head;
-  }
+  else
+    ll->tail = (uintptr_t)node_head;
+  ll->head = (uintptr_t)node_head;
 
   ll->count += 1;
 
@@ -416,20 +553,19 @@ int ll_remove(LinkedList *ll, const void *elem) {
   LlNode *tail = NODE(ll->tail);
   for (size_t x = 0; x < ll->count; x += 1) {
     if (memcmp((uint8_t *)tail->elem, (uint8_t *)elem, ll->elem_size) == 0) {
-      if (tail->next == 0 && tail->prev == 0) {
+      // prev == 0 is the tail end, next == 0 is the head end
+      if (tail->prev != 0)
         NODE(tail->prev)->next = tail->next;
+      else
+        ll->tail = tail->next;
+
+      if (tail->next != 0)
         NODE(tail->next)->prev = tail->prev;
-      } else if (tail->next == 0 && tail->prev != 0) {
-        NODE(tail->prev)->next = 0;
+      else
         ll->head = tail->prev;
-      } else if (tail->next != 0 && tail->prev == 0) {
-        NODE(tail->next)->prev = 0;
-        ll->tail = tail->next;
-      }
 
       ll->count -= 1;
-      free(tail->elem);
-      free(tail);
+      _ll_node_release(ll, tail);
       return 1;
     } else
       tail = NODE(tail->next);
@@ -439,64 +575,42 @@ int ll_remove(LinkedList *ll, const void *elem) {
 }
 
 int ll_pop(LinkedList *ll, void *out) {
-  if (ll->head == 0)
+  if (!ll)
     return -1;
 
   if (ll_is_empty(ll))
     return -2;
 
   LlNode *detached_head = NODE(ll->head);
-  if (detached_head->prev == 0)
-    ll->head = 0;
-  else {
-    ll->head = detached_head->prev;
+  ll->head = detached_head->prev;
+  if (ll->head == 0)
+    ll->tail = 0;
+  else
     NODE(ll->head)->next = 0;
-  }
 
   memcpy((uint8_t *)out, (uint8_t *)detached_head->elem, ll->elem_size);
-  free(detached_head->elem);
-  free(detached_head);
+  _ll_node_release(ll, detached_head);
   ll->count -= 1;
-
-  if (ll->count == 0) {
-    LlNode *node = malloc(sizeof(LlNode));
-    node->next = 0;
-    node->prev = 0;
-    node->elem = NULL;
-    ll->head = (uintptr_t)node;
-    ll->tail = (uintptr_t)node;
-  }
   return 0;
 }
 
 int ll_pop_back(LinkedList *ll, void *out) {
-  if (ll->tail == 0)
+  if (!ll)
     return -1;
 
   if (ll_is_empty(ll))
     return -2;
 
   LlNode *detached_tail = NODE(ll->tail);
-  if (detached_tail->next == 0)
-    ll->tail = 0;
-  else {
-    ll->tail = detached_tail->next;
+  ll->tail = detached_tail->next;
+  if (ll->tail == 0)
+    ll->head = 0;
+  else
     NODE(ll->tail)->prev = 0;
-  };
 
   memcpy((uint8_t *)out, (uint8_t *)detached_tail->elem, ll->elem_size);
-  free(detached_tail->elem);
-  free(detached_tail);
+  _ll_node_release(ll, detached_tail);
   ll->count -= 1;
-
-  if (ll->count == 0) {
-    LlNode *node = malloc(sizeof(LlNode));
-    node->next = 0;
-    node->prev = 0;
-    node->elem = NULL;
-    ll->head = (uintptr_t)node;
-    ll->tail = (uintptr_t)node;
-  }
   return 0;
 }
 
@@ -508,17 +622,13 @@ void ll_free(LinkedList *ll) {
 
   LlNode *tail = NODE(ll->tail);
   for (size_t x = 0; x < ll->count; x += 1) {
-    if (tail->next != 0) {
-      LlNode *next = NODE(tail->next);
-      free(tail->elem);
-      free(tail);
-      tail = next;
-    } else {
-      free(tail->elem);
-      free(tail);
-    }
+    LlNode *next = NODE(tail->next);
+    _ll_node_release(ll, tail);
+    tail = next;
   }
 
   ll->count = 0;
+  ll->head = 0;
+  ll->tail = 0;
 }
 #endif
@@ -104,6 +104,208 @@ int stack_pop(Stack *s, void *out);
 -----------------------------------------------------------------------------*/
 void stack_free(Stack s);
 
+/*
+------------------------------------------------------------------------------
+LfStack — lock-free Treiber stack, ObjPool — fixed-size object pool
+
+LfStack is an intrusive stack of LfNode that any number of threads may push
+to and pop from. The head packs a 16 bit tag above the 48 bit address of the
+top node. Every push and pop bumps the tag, so a pop that read a stale top
+(the node was popped and pushed back meanwhile) fails its CAS instead of
+installing a stale next pointer (ABA). A whole chain goes on or comes off in
+one CAS (lf_stack_push_chain / lf_stack_pop_all).
+
+ObjPool hands out objects of one size from a block allocated up front,
+following Bonwick's magazine design ("Magazines and Vmem", USENIX 2001):
+
+- Each thread owns an ObjPoolCache holding two magazines (arrays of up to
+  OBJ_POOL_MAGAZINE objects). Gets and puts work on them with plain loads
+  and stores, no atomic operation and no shared cache line.
+- Only when both are empty (get) or full (put) does the cache swap a
+  magazine with the depot: two LfStacks of full and empty magazines, one
+  pop and one push.
+
+USAGE
+
+In exactly ONE source file:
+
+    #define MYSTACK_IMPLEMENTATION
+    #include "stack.h"
+
+    ObjPool *msgs = obj_pool_create(sizeof(Msg), 65536);
+
+Any thread:
+
+    static _Thread_local ObjPoolCache t_msgs;
+    Msg *m = obj_pool_get(msgs, &t_msgs);
+    ...
+    obj_pool_put(msgs, &t_msgs, m); // may be another thread than the getter
+
+Before a thread exits for good:
+
+    obj_pool_cache_flush(msgs, &t_msgs);
+
+------------------------------------------------------------------------------
+*/
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#ifndef CACHELINE_SIZE
+#define CACHELINE_SIZE 64
+#endif
+
+#ifndef OBJ_POOL_MAGAZINE
+#define OBJ_POOL_MAGAZINE 32 // objects per magazine
+#endif
+
+// Link word, embedded in whatever is pushed.
+typedef struct LfNode_t {
+  _Atomic(struct LfNode_t *) next;
+} LfNode;
+
+typedef struct LfStack_t {
+  _Atomic uint64_t head; // tag << 48 | LfNode *, 0 = empty
+} LfStack;
+
+#define LF_STACK_INIT {0}
+
+typedef struct ObjPoolMagazine_t {
+  LfNode node; // link in the depot, first member
+  struct ObjPoolMagazine_t *all; // every magazine of the pool, for destroy
+  size_t count;
+  void *objs[OBJ_POOL_MAGAZINE];
+} ObjPoolMagazine;
+
+typedef struct ObjPool_t {
+  alignas(CACHELINE_SIZE) LfStack full; // magazines holding 1..MAGAZINE objs
+  alignas(CACHELINE_SIZE) LfStack empty; // magazines holding none
+  alignas(CACHELINE_SIZE) _Atomic(ObjPoolMagazine *) mags;
+  unsigned char *objs;
+  size_t obj_size; // rounded up to alignof(max_align_t)
+  size_t capacity;
+  size_t epoch; // unique per pool, caches of another pool are dropped
+} ObjPool;
+
+// Per-thread pool state, zero-initialized before first use.
+typedef struct ObjPoolCache_t {
+  const ObjPool *pool;
+  size_t epoch;
+  ObjPoolMagazine *loaded;   // gets and puts go here first
+  ObjPoolMagazine *previous; // full or empty, swapped in before the depot
+} ObjPoolCache;
+
+/*-----------------------------------------------------------------------------
+  lf_stack_init
+  Initializes an empty stack (same as LF_STACK_INIT).
+-----------------------------------------------------------------------------*/
+void lf_stack_init(LfStack *s);
+
+/*-----------------------------------------------------------------------------
+  lf_stack_push
+  Pushes node. Safe from any thread.
+
+  Notes:
+    - The node belongs to the stack until it is popped again.
+-----------------------------------------------------------------------------*/
+void lf_stack_push(LfStack *s, LfNode *node);
+
+/*-----------------------------------------------------------------------------
+  lf_stack_push_chain
+  Pushes the chain first -> ... -> last (linked through next) in one CAS.
+  first ends up on top. Safe from any thread.
+
+  Notes:
+    - last->next is overwritten, the links before it are left as they are.
+-----------------------------------------------------------------------------*/
+void lf_stack_push_chain(LfStack *s, LfNode *first, LfNode *last);
+
+/*-----------------------------------------------------------------------------
+  lf_stack_pop
+  Pops the top node. Safe from any thread.
+
+  Returns the node, or NULL if the stack is empty.
+
+  Notes:
+    - A pop reads the next link of a node that another thread may have
+      popped meanwhile (the CAS then fails and the value is discarded), so
+      node memory must stay mapped while the stack is in use: recycle nodes,
+      don't free them back to the OS.
+    - The tag has 16 bits: a pop goes wrong only if it is delayed across
+      exactly a multiple of 65536 pushes and pops that bring the same node
+      back on top.
+-----------------------------------------------------------------------------*/
+LfNode *lf_stack_pop(LfStack *s);
+
+/*-----------------------------------------------------------------------------
+  lf_stack_pop_all
+  Takes every node in one CAS. Safe from any thread.
+
+  Returns the former top, the chain is linked through next and ends with
+  NULL (most recently pushed first). NULL if the stack was empty.
+-----------------------------------------------------------------------------*/
+LfNode *lf_stack_pop_all(LfStack *s);
+
+/*-----------------------------------------------------------------------------
+  obj_pool_create
+  Allocates a pool of capacity objects of obj_size bytes each.
+
+  Returns a pointer to ObjPool, NULL if obj_size or capacity is 0 or on
+  allocation failure.
+
+  Notes:
+    - Objects are aligned to alignof(max_align_t), the block to
+      CACHELINE_SIZE. Their contents are not initialized.
+    - All objects start in full magazines in the depot.
+-----------------------------------------------------------------------------*/
+ObjPool *obj_pool_create(size_t obj_size, size_t capacity);
+
+/*-----------------------------------------------------------------------------
+  obj_pool_get
+  Takes one object.
+
+  cache : the calling thread's cache, never shared between threads
+
+  Returns the object, or NULL if pool or cache is NULL or every object is
+  in use (or sitting in other threads' caches).
+
+  Notes:
+    - At most 2 * OBJ_POOL_MAGAZINE objects wait in each thread's cache.
+-----------------------------------------------------------------------------*/
+void *obj_pool_get(ObjPool *pool, ObjPoolCache *cache);
+
+/*-----------------------------------------------------------------------------
+  obj_pool_put
+  Returns an object taken from the same pool, by this or any other thread.
+
+  cache : the calling thread's cache, never shared between threads
+
+  Returns:
+    - 0  on success
+    - -1 if an argument is NULL or a new magazine could not be allocated
+         (the object is not returned)
+
+  Notes:
+    - Empty magazines are allocated on demand once the depot runs out of
+      them (at most two per thread and pool), and freed by obj_pool_destroy.
+-----------------------------------------------------------------------------*/
+int obj_pool_put(ObjPool *pool, ObjPoolCache *cache, void *obj);
+
+/*-----------------------------------------------------------------------------
+  obj_pool_cache_flush
+  Returns the cache's magazines to the depot, so other threads can get the
+  objects in them. Call it before a thread gives up the cache for good.
+-----------------------------------------------------------------------------*/
+void obj_pool_cache_flush(ObjPool *pool, ObjPoolCache *cache);
+
+/*-----------------------------------------------------------------------------
+  obj_pool_destroy
+  Frees the pool, its objects and magazines. No thread may use it or a
+  cache of it afterwards (a zeroed or flushed cache may be reused with
+  another pool).
+-----------------------------------------------------------------------------*/
+void obj_pool_destroy(ObjPool *pool);
+
 #endif // !MYSTACK_H
 
 #if (defined(MYSTACK_IMPLEMENTATION))
@@ -156,4 +358,238 @@ void stack_free(Stack s) {
   s.cap = 0;
   s.sp = NULL;
 };
+
+// the head packs a 16 bit tag above a 48 bit address
+_Static_assert(sizeof(void *) == 8, "LfStack needs 64-bit pointers");
+
+#define LF_STACK_TAG_SHIFT 48
+#define LF_STACK_PTR_MASK ((UINT64_C(1) << LF_STACK_TAG_SHIFT) - 1)
+
+static inline LfNode *_lf_stack_top(uint64_t head) {
+  return (LfNode *)(uintptr_t)(head & LF_STACK_PTR_MASK);
+}
+
+// next head word: the tag of head bumped, pointing at top
+static inline uint64_t _lf_stack_head(uint64_t head, LfNode *top) {
+  return ((head & ~LF_STACK_PTR_MASK) + (UINT64_C(1) << LF_STACK_TAG_SHIFT)) |
+         (uint64_t)(uintptr_t)top;
+}
+
+void lf_stack_init(LfStack *s) { atomic_init(&s->head, 0); }
+
+void lf_stack_push(LfStack *s, LfNode *node) {
+  lf_stack_push_chain(s, node, node);
+}
+
+void lf_stack_push_chain(LfStack *s, LfNode *first, LfNode *last) {
+  uint64_t head = atomic_load_explicit(&s->head, memory_order_relaxed);
+  for (;;) {
+    atomic_store_explicit(&last->next, _lf_stack_top(head),
+                          memory_order_relaxed);
+    if (atomic_compare_exchange_weak_explicit(
+            &s->head, &head, _lf_stack_head(head, first),
+            memory_order_release, memory_order_relaxed)) {
+      return;
+    }
+  }
+}
+
+LfNode *lf_stack_pop(LfStack *s) {
+  uint64_t head = atomic_load_explicit(&s->head, memory_order_acquire);
+  for (;;) {
+    LfNode *top = _lf_stack_top(head);
+    if (!top) {
+      return NULL;
+    }
+    // stale if top was popped meanwhile, the tag makes the CAS fail then
+    LfNode *next = atomic_load_explicit(&top->next, memory_order_relaxed);
+    if (atomic_compare_exchange_weak_explicit(
+            &s->head, &head, _lf_stack_head(head, next),
+            memory_order_acquire, memory_order_acquire)) {
+      return top;
+    }
+  }
+}
+
+LfNode *lf_stack_pop_all(LfStack *s) {
+  uint64_t head = atomic_load_explicit(&s->head, memory_order_acquire);
+  for (;;) {
+    LfNode *top = _lf_stack_top(head);
+    if (!top) {
+      return NULL;
+    }
+    if (atomic_compare_exchange_weak_explicit(
+            &s->head, &head, _lf_stack_head(head, NULL),
+            memory_order_acquire, memory_order_acquire)) {
+      return top;
+    }
+  }
+}
+
+// source of unique epochs across all ObjPools of the process
+static _Atomic size_t g_obj_pool_epochs = 0;
+
+static ObjPoolMagazine *_obj_pool_new_magazine(ObjPool *pool) {
+  ObjPoolMagazine *mag = malloc(sizeof(ObjPoolMagazine));
+  if (!mag) {
+    return NULL;
+  }
+  atomic_init(&mag->node.next, NULL);
+  mag->count = 0;
+  // push-only list, no ABA
+  mag->all = atomic_load_explicit(&pool->mags, memory_order_relaxed);
+  while (!atomic_compare_exchange_weak_explicit(&pool->mags, &mag->all, mag,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)) {
+  }
+  return mag;
+}
+
+// back to the depot, on the stack matching its fill
+static void _obj_pool_release(ObjPool *pool, ObjPoolMagazine *mag) {
+  lf_stack_push(mag->count ? &pool->full : &pool->empty, &mag->node);
+}
+
+ObjPool *obj_pool_create(size_t obj_size, size_t capacity) {
+  if (obj_size == 0 || capacity == 0) {
+    return NULL;
+  }
+  size_t align = alignof(max_align_t);
+  obj_size = (obj_size + align - 1) & ~(align - 1);
+
+  ObjPool *pool = aligned_alloc(CACHELINE_SIZE, sizeof(ObjPool));
+  if (!pool) {
+    return NULL;
+  }
+  size_t bytes = obj_size * capacity;
+  pool->objs = aligned_alloc(
+      CACHELINE_SIZE, (bytes + CACHELINE_SIZE - 1) & ~(size_t)(CACHELINE_SIZE - 1));
+  if (!pool->objs) {
+    free(pool);
+    return NULL;
+  }
+  pool->obj_size = obj_size;
+  pool->capacity = capacity;
+  pool->epoch =
+      atomic_fetch_add_explicit(&g_obj_pool_epochs, 1, memory_order_relaxed) +
+      1;
+  lf_stack_init(&pool->full);
+  lf_stack_init(&pool->empty);
+  atomic_init(&pool->mags, NULL);
+
+  // fill full magazines, from the end so the first get returns objs[0]
+  size_t i = capacity;
+  while (i > 0) {
+    ObjPoolMagazine *mag = _obj_pool_new_magazine(pool);
+    if (!mag) {
+      obj_pool_destroy(pool);
+      return NULL;
+    }
+    for (; i > 0 && mag->count < OBJ_POOL_MAGAZINE; i--) {
+      mag->objs[mag->count++] = pool->objs + (i - 1) * obj_size;
+    }
+    lf_stack_push(&pool->full, &mag->node);
+  }
+  return pool;
+}
+
+static inline void _obj_pool_bind(ObjPool *pool, ObjPoolCache *cache) {
+  if (cache->pool != pool || cache->epoch != pool->epoch) {
+    // magazines of another pool (or none yet): forget them
+    cache->pool = pool;
+    cache->epoch = pool->epoch;
+    cache->loaded = NULL;
+    cache->previous = NULL;
+  }
+}
+
+static inline void _obj_pool_swap(ObjPoolCache *cache) {
+  ObjPoolMagazine *mag = cache->loaded;
+  cache->loaded = cache->previous;
+  cache->previous = mag;
+}
+
+void *obj_pool_get(ObjPool *pool, ObjPoolCache *cache) {
+  if (!pool || !cache) {
+    return NULL;
+  }
+  _obj_pool_bind(pool, cache);
+  ObjPoolMagazine *mag = cache->loaded;
+  if (!mag || mag->count == 0) {
+    if (cache->previous && cache->previous->count) {
+      _obj_pool_swap(cache);
+    } else {
+      // slow path: trade the empty previous magazine for a full one
+      ObjPoolMagazine *full = (ObjPoolMagazine *)lf_stack_pop(&pool->full);
+      if (!full) {
+        return NULL;
+      }
+      if (cache->previous) {
+        _obj_pool_release(pool, cache->previous);
+      }
+      cache->previous = cache->loaded;
+      cache->loaded = full;
+    }
+    mag = cache->loaded;
+  }
+  return mag->objs[--mag->count];
+}
+
+int obj_pool_put(ObjPool *pool, ObjPoolCache *cache, void *obj) {
+  if (!pool || !cache || !obj) {
+    return -1;
+  }
+  _obj_pool_bind(pool, cache);
+  ObjPoolMagazine *mag = cache->loaded;
+  if (!mag || mag->count == OBJ_POOL_MAGAZINE) {
+    if (cache->previous && cache->previous->count < OBJ_POOL_MAGAZINE) {
+      _obj_pool_swap(cache);
+    } else {
+      // slow path: trade the full previous magazine for an empty one
+      ObjPoolMagazine *empty = (ObjPoolMagazine *)lf_stack_pop(&pool->empty);
+      if (!empty && !(empty = _obj_pool_new_magazine(pool))) {
+        return -1;
+      }
+      if (cache->previous) {
+        _obj_pool_release(pool, cache->previous);
+      }
+      cache->previous = cache->loaded;
+      cache->loaded = empty;
+    }
+    mag = cache->loaded;
+  }
+  mag->objs[mag->count++] = obj;
+  return 0;
+}
+
+void obj_pool_cache_flush(ObjPool *pool, ObjPoolCache *cache) {
+  if (!pool || !cache) {
+    return;
+  }
+  if (cache->pool == pool && cache->epoch == pool->epoch) {
+    if (cache->loaded) {
+      _obj_pool_release(pool, cache->loaded);
+    }
+    if (cache->previous) {
+      _obj_pool_release(pool, cache->previous);
+    }
+  }
+  cache->pool = NULL;
+  cache->loaded = NULL;
+  cache->previous = NULL;
+}
+
+void obj_pool_destroy(ObjPool *pool) {
+  if (!pool) {
+    return;
+  }
+  ObjPoolMagazine *mag = atomic_load_explicit(&pool->mags, memory_order_acquire);
+  while (mag) {
+    ObjPoolMagazine *next = mag->all;
+    free(mag);
+    mag = next;
+  }
+  free(pool->objs);
+  free(pool);
+}
 #endif
@@ -0,0 +1,259 @@
+// Copyright 2025 Seaker <seakerone@proton.me>
+
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+/*
+------------------------------------------------------------------------------
+ws_deque.h — Chase-Lev work-stealing deque
+
+Fixed-capacity, lock-free deque of pointers with one owner and many thieves.
+
+- The owner thread pushes and pops at the bottom (LIFO, cache-hot).
+- Any other thread may steal from the top (FIFO, oldest work first).
+
+The implementation follows "Correct and Efficient Work-Stealing for Weak
+Memory Models" (Le, Pop, Cohen, Zappa Nardelli — PPoPP 2013), without the
+growable buffer: when the deque is full, push fails and the caller decides
+where the work goes instead (e.g. a shared injection queue).
+
+------------------------------------------------------------------------------
+USAGE
+
+In exactly ONE source file:
+
+    #define WS_DEQUE_IMPLEMENTATION
+    #include "ws_deque.h"
+
+Owner thread:
+
+    WsDeque *q = ws_deque_new(1024);
+    ws_deque_push(q, job);
+    void *job;
+    if (ws_deque_pop(q, &job) == 0) { ... }
+
+Thief threads:
+
+    void *job;
+    if (ws_deque_steal(q, &job) == 0) { ... }
+
+------------------------------------------------------------------------------
+RETURN CODES
+
+    WS_DEQUE_OK          Operation succeeded
+    WS_DEQUE_ERR_NULL    q is NULL
+    WS_DEQUE_ERR_EMPTY   Deque is empty (pop, steal)
+    WS_DEQUE_ERR_ABORT   Steal lost a race, retry or pick another victim
+    WS_DEQUE_ERR_FULL    Deque is full (push)
+
+------------------------------------------------------------------------------
+*/
+#ifndef WS_DEQUE_H
+#define WS_DEQUE_H
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef CACHELINE_SIZE
+#define CACHELINE_SIZE 64
+#endif
+
+#define WS_DEQUE_OK 0
+#define WS_DEQUE_ERR_NULL -1
+#define WS_DEQUE_ERR_EMPTY -2
+#define WS_DEQUE_ERR_ABORT -3
+#define WS_DEQUE_ERR_FULL -4
+
+typedef struct WsDeque_t {
+  alignas(CACHELINE_SIZE) _Atomic int64_t top; // thieves side
+  alignas(CACHELINE_SIZE) _Atomic int64_t bottom; // owner side
+
+  alignas(CACHELINE_SIZE) _Atomic(void *) *items;
+  size_t mask; // capacity - 1 (capacity is a power of two)
+} WsDeque;
+
+/*-----------------------------------------------------------------------------
+  ws_deque_new
+  Allocates a new work-stealing deque.
+
+  cap : requested capacity (rounded up to the next power of two)
+
+  Returns a pointer to WsDeque on success, NULL on allocation failure.
+-----------------------------------------------------------------------------*/
+WsDeque *ws_deque_new(size_t cap);
+
+/*-----------------------------------------------------------------------------
+  ws_deque_push
+  Pushes an item at the bottom of the deque. Owner thread only.
+
+  Returns:
+    - 0  on success
+    - -1 if q is NULL
+    - -4 if the deque is full
+-----------------------------------------------------------------------------*/
+int ws_deque_push(WsDeque *q, void *item);
+
+/*-----------------------------------------------------------------------------
+  ws_deque_pop
+  Pops the most recently pushed item from the bottom. Owner thread only.
+
+  Returns:
+    - 0  on success (item written to out)
+    - -1 if q is NULL
+    - -2 if the deque is empty (or the last item was lost to a thief)
+-----------------------------------------------------------------------------*/
+int ws_deque_pop(WsDeque *q, void **out);
+
+/*-----------------------------------------------------------------------------
+  ws_deque_steal
+  Steals the oldest item from the top. Safe from any thread.
+
+  Returns:
+    - 0  on success (item written to out)
+    - -1 if q is NULL
+    - -2 if the deque is empty
+    - -3 if the steal lost a race (caller may retry or pick another victim)
+-----------------------------------------------------------------------------*/
+int ws_deque_steal(WsDeque *q, void **out);
+
+/*-----------------------------------------------------------------------------
+  ws_deque_size
+  Returns an approximate number of items in the deque.
+
+  Notes:
+    - Only a snapshot; may be stale by the time it is read.
+-----------------------------------------------------------------------------*/
+size_t ws_deque_size(WsDeque *q);
+
+/*-----------------------------------------------------------------------------
+  ws_deque_free
+  Frees the deque. No thread may use it afterwards.
+-----------------------------------------------------------------------------*/
+void ws_deque_free(WsDeque *q);
+
+#endif // !WS_DEQUE_H
+
+#if (defined(WS_DEQUE_IMPLEMENTATION))
+#include <stdlib.h>
+
+WsDeque *ws_deque_new(size_t cap) {
+  size_t real_cap = 2;
+  while (real_cap < cap) {
+    real_cap <<= 1;
+  }
+
+  WsDeque *q = aligned_alloc(CACHELINE_SIZE, sizeof(WsDeque));
+  if (!q) {
+    return NULL;
+  }
+
+  q->items = calloc(real_cap, sizeof(*q->items));
+  if (!q->items) {
+    free(q);
+    return NULL;
+  }
+  q->mask = real_cap - 1;
+  atomic_init(&q->top, 0);
+  atomic_init(&q->bottom, 0);
+  return q;
+}
+
+int ws_deque_push(WsDeque *q, void *item) {
+  if (!q) {
+    return WS_DEQUE_ERR_NULL;
+  }
+  int64_t b = atomic_load_explicit(&q->bottom, memory_order_relaxed);
+  int64_t t = atomic_load_explicit(&q->top, memory_order_acquire);
+  if ((size_t)(b - t) > q->mask) {
+    return WS_DEQUE_ERR_FULL;
+  }
+
+  atomic_store_explicit(&q->items[(size_t)b & q->mask], item,
+                        memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+  return WS_DEQUE_OK;
+}
+
+int ws_deque_pop(WsDeque *q, void **out) {
+  if (!q) {
+    return WS_DEQUE_ERR_NULL;
+  }
+  int64_t b = atomic_load_explicit(&q->bottom, memory_order_relaxed) - 1;
+  atomic_store_explicit(&q->bottom, b, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  int64_t t = atomic_load_explicit(&q->top, memory_order_relaxed);
+
+  if (t > b) {
+    // empty
+    atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+    return WS_DEQUE_ERR_EMPTY;
+  }
+
+  void *item =
+      atomic_load_explicit(&q->items[(size_t)b & q->mask], memory_order_relaxed);
+  if (t == b) {
+    // last item, race against thieves
+    int won = atomic_compare_exchange_strong_explicit(
+        &q->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+    atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+    if (!won) {
+      return WS_DEQUE_ERR_EMPTY;
+    }
+  }
+  *out = item;
+  return WS_DEQUE_OK;
+}
+
+int ws_deque_steal(WsDeque *q, void **out) {
+  if (!q) {
+    return WS_DEQUE_ERR_NULL;
+  }
+  int64_t t = atomic_load_explicit(&q->top, memory_order_acquire);
+  atomic_thread_fence(memory_order_seq_cst);
+  int64_t b = atomic_load_explicit(&q->bottom, memory_order_acquire);
+  if (t >= b) {
+    return WS_DEQUE_ERR_EMPTY;
+  }
+
+  void *item =
+      atomic_load_explicit(&q->items[(size_t)t & q->mask], memory_order_relaxed);
+  if (!atomic_compare_exchange_strong_explicit(
+          &q->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+    return WS_DEQUE_ERR_ABORT;
+  }
+  *out = item;
+  return WS_DEQUE_OK;
+}
+
+size_t ws_deque_size(WsDeque *q) {
+  int64_t b = atomic_load_explicit(&q->bottom, memory_order_relaxed);
+  int64_t t = atomic_load_explicit(&q->top, memory_order_relaxed);
+  return b > t ? (size_t)(b - t) : 0;
+}
+
+void ws_deque_free(WsDeque *q) {
+  if (!q) {
+    return;
+  }
+  free(q->items);
+  free(q);
+}
+#endif
@@ -29,9 +29,16 @@ channels, and JobHandles.
 Features:
   - Spawn independent jobs
   - Support for dependent jobs (job_then, job_chain, job_chain_arr)
+  - Fan-in / fan-out dependency graphs (job_depends_on)
+  - Job counters, job_wait_for runs other jobs while it waits
+  - Job priorities (job_spawn_prio), optional workers reserved for high
+  - Reusable job graphs, re-run without allocating (job_graph_*)
   - Compatible with WaitGroups
-  - Automatic arena reset when job count nears max capacity
+  - Job handles recycled one by one (per-thread free lists, generation
+    counters), no global pause and a steady memory footprint
   - Lock-free scheduling with atomic counters
+  - Optional work-stealing mode (per-worker Chase-Lev deques)
+  - Parallel loops (job_parallel_for, job_parallel_reduce)
 
 Typical usage:
   1. Initialize ThreadPool and Scheduler:
@@ -60,6 +67,17 @@ CONSTANTS
 JOB_SCHEDULER_REGION_CAPACITY : Arena region size (4096)
 JOB_SCHEDULER_MAX_REGIONS     : Maximum regions (1024)
 JOB_SCHEDULER_MAX_JOBS        : Maximum jobs = CAPACITY * MAX_REGIONS
+JOB_SCHEDULER_LOCAL_QUEUE_CAPACITY : Per-worker deque size (4096),
+                                     work-stealing mode only
+JOB_SCHEDULER_PRIO_QUEUE_CAPACITY : High / low priority queue size (65536)
+JOB_SCHEDULER_STARVATION_LIMIT    : Picks a lower level may be skipped
+                                    before it is checked first once (64)
+JOB_SCHEDULER_SLOT_CACHE      : Free slots a thread keeps before handing
+                                them back to the shared list (256)
+JOB_SCHEDULER_SLOT_BATCH      : Free slots a thread takes from the shared
+                                list at once (64)
+JOB_GRAPH_REGION_CAPACITY     : Graph nodes / edges per region (256)
+JOB_GRAPH_MAX_REGIONS         : Maximum regions per graph (1024)
 
 ===========================================================================
 MAIN TYPES
@@ -67,22 +85,38 @@ MAIN TYPES
 
 Scheduler:
   - ThreadPool *threadpool          : pointer to internal thread pool
-  - _Atomic uint8_t accepting_jobs  : 0 = not accepting, 1 = accepting
-  - _Atomic size_t active_jobs      : number of active jobs
-  - _Atomic size_t jobs_completed_epoch : jobs executed since last reset
-  - RegionArena job_arena           : arena storing JobHandles
+  - JobSlotPool pools[2]            : JobHandles / small slots (extra
+                                      dependency edges, parallel-for ranges),
+                                      each an arena plus a shared free list
+  - size_t instance                 : tells per-thread caches of an earlier
+                                      scheduler apart
 
 JobHandle:
+  - _Atomic uint64_t state         : generation << 32 | unfinished
+                                     (1 + parents still pending, 0 once run)
+  - _Atomic uint64_t successors    : jobs released when this one finishes,
+                                     tagged with the generation
   - __job_handle Job               : function to execute
   - void *ctx                      : user-provided context pointer
-  - _Atomic size_t unfinished      : counter for dependencies
-  - JobHandle *continuation        : pointer to dependent job
+  - JobCounter *done               : job_counter_done after the job ran
+                                     (or NULL)
+  - JobEdge link                   : edge for the first parent, so linear
+                                     chains need no allocation
+
+JobGraph:
+  - reusable set of nodes and edges, see job_graph_*
 
 ThreadPool:
   - Array of worker threads
   - Each worker consumes jobs from an MPMC channel
   - Runs jobs and schedules dependent continuations
 
+JobSchedulerMode:
+  - JOB_SCHEDULER_SHARED        : every worker pops from one MPMC channel
+  - JOB_SCHEDULER_WORK_STEALING : every worker owns a Chase-Lev deque,
+                                  the MPMC channel is only an injection
+                                  queue for jobs submitted from outside
+
 ===========================================================================
 MAIN FUNCTIONS
 ===========================================================================
@@ -91,6 +125,17 @@ ThreadPool *threadpool_init_for_scheduler(size_t num_threads)
   - Creates a thread pool for the scheduler
   - Initializes lock-free MPMC channels for job dispatch
 
+ThreadPool *threadpool_init_for_scheduler_opts(size_t num_threads,
+                                               const JobSchedulerOptions *opts)
+  - Same as above, with explicit options (NULL = defaults)
+  - opts->mode selects JOB_SCHEDULER_SHARED or JOB_SCHEDULER_WORK_STEALING
+  - opts->wait selects how idle workers wait: spin, yield, or park on a
+    futex until a job is scheduled (CHANNEL_WAIT_PARK)
+  - opts->reserved_high_workers reserves the first workers for
+    JOB_PRIO_HIGH jobs (at least one worker stays unreserved)
+  - opts->cpus pins the workers, opts->memory allocates the job queues and
+    the scheduler's arenas (e.g. huge pages bound to the workers' node)
+
 void job_scheduler_spawn(ThreadPool *threadpool)
   - Initializes the global scheduler (g_scheduler)
   - Allocates internal arena for JobHandles
@@ -100,34 +145,78 @@ void job_scheduler_shutdown(void)
   - Frees internal arena memory
 
 JobHandle *job_spawn(__job_handle fn, void *ctx)
-  - Creates a JobHandle
+JobHandle *job_spawn_prio(__job_handle fn, void *ctx, JobPriority prio)
+  - Creates a JobHandle (job_spawn: JOB_PRIO_NORMAL)
   - Job is not executed immediately; it can be scheduled using:
       - job_then
       - job_chain / job_chain_arr
       - job_wait
+  - The handle is valid until the job has run, its slot is reused after
 
-void job_then(JobHandle *first, JobHandle *then)
+int job_then(JobHandle *first, JobHandle *then)
   - Schedules `then` to execute **after** `first` finishes
+  - -1 if `then` already has a parent and no edge can be allocated for
+    this one, nothing is linked or scheduled then (0 on success)
 
-void job_chain(size_t num_jobs, ...)
+int job_chain(size_t num_jobs, ...)
   - Creates a sequential chain of jobs using variadic arguments
 
-void job_chain_arr(size_t num_jobs, JobHandle **job_list)
+int job_chain_arr(size_t num_jobs, JobHandle **job_list)
   - Creates a sequential chain of jobs using an array
+  - Both return -1 like job_then: the chain is linked and scheduled whole
+    or not at all
 
 void job_wait(JobHandle *job)
   - Schedules the job for execution immediately
   - Can be used for independent jobs or as the root of a chain
 
+int job_depends_on(JobHandle *job, JobHandle **parents, size_t n)
+int job_depends_on_refs(JobHandle *job, const JobRef *parents, size_t n)
+  - job runs after every parent finished, the last parent schedules it
+  - -1 when the edges can't be allocated, nothing is linked then
+
+JobRef job_ref(JobHandle *job) / int job_ref_stale(JobRef ref)
+  - Handle + generation, stays meaningful after the slot was recycled
+
+JobHandle *job_spawn_counted(__job_handle fn, void *ctx, JobCounter *c)
+void job_wait_for(JobCounter *c)
+  - job_wait_for blocks until every job counted on c has run; a worker
+    runs other jobs meanwhile, other threads spin then sleep on a futex
+
+JobGraph *job_graph_create(void) / job_graph_add / job_graph_depends_on
+  - Builds a graph once; job_graph_run / job_graph_wait re-issue it
+
 ===========================================================================
 IMPORTANT NOTES
 ===========================================================================
 - All internal counters are atomic for lock-free thread safety.
-- Scheduler performs automatic health checks to reset the arena
-  when the job count approaches JOB_SCHEDULER_MAX_JOBS.
-- JobHandle::unfinished ensures proper synchronization of dependent jobs.
-- job_then / job_chain increment and decrement unfinished correctly.
+- A JobHandle is valid from job_spawn until its job has run, then the slot
+  goes back to a free list and is reused by a later job_spawn. Every reuse
+  bumps the handle's generation: queue entries and successor lists carry it,
+  so a stale entry is dropped instead of running the new job.
+- Free slots are cached per thread (JOB_SCHEDULER_SLOT_CACHE), a full cache
+  moves to a shared list that other threads refill from, the arenas only
+  grow when every list is empty. Fresh slots come from a per-thread chunk
+  (arenas/tl_arena.h), so neither path does an atomic per job. Memory
+  follows the peak number of live jobs, there is no reset and no pause.
+- Requires arenas/tl_arena.h (TL_ARENA_IMPLEMENTATION) after r_arena.h.
+- The unfinished count ensures proper synchronization of dependent jobs:
+  each parent holds one count, the parent that brings it back to 1 schedules
+  the job, and running it takes 1 -> 0 so it runs at most once.
+- A finished job closes its successor list; edges added later see the
+  parent as already done.
 - Uses RegionArena to reduce malloc/free overhead.
+- Work-stealing mode:
+    - Jobs scheduled from a worker (job_wait, job_then, continuations)
+      go to that worker's local deque; idle workers steal from random
+      victims.
+    - Jobs scheduled from any other thread go to the injection queue.
+    - If a local deque is full, the job falls back to the injection queue.
+    - Requires ws_deque.h (WS_DEQUE_IMPLEMENTATION) and mpmc_try_recv.
+- Priorities: high and low jobs go to their own MPMC queue, normal jobs
+  take the path above. Workers take high, normal, then low; a level
+  skipped for JOB_SCHEDULER_STARVATION_LIMIT picks in a row is looked at
+  first once (normal and low each keep their own count).
 
 ===========================================================================
 USAGE EXAMPLE
@@ -135,10 +224,14 @@ USAGE EXAMPLE
 
 #define REGION_ARENA_IMPLEMENTATION
 #include "./arenas/r_arena.h"
+#define TL_ARENA_IMPLEMENTATION
+#include "./arenas/tl_arena.h"
 #define CHANNEL_BASICS_IMPLEMENTATION
 #include "channels/channels.h"
 #define MPMC_IMPLEMENTATION
 #include "channels/mpmc.h"
+#define WS_DEQUE_IMPLEMENTATION
+#include "data_structures/ws_deque.h"
 #define THREADPOOL_IMPLEMENTATION
 #include "threadpool/threadpool.h"
 #define JOBSYSTEM_IMPLEMENTATION
@@ -243,13 +336,45 @@ job_scheduler_shutdown();
 typedef struct ThreadPool_t ThreadPool;
 
 #include <stddef.h>
+#include <stdint.h>
 
 #define JOB_SCHEDULER_REGION_CAPACITY 4096
 #define JOB_SCHEDULER_MAX_REGIONS 1024
 #define JOB_SCHEDULER_MAX_JOBS                                                 \
   (JOB_SCHEDULER_REGION_CAPACITY * JOB_SCHEDULER_MAX_REGIONS)
+#define JOB_SCHEDULER_LOCAL_QUEUE_CAPACITY 4096
+#define JOB_SCHEDULER_PRIO_QUEUE_CAPACITY 65536
+#define JOB_SCHEDULER_STARVATION_LIMIT 64
+#define JOB_SCHEDULER_SLOT_CACHE 256
+#define JOB_SCHEDULER_SLOT_BATCH 64
+#define JOB_GRAPH_REGION_CAPACITY 256
+#define JOB_GRAPH_MAX_REGIONS 1024
+
+typedef enum {
+  JOB_SCHEDULER_SHARED = 0,       // one MPMC channel shared by all workers
+  JOB_SCHEDULER_WORK_STEALING = 1 // per-worker deques + injection channel
+} JobSchedulerMode;
+
+typedef enum {
+  JOB_PRIO_NORMAL = 0, // default, local deques in work-stealing mode
+  JOB_PRIO_HIGH = 1,   // taken before anything else
+  JOB_PRIO_LOW = 2     // background work, taken when nothing else is ready
+} JobPriority;
+
+typedef struct JobSchedulerOptions_t {
+  JobSchedulerMode mode;
+  ChanWaitStrategy wait; // how idle workers wait (CHANNEL_WAIT_SPIN default)
+  size_t reserved_high_workers; // leading workers running only JOB_PRIO_HIGH
+  const int *cpus; // worker i pinned to cpus[i % num_cpus], NULL = none
+  size_t num_cpus;
+  // job queues and job arenas allocator (NULL = default), must outlive the
+  // scheduler; e.g. huge pages on the node of cpus (arenas/page_alloc.h)
+  const MemBackend *memory;
+} JobSchedulerOptions;
 
 ThreadPool *threadpool_init_for_scheduler(size_t num_threads);
+ThreadPool *threadpool_init_for_scheduler_opts(size_t num_threads,
+                                               const JobSchedulerOptions *opts);
 
 typedef struct JobHandle_t JobHandle;
 
@@ -262,11 +387,205 @@ void job_scheduler_spawn(ThreadPool *threadpool);
 void job_scheduler_shutdown(void);
 
 JobHandle *job_spawn(__job_handle fn, void *ctx);
-void job_chain(size_t num_jobs, ...);
-void job_chain_arr(size_t num_jobs, JobHandle **job_list);
-void job_then(JobHandle *first, JobHandle *then);
+JobHandle *job_spawn_prio(__job_handle fn, void *ctx, JobPriority prio);
+int job_chain(size_t num_jobs, ...);
+int job_chain_arr(size_t num_jobs, JobHandle **job_list);
+int job_then(JobHandle *first, JobHandle *then);
 void job_wait(JobHandle *job);
 
+// set in JobCounter::value while a thread sleeps on it
+#define JOB_COUNTER_SLEEPERS 0x80000000u
+
+/*-----------------------------------------------------------------------------
+  JobCounter
+  Count of outstanding work that threads can wait on with job_wait_for.
+
+  value : pending count in the low 31 bits, JOB_COUNTER_SLEEPERS when a
+          thread sleeps on the futex; it is also the futex word, so the
+          final job_counter_done never touches the counter after waking
+
+  Notes:
+    - A counter may live on the waiter's stack: once job_wait_for returned
+      no job touches it again.
+-----------------------------------------------------------------------------*/
+typedef struct JobCounter_t {
+  _Atomic uint32_t value;
+} JobCounter;
+
+void job_counter_init(JobCounter *counter, uint32_t value);
+void job_counter_add(JobCounter *counter, uint32_t n);
+void job_counter_done(JobCounter *counter);
+uint32_t job_counter_value(JobCounter *counter);
+
+/*-----------------------------------------------------------------------------
+  job_spawn_counted
+  Like job_spawn; adds 1 to counter now and calls job_counter_done(counter)
+  once the job has run. The job is scheduled as usual (job_wait, ...).
+-----------------------------------------------------------------------------*/
+JobHandle *job_spawn_counted(__job_handle fn, void *ctx, JobCounter *counter);
+
+/*-----------------------------------------------------------------------------
+  job_wait_for
+  Blocks until counter reaches 0.
+
+  Notes:
+    - On a scheduler worker, keeps running other ready jobs while it waits:
+      a job can wait on work it spawned without tying up its thread, and
+      nested waits can't deadlock a small pool.
+    - On any other thread, spins, yields, then sleeps on a futex.
+-----------------------------------------------------------------------------*/
+void job_wait_for(JobCounter *counter);
+
+/*-----------------------------------------------------------------------------
+  job_depends_on
+  Makes job run only after every job in parents has finished.
+
+  job     : dependent job, not yet scheduled
+  parents : jobs that must finish first (scheduled or not)
+  n       : number of parents
+
+  Notes:
+    - The last parent to finish schedules job from its worker. Never call
+      job_wait on job as well: it may already have run by then, and its
+      recycled handle belong to an unrelated job.
+    - Parents that already finished count as done; when every parent has
+      already finished, job is scheduled right away.
+    - A parent handle is only valid until that job ran. When a parent may
+      be done by now, take a JobRef while it is valid and use
+      job_depends_on_refs.
+    - Declare all parents of a job before the last one can finish.
+    - The first dependency of a job is stored inside its handle, every
+      further one takes a small slot of the scheduler.
+
+  Returns:
+    - 0  on success
+    - -1 if job or parents is NULL, or the scheduler ran out of slots for
+         the edges (nothing was linked, job is left as it was)
+-----------------------------------------------------------------------------*/
+int job_depends_on(JobHandle *job, JobHandle **parents, size_t n);
+
+/*-----------------------------------------------------------------------------
+  JobRef
+  A JobHandle together with its generation at the time it was taken.
+
+  Job handles are recycled once their job ran; the generation is bumped on
+  every reuse, so a JobRef keeps telling whether *its* job finished even
+  after the slot went to another job.
+
+  job_ref       : takes a reference, job must still be valid
+  job_ref_stale : 1 once the referenced job finished (the slot may hold
+                  another job by now), 0 while it is pending or running
+
+  Notes:
+    - Graph nodes are never recycled: a reference to one goes stale when
+      the node finished and becomes valid again on the next job_graph_run.
+    - Generations are compared on 16 bits inside queues and successor
+      lists: a reference must not be kept across 65536 reuses of its slot.
+-----------------------------------------------------------------------------*/
+typedef struct JobRef_t {
+  JobHandle *job;
+  uint32_t gen;
+} JobRef;
+
+JobRef job_ref(JobHandle *job);
+int job_ref_stale(JobRef ref);
+
+/*-----------------------------------------------------------------------------
+  job_depends_on_refs
+  Like job_depends_on, with parents given as JobRefs: a parent that already
+  finished counts as done even when its handle was recycled since.
+
+  Returns 0 on success, -1 like job_depends_on.
+-----------------------------------------------------------------------------*/
+int job_depends_on_refs(JobHandle *job, const JobRef *parents, size_t n);
+
+typedef struct JobGraph_t JobGraph;
+
+/*-----------------------------------------------------------------------------
+  job_graph_create / job_graph_add / job_graph_depends_on
+  Builds a job graph that can be run many times (e.g. once per frame).
+
+  Nodes and edges are owned by the graph, running it again allocates
+  nothing. The returned handles belong to the graph: use them only with
+  job_graph_depends_on, never with job_wait / job_then / job_depends_on.
+
+  Returns NULL (create / add) or -1 (depends_on) on invalid arguments or
+  when the graph's arenas can't allocate; a failed depends_on adds none of
+  its edges.
+-----------------------------------------------------------------------------*/
+JobGraph *job_graph_create(void);
+JobHandle *job_graph_add(JobGraph *graph, __job_handle fn, void *ctx);
+int job_graph_depends_on(JobGraph *graph, JobHandle *node, JobHandle **parents,
+                         size_t n);
+
+/*-----------------------------------------------------------------------------
+  job_graph_run / job_graph_wait
+  job_graph_run schedules every node without parents and returns; the other
+  nodes are scheduled by their last parent. job_graph_wait blocks until
+  every node of the current run has finished (on a worker it keeps running
+  other jobs meanwhile).
+
+  Notes:
+    - A graph must not be run again before the previous run finished.
+-----------------------------------------------------------------------------*/
+void job_graph_run(JobGraph *graph);
+void job_graph_wait(JobGraph *graph);
+
+/*-----------------------------------------------------------------------------
+  job_graph_free
+  Frees the graph, its nodes and edges. It must not be running.
+-----------------------------------------------------------------------------*/
+void job_graph_free(JobGraph *graph);
+
+typedef void (*job_range_fn)(size_t begin, size_t end, void *ctx);
+typedef void (*job_reduce_fn)(size_t begin, size_t end, void *acc, void *ctx);
+typedef void (*job_combine_fn)(void *into, const void *from, void *ctx);
+
+/*-----------------------------------------------------------------------------
+  job_parallel_for
+  Runs fn over [begin, end) on the scheduler and returns once every index has
+  been processed.
+
+  begin, end : half-open index range
+  grain      : largest range handed to one fn call (0 = pick one from the
+               number of workers)
+  fn         : called as fn(chunk_begin, chunk_end, ctx), concurrently
+  ctx        : user context passed to fn
+
+  Notes:
+    - The range is split recursively: every split schedules the upper half
+      as a job and keeps the lower half, so idle workers steal the largest
+      pieces first.
+    - Chunk contexts are recycled scheduler slots, no malloc.
+    - The calling thread runs chunks too. Called from inside a job, the
+      worker keeps running other jobs while it waits, so nesting is safe.
+-----------------------------------------------------------------------------*/
+void job_parallel_for(size_t begin, size_t end, size_t grain, job_range_fn fn,
+                      void *ctx);
+
+/*-----------------------------------------------------------------------------
+  job_parallel_reduce
+  Like job_parallel_for, folding [begin, end) into a single acc_size value.
+
+  identity : acc_size bytes every partial accumulator starts from
+  fn       : fn(chunk_begin, chunk_end, acc, ctx) folds a chunk into acc
+  combine  : combine(into, from, ctx) folds one accumulator into another
+  out      : receives the result (acc_size bytes)
+
+  Returns:
+    - 0  on success
+    - -1 on invalid arguments or allocation failure (out is untouched)
+
+  Notes:
+    - Partials are kept per worker, so combine must be associative and
+      commutative; the combine order across workers is unspecified.
+    - fn folds into a stack copy of identity, acc_size should stay small.
+-----------------------------------------------------------------------------*/
+int job_parallel_reduce(size_t begin, size_t end, size_t grain,
+                        size_t acc_size, const void *identity,
+                        job_reduce_fn fn, job_combine_fn combine, void *ctx,
+                        void *out);
+
 #endif
 
 #if (defined(JOBSYSTEM_IMPLEMENTATION))
@@ -276,144 +595,904 @@ void job_wait(JobHandle *job);
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
+// counters and job tracing when stats/stats.h came first, nothing otherwise
+#if defined(STATS_H)
+#define _JOB_STATS_ADD(c, n) stats_add((c), (n))
+#define _JOB_STATS_MAX(c, v) stats_max((c), (v))
+#else
+#define _JOB_STATS_ADD(c, n) ((void)0)
+#define _JOB_STATS_MAX(c, v) ((void)0)
+#endif
+
 typedef struct RegionArena_t RegionArena;
+typedef struct TlArena_t TlArena;
 typedef struct SenderMpmc_t SenderMpmc;
 
 Scheduler *g_scheduler = NULL;
 
+// deque owned by the current thread, NULL outside work-stealing workers
+static _Thread_local WsDeque *t_local_queue = NULL;
+// worker running on the current thread, NULL outside the pool
+static _Thread_local Worker *t_worker = NULL;
+
+// queue entries and successor heads pack a 16 bit generation tag above a
+// 48 bit address
+static_assert(sizeof(void *) == 8, "job tickets need 64-bit pointers");
+
+#define JOB_TAG_SHIFT 48
+#define JOB_PTR_MASK ((UINT64_C(1) << JOB_TAG_SHIFT) - 1)
+
+// successor list of a finished job (address bits of JobHandle::successors)
+#define JOB_EDGES_CLOSED ((uint64_t)1)
+
+// slot kinds, one pool each
+#define JOB_POOL_HANDLES 0
+#define JOB_POOL_SMALL 1
+
 static void *__set_worker_scheduler(void *arg);
-static void _job_scheduler_healthcheck(void);
+static void _job_run(Worker *worker, uint64_t ticket);
 static void threadpool_schedule(SenderMpmc *sender, JobHandle *scheduled_job);
 
-typedef struct Scheduler_t {
-  ThreadPool *threadpool;
-  _Atomic uint8_t accepting_jobs; // 0 -> accepting or 1 -> not accepting
-  _Atomic size_t active_jobs;
-  _Atomic size_t jobs_completed_epoch;
-  RegionArena job_arena;
-} Scheduler;
+typedef struct JobEdge_t {
+  struct JobHandle_t *job; // successor
+  struct JobEdge_t *next;
+} JobEdge;
 
 typedef struct JobHandle_t {
+  // generation << 32 | unfinished (1 + pending parents, 0 once claimed to
+  // run); one word, so a claim or release through a stale entry fails
+  _Atomic uint64_t state;
+  // generation tag << JOB_TAG_SHIFT | JobEdge * (or JOB_EDGES_CLOSED)
+  _Atomic uint64_t successors;
+
   __job_handle Job;
+  void *ctx; // next free slot while the handle sits in a free list
+  JobCounter *done;
+  JobEdge link;   // edge for the first parent, no allocation
+  uint8_t prio;   // JobPriority
+  uint8_t pooled; // 0 for graph nodes, they are never recycled
+} JobHandle;
+
+static inline uint32_t _job_gen(uint64_t state) {
+  return (uint32_t)(state >> 32);
+}
+
+static inline uint32_t _job_unfinished(uint64_t state) {
+  return (uint32_t)state;
+}
+
+static inline uint64_t _job_tag(uint32_t gen) {
+  return (uint64_t)(gen & 0xFFFF) << JOB_TAG_SHIFT;
+}
+
+/* what the queues carry: the handle plus the generation it was scheduled
+ * with */
+static inline uint64_t _job_ticket(JobHandle *job, uint32_t gen) {
+  return _job_tag(gen) | (uint64_t)(uintptr_t)job;
+}
+
+/* shared by every chunk of one job_parallel_for / job_parallel_reduce call,
+ * lives on the caller's stack (the caller does not return before pending
+ * drops to 0) */
+typedef struct JobParallel_t {
+  job_range_fn fn;
+  job_reduce_fn reduce;
+  job_combine_fn combine;
   void *ctx;
+  size_t grain;
+
+  // reduce only: one accumulator per worker + one for the calling thread
+  const void *identity;
+  size_t acc_size;
+  size_t acc_stride;
+  uint8_t *accs;
+
+  JobCounter pending; // ranges not yet finished
+} JobParallel;
+
+/* per-chunk context, a small slot next to the chunk's JobHandle */
+typedef struct JobParallelRange_t {
+  JobParallel *par;
+  size_t begin;
+  size_t end;
+} JobParallelRange;
+
+/* slots of the small pool, never referenced once freed */
+typedef union JobSmallSlot_t {
+  JobEdge edge;
+  JobParallelRange range;
+  void *next_free;
+} JobSmallSlot;
+
+/* free slots of one kind: per-thread caches spill here and refill from
+ * here, the arena only grows when both are empty (through a per-thread
+ * chunk, so fresh slots cost no atomic either) */
+typedef struct JobSlotPool_t {
+  RegionArena arena;
+  TlArena fresh;
+  size_t link; // offset of the free list pointer inside a slot
+  _Atomic uint8_t lock;
+  _Atomic size_t free_count; // read unlocked as a hint
+  void *free;
+} JobSlotPool;
 
-  _Atomic size_t unfinished;
-  struct JobHandle_t *continuation;
-} JobHandle;
+typedef struct Scheduler_t {
+  ThreadPool *threadpool;
+  JobSlotPool pools[2]; // JOB_POOL_HANDLES, JOB_POOL_SMALL
+  size_t instance;
+} Scheduler;
+
+/* per-thread free slots; owner is the scheduler instance the slots came
+ * from, a cache left over from an earlier scheduler is dropped */
+typedef struct JobSlotCache_t {
+  void *head;
+  void *tail;
+  size_t count;
+  size_t owner;
+  TlArenaCache fresh;
+} JobSlotCache;
+
+static _Thread_local JobSlotCache t_slot_cache[2];
+static size_t g_scheduler_instances = 0;
+
+static inline void **_job_slot_link(JobSlotPool *pool, void *slot) {
+  return (void **)((uint8_t *)slot + pool->link);
+}
+
+static inline void _job_pool_lock(JobSlotPool *pool) {
+  while (atomic_exchange_explicit(&pool->lock, 1, memory_order_acquire)) {
+    cpu_relax();
+  }
+}
+
+static inline void _job_pool_unlock(JobSlotPool *pool) {
+  atomic_store_explicit(&pool->lock, 0, memory_order_release);
+}
+
+static inline JobSlotCache *_job_slot_cache(size_t kind) {
+  JobSlotCache *cache = &t_slot_cache[kind];
+  if (cache->owner != g_scheduler->instance) {
+    *cache = (JobSlotCache){.owner = g_scheduler->instance};
+  }
+  return cache;
+}
+
+static void *_job_slot_alloc(size_t kind) {
+  JobSlotPool *pool = &g_scheduler->pools[kind];
+  JobSlotCache *cache = _job_slot_cache(kind);
+
+  if (!cache->head &&
+      atomic_load_explicit(&pool->free_count, memory_order_relaxed) != 0) {
+    // refill a batch, threads that only spawn live off what workers free
+    _job_pool_lock(pool);
+    void *head = pool->free;
+    void *tail = NULL;
+    size_t taken = 0;
+    for (void *slot = head; slot && taken < JOB_SCHEDULER_SLOT_BATCH;
+         slot = *_job_slot_link(pool, slot)) {
+      tail = slot;
+      taken++;
+    }
+    if (tail) {
+      pool->free = *_job_slot_link(pool, tail);
+      *_job_slot_link(pool, tail) = NULL;
+      atomic_store_explicit(&pool->free_count,
+                            atomic_load_explicit(&pool->free_count,
+                                                 memory_order_relaxed) -
+                                taken,
+                            memory_order_relaxed);
+    }
+    _job_pool_unlock(pool);
+    cache->head = head;
+    cache->tail = tail;
+    cache->count = taken;
+  }
+
+  void *slot = cache->head;
+  if (!slot) {
+    return tl_arena_alloc(&pool->fresh, &cache->fresh);
+  }
+  cache->head = *_job_slot_link(pool, slot);
+  if (!cache->head) {
+    cache->tail = NULL;
+  }
+  cache->count--;
+  return slot;
+}
+
+static void _job_slot_free(size_t kind, void *slot) {
+  JobSlotPool *pool = &g_scheduler->pools[kind];
+  JobSlotCache *cache = _job_slot_cache(kind);
+
+  *_job_slot_link(pool, slot) = cache->head;
+  cache->head = slot;
+  if (!cache->tail) {
+    cache->tail = slot;
+  }
+  if (++cache->count < JOB_SCHEDULER_SLOT_CACHE) {
+    return;
+  }
+  // full: hand the whole cache over in one splice
+  _job_pool_lock(pool);
+  *_job_slot_link(pool, cache->tail) = pool->free;
+  pool->free = cache->head;
+  atomic_store_explicit(
+      &pool->free_count,
+      atomic_load_explicit(&pool->free_count, memory_order_relaxed) +
+          cache->count,
+      memory_order_relaxed);
+  _job_pool_unlock(pool);
+  cache->head = NULL;
+  cache->tail = NULL;
+  cache->count = 0;
+}
+
+static void _job_slot_pool_init(JobSlotPool *pool, size_t elem_size,
+                                size_t link, const MemBackend *memory) {
+  pool->arena = r_arena_create_opts(elem_size, JOB_SCHEDULER_REGION_CAPACITY,
+                                    JOB_SCHEDULER_MAX_REGIONS, memory);
+  pool->fresh = tl_arena_create(&pool->arena, JOB_SCHEDULER_SLOT_BATCH);
+  pool->link = link;
+  atomic_init(&pool->lock, 0);
+  atomic_init(&pool->free_count, 0);
+  pool->free = NULL;
+}
+
+typedef struct JobGraphNode_t {
+  JobHandle handle; // first: graph nodes are handed out as JobHandle *
+  size_t parents;
+  JobEdge *edges; // reinstalled as successors on every run
+} JobGraphNode;
+
+typedef struct JobGraph_t {
+  RegionArena nodes;
+  RegionArena edges;
+  JobCounter pending; // nodes of the current run not yet finished
+} JobGraph;
 
 void job_scheduler_spawn(ThreadPool *threadpool) {
   Scheduler *sche = malloc(sizeof(Scheduler));
-  sche->job_arena =
-      r_arena_create(sizeof(JobHandle), JOB_SCHEDULER_REGION_CAPACITY,
-                     JOB_SCHEDULER_MAX_REGIONS);
+  // a free handle keeps state and successors intact, it links through ctx
+  _job_slot_pool_init(&sche->pools[JOB_POOL_HANDLES], sizeof(JobHandle),
+                      offsetof(JobHandle, ctx), threadpool->memory);
+  _job_slot_pool_init(&sche->pools[JOB_POOL_SMALL], sizeof(JobSmallSlot), 0,
+                      threadpool->memory);
   sche->threadpool = threadpool;
-  atomic_init(&sche->accepting_jobs, 1);
-  atomic_init(&sche->active_jobs, 0);
-  atomic_init(&sche->jobs_completed_epoch, 0);
+  sche->instance = ++g_scheduler_instances;
   g_scheduler = sche;
 };
 
 void job_scheduler_shutdown(void) {
+  WsDeque **local_queues = g_scheduler->threadpool->local_queues;
+  size_t num_workers = g_scheduler->threadpool->num_workers;
+
   threadpool_shutdown(g_scheduler->threadpool);
-  r_arena_free(&g_scheduler->job_arena);
+  if (local_queues) {
+    for (size_t x = 0; x < num_workers; x++) {
+      ws_deque_free(local_queues[x]);
+    }
+    free(local_queues);
+  }
+  r_arena_free(&g_scheduler->pools[JOB_POOL_HANDLES].arena);
+  r_arena_free(&g_scheduler->pools[JOB_POOL_SMALL].arena);
   free(g_scheduler);
 };
 
 JobHandle *job_spawn(__job_handle fn, void *ctx) {
-  // small contention, rare to be needed as scheduler temporarily doesnt accept
-  // jobs only when it needs to reset the inner arena
-  while (atomic_load_explicit(&g_scheduler->accepting_jobs,
-                              memory_order_acquire) != 1) {
-    cpu_relax();
-  }
-  atomic_fetch_add_explicit(&g_scheduler->active_jobs, 1, memory_order_acq_rel);
+  return job_spawn_prio(fn, ctx, JOB_PRIO_NORMAL);
+}
 
-  JobHandle *job = (JobHandle *)r_arena_alloc(&g_scheduler->job_arena);
+JobHandle *job_spawn_prio(__job_handle fn, void *ctx, JobPriority prio) {
+  JobHandle *job = (JobHandle *)_job_slot_alloc(JOB_POOL_HANDLES);
   if (!job) {
-    atomic_fetch_sub_explicit(&g_scheduler->active_jobs, 1,
-                              memory_order_acq_rel);
     return NULL;
   }
+  // the generation was bumped when the slot was freed (fresh slots are 0);
+  // stale queue entries may read state concurrently, so it goes last
+  uint32_t gen =
+      _job_gen(atomic_load_explicit(&job->state, memory_order_relaxed));
   job->Job = fn;
   job->ctx = ctx;
-  atomic_init(&job->unfinished, 1);
-  job->continuation = NULL;
+  job->done = NULL;
+  job->link.job = NULL;
+  job->link.next = NULL;
+  job->prio = (uint8_t)prio;
+  job->pooled = 1;
+  atomic_store_explicit(&job->successors, _job_tag(gen), memory_order_relaxed);
+  atomic_store_explicit(&job->state, ((uint64_t)gen << 32) | 1,
+                        memory_order_release);
   return job;
 };
 
+/* the first parent uses the edge inside the handle, others take a slot;
+ * NULL when the slot arena is exhausted */
+static JobEdge *_job_edge_for(JobHandle *job) {
+  JobEdge *edge = &job->link;
+  if (edge->job) {
+    JobSmallSlot *slot = (JobSmallSlot *)_job_slot_alloc(JOB_POOL_SMALL);
+    if (!slot) {
+      return NULL;
+    }
+    edge = &slot->edge;
+  }
+  edge->job = job;
+  return edge;
+}
+
+/* an edge that was never published, or whose parent released it */
+static void _job_edge_drop(JobEdge *edge) {
+  if (edge == &edge->job->link) {
+    edge->job = NULL;
+  } else {
+    _job_slot_free(JOB_POOL_SMALL, edge);
+  }
+}
+
+static inline uint32_t _job_current_gen(JobHandle *job) {
+  return _job_gen(atomic_load_explicit(&job->state, memory_order_acquire));
+}
+
+/* returns 0 if parent already finished: its list is closed, or tagged with
+ * a later generation because the slot was reused */
+static int _job_push_successor(JobHandle *parent, uint32_t gen,
+                               JobEdge *edge) {
+  uint64_t tag = _job_tag(gen);
+  uint64_t head =
+      atomic_load_explicit(&parent->successors, memory_order_acquire);
+  do {
+    if ((head & ~JOB_PTR_MASK) != tag ||
+        (head & JOB_PTR_MASK) == JOB_EDGES_CLOSED) {
+      return 0;
+    }
+    edge->next = (JobEdge *)(uintptr_t)(head & JOB_PTR_MASK);
+  } while (!atomic_compare_exchange_weak_explicit(
+      &parent->successors, &head, tag | (uint64_t)(uintptr_t)edge,
+      memory_order_release, memory_order_acquire));
+  return 1;
+}
+
+/* drops one parent count, the one reaching 1 (ready) schedules the job */
+static void _job_release(SenderMpmc *sender, JobHandle *job) {
+  if (_job_unfinished(atomic_fetch_sub_explicit(&job->state, 1,
+                                                memory_order_acq_rel)) == 2) {
+    threadpool_schedule(sender, job);
+  }
+}
+
+/* counted before the edge is published, the parent may finish right away */
+static void _job_link_edge(JobHandle *parent, uint32_t gen, JobEdge *edge) {
+  JobHandle *child = edge->job;
+  if (!_job_push_successor(parent, gen, edge)) {
+    _job_edge_drop(edge);
+    _job_release(g_scheduler->threadpool->dispatcher, child);
+  }
+}
+
+/* the first parent of a job never allocates, so chains of fresh jobs can't
+ * fail; past that, returns -1 (nothing linked) if the slot arena is
+ * exhausted */
+static int _job_link(JobHandle *parent, JobHandle *child) {
+  JobEdge *edge = _job_edge_for(child);
+  if (!edge) {
+    return -1;
+  }
+  atomic_fetch_add_explicit(&child->state, 1, memory_order_relaxed);
+  _job_link_edge(parent, _job_current_gen(parent), edge);
+  return 0;
+}
+
+static void _job_edges_drop(JobEdge *edges) {
+  while (edges) {
+    JobEdge *next = edges->next;
+    _job_edge_drop(edges);
+    edges = next;
+  }
+}
+
+/* takes the n edges of job up front, so linking can't fail halfway */
+static JobEdge *_job_edges_for(JobHandle *job, size_t n) {
+  JobEdge *edges = NULL;
+  for (size_t x = 0; x < n; x++) {
+    JobEdge *edge = _job_edge_for(job);
+    if (!edge) {
+      _job_edges_drop(edges);
+      return NULL;
+    }
+    edge->next = edges;
+    edges = edge;
+  }
+  return edges;
+}
+
+/* appends the edge of the next chain link, NULL (all dropped) on failure */
+static JobEdge **_job_chain_edge(JobEdge **tail, JobEdge **edges,
+                                 JobHandle *job) {
+  JobEdge *edge = _job_edge_for(job);
+  if (!edge) {
+    _job_edges_drop(*edges);
+    return NULL;
+  }
+  edge->next = NULL;
+  *tail = edge;
+  return &edge->next;
+}
+
+/* links first -> edges[0].job -> edges[1].job ..., the edges taken in chain
+ * order, then schedules first */
+static void _job_chain_link(JobHandle *first, JobEdge *edges) {
+  JobHandle *parent = first;
+  while (edges) {
+    JobEdge *next = edges->next; // overwritten once published
+    JobHandle *child = edges->job;
+    atomic_fetch_add_explicit(&child->state, 1, memory_order_relaxed);
+    _job_link_edge(parent, _job_current_gen(parent), edges);
+    parent = child;
+    edges = next;
+  }
+  threadpool_schedule(g_scheduler->threadpool->dispatcher, first);
+}
+
 /* this will schedule `first` and `then` when `first` finishes */
-void job_then(JobHandle *first, JobHandle *then) {
-  first->continuation = then;
-  atomic_fetch_add_explicit(&then->unfinished, 1, memory_order_release);
+int job_then(JobHandle *first, JobHandle *then) {
+  if (_job_link(first, then) != 0) {
+    return -1;
+  }
   threadpool_schedule(g_scheduler->threadpool->dispatcher, first);
+  return 0;
 };
 
-void job_chain(size_t num_jobs, ...) {
+int job_chain(size_t num_jobs, ...) {
+  if (num_jobs == 0) {
+    return 0;
+  }
   va_list args;
-  JobHandle *job_to_schedule;
-
-  uint8_t first = 1;
-  JobHandle *prev_job;
   va_start(args, num_jobs);
-  for (size_t x = 0; x < num_jobs; x++) {
-    JobHandle *job = va_arg(args, JobHandle *);
-    if (first == 1) {
-      job_to_schedule = job;
-      prev_job = job;
-      first = 0;
-    } else {
-      prev_job->continuation = job;
-      atomic_fetch_add_explicit(&job->unfinished, 1, memory_order_release);
-      prev_job = job;
+  JobHandle *first = va_arg(args, JobHandle *);
+
+  // every edge is taken before the first link: a chain is linked whole or
+  // not at all
+  JobEdge *edges = NULL;
+  JobEdge **tail = &edges;
+  for (size_t x = 1; x < num_jobs; x++) {
+    tail = _job_chain_edge(tail, &edges, va_arg(args, JobHandle *));
+    if (!tail) {
+      va_end(args);
+      return -1;
     }
   }
   va_end(args);
 
-  threadpool_schedule(g_scheduler->threadpool->dispatcher, job_to_schedule);
+  _job_chain_link(first, edges);
+  return 0;
 }
 
-void job_chain_arr(size_t num_jobs, JobHandle **job_list) {
-  JobHandle *job_to_schedule;
-
-  uint8_t first = 1;
-  JobHandle *prev_job;
-  for (size_t x = 0; x < num_jobs; x++) {
-    JobHandle *job = job_list[x];
-    if (first == 1) {
-      job_to_schedule = job;
-      prev_job = job;
-      first = 0;
-    } else {
-      prev_job->continuation = job;
-      atomic_fetch_add_explicit(&job->unfinished, 1, memory_order_release);
-      prev_job = job;
+int job_chain_arr(size_t num_jobs, JobHandle **job_list) {
+  if (num_jobs == 0) {
+    return 0;
+  }
+  JobEdge *edges = NULL;
+  JobEdge **tail = &edges;
+  for (size_t x = 1; x < num_jobs; x++) {
+    tail = _job_chain_edge(tail, &edges, job_list[x]);
+    if (!tail) {
+      return -1;
     }
   }
 
-  threadpool_schedule(g_scheduler->threadpool->dispatcher, job_to_schedule);
+  _job_chain_link(job_list[0], edges);
+  return 0;
 }
 
 void job_wait(JobHandle *job) {
   threadpool_schedule(g_scheduler->threadpool->dispatcher, job);
 };
 
+int job_depends_on(JobHandle *job, JobHandle **parents, size_t n) {
+  if (!job || !parents) {
+    return -1;
+  }
+  JobEdge *edges = _job_edges_for(job, n);
+  if (n && !edges) {
+    return -1;
+  }
+  // every count is taken up front: the job can't get ready halfway through
+  atomic_fetch_add_explicit(&job->state, n, memory_order_relaxed);
+  for (size_t x = 0; x < n; x++) {
+    JobEdge *next = edges->next; // overwritten once published
+    _job_link_edge(parents[x], _job_current_gen(parents[x]), edges);
+    edges = next;
+  }
+  return 0;
+}
+
+int job_depends_on_refs(JobHandle *job, const JobRef *parents, size_t n) {
+  if (!job || !parents) {
+    return -1;
+  }
+  JobEdge *edges = _job_edges_for(job, n);
+  if (n && !edges) {
+    return -1;
+  }
+  atomic_fetch_add_explicit(&job->state, n, memory_order_relaxed);
+  for (size_t x = 0; x < n; x++) {
+    JobEdge *next = edges->next;
+    _job_link_edge(parents[x].job, parents[x].gen, edges);
+    edges = next;
+  }
+  return 0;
+}
+
+JobRef job_ref(JobHandle *job) {
+  return (JobRef){.job = job, .gen = job ? _job_current_gen(job) : 0};
+}
+
+int job_ref_stale(JobRef ref) {
+  if (!ref.job) {
+    return 1;
+  }
+  // graph nodes keep their generation, check the list they close as well
+  uint64_t head =
+      atomic_load_explicit(&ref.job->successors, memory_order_acquire);
+  return _job_current_gen(ref.job) != ref.gen ||
+         (head & JOB_PTR_MASK) == JOB_EDGES_CLOSED;
+}
+
+JobGraph *job_graph_create(void) {
+  JobGraph *graph = malloc(sizeof(JobGraph));
+  if (!graph) {
+    return NULL;
+  }
+  graph->nodes = r_arena_create(sizeof(JobGraphNode),
+                                JOB_GRAPH_REGION_CAPACITY, JOB_GRAPH_MAX_REGIONS);
+  graph->edges = r_arena_create(sizeof(JobEdge), JOB_GRAPH_REGION_CAPACITY,
+                                JOB_GRAPH_MAX_REGIONS);
+  job_counter_init(&graph->pending, 0);
+  return graph;
+}
+
+JobHandle *job_graph_add(JobGraph *graph, __job_handle fn, void *ctx) {
+  if (!graph || !fn) {
+    return NULL;
+  }
+  JobGraphNode *node = (JobGraphNode *)r_arena_alloc(&graph->nodes);
+  if (!node) {
+    return NULL;
+  }
+  node->handle.Job = fn;
+  node->handle.ctx = ctx;
+  node->handle.done = &graph->pending;
+  atomic_init(&node->handle.state, 0);
+  atomic_init(&node->handle.successors, JOB_EDGES_CLOSED);
+  node->handle.prio = JOB_PRIO_NORMAL;
+  node->handle.pooled = 0;
+  node->parents = 0;
+  node->edges = NULL;
+  return &node->handle;
+}
+
+int job_graph_depends_on(JobGraph *graph, JobHandle *node, JobHandle **parents,
+                         size_t n) {
+  if (!graph || !node || !parents) {
+    return -1;
+  }
+  for (size_t x = 0; x < n; x++) {
+    JobGraphNode *parent = (JobGraphNode *)parents[x];
+    JobEdge *edge = (JobEdge *)r_arena_alloc(&graph->edges);
+    if (!edge) {
+      // unlink this call's edges again, each is still first in its list
+      while (x--) {
+        JobGraphNode *linked = (JobGraphNode *)parents[x];
+        linked->edges = linked->edges->next;
+      }
+      return -1;
+    }
+    edge->job = node;
+    edge->next = parent->edges;
+    parent->edges = edge;
+  }
+  ((JobGraphNode *)node)->parents += n;
+  return 0;
+}
+
+void job_graph_run(JobGraph *graph) {
+  if (!graph) {
+    return;
+  }
+  size_t count = atomic_load_explicit(&graph->nodes.count, memory_order_acquire);
+  if (count == 0) {
+    return;
+  }
+
+  job_counter_init(&graph->pending, (uint32_t)count);
+
+  // every node is reset before the first root is scheduled, scheduling
+  // publishes the resets to the workers; nodes stay at generation 0
+  for (size_t x = 0; x < count; x++) {
+    JobGraphNode *node = (JobGraphNode *)r_arena_get(&graph->nodes, x);
+    atomic_store_explicit(&node->handle.state, node->parents + 1,
+                          memory_order_relaxed);
+    atomic_store_explicit(&node->handle.successors,
+                          (uint64_t)(uintptr_t)node->edges,
+                          memory_order_relaxed);
+  }
+  for (size_t x = 0; x < count; x++) {
+    JobGraphNode *node = (JobGraphNode *)r_arena_get(&graph->nodes, x);
+    if (node->parents == 0) {
+      threadpool_schedule(g_scheduler->threadpool->dispatcher, &node->handle);
+    }
+  }
+}
+
+void job_graph_wait(JobGraph *graph) {
+  if (!graph) {
+    return;
+  }
+  job_wait_for(&graph->pending);
+}
+
+void job_graph_free(JobGraph *graph) {
+  if (!graph) {
+    return;
+  }
+  r_arena_free(&graph->nodes);
+  r_arena_free(&graph->edges);
+  free(graph);
+}
+
+static void _job_parallel_range(JobParallel *par, size_t begin, size_t end);
+
+static void _job_parallel_leaf(JobParallel *par, size_t begin, size_t end) {
+  if (!par->reduce) {
+    par->fn(begin, end, par->ctx);
+    return;
+  }
+  // fold into a private copy first, the per-worker slot only sees combine,
+  // which can't nest another parallel call on this thread
+  max_align_t acc[(par->acc_size + sizeof(max_align_t) - 1) /
+                  sizeof(max_align_t)];
+  memcpy(acc, par->identity, par->acc_size);
+  par->reduce(begin, end, acc, par->ctx);
+
+  size_t slot =
+      t_worker ? t_worker->id : g_scheduler->threadpool->num_workers;
+  par->combine(par->accs + slot * par->acc_stride, acc, par->ctx);
+}
+
+static void _job_parallel_run(void *arg) {
+  // copy out and free first, the slot is still warm for the next split
+  JobParallelRange range = *(JobParallelRange *)arg;
+  _job_slot_free(JOB_POOL_SMALL, arg);
+  _job_parallel_range(range.par, range.begin, range.end);
+}
+
+static void _job_parallel_range(JobParallel *par, size_t begin, size_t end) {
+  while (end - begin > par->grain) {
+    size_t mid = begin + (end - begin) / 2;
+
+    JobSmallSlot *slot = (JobSmallSlot *)_job_slot_alloc(JOB_POOL_SMALL);
+    JobParallelRange *range = slot ? &slot->range : NULL;
+    JobHandle *job = range ? job_spawn(_job_parallel_run, range) : NULL;
+    if (!job) {
+      // out of slots: this thread keeps the rest of the range
+      if (range) {
+        _job_slot_free(JOB_POOL_SMALL, range);
+      }
+      break;
+    }
+    range->par = par;
+    range->begin = mid;
+    range->end = end;
+
+    job_counter_add(&par->pending, 1);
+    job_wait(job);
+    end = mid;
+  }
+  _job_parallel_leaf(par, begin, end);
+  // last access to par, the caller may return right after
+  job_counter_done(&par->pending);
+}
+
+void job_counter_init(JobCounter *counter, uint32_t value) {
+  // plain store: graphs re-init their counter between runs
+  atomic_store_explicit(&counter->value, value, memory_order_relaxed);
+}
+
+void job_counter_add(JobCounter *counter, uint32_t n) {
+  atomic_fetch_add_explicit(&counter->value, n, memory_order_relaxed);
+}
+
+void job_counter_done(JobCounter *counter) {
+  uint32_t old =
+      atomic_fetch_sub_explicit(&counter->value, 1, memory_order_acq_rel);
+  // the counter may be gone once it reads 0: only its address is used here
+  if (old == (JOB_COUNTER_SLEEPERS | 1)) {
+    chan_futex_wake(&counter->value, 1);
+  }
+}
+
+uint32_t job_counter_value(JobCounter *counter) {
+  return atomic_load_explicit(&counter->value, memory_order_acquire) &
+         ~JOB_COUNTER_SLEEPERS;
+}
+
+JobHandle *job_spawn_counted(__job_handle fn, void *ctx, JobCounter *counter) {
+  JobHandle *job = job_spawn(fn, ctx);
+  if (job && counter) {
+    job_counter_add(counter, 1);
+    job->done = counter;
+  }
+  return job;
+}
+
+static int _job_find_work(Worker *worker, uint64_t *rng, uint64_t *out);
+
+void job_wait_for(JobCounter *counter) {
+  Worker *worker = t_worker;
+  uint64_t rng = 0x9E3779B97F4A7C15ull ^ (uintptr_t)counter;
+  uint32_t round = 0;
+  uint64_t job;
+
+  while (1) {
+    uint32_t seen = atomic_load_explicit(&counter->value, memory_order_acquire);
+    if ((seen & ~JOB_COUNTER_SLEEPERS) == 0) {
+      break;
+    }
+
+    if (worker) {
+      // help: whatever runs here is work this thread would do anyway
+      if (_job_find_work(worker, &rng, &job)) {
+        round = 0;
+        _job_run(worker, job);
+      } else {
+        // workers never sleep here, new jobs would go unnoticed
+        chan_wait_step(CHANNEL_WAIT_YIELD, &round);
+      }
+      continue;
+    }
+
+    if (!chan_wait_step(CHANNEL_WAIT_PARK, &round)) {
+      continue;
+    }
+    // flag a sleeper, then sleep only if the word did not move since
+    if (!(seen & JOB_COUNTER_SLEEPERS) &&
+        !atomic_compare_exchange_weak_explicit(
+            &counter->value, &seen, seen | JOB_COUNTER_SLEEPERS,
+            memory_order_acq_rel, memory_order_acquire)) {
+      continue;
+    }
+    chan_futex_wait(&counter->value, seen | JOB_COUNTER_SLEEPERS);
+  }
+
+  // the counter is ours again: drop a leftover flag so reuse skips the wake
+  uint32_t flagged = JOB_COUNTER_SLEEPERS;
+  atomic_compare_exchange_strong_explicit(&counter->value, &flagged, 0,
+                                          memory_order_relaxed,
+                                          memory_order_relaxed);
+}
+
+static void _job_parallel_start(JobParallel *par, size_t begin, size_t end,
+                                size_t grain) {
+  if (grain == 0) {
+    // ~8 chunks per worker leaves room for stealing to even things out
+    size_t chunks = g_scheduler->threadpool->num_workers * 8;
+    grain = (end - begin) / (chunks ? chunks : 1);
+  }
+  par->grain = grain ? grain : 1;
+  job_counter_init(&par->pending, 1);
+
+  _job_parallel_range(par, begin, end);
+  job_wait_for(&par->pending);
+}
+
+void job_parallel_for(size_t begin, size_t end, size_t grain, job_range_fn fn,
+                      void *ctx) {
+  if (!fn || begin >= end) {
+    return;
+  }
+  JobParallel par = {.fn = fn, .ctx = ctx};
+  _job_parallel_start(&par, begin, end, grain);
+}
+
+int job_parallel_reduce(size_t begin, size_t end, size_t grain,
+                        size_t acc_size, const void *identity,
+                        job_reduce_fn fn, job_combine_fn combine, void *ctx,
+                        void *out) {
+  if (!fn || !combine || !identity || !out || acc_size == 0) {
+    return -1;
+  }
+  if (begin >= end) {
+    memcpy(out, identity, acc_size);
+    return 0;
+  }
+
+  // one cache line aligned accumulator per thread, no false sharing
+  size_t stride = (acc_size + CACHELINE_SIZE - 1) & ~(size_t)(CACHELINE_SIZE - 1);
+  size_t slots = g_scheduler->threadpool->num_workers + 1;
+  uint8_t *accs = aligned_alloc(CACHELINE_SIZE, slots * stride);
+  if (!accs) {
+    return -1;
+  }
+  for (size_t x = 0; x < slots; x++) {
+    memcpy(accs + x * stride, identity, acc_size);
+  }
+
+  JobParallel par = {.reduce = fn,
+                     .combine = combine,
+                     .ctx = ctx,
+                     .identity = identity,
+                     .acc_size = acc_size,
+                     .acc_stride = stride,
+                     .accs = accs};
+  _job_parallel_start(&par, begin, end, grain);
+
+  memcpy(out, accs, acc_size);
+  for (size_t x = 1; x < slots; x++) {
+    combine(out, accs + x * stride, ctx);
+  }
+  free(accs);
+  return 0;
+}
+
 ThreadPool *threadpool_init_for_scheduler(size_t num_threads) {
+  return threadpool_init_for_scheduler_opts(num_threads, NULL);
+}
+
+ThreadPool *threadpool_init_for_scheduler_opts(size_t num_threads,
+                                               const JobSchedulerOptions *opts) {
+  JobSchedulerMode mode = opts ? opts->mode : JOB_SCHEDULER_SHARED;
   ThreadPool *tp = malloc(sizeof(ThreadPool));
 
   tp->workers = malloc(num_threads * sizeof(pthread_t));
   tp->num_workers = num_threads;
-
-  tp->channel =
-      channel_create_mpmc(JOB_SCHEDULER_MAX_JOBS, sizeof(JobHandle *));
+  tp->wait = opts ? opts->wait : CHANNEL_WAIT_SPIN;
+  tp->memory = opts ? opts->memory : NULL;
+  chan_parker_init(&tp->idle);
+
+  // 8-byte job tickets: packed slots keep the 4M-slot queue at 64MB
+  ChannelOptions chan_opts = {.wait = tp->wait,
+                              .layout = CHANNEL_SLOT_PACKED,
+                              .memory = tp->memory};
+  tp->channel = channel_create_mpmc_opts(JOB_SCHEDULER_MAX_JOBS,
+                                         sizeof(uint64_t), &chan_opts);
   tp->dispatcher = mpmc_get_sender(tp->channel);
+  tp->local_queues = NULL;
+
+  // high / low priority: small queues, a job falls back to normal when full
+  for (size_t x = 0; x < 2; x++) {
+    tp->prio_channels[x] = channel_create_mpmc_opts(
+        JOB_SCHEDULER_PRIO_QUEUE_CAPACITY, sizeof(uint64_t), &chan_opts);
+    tp->prio_dispatchers[x] = mpmc_get_sender(tp->prio_channels[x]);
+  }
+  size_t reserved = opts ? opts->reserved_high_workers : 0;
+  // at least one worker must run normal and low priority jobs
+  tp->reserved_workers = reserved < num_threads ? reserved
+                         : num_threads ? num_threads - 1
+                                       : 0;
+
+  // every deque must exist before the first worker starts stealing
+  if (mode == JOB_SCHEDULER_WORK_STEALING) {
+    tp->local_queues = malloc(num_threads * sizeof(WsDeque *));
+    for (size_t i = 0; i < num_threads; i++) {
+      tp->local_queues[i] = ws_deque_new(JOB_SCHEDULER_LOCAL_QUEUE_CAPACITY);
+    }
+  }
 
   for (size_t i = 0; i < num_threads; i++) {
     Worker *worker = malloc(sizeof(Worker));
     worker->receiver = mpmc_get_receiver(tp->channel);
     worker->sender = mpmc_get_sender(tp->channel);
     worker->chan_ref = tp->channel;
+    for (size_t x = 0; x < 2; x++) {
+      worker->prio_receivers[x] = mpmc_get_receiver(tp->prio_channels[x]);
+    }
+    worker->pool = tp;
+    worker->id = i;
+    worker->cpu = opts && opts->cpus && opts->num_cpus
+                      ? opts->cpus[i % opts->num_cpus]
+                      : -1;
 
     pthread_create(&tp->workers[i], NULL, __set_worker_scheduler, worker);
   }
@@ -421,74 +1500,244 @@ ThreadPool *threadpool_init_for_scheduler(size_t num_threads) {
   return tp;
 }
 
+static void _job_run(Worker *worker, uint64_t ticket) {
+  JobHandle *job = (JobHandle *)(uintptr_t)(ticket & JOB_PTR_MASK);
+  assert(job != NULL);
+
+  // 1 -> 0 claims the job: no parent is pending, nobody else ran it, and
+  // the slot still holds the generation the ticket was made for
+  uint64_t state = atomic_load_explicit(&job->state, memory_order_acquire);
+  if (_job_tag(_job_gen(state)) != (ticket & ~JOB_PTR_MASK) ||
+      _job_unfinished(state) != 1 ||
+      !atomic_compare_exchange_strong_explicit(&job->state, &state, state - 1,
+                                               memory_order_acq_rel,
+                                               memory_order_acquire)) {
+    return;
+  }
+  uint32_t gen = _job_gen(state);
+  assert(job->Job != NULL);
+#if defined(STATS_H)
+  __job_handle fn = job->Job;
+  uint64_t trace_begin = stats_tracing() ? stats_now_ns() : 0;
+  fn(job->ctx);
+  stats_add(STATS_JOBS_EXECUTED, 1);
+  if (trace_begin) {
+    stats_trace_job((uintptr_t)fn, job, trace_begin);
+  }
+#else
+  job->Job(job->ctx);
+#endif
+
+  // closing the list makes later job_depends_on calls see this job as done
+  uint64_t head =
+      atomic_exchange_explicit(&job->successors,
+                               _job_tag(gen) | JOB_EDGES_CLOSED,
+                               memory_order_acq_rel);
+  JobEdge *edge = (JobEdge *)(uintptr_t)(head & JOB_PTR_MASK);
+  while (edge) {
+    // the successor may run and be recycled once released, read it first
+    JobEdge *next = edge->next;
+    JobHandle *child = edge->job;
+    // graph edges belong to the graph and are reinstalled on the next run
+    if (job->pooled && edge != &child->link) {
+      _job_slot_free(JOB_POOL_SMALL, edge);
+    }
+    _job_release(worker->sender, child);
+    edge = next;
+  }
+
+  // a graph node may be freed as soon as its counter drops: no access after
+  JobCounter *done = job->done;
+  if (job->pooled) {
+    // the new generation invalidates every ticket and JobRef still around
+    atomic_store_explicit(&job->state, (uint64_t)(gen + 1) << 32,
+                          memory_order_release);
+    _job_slot_free(JOB_POOL_HANDLES, job);
+  }
+  if (done) {
+    job_counter_done(done);
+  }
+}
+
+/* xorshift64, good enough to spread steal attempts across victims */
+static inline uint64_t _job_next_victim(uint64_t *state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+/* queue 0 = high, 1 = low */
+static inline int _job_try_prio(Worker *worker, size_t queue, uint64_t *out) {
+  return mpmc_try_recv(worker->prio_receivers[queue], out) == CHANNEL_OK;
+}
+
+/* normal priority: local deque first (LIFO, cache-hot), then the injection
+ * queue, then steal from random victims (FIFO, oldest work first) */
+static int _job_find_normal(Worker *worker, uint64_t *rng, uint64_t *out) {
+  ThreadPool *tp = worker->pool;
+  void *item;
+
+  if (t_local_queue && ws_deque_pop(t_local_queue, &item) == WS_DEQUE_OK) {
+    *out = (uint64_t)(uintptr_t)item;
+    return 1;
+  }
+  if (mpmc_try_recv(worker->receiver, out) == CHANNEL_OK) {
+    return 1;
+  }
+  if (!tp->local_queues || tp->num_workers < 2) {
+    return 0;
+  }
+  for (size_t attempt = 0; attempt < tp->num_workers * 2; attempt++) {
+    size_t victim = (size_t)(_job_next_victim(rng) % tp->num_workers);
+    if (victim == worker->id) {
+      continue;
+    }
+    if (ws_deque_steal(tp->local_queues[victim], &item) == WS_DEQUE_OK) {
+      *out = (uint64_t)(uintptr_t)item;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// jobs this worker took in a row while normal / low priority was skipped
+static _Thread_local uint32_t t_normal_streak = 0;
+static _Thread_local uint32_t t_low_streak = 0;
+
+/* high, then normal, then low. A level skipped for
+ * JOB_SCHEDULER_STARVATION_LIMIT picks in a row is looked at first once,
+ * each level with its own streak, so every lower level makes progress even
+ * while all the levels above it are flooded.
+ * Reserved workers only take high priority jobs. */
+static int _job_find_work(Worker *worker, uint64_t *rng, uint64_t *out) {
+  if (worker->id < worker->pool->reserved_workers) {
+    return _job_try_prio(worker, 0, out);
+  }
+  if (t_low_streak >= JOB_SCHEDULER_STARVATION_LIMIT) {
+    t_low_streak = 0;
+    if (_job_try_prio(worker, 1, out)) {
+      t_normal_streak++;
+      return 1;
+    }
+  }
+  if (t_normal_streak >= JOB_SCHEDULER_STARVATION_LIMIT) {
+    t_normal_streak = 0;
+    if (_job_find_normal(worker, rng, out)) {
+      t_low_streak++;
+      return 1;
+    }
+  }
+  if (_job_try_prio(worker, 0, out)) {
+    t_normal_streak++;
+    t_low_streak++;
+    return 1;
+  }
+  // normal was looked at: it is not starving, whatever happens next
+  t_normal_streak = 0;
+  if (_job_find_normal(worker, rng, out)) {
+    t_low_streak++;
+    return 1;
+  }
+  if (_job_try_prio(worker, 1, out)) {
+    t_low_streak = 0;
+    return 1;
+  }
+  return 0;
+}
+
+/* one loop for both modes: with several queues to watch a worker can't
+ * block inside a channel, it parks on the pool instead */
 static void *__set_worker_scheduler(void *arg) {
   Worker *worker = (Worker *)arg;
-  JobHandle *job;
+  ThreadPool *tp = worker->pool;
+  uint64_t rng = 0x9E3779B97F4A7C15ull * (uint64_t)(worker->id + 1);
+  uint32_t round = 0;
+  uint64_t job;
+
+  // pinned before the first queue access, so first-touch lands locally
+  if (worker->cpu >= 0) {
+    threadpool_pin_thread(worker->cpu);
+  }
+  // reserved workers keep nothing local: what they schedule goes to a queue
+  if (tp->local_queues && worker->id >= tp->reserved_workers) {
+    t_local_queue = tp->local_queues[worker->id];
+  }
+  t_worker = worker;
+#if defined(STATS_H)
+  stats_thread_label("job worker", worker->id);
+#endif
   while (1) {
-    if (mpmc_recv(worker->receiver, &job) == CHANNEL_OK) {
-      assert(job != NULL);
-      assert(job->Job != NULL);
-
-      if (atomic_load_explicit(&job->unfinished, memory_order_acquire) == 1) {
-        // --> run job
-        job->Job(job->ctx);
-        atomic_fetch_add_explicit(&g_scheduler->jobs_completed_epoch, 1,
-                                  memory_order_release);
-        atomic_fetch_sub_explicit(&job->unfinished, 1, memory_order_release);
-
-        if (job->continuation) {
-          atomic_fetch_sub_explicit(&job->continuation->unfinished, 1,
-                                    memory_order_release);
-          threadpool_schedule(worker->sender, job->continuation);
-        } else {
-          _job_scheduler_healthcheck();
-        }
-
-        atomic_fetch_sub_explicit(&g_scheduler->active_jobs, 1,
-                                  memory_order_acq_rel);
-      }
+    if (_job_find_work(worker, &rng, &job)) {
+      _JOB_STATS_ADD(STATS_WORKER_IDLE_ROUNDS, round);
+      round = 0;
+      _job_run(worker, job);
     } else if (mpmc_is_closed(worker->chan_ref) == CLOSED) {
       break;
+    } else if (chan_wait_step(tp->wait, &round)) {
+      // register as idle, then look once more before sleeping;
+      // pairs with the fence in threadpool_schedule
+      uint32_t token = chan_park_begin(&tp->idle);
+      atomic_thread_fence(memory_order_seq_cst);
+      int found = _job_find_work(worker, &rng, &job);
+      int park = !found && mpmc_is_closed(worker->chan_ref) == OPEN;
+      _JOB_STATS_ADD(STATS_WORKER_PARKS, park);
+      chan_park_end(&tp->idle, token, park);
+      if (found) {
+        _JOB_STATS_ADD(STATS_WORKER_IDLE_ROUNDS, round);
+        round = 0;
+        _job_run(worker, job);
+      }
     }
   }
+  _JOB_STATS_ADD(STATS_WORKER_IDLE_ROUNDS, round);
+  t_local_queue = NULL;
+  t_worker = NULL;
 
   mpmc_close_sender(worker->sender);
   mpmc_close_receiver(worker->receiver);
   free(worker->receiver);
   free(worker->sender);
+  for (size_t x = 0; x < 2; x++) {
+    mpmc_close_receiver(worker->prio_receivers[x]);
+    free(worker->prio_receivers[x]);
+  }
   free(worker);
   return NULL;
 };
 
 static void threadpool_schedule(SenderMpmc *sender, JobHandle *scheduled_job) {
-  if (atomic_load_explicit(&scheduled_job->unfinished, memory_order_acquire) ==
-      0) {
+  uint64_t state =
+      atomic_load_explicit(&scheduled_job->state, memory_order_acquire);
+  if (_job_unfinished(state) == 0) {
     return;
   }
-  mpmc_send(sender, &scheduled_job);
-};
-
-static void _job_scheduler_reset(void);
-
-static void _job_scheduler_healthcheck(void) {
-  if (atomic_load_explicit(&g_scheduler->jobs_completed_epoch,
-                           memory_order_acquire) >
-      JOB_SCHEDULER_MAX_JOBS - 20) {
-    _job_scheduler_reset();
+  ThreadPool *tp = g_scheduler->threadpool;
+  uint64_t ticket = _job_ticket(scheduled_job, _job_gen(state));
+
+  // high / low have their own queues; a full one degrades the job to normal
+  // priority instead of blocking the scheduling thread
+  uint8_t prio = scheduled_job->prio;
+  if (prio == JOB_PRIO_NORMAL ||
+      mpmc_try_send(tp->prio_dispatchers[prio == JOB_PRIO_HIGH ? 0 : 1],
+                    &ticket) != CHANNEL_OK) {
+    // inside a work-stealing worker: keep it local, thieves will balance it
+    if (!t_local_queue ||
+        ws_deque_push(t_local_queue, (void *)(uintptr_t)ticket) !=
+            WS_DEQUE_OK) {
+      mpmc_send(sender, &ticket);
+    } else {
+      _JOB_STATS_MAX(STATS_WS_DEPTH_MAX, ws_deque_size(t_local_queue));
+    }
   }
-}
 
-static void _job_scheduler_reset(void) {
-  atomic_store_explicit(&g_scheduler->accepting_jobs, 0, memory_order_release);
-
-  while (atomic_load_explicit(&g_scheduler->active_jobs,
-                              memory_order_acquire) != 0) {
-    cpu_relax();
+  // workers never block inside a channel, wake one of them (all of them
+  // with reserved workers, a reserved one can't take every job)
+  if (tp->wait == CHANNEL_WAIT_PARK) {
+    atomic_thread_fence(memory_order_seq_cst);
+    chan_unpark(&tp->idle, tp->reserved_workers != 0);
   }
-  r_arena_reset(&g_scheduler->job_arena);
-  atomic_store_explicit(&g_scheduler->jobs_completed_epoch, 0,
-                        memory_order_release);
-
-  atomic_store_explicit(&g_scheduler->accepting_jobs, 1, memory_order_release);
-}
+};
 #endif
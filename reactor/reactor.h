@@ -0,0 +1,1332 @@
+// Copyright 2025 Seaker <seakerone@proton.me>
+
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+/*
+------------------------------------------------------------------------------
+reactor.h — Completion-based async I/O over io_uring (epoll fallback)
+
+One Reactor owns an io_uring instance (or an epoll set when io_uring is not
+available) and a pool of fixed buffers. Any thread submits reads, writes,
+accepts and timers as ReactorOp requests; one thread polls the reactor and
+completes them. A completed op either:
+
+- wakes whoever waits on it in reactor_wait: a green thread (yield/green.h)
+  parks off its worker's run queue, a plain thread sleeps on a futex, or
+- runs its callback on the polling thread, e.g. schedules a JobHandle
+  continuation (reactor_op_then_job).
+
+Submissions go straight into the shared submission ring. The polling thread
+hands everything queued since its last pass to the kernel in the same
+io_uring_enter that waits for completions, so a busy reactor costs one
+syscall per batch, not per operation. A submitter only enters the kernel
+itself when the poller is asleep. With ReactorOptions.sqpoll a kernel thread
+consumes the ring and submissions need no syscall at all.
+
+Buffers from the reactor's pool (reactor_buf_get) are registered with the
+ring once, at creation: reads and writes into them use READ_FIXED /
+WRITE_FIXED, which skip the per-request page pinning and mapping. The pool
+is a single block from a MemBackend (arenas/page_alloc.h's page_backend gives
+huge pages / NUMA placement), so socket data goes from the kernel straight
+into memory the application owns, with no copy.
+
+Without io_uring (old kernel, io_uring_disabled, seccomp) the reactor falls
+back to epoll: the poller tries each operation as it picks it up, and again
+when epoll reports the fd ready. Timers sit in a min-heap that bounds the
+epoll timeout.
+
+------------------------------------------------------------------------------
+USAGE
+
+Include channels/channels.h first (ReactorOp waits on a ChanParker), and
+job_system/jobsystem.h first for reactor_op_then_job.
+
+In exactly ONE source file:
+
+    #define REACTOR_IMPLEMENTATION
+    #include "reactor.h"
+
+    ReactorOptions opts = {.buffer_count = 256, .buffer_size = 16384};
+    Reactor *r = reactor_create(&opts);
+    threadpool_execute(pool, reactor_host, r); // polls until reactor_stop
+
+From any thread or green thread:
+
+    ReactorOp op = {0};
+    void *buf = reactor_buf_get(r);
+    reactor_read(r, &op, sock, buf, reactor_buf_size(r), -1);
+    int64_t n = reactor_wait(&op); // bytes read, or -errno
+    ...
+    reactor_buf_put(r, buf);
+
+As a job continuation (the job reads op->result through its context):
+
+    reactor_op_then_job(&op, job_spawn(on_read, &op));
+    reactor_read(r, &op, sock, buf, len, -1);
+
+    reactor_stop(r);
+    // wait for reactor_host to return (e.g. threadpool_wait)
+    reactor_destroy(r);
+
+------------------------------------------------------------------------------
+OPERATIONS
+
+Every submission takes a caller-owned ReactorOp that must stay valid until
+the op completed (reactor_wait returned, or the callback ran). The request
+fields are rewritten by each submission; callback and user are left alone,
+so they are set once before submitting. An op is reusable once completed.
+
+    reactor_read     read / pread (offset >= 0), result = bytes or -errno
+    reactor_write    write / pwrite, result = bytes or -errno
+    reactor_accept   result = new fd (non-blocking, close-on-exec) or -errno
+    reactor_timeout  result = 0 when the delay expired
+
+⚠️ An op has waiters or a callback, not both: after the callback the op
+  belongs to the callback, a waiter could free it under it.
+
+⚠️ On the epoll backend, fds must be non-blocking (accepted ones are): the
+  polling thread runs the read / write itself, a blocking fd stalls it.
+  Regular files are always "ready" for epoll, so their I/O also runs on the
+  polling thread.
+
+------------------------------------------------------------------------------
+NOTES
+
+- Linux only. The io_uring backend needs Linux 5.11+ (IORING_OP_READ /
+  WRITE and the timed wait); every syscall goes through syscall(), no
+  liburing, and strict C11 builds are fine.
+- Submission is serialized by a short spinlock (one ring slot per op).
+  Completion handling runs on the polling thread only: one thread at a time
+  may be inside reactor_poll / reactor_run.
+- If the ring's submission queue is full the submitter flushes it to the
+  kernel; REACTOR_ERR_BUSY means the kernel refused more work.
+- tasks of yield.h (one thread, no await hook) poll reactor_op_done and
+  yield() instead of calling reactor_wait, which would block the thread.
+
+------------------------------------------------------------------------------
+CONSTANTS
+
+REACTOR_DEFAULT_ENTRIES     : ring size when ReactorOptions.entries is 0 (256)
+REACTOR_DEFAULT_BUFFER_SIZE : fixed buffer size when buffer_size is 0 (16KB)
+REACTOR_EPOLL_EVENTS        : epoll events taken per poll (64)
+
+------------------------------------------------------------------------------
+RETURN CODES
+
+    REACTOR_OK          Submitted
+    REACTOR_ERR_NULL    NULL reactor or op
+    REACTOR_ERR_BUSY    The kernel queue is full, try again later
+    REACTOR_ERR_STOPPED reactor_stop was called
+    REACTOR_ERR_NOMEM   Bookkeeping allocation failed (epoll backend)
+
+------------------------------------------------------------------------------
+*/
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if !defined(__linux__)
+#error "reactor.h: only Linux is supported"
+#endif
+
+#ifndef REACTOR_DEFAULT_ENTRIES
+#define REACTOR_DEFAULT_ENTRIES 256
+#endif
+
+#ifndef REACTOR_DEFAULT_BUFFER_SIZE
+#define REACTOR_DEFAULT_BUFFER_SIZE (16 * 1024)
+#endif
+
+#ifndef REACTOR_EPOLL_EVENTS
+#define REACTOR_EPOLL_EVENTS 64
+#endif
+
+#define REACTOR_OK 0
+#define REACTOR_ERR_NULL -1
+#define REACTOR_ERR_BUSY -2
+#define REACTOR_ERR_STOPPED -3
+#define REACTOR_ERR_NOMEM -4
+
+typedef enum ReactorBackend_t {
+  REACTOR_BACKEND_AUTO = 0, // io_uring, epoll if it cannot be set up
+  REACTOR_BACKEND_IO_URING,
+  REACTOR_BACKEND_EPOLL
+} ReactorBackend;
+
+typedef enum ReactorOpKind_t {
+  REACTOR_OP_READ = 0,
+  REACTOR_OP_WRITE,
+  REACTOR_OP_ACCEPT,
+  REACTOR_OP_TIMEOUT
+} ReactorOpKind;
+
+// Creation options, pass NULL to reactor_create for the defaults.
+typedef struct ReactorOptions_t {
+  ReactorBackend backend;
+  uint32_t entries;       // submission ring size (0 = REACTOR_DEFAULT_ENTRIES)
+  size_t buffer_count;    // fixed buffers in the pool (0 = no pool)
+  size_t buffer_size;     // bytes per buffer (0 = REACTOR_DEFAULT_BUFFER_SIZE)
+  const MemBackend *memory; // pool allocator (NULL = aligned_alloc), must
+                            // outlive the reactor
+  uint8_t sqpoll;           // io_uring: a kernel thread polls the ring
+  uint32_t sqpoll_idle_ms;  // sqpoll: idle time before that thread sleeps
+} ReactorOptions;
+
+typedef struct Reactor_t Reactor;
+typedef struct ReactorOp_t ReactorOp;
+
+// Runs on the polling thread once op completed, op->result is set.
+typedef void (*ReactorCallback)(ReactorOp *op);
+
+struct ReactorOp_t {
+  // request, filled by the submission functions
+  uint8_t kind;
+  int fd;
+  void *buf;
+  size_t len;
+  int64_t offset;     // -1 = current file position
+  int64_t timeout[2]; // {sec, nsec}, read in place by io_uring
+  uint64_t deadline;  // epoll timers, monotonic ns
+
+  // completion
+  int64_t result;          // bytes / fd / 0, or -errno
+  _Atomic uint32_t state;  // pending, completing, completed
+  ChanParker parker;       // reactor_wait sleeps here
+  ReactorCallback callback;
+  void *user;
+
+  ReactorOp *next; // reactor bookkeeping
+};
+
+/*-----------------------------------------------------------------------------
+  reactor_create
+  Creates a reactor: sets up the io_uring instance (or the epoll set) and
+  allocates and registers the fixed buffer pool.
+
+  Returns a pointer to Reactor on success, NULL if neither backend could be
+  set up (or the one forced by opts->backend) or on allocation failure.
+
+  Notes:
+    - A pool the kernel refuses to register (RLIMIT_MEMLOCK on old kernels)
+      still works, reads and writes into it just do not use the fixed ops.
+-----------------------------------------------------------------------------*/
+Reactor *reactor_create(const ReactorOptions *opts);
+
+/*-----------------------------------------------------------------------------
+  reactor_backend
+  Returns the backend in use (REACTOR_BACKEND_IO_URING or _EPOLL).
+-----------------------------------------------------------------------------*/
+ReactorBackend reactor_backend(const Reactor *r);
+
+/*-----------------------------------------------------------------------------
+  reactor_read / reactor_write
+  Submits a read of up to len bytes from fd into buf (write: from buf to
+  fd), at offset, or at the current file position if offset is -1.
+
+  Returns:
+    - REACTOR_OK on success, op completes later
+    - REACTOR_ERR_NULL, REACTOR_ERR_BUSY, REACTOR_ERR_STOPPED or
+      REACTOR_ERR_NOMEM, op is untouched
+
+  Notes:
+    - A buf inside the reactor's fixed pool uses READ_FIXED / WRITE_FIXED
+      (the whole [buf, buf + len) range must be inside one pool buffer).
+    - Like read(2), a short count is not an error.
+-----------------------------------------------------------------------------*/
+int reactor_read(Reactor *r, ReactorOp *op, int fd, void *buf, size_t len,
+                 int64_t offset);
+int reactor_write(Reactor *r, ReactorOp *op, int fd, const void *buf,
+                  size_t len, int64_t offset);
+
+/*-----------------------------------------------------------------------------
+  reactor_accept
+  Submits an accept on the listening socket fd. The new connection's fd is
+  the op result, opened non-blocking and close-on-exec.
+
+  Returns: as reactor_read.
+-----------------------------------------------------------------------------*/
+int reactor_accept(Reactor *r, ReactorOp *op, int fd);
+
+/*-----------------------------------------------------------------------------
+  reactor_timeout
+  Submits a timer that completes after ns nanoseconds, with result 0.
+
+  Returns: as reactor_read.
+-----------------------------------------------------------------------------*/
+int reactor_timeout(Reactor *r, ReactorOp *op, uint64_t ns);
+
+/*-----------------------------------------------------------------------------
+  reactor_wait
+  Waits for a submitted op to complete.
+
+  Returns op->result.
+
+  Notes:
+    - In a green thread the task is parked (chan_await) and its worker keeps
+      running other tasks; on a plain thread the thread sleeps.
+    - Any number of threads may wait on the same op.
+-----------------------------------------------------------------------------*/
+int64_t reactor_wait(ReactorOp *op);
+
+/*-----------------------------------------------------------------------------
+  reactor_op_done
+  Returns 1 once op completed (op->result is then valid), 0 before.
+-----------------------------------------------------------------------------*/
+int reactor_op_done(ReactorOp *op);
+
+/*-----------------------------------------------------------------------------
+  reactor_poll
+  Submits what is queued, waits up to timeout_ms (-1 = no limit, 0 = do not
+  wait) for completions and handles them: waiters are woken and callbacks
+  run on the calling thread.
+
+  Returns the number of ops completed.
+
+  Notes:
+    - One polling thread at a time.
+    - Also returns early (possibly 0) when reactor_stop is called.
+-----------------------------------------------------------------------------*/
+size_t reactor_poll(Reactor *r, int timeout_ms);
+
+/*-----------------------------------------------------------------------------
+  reactor_run / reactor_host / reactor_host_job
+  Polls r until reactor_stop, with the signatures of a plain call, of a
+  ThreadPool job (threadpool_execute) and of a job system job (job_spawn).
+
+  Notes:
+    - The hosting thread is busy until reactor_stop.
+-----------------------------------------------------------------------------*/
+void reactor_run(Reactor *r);
+void *reactor_host(void *reactor);
+void reactor_host_job(void *reactor);
+
+/*-----------------------------------------------------------------------------
+  reactor_stop
+  Makes reactor_run return and refuses new submissions. Ops already
+  submitted still complete if the reactor is polled again.
+-----------------------------------------------------------------------------*/
+void reactor_stop(Reactor *r);
+
+/*-----------------------------------------------------------------------------
+  reactor_buf_get / reactor_buf_put / reactor_buf_size
+  Takes a buffer from the fixed pool (NULL if the pool is empty or there is
+  none), gives one back, and returns the size of each buffer.
+
+  Notes:
+    - Lock-free, from any thread.
+    - Buffers are 64-byte aligned; put must get a pointer get returned.
+-----------------------------------------------------------------------------*/
+void *reactor_buf_get(Reactor *r);
+void reactor_buf_put(Reactor *r, void *buf);
+size_t reactor_buf_size(const Reactor *r);
+
+/*-----------------------------------------------------------------------------
+  reactor_destroy
+  Closes the ring (or epoll set) and frees the pool.
+
+  Notes:
+    - Every op must have completed, and no thread may be polling.
+-----------------------------------------------------------------------------*/
+void reactor_destroy(Reactor *r);
+
+#if defined(JOB_SYSTEM_H)
+/*-----------------------------------------------------------------------------
+  reactor_op_then_job
+  Makes job the continuation of op: when op completes the polling thread
+  schedules job (job_wait). Call before submitting op; it sets op->callback
+  and op->user.
+
+  Notes:
+    - job must be spawned (job_spawn) and not yet scheduled.
+-----------------------------------------------------------------------------*/
+void reactor_op_then_job(ReactorOp *op, JobHandle *job);
+#endif
+
+#endif // !REACTOR_H
+
+#if (defined(REACTOR_IMPLEMENTATION))
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+
+/* strict C11 hides the Linux extensions, the values are the generic ones */
+#ifndef MAP_POPULATE
+#define MAP_POPULATE 0x8000
+#endif
+#ifndef SOCK_NONBLOCK
+#define SOCK_NONBLOCK 04000
+#endif
+#ifndef SOCK_CLOEXEC
+#define SOCK_CLOEXEC 02000000
+#endif
+
+extern long syscall(long number, ...);
+
+enum {
+  _REACTOR_PENDING = 0,
+  _REACTOR_COMPLETING = 1, // result set, waiters being woken
+  _REACTOR_COMPLETED = 2   // the reactor no longer touches the op
+};
+
+// Per-fd ops waiting for readiness (epoll backend), FIFO per direction.
+typedef struct _ReactorFd_t {
+  ReactorOp *rd_head, *rd_tail; // reads and accepts
+  ReactorOp *wr_head, *wr_tail;
+  uint32_t events;              // what the fd is armed for
+  uint8_t added;                // registered with epoll_ctl
+} _ReactorFd;
+
+struct Reactor_t {
+  ReactorBackend backend;
+  _Atomic uint32_t lock;     // submission side
+  _Atomic uint32_t stopping;
+  uint32_t sleeping;         // poller is (about to be) in the kernel wait,
+                             // guarded by lock
+
+  // io_uring
+  int ring_fd;
+  uint8_t sqpoll;
+  uint8_t ext_arg;           // IORING_FEAT_EXT_ARG: timed waits
+  void *sq_map, *cq_map;
+  size_t sq_map_size, cq_map_size;
+  struct io_uring_sqe *sqes;
+  size_t sqes_size;
+  _Atomic uint32_t *sq_head, *sq_tail, *sq_flags;
+  uint32_t *sq_array, sq_mask, sq_entries;
+  _Atomic uint32_t *cq_head, *cq_tail;
+  struct io_uring_cqe *cqes;
+  uint32_t cq_mask;
+  uint32_t sq_pending; // published, not yet handed to the kernel (lock)
+
+  // epoll
+  int epoll_fd, event_fd;
+  uint32_t kicked;       // event_fd written since the last drain (lock)
+  ReactorOp *incoming;   // submitted, not yet started (lock), LIFO
+  _ReactorFd *fds;       // indexed by fd (poller only)
+  size_t fds_cap;
+  ReactorOp **timers;    // min-heap on deadline (poller only)
+  size_t timers_len, timers_cap;
+
+  // fixed buffers
+  const MemBackend *memory;
+  unsigned char *pool;
+  size_t pool_bytes, buf_size, buf_count;
+  uint8_t registered;
+  uint32_t *buf_next;
+  _Atomic uint64_t buf_head; // tag << 32 | (index + 1), 0 = empty
+};
+
+static inline void _reactor_lock(Reactor *r) {
+  uint32_t spins = 0;
+  while (atomic_exchange_explicit(&r->lock, 1, memory_order_acquire)) {
+    while (atomic_load_explicit(&r->lock, memory_order_relaxed)) {
+      // the holder may have been preempted
+      if (++spins < CHANNEL_SPIN_LIMIT) {
+        cpu_relax();
+      } else {
+        sched_yield();
+      }
+    }
+  }
+}
+
+static inline void _reactor_unlock(Reactor *r) {
+  atomic_store_explicit(&r->lock, 0, memory_order_release);
+}
+
+static uint64_t _reactor_now(void) {
+  struct {
+    int64_t sec, nsec;
+  } ts = {0, 0};
+  syscall(SYS_clock_gettime, 1 /* CLOCK_MONOTONIC */, &ts);
+  return (uint64_t)ts.sec * 1000000000ull + (uint64_t)ts.nsec;
+}
+
+static int _reactor_enter(Reactor *r, uint32_t to_submit, uint32_t min_complete,
+                          uint32_t flags, void *arg, size_t arg_size) {
+  long n = syscall(SYS_io_uring_enter, r->ring_fd, to_submit, min_complete,
+                   flags, arg, arg_size);
+  return n < 0 ? -errno : (int)n;
+}
+
+static void _reactor_complete(ReactorOp *op, int64_t result) {
+  ReactorCallback cb = op->callback;
+  op->result = result;
+  if (cb) {
+    atomic_store_explicit(&op->state, _REACTOR_COMPLETED, memory_order_release);
+    cb(op);
+    return;
+  }
+  // waiters that see COMPLETING retry until COMPLETED: the op must not be
+  // released while the close still walks its parker. Closing (not an
+  // unpark) fires every registered waiter, also one that registers after
+  // this point, so none is left on the parker when the op is reused.
+  atomic_store_explicit(&op->state, _REACTOR_COMPLETING, memory_order_seq_cst);
+  chan_parker_close(&op->parker);
+  atomic_store_explicit(&op->state, _REACTOR_COMPLETED, memory_order_release);
+}
+
+/* ---------------------------------------------------------------------------
+   fixed buffers
+--------------------------------------------------------------------------- */
+
+static int _reactor_pool_init(Reactor *r, const ReactorOptions *o) {
+  size_t size = o->buffer_size ? o->buffer_size : REACTOR_DEFAULT_BUFFER_SIZE;
+  size = (size + 63) & ~(size_t)63;
+  if (o->buffer_count > UINT32_MAX - 1 || size > SIZE_MAX / o->buffer_count) {
+    return -1;
+  }
+  r->buf_size = size;
+  r->buf_count = o->buffer_count;
+  r->pool_bytes = (size * o->buffer_count + 4095) & ~(size_t)4095;
+  r->memory = o->memory;
+  r->pool = r->memory ? r->memory->alloc(r->pool_bytes, r->memory->ctx)
+                      : aligned_alloc(4096, r->pool_bytes);
+  r->buf_next = malloc(r->buf_count * sizeof(*r->buf_next));
+  if (!r->pool || !r->buf_next) {
+    return -1;
+  }
+  for (size_t i = 0; i < r->buf_count; i++) {
+    r->buf_next[i] = (uint32_t)(i + 2 <= r->buf_count ? i + 2 : 0);
+  }
+  atomic_init(&r->buf_head, 1);
+  return 0;
+}
+
+// 1 if [buf, buf + len) lies inside one pool buffer.
+static int _reactor_pool_contains(const Reactor *r, const void *buf, size_t len) {
+  const unsigned char *p = buf;
+  if (!r->pool || p < r->pool || p >= r->pool + r->buf_size * r->buf_count) {
+    return 0;
+  }
+  size_t off = (size_t)(p - r->pool) % r->buf_size;
+  return len <= r->buf_size - off;
+}
+
+void *reactor_buf_get(Reactor *r) {
+  if (!r || !r->pool) {
+    return NULL;
+  }
+  uint64_t head = atomic_load_explicit(&r->buf_head, memory_order_acquire);
+  for (;;) {
+    uint32_t idx = (uint32_t)head;
+    if (idx == 0) {
+      return NULL;
+    }
+    // a stale next is caught by the tag in the CAS
+    uint64_t next = ((head >> 32) + 1) << 32 | r->buf_next[idx - 1];
+    if (atomic_compare_exchange_weak_explicit(&r->buf_head, &head, next,
+                                              memory_order_acquire,
+                                              memory_order_acquire)) {
+      return r->pool + (size_t)(idx - 1) * r->buf_size;
+    }
+  }
+}
+
+void reactor_buf_put(Reactor *r, void *buf) {
+  if (!r || !buf) {
+    return;
+  }
+  uint32_t idx = (uint32_t)((size_t)((unsigned char *)buf - r->pool) /
+                            r->buf_size) + 1;
+  uint64_t head = atomic_load_explicit(&r->buf_head, memory_order_relaxed);
+  for (;;) {
+    r->buf_next[idx - 1] = (uint32_t)head;
+    uint64_t next = ((head >> 32) + 1) << 32 | idx;
+    if (atomic_compare_exchange_weak_explicit(&r->buf_head, &head, next,
+                                              memory_order_release,
+                                              memory_order_relaxed)) {
+      return;
+    }
+  }
+}
+
+size_t reactor_buf_size(const Reactor *r) { return r ? r->buf_size : 0; }
+
+/* ---------------------------------------------------------------------------
+   io_uring backend
+--------------------------------------------------------------------------- */
+
+// Unmaps the rings and closes the ring fd, also for a half-done
+// _reactor_uring_init: the epoll fallback must not keep them around.
+static void _reactor_uring_release(Reactor *r) {
+  if (r->sqes) {
+    munmap(r->sqes, r->sqes_size);
+  }
+  if (r->cq_map && r->cq_map != r->sq_map) {
+    munmap(r->cq_map, r->cq_map_size);
+  }
+  if (r->sq_map) {
+    munmap(r->sq_map, r->sq_map_size);
+  }
+  if (r->ring_fd >= 0) {
+    syscall(SYS_close, r->ring_fd); // also unregisters the pool
+  }
+  r->sqes = NULL;
+  r->sq_map = r->cq_map = NULL;
+  r->ring_fd = -1;
+  r->registered = 0;
+}
+
+static int _reactor_uring_init(Reactor *r, const ReactorOptions *o) {
+  struct io_uring_params p;
+  memset(&p, 0, sizeof(p));
+  if (o->sqpoll) {
+    p.flags |= IORING_SETUP_SQPOLL;
+    p.sq_thread_idle = o->sqpoll_idle_ms ? o->sqpoll_idle_ms : 1000;
+  }
+  uint32_t entries = o->entries ? o->entries : REACTOR_DEFAULT_ENTRIES;
+  long fd = syscall(SYS_io_uring_setup, entries, &p);
+  if (fd < 0) {
+    return -1;
+  }
+  r->ring_fd = (int)fd;
+  r->sqpoll = o->sqpoll ? 1 : 0;
+  r->ext_arg = (p.features & IORING_FEAT_EXT_ARG) ? 1 : 0;
+
+  r->sq_map_size = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+  r->cq_map_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  int single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single) {
+    if (r->cq_map_size > r->sq_map_size) {
+      r->sq_map_size = r->cq_map_size;
+    }
+    r->cq_map_size = r->sq_map_size;
+  }
+  r->sq_map = mmap(NULL, r->sq_map_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, r->ring_fd, IORING_OFF_SQ_RING);
+  if (r->sq_map == MAP_FAILED) {
+    r->sq_map = NULL;
+    _reactor_uring_release(r);
+    return -1;
+  }
+  if (single) {
+    r->cq_map = r->sq_map;
+  } else {
+    r->cq_map = mmap(NULL, r->cq_map_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, r->ring_fd, IORING_OFF_CQ_RING);
+    if (r->cq_map == MAP_FAILED) {
+      r->cq_map = NULL;
+      _reactor_uring_release(r);
+      return -1;
+    }
+  }
+  r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+  r->sqes = mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, r->ring_fd, IORING_OFF_SQES);
+  if (r->sqes == MAP_FAILED) {
+    r->sqes = NULL;
+    _reactor_uring_release(r);
+    return -1;
+  }
+
+  unsigned char *sq = r->sq_map, *cq = r->cq_map;
+  r->sq_head = (_Atomic uint32_t *)(sq + p.sq_off.head);
+  r->sq_tail = (_Atomic uint32_t *)(sq + p.sq_off.tail);
+  r->sq_flags = (_Atomic uint32_t *)(sq + p.sq_off.flags);
+  r->sq_mask = *(uint32_t *)(sq + p.sq_off.ring_mask);
+  r->sq_entries = p.sq_entries;
+  r->sq_array = (uint32_t *)(sq + p.sq_off.array);
+  r->cq_head = (_Atomic uint32_t *)(cq + p.cq_off.head);
+  r->cq_tail = (_Atomic uint32_t *)(cq + p.cq_off.tail);
+  r->cq_mask = *(uint32_t *)(cq + p.cq_off.ring_mask);
+  r->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+  if (r->pool) {
+    struct {
+      void *base;
+      size_t len;
+    } iov = {r->pool, r->buf_size * r->buf_count};
+    r->registered = syscall(SYS_io_uring_register, r->ring_fd,
+                            IORING_REGISTER_BUFFERS, &iov, 1) == 0;
+  }
+  return 0;
+}
+
+// Takes the published entries nobody handed to the kernel yet. Called with
+// the lock held.
+static uint32_t _reactor_uring_take(Reactor *r) {
+  uint32_t n = r->sq_pending;
+  r->sq_pending = 0;
+  return n;
+}
+
+// Hands n taken entries to the kernel (or wakes the sqpoll thread). Called
+// without the lock: io_uring_enter may sleep, and the other submitters and
+// the poller would spin on the lock meanwhile.
+static void _reactor_uring_push(Reactor *r, uint32_t n) {
+  if (r->sqpoll) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(r->sq_flags, memory_order_relaxed) &
+        IORING_SQ_NEED_WAKEUP) {
+      _reactor_enter(r, 0, 0, IORING_ENTER_SQ_WAKEUP, NULL, 0);
+    }
+    return;
+  }
+  if (n == 0) {
+    return;
+  }
+  int done = _reactor_enter(r, n, 0, 0, NULL, 0);
+  if (done < 0) {
+    done = 0;
+  }
+  if ((uint32_t)done < n) {
+    // still in the ring, the poller submits them on its next pass
+    _reactor_lock(r);
+    r->sq_pending += n - (uint32_t)done;
+    _reactor_unlock(r);
+  }
+}
+
+static inline uint32_t _reactor_uring_room(Reactor *r, uint32_t tail) {
+  return r->sq_entries -
+         (tail - atomic_load_explicit(r->sq_head, memory_order_acquire));
+}
+
+static int _reactor_uring_submit(Reactor *r, ReactorOp *op) {
+  _reactor_lock(r);
+  uint32_t tail = atomic_load_explicit(r->sq_tail, memory_order_relaxed);
+  if (_reactor_uring_room(r, tail) == 0) {
+    uint32_t n = _reactor_uring_take(r);
+    _reactor_unlock(r);
+    _reactor_uring_push(r, n);
+    _reactor_lock(r);
+    tail = atomic_load_explicit(r->sq_tail, memory_order_relaxed);
+    if (_reactor_uring_room(r, tail) == 0) {
+      _reactor_unlock(r);
+      return REACTOR_ERR_BUSY;
+    }
+  }
+  uint32_t idx = tail & r->sq_mask;
+  struct io_uring_sqe *sqe = &r->sqes[idx];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->fd = op->fd;
+  sqe->user_data = (uint64_t)(uintptr_t)op;
+  switch (op->kind) {
+  case REACTOR_OP_READ:
+  case REACTOR_OP_WRITE: {
+    int fixed = r->registered && _reactor_pool_contains(r, op->buf, op->len);
+    if (op->kind == REACTOR_OP_READ) {
+      sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    } else {
+      sqe->opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    }
+    sqe->addr = (uint64_t)(uintptr_t)op->buf;
+    sqe->len = op->len > UINT32_MAX ? UINT32_MAX : (uint32_t)op->len;
+    sqe->off = (uint64_t)op->offset; // -1 = current position
+    sqe->buf_index = 0;              // the pool is one registered buffer
+    break;
+  }
+  case REACTOR_OP_ACCEPT:
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    break;
+  case REACTOR_OP_TIMEOUT:
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = (uint64_t)(uintptr_t)op->timeout;
+    sqe->len = 1;
+    break;
+  }
+  r->sq_array[idx] = idx;
+  atomic_store_explicit(r->sq_tail, tail + 1, memory_order_release);
+  r->sq_pending += r->sqpoll ? 0 : 1;
+  // a polling thread takes sq_pending with it into its wait; once it is in
+  // there nobody else submits, so do it here
+  uint32_t n = r->sleeping ? _reactor_uring_take(r) : 0;
+  _reactor_unlock(r);
+  if (n || r->sqpoll) {
+    _reactor_uring_push(r, n);
+  }
+  return REACTOR_OK;
+}
+
+static size_t _reactor_uring_reap(Reactor *r) {
+  size_t done = 0;
+  uint32_t head = atomic_load_explicit(r->cq_head, memory_order_relaxed);
+  for (;;) {
+    uint32_t tail = atomic_load_explicit(r->cq_tail, memory_order_acquire);
+    if (head == tail) {
+      break;
+    }
+    while (head != tail) {
+      struct io_uring_cqe *cqe = &r->cqes[head & r->cq_mask];
+      ReactorOp *op = (ReactorOp *)(uintptr_t)cqe->user_data;
+      int64_t res = cqe->res;
+      head++;
+      if (!op) {
+        continue; // reactor_stop's wake-up nop
+      }
+      if (op->kind == REACTOR_OP_TIMEOUT && res == -ETIME) {
+        res = 0;
+      }
+      _reactor_complete(op, res);
+      done++;
+    }
+    atomic_store_explicit(r->cq_head, head, memory_order_release);
+  }
+  return done;
+}
+
+static size_t _reactor_uring_poll(Reactor *r, int timeout_ms) {
+  size_t done = _reactor_uring_reap(r);
+  int wait = done == 0 && timeout_ms != 0 &&
+             !atomic_load_explicit(&r->stopping, memory_order_acquire);
+
+  _reactor_lock(r);
+  uint32_t to_submit = r->sqpoll ? 0 : r->sq_pending;
+  r->sq_pending = 0;
+  r->sleeping = (uint32_t)wait;
+  _reactor_unlock(r);
+
+  if (wait) {
+    struct __kernel_timespec ts = {timeout_ms / 1000,
+                                   (long long)(timeout_ms % 1000) * 1000000};
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.ts = (uint64_t)(uintptr_t)&ts;
+    uint32_t flags = IORING_ENTER_GETEVENTS;
+    void *argp = NULL;
+    size_t arg_size = 0;
+    if (timeout_ms > 0 && r->ext_arg) {
+      flags |= IORING_ENTER_EXT_ARG;
+      argp = &arg;
+      arg_size = sizeof(arg);
+    } else if (timeout_ms > 0) {
+      flags = 0; // no timed wait on this kernel: only submit
+    }
+    if (r->sqpoll && (atomic_load_explicit(r->sq_flags, memory_order_relaxed) &
+                      IORING_SQ_NEED_WAKEUP)) {
+      flags |= IORING_ENTER_SQ_WAKEUP;
+    }
+    _reactor_enter(r, to_submit, flags ? 1 : 0, flags, argp, arg_size);
+    _reactor_lock(r);
+    r->sleeping = 0;
+    _reactor_unlock(r);
+  } else if (to_submit) {
+    _reactor_enter(r, to_submit, 0, 0, NULL, 0);
+  }
+  return done + _reactor_uring_reap(r);
+}
+
+static void _reactor_uring_wake(Reactor *r) {
+  _reactor_lock(r);
+  uint32_t tail = atomic_load_explicit(r->sq_tail, memory_order_relaxed);
+  if (_reactor_uring_room(r, tail) != 0) {
+    uint32_t idx = tail & r->sq_mask;
+    memset(&r->sqes[idx], 0, sizeof(r->sqes[idx]));
+    r->sqes[idx].opcode = IORING_OP_NOP;
+    r->sq_array[idx] = idx;
+    atomic_store_explicit(r->sq_tail, tail + 1, memory_order_release);
+    r->sq_pending += r->sqpoll ? 0 : 1;
+  }
+  uint32_t n = _reactor_uring_take(r);
+  _reactor_unlock(r);
+  _reactor_uring_push(r, n);
+}
+
+/* ---------------------------------------------------------------------------
+   epoll backend
+--------------------------------------------------------------------------- */
+
+static int _reactor_epoll_init(Reactor *r) {
+  long ep = syscall(SYS_epoll_create1, 02000000 /* EPOLL_CLOEXEC */);
+  if (ep < 0) {
+    return -1;
+  }
+  r->epoll_fd = (int)ep;
+  long ev = syscall(SYS_eventfd2, 0, 02000000 | 04000 /* CLOEXEC|NONBLOCK */);
+  if (ev < 0) {
+    return -1;
+  }
+  r->event_fd = (int)ev;
+  struct epoll_event e;
+  memset(&e, 0, sizeof(e));
+  e.events = EPOLLIN;
+  e.data.u64 = 0; // fds are stored as fd + 1
+  if (syscall(SYS_epoll_ctl, r->epoll_fd, EPOLL_CTL_ADD, r->event_fd, &e) < 0) {
+    return -1;
+  }
+  return 0;
+}
+
+// Runs op once. Returns 1 if it completed, 0 if the fd is not ready.
+static int _reactor_epoll_try(ReactorOp *op) {
+  long n;
+  switch (op->kind) {
+  case REACTOR_OP_READ:
+    n = op->offset < 0
+            ? syscall(SYS_read, op->fd, op->buf, op->len)
+            : syscall(SYS_pread64, op->fd, op->buf, op->len, op->offset);
+    break;
+  case REACTOR_OP_WRITE:
+    n = op->offset < 0
+            ? syscall(SYS_write, op->fd, op->buf, op->len)
+            : syscall(SYS_pwrite64, op->fd, op->buf, op->len, op->offset);
+    break;
+  default:
+    n = syscall(SYS_accept4, op->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    break;
+  }
+  if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+    return 0;
+  }
+  _reactor_complete(op, n < 0 ? -(int64_t)errno : (int64_t)n);
+  return 1;
+}
+
+static void _reactor_timer_push(Reactor *r, ReactorOp *op) {
+  size_t i = r->timers_len++;
+  while (i > 0) {
+    size_t parent = (i - 1) / 2;
+    if (r->timers[parent]->deadline <= op->deadline) {
+      break;
+    }
+    r->timers[i] = r->timers[parent];
+    i = parent;
+  }
+  r->timers[i] = op;
+}
+
+static ReactorOp *_reactor_timer_pop(Reactor *r) {
+  ReactorOp *top = r->timers[0];
+  ReactorOp *last = r->timers[--r->timers_len];
+  size_t i = 0;
+  for (;;) {
+    size_t child = 2 * i + 1;
+    if (child >= r->timers_len) {
+      break;
+    }
+    if (child + 1 < r->timers_len &&
+        r->timers[child + 1]->deadline < r->timers[child]->deadline) {
+      child++;
+    }
+    if (last->deadline <= r->timers[child]->deadline) {
+      break;
+    }
+    r->timers[i] = r->timers[child];
+    i = child;
+  }
+  if (r->timers_len) {
+    r->timers[i] = last;
+  }
+  return top;
+}
+
+// Arms fd for whatever its queues wait on (one-shot).
+static void _reactor_epoll_arm(Reactor *r, int fd) {
+  _ReactorFd *f = &r->fds[fd];
+  uint32_t want = (f->rd_head ? (uint32_t)EPOLLIN : 0) |
+                  (f->wr_head ? (uint32_t)EPOLLOUT : 0);
+  if (!want) {
+    f->events = 0; // one-shot: already disarmed by the event that fired
+    return;
+  }
+  struct epoll_event e;
+  memset(&e, 0, sizeof(e));
+  e.events = want | EPOLLONESHOT;
+  e.data.u64 = (uint64_t)fd + 1;
+  int op = f->added ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+  if (syscall(SYS_epoll_ctl, r->epoll_fd, op, fd, &e) == 0) {
+    f->added = 1;
+    f->events = want;
+    return;
+  }
+  // not pollable (or bad fd): fail every op waiting on it
+  int64_t err = -(int64_t)errno;
+  ReactorOp *lists[2] = {f->rd_head, f->wr_head};
+  f->rd_head = f->rd_tail = f->wr_head = f->wr_tail = NULL;
+  for (int i = 0; i < 2; i++) {
+    for (ReactorOp *op = lists[i], *next; op; op = next) {
+      next = op->next;
+      _reactor_complete(op, err);
+    }
+  }
+}
+
+// Starts an op on the polling thread. Returns 1 if it completed.
+static int _reactor_epoll_start(Reactor *r, ReactorOp *op) {
+  if (op->kind == REACTOR_OP_TIMEOUT) {
+    if (r->timers_len == r->timers_cap) {
+      size_t cap = r->timers_cap ? r->timers_cap * 2 : 64;
+      ReactorOp **t = realloc(r->timers, cap * sizeof(*t));
+      if (!t) {
+        _reactor_complete(op, -ENOMEM);
+        return 1;
+      }
+      r->timers = t;
+      r->timers_cap = cap;
+    }
+    _reactor_timer_push(r, op);
+    return 0;
+  }
+
+  if (op->fd < 0) {
+    _reactor_complete(op, -EBADF);
+    return 1;
+  }
+  if ((size_t)op->fd >= r->fds_cap) {
+    size_t cap = r->fds_cap ? r->fds_cap : 64;
+    while (cap <= (size_t)op->fd) {
+      cap *= 2;
+    }
+    _ReactorFd *f = realloc(r->fds, cap * sizeof(*f));
+    if (!f) {
+      _reactor_complete(op, -ENOMEM);
+      return 1;
+    }
+    memset(f + r->fds_cap, 0, (cap - r->fds_cap) * sizeof(*f));
+    r->fds = f;
+    r->fds_cap = cap;
+  }
+  _ReactorFd *f = &r->fds[op->fd];
+  int reading = op->kind != REACTOR_OP_WRITE;
+  ReactorOp **head = reading ? &f->rd_head : &f->wr_head;
+  ReactorOp **tail = reading ? &f->rd_tail : &f->wr_tail;
+  // earlier ops on this side go first
+  if (!*head && _reactor_epoll_try(op)) {
+    return 1;
+  }
+  op->next = NULL;
+  if (*tail) {
+    (*tail)->next = op;
+  } else {
+    *head = op;
+  }
+  *tail = op;
+  _reactor_epoll_arm(r, op->fd);
+  return 0;
+}
+
+static int _reactor_epoll_submit(Reactor *r, ReactorOp *op) {
+  _reactor_lock(r);
+  op->next = r->incoming;
+  r->incoming = op;
+  if (r->sleeping && !r->kicked) {
+    uint64_t one = 1;
+    r->kicked = 1;
+    syscall(SYS_write, r->event_fd, &one, sizeof(one));
+  }
+  _reactor_unlock(r);
+  return REACTOR_OK;
+}
+
+static size_t _reactor_epoll_drain_side(ReactorOp **head, ReactorOp **tail) {
+  size_t done = 0;
+  while (*head) {
+    ReactorOp *op = *head;
+    ReactorOp *next = op->next;
+    if (!_reactor_epoll_try(op)) {
+      break;
+    }
+    done++;
+    *head = next;
+    if (!next) {
+      *tail = NULL;
+    }
+  }
+  return done;
+}
+
+static size_t _reactor_epoll_poll(Reactor *r, int timeout_ms) {
+  size_t done = 0;
+
+  _reactor_lock(r);
+  ReactorOp *list = r->incoming;
+  r->incoming = NULL;
+  _reactor_unlock(r);
+  ReactorOp *fifo = NULL;
+  while (list) {
+    ReactorOp *next = list->next;
+    list->next = fifo;
+    fifo = list;
+    list = next;
+  }
+  while (fifo) {
+    ReactorOp *next = fifo->next;
+    done += (size_t)_reactor_epoll_start(r, fifo);
+    fifo = next;
+  }
+
+  int timeout = done || atomic_load_explicit(&r->stopping, memory_order_acquire)
+                    ? 0
+                    : timeout_ms;
+  if (r->timers_len && timeout != 0) {
+    uint64_t now = _reactor_now();
+    uint64_t deadline = r->timers[0]->deadline;
+    uint64_t ms = deadline > now ? (deadline - now + 999999) / 1000000 : 0;
+    if (timeout < 0 || ms < (uint64_t)timeout) {
+      timeout = (int)(ms > INT32_MAX ? INT32_MAX : ms);
+    }
+  }
+
+  _reactor_lock(r);
+  if (r->incoming) {
+    timeout = 0;
+  }
+  r->sleeping = timeout != 0;
+  _reactor_unlock(r);
+
+  struct epoll_event events[REACTOR_EPOLL_EVENTS];
+  long n = syscall(SYS_epoll_pwait, r->epoll_fd, events, REACTOR_EPOLL_EVENTS,
+                   timeout, NULL, 8);
+
+  _reactor_lock(r);
+  r->sleeping = 0;
+  _reactor_unlock(r);
+
+  for (long i = 0; i < n; i++) {
+    if (events[i].data.u64 == 0) {
+      uint64_t count;
+      _reactor_lock(r);
+      r->kicked = 0;
+      syscall(SYS_read, r->event_fd, &count, sizeof(count));
+      _reactor_unlock(r);
+      continue;
+    }
+    int fd = (int)(events[i].data.u64 - 1);
+    _ReactorFd *f = &r->fds[fd];
+    if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+      done += _reactor_epoll_drain_side(&f->rd_head, &f->rd_tail);
+    }
+    if (events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) {
+      done += _reactor_epoll_drain_side(&f->wr_head, &f->wr_tail);
+    }
+    _reactor_epoll_arm(r, fd);
+  }
+
+  if (r->timers_len) {
+    uint64_t now = _reactor_now();
+    while (r->timers_len && r->timers[0]->deadline <= now) {
+      _reactor_complete(_reactor_timer_pop(r), 0);
+      done++;
+    }
+  }
+  return done;
+}
+
+/* ---------------------------------------------------------------------------
+   public API
+--------------------------------------------------------------------------- */
+
+Reactor *reactor_create(const ReactorOptions *opts) {
+  ReactorOptions o;
+  memset(&o, 0, sizeof(o));
+  if (opts) {
+    o = *opts;
+  }
+  Reactor *r = calloc(1, sizeof(Reactor));
+  if (!r) {
+    return NULL;
+  }
+  r->ring_fd = r->epoll_fd = r->event_fd = -1;
+  atomic_init(&r->lock, 0);
+  atomic_init(&r->stopping, 0);
+  atomic_init(&r->buf_head, 0);
+  if (o.buffer_count && _reactor_pool_init(r, &o) != 0) {
+    reactor_destroy(r);
+    return NULL;
+  }
+
+  if (o.backend != REACTOR_BACKEND_EPOLL) {
+    if (_reactor_uring_init(r, &o) == 0) {
+      r->backend = REACTOR_BACKEND_IO_URING;
+      return r;
+    }
+    if (o.backend == REACTOR_BACKEND_IO_URING) {
+      reactor_destroy(r);
+      return NULL;
+    }
+  }
+  if (_reactor_epoll_init(r) != 0) {
+    reactor_destroy(r);
+    return NULL;
+  }
+  r->backend = REACTOR_BACKEND_EPOLL;
+  return r;
+}
+
+ReactorBackend reactor_backend(const Reactor *r) {
+  return r ? r->backend : REACTOR_BACKEND_AUTO;
+}
+
+static int _reactor_submit(Reactor *r, ReactorOp *op) {
+  if (atomic_load_explicit(&r->stopping, memory_order_acquire)) {
+    return REACTOR_ERR_STOPPED;
+  }
+  op->result = 0;
+  // reopens the parker: the last completion closed it, which fired and
+  // dropped all its waiters
+  chan_parker_init(&op->parker);
+  atomic_store_explicit(&op->state, _REACTOR_PENDING, memory_order_relaxed);
+  if (r->backend == REACTOR_BACKEND_IO_URING) {
+    return _reactor_uring_submit(r, op);
+  }
+  return _reactor_epoll_submit(r, op);
+}
+
+int reactor_read(Reactor *r, ReactorOp *op, int fd, void *buf, size_t len,
+                 int64_t offset) {
+  if (!r || !op) {
+    return REACTOR_ERR_NULL;
+  }
+  op->kind = REACTOR_OP_READ;
+  op->fd = fd;
+  op->buf = buf;
+  op->len = len;
+  op->offset = offset < 0 ? -1 : offset;
+  return _reactor_submit(r, op);
+}
+
+int reactor_write(Reactor *r, ReactorOp *op, int fd, const void *buf,
+                  size_t len, int64_t offset) {
+  if (!r || !op) {
+    return REACTOR_ERR_NULL;
+  }
+  op->kind = REACTOR_OP_WRITE;
+  op->fd = fd;
+  op->buf = (void *)buf;
+  op->len = len;
+  op->offset = offset < 0 ? -1 : offset;
+  return _reactor_submit(r, op);
+}
+
+int reactor_accept(Reactor *r, ReactorOp *op, int fd) {
+  if (!r || !op) {
+    return REACTOR_ERR_NULL;
+  }
+  op->kind = REACTOR_OP_ACCEPT;
+  op->fd = fd;
+  op->buf = NULL;
+  op->len = 0;
+  return _reactor_submit(r, op);
+}
+
+int reactor_timeout(Reactor *r, ReactorOp *op, uint64_t ns) {
+  if (!r || !op) {
+    return REACTOR_ERR_NULL;
+  }
+  op->kind = REACTOR_OP_TIMEOUT;
+  op->fd = -1;
+  op->timeout[0] = (int64_t)(ns / 1000000000ull);
+  op->timeout[1] = (int64_t)(ns % 1000000000ull);
+  op->deadline = _reactor_now() + ns;
+  return _reactor_submit(r, op);
+}
+
+static int _reactor_attempt(void *arg) {
+  ReactorOp *op = arg;
+  switch (atomic_load_explicit(&op->state, memory_order_seq_cst)) {
+  case _REACTOR_COMPLETED:
+    return CHAN_AWAIT_DONE;
+  case _REACTOR_COMPLETING:
+    return CHAN_AWAIT_RETRY;
+  default:
+    return CHAN_AWAIT_PARK;
+  }
+}
+
+int64_t reactor_wait(ReactorOp *op) {
+  chan_await(&op->parker, _reactor_attempt, op);
+  return op->result;
+}
+
+int reactor_op_done(ReactorOp *op) {
+  return atomic_load_explicit(&op->state, memory_order_acquire) ==
+         _REACTOR_COMPLETED;
+}
+
+size_t reactor_poll(Reactor *r, int timeout_ms) {
+  if (!r) {
+    return 0;
+  }
+  if (r->backend == REACTOR_BACKEND_IO_URING) {
+    return _reactor_uring_poll(r, timeout_ms);
+  }
+  return _reactor_epoll_poll(r, timeout_ms);
+}
+
+void reactor_run(Reactor *r) {
+  while (!atomic_load_explicit(&r->stopping, memory_order_acquire)) {
+    reactor_poll(r, -1);
+  }
+}
+
+void *reactor_host(void *reactor) {
+  reactor_run(reactor);
+  return NULL;
+}
+
+void reactor_host_job(void *reactor) { reactor_run(reactor); }
+
+void reactor_stop(Reactor *r) {
+  if (!r) {
+    return;
+  }
+  atomic_store_explicit(&r->stopping, 1, memory_order_seq_cst);
+  if (r->backend == REACTOR_BACKEND_IO_URING) {
+    _reactor_uring_wake(r);
+  } else {
+    uint64_t one = 1;
+    syscall(SYS_write, r->event_fd, &one, sizeof(one));
+  }
+}
+
+void reactor_destroy(Reactor *r) {
+  if (!r) {
+    return;
+  }
+  _reactor_uring_release(r);
+  if (r->event_fd >= 0) {
+    syscall(SYS_close, r->event_fd);
+  }
+  if (r->epoll_fd >= 0) {
+    syscall(SYS_close, r->epoll_fd);
+  }
+  if (r->pool) {
+    if (r->memory) {
+      r->memory->release(r->pool, r->pool_bytes, r->memory->ctx);
+    } else {
+      free(r->pool);
+    }
+  }
+  free(r->buf_next);
+  free(r->fds);
+  free(r->timers);
+  free(r);
+}
+
+#if defined(JOB_SYSTEM_H)
+static void _reactor_job_callback(ReactorOp *op) { job_wait(op->user); }
+
+void reactor_op_then_job(ReactorOp *op, JobHandle *job) {
+  op->callback = _reactor_job_callback;
+  op->user = job;
+}
+#endif
+#endif
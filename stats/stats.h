@@ -0,0 +1,490 @@
+// Copyright 2025 Seaker <seakerone@proton.me>
+
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+/*
+------------------------------------------------------------------------------
+stats.h — Opt-in per-thread counters and job tracing
+
+Counters for the scheduler, the thread pool, MPMC channels and region
+arenas, to tell a starved worker from a full queue or a slow reset:
+
+- every thread that records gets its own counter block (cache-line
+  aligned, found through a thread-local pointer); only the owner writes
+  it, with plain relaxed load + store, so counting does no shared atomic
+  read-modify-write and no cache line bounces between threads
+- stats_snapshot() copies every thread's block, stats_total() adds them up
+- stats_trace_start() / stats_trace_write() record one event per job run
+  (begin, end, function) and write them as a Chrome trace (JSON), which
+  chrome://tracing and ui.perfetto.dev open: one track per worker, the
+  critical path of a job graph shows as the chain of slices that never
+  overlaps its successor
+
+Instrumentation is opt-in at compile time: stats.h must be included before
+the headers to instrument (r_arena.h, mpmc.h, threadpool.h, jobsystem.h).
+Without it those headers compile exactly as before, no counter code at all.
+
+------------------------------------------------------------------------------
+USAGE
+
+In exactly ONE source file:
+
+    #define STATS_IMPLEMENTATION
+    #include "stats/stats.h"
+    #define REGION_ARENA_IMPLEMENTATION
+    #include "arenas/r_arena.h"
+    ... // channels, threadpool, job system as usual
+
+    stats_trace_start();
+    run_frame();
+    stats_trace_stop();
+    stats_trace_write("frame.json");
+
+    StatsSnapshot threads[64], total;
+    size_t n = stats_snapshot(threads, 64);
+    stats_total(&total);
+    for (size_t c = 0; c < STATS_COUNT; c++) {
+        printf("%s %llu\n", stats_counter_name(c),
+               (unsigned long long)total.counters[c]);
+    }
+
+------------------------------------------------------------------------------
+COUNTERS
+
+STATS_JOBS_EXECUTED      : jobs run (job system and thread pool workers)
+STATS_WORKER_IDLE_ROUNDS : wait steps of job workers finding no work
+STATS_WORKER_PARKS       : times an idle job worker went to sleep
+STATS_MPMC_SEND_SPINS    : wait steps of mpmc sends on a full slot
+STATS_MPMC_RECV_SPINS    : wait steps of mpmc receives on an empty slot
+STATS_MPMC_FULL          : mpmc sends that found the ring full
+STATS_MPMC_EMPTY         : mpmc receives that found the ring empty
+STATS_MPMC_DEPTH_MAX     : high-water mark of elements queued, at a send
+STATS_WS_DEPTH_MAX       : high-water mark of a worker's local deque
+STATS_ARENA_RESETS       : r_arena_reset / r_arena_reset_mode calls
+STATS_ARENA_RESET_NS     : time spent in them
+STATS_ARENA_CLEARS       : regions zeroed on first use after a reset
+STATS_ARENA_CLEAR_NS     : time spent zeroing them (the deferred part of
+                           a reset)
+STATS_TRACE_DROPPED      : trace events lost to a full buffer
+
+*_MAX counters are maxima, everything else is a sum. The mpmc counters
+cover mpmc_send / mpmc_recv / mpmc_try_send / mpmc_try_recv and
+everything built on them (reserve / peek, await, the job queues).
+
+------------------------------------------------------------------------------
+NOTES
+
+- A counter block outlives its thread (counts of finished workers stay in
+  the snapshot); one block per thread that ever recorded, ~200 bytes.
+- stats_reset() rebases the sums, so it is exact while threads run. The
+  maxima are cleared in place: a racing update may survive the reset.
+- Tracing keeps STATS_TRACE_EVENTS events per thread and counts the rest
+  in STATS_TRACE_DROPPED. Call stats_trace_write after stats_trace_stop,
+  once the traced jobs are done.
+- Trace slices are named by function address ("0x4012a0"); `addr2line -f`
+  or `nm` on the binary gives the name (subtract the load base for PIE).
+- stats_reset and the stats_trace_* calls are meant for one controlling
+  thread at a time.
+
+------------------------------------------------------------------------------
+*/
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef STATS_TRACE_EVENTS
+#define STATS_TRACE_EVENTS 65536 // trace events kept per thread
+#endif
+
+typedef enum {
+  STATS_JOBS_EXECUTED = 0,
+  STATS_WORKER_IDLE_ROUNDS,
+  STATS_WORKER_PARKS,
+  STATS_MPMC_SEND_SPINS,
+  STATS_MPMC_RECV_SPINS,
+  STATS_MPMC_FULL,
+  STATS_MPMC_EMPTY,
+  STATS_MPMC_DEPTH_MAX,
+  STATS_WS_DEPTH_MAX,
+  STATS_ARENA_RESETS,
+  STATS_ARENA_RESET_NS,
+  STATS_ARENA_CLEARS,
+  STATS_ARENA_CLEAR_NS,
+  STATS_TRACE_DROPPED,
+  STATS_COUNT
+} StatsCounter;
+
+// One job run, times from stats_now_ns
+typedef struct StatsTraceEvent_t {
+  uint64_t begin_ns;
+  uint64_t end_ns;
+  uintptr_t fn;
+  const void *job;
+} StatsTraceEvent;
+
+/*-----------------------------------------------------------------------------
+  StatsThread
+  Counter block of one thread.
+
+  counters    : written by the owner only
+  base        : sums at the last stats_reset
+  label/index : set by stats_thread_label ("job worker", 3)
+  events      : trace buffer, allocated on the first traced job
+-----------------------------------------------------------------------------*/
+typedef struct StatsThread_t {
+  _Atomic uint64_t counters[STATS_COUNT];
+  _Atomic uint64_t base[STATS_COUNT];
+  struct StatsThread_t *next;
+  size_t id; // registration order
+  _Atomic(const char *) label;
+  _Atomic size_t index;
+  StatsTraceEvent *events;
+  _Atomic size_t event_count;
+  _Atomic uint32_t trace_epoch; // trace session the events belong to
+} StatsThread;
+
+typedef struct StatsSnapshot_t {
+  size_t id;
+  const char *label; // NULL when the thread never called stats_thread_label
+  size_t index;
+  uint64_t counters[STATS_COUNT];
+} StatsSnapshot;
+
+extern _Thread_local StatsThread *t_stats;
+extern _Atomic uint32_t g_stats_tracing; // trace epoch, 0 = not tracing
+
+StatsThread *_stats_register(void);
+void _stats_trace_record(uintptr_t fn, const void *job, uint64_t begin_ns);
+
+static inline StatsThread *_stats_local(void) {
+  StatsThread *t = t_stats;
+  return __builtin_expect(t != NULL, 1) ? t : _stats_register();
+}
+
+/*-----------------------------------------------------------------------------
+  stats_add / stats_max
+  Adds n to counter c / raises counter c to v, on the calling thread.
+-----------------------------------------------------------------------------*/
+static inline void stats_add(StatsCounter c, uint64_t n) {
+  _Atomic uint64_t *p = &_stats_local()->counters[c];
+  atomic_store_explicit(p, atomic_load_explicit(p, memory_order_relaxed) + n,
+                        memory_order_relaxed);
+}
+
+static inline void stats_max(StatsCounter c, uint64_t v) {
+  _Atomic uint64_t *p = &_stats_local()->counters[c];
+  if (v > atomic_load_explicit(p, memory_order_relaxed)) {
+    atomic_store_explicit(p, v, memory_order_relaxed);
+  }
+}
+
+// 1 while a trace session is recording
+static inline int stats_tracing(void) {
+  return atomic_load_explicit(&g_stats_tracing, memory_order_relaxed) != 0;
+}
+
+uint64_t stats_now_ns(void);
+
+/*-----------------------------------------------------------------------------
+  stats_trace_job
+  Records one job run on the calling thread: begin_ns (stats_now_ns taken
+  before the call) to now. Does nothing when no session is recording.
+-----------------------------------------------------------------------------*/
+static inline void stats_trace_job(uintptr_t fn, const void *job,
+                                   uint64_t begin_ns) {
+  if (stats_tracing()) {
+    _stats_trace_record(fn, job, begin_ns);
+  }
+}
+
+/*-----------------------------------------------------------------------------
+  stats_thread_label
+  Names the calling thread in snapshots and traces, e.g. ("job worker", 2).
+  label must stay valid (a string literal).
+-----------------------------------------------------------------------------*/
+void stats_thread_label(const char *label, size_t index);
+
+/*-----------------------------------------------------------------------------
+  stats_snapshot
+  Copies the counters of up to max threads into out.
+
+  Returns the number of threads that have a counter block (may be > max).
+
+  Notes:
+    - Most recently registered thread first; id gives registration order.
+    - Values are read while their owners keep counting: each one is exact
+      at some point during the call, not all at the same point.
+-----------------------------------------------------------------------------*/
+size_t stats_snapshot(StatsSnapshot *out, size_t max);
+
+/*-----------------------------------------------------------------------------
+  stats_total
+  Sums over every thread (maximum for the *_MAX counters), label "total".
+-----------------------------------------------------------------------------*/
+void stats_total(StatsSnapshot *out);
+
+/*-----------------------------------------------------------------------------
+  stats_reset
+  Starts every counter of every thread over from 0.
+-----------------------------------------------------------------------------*/
+void stats_reset(void);
+
+const char *stats_counter_name(StatsCounter c);
+
+/*-----------------------------------------------------------------------------
+  stats_trace_start / stats_trace_stop
+  Starts a new trace session (previous events are dropped) / stops
+  recording. Jobs running across stats_trace_stop may still be recorded.
+-----------------------------------------------------------------------------*/
+void stats_trace_start(void);
+void stats_trace_stop(void);
+
+/*-----------------------------------------------------------------------------
+  stats_trace_write
+  Writes the events of the last session to path, Chrome trace format.
+
+  Returns:
+    - 0  on success
+    - -1 if path could not be written
+-----------------------------------------------------------------------------*/
+int stats_trace_write(const char *path);
+
+#endif // !STATS_H
+
+#if (defined(STATS_IMPLEMENTATION))
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+_Thread_local StatsThread *t_stats = NULL;
+_Atomic uint32_t g_stats_tracing = 0;
+
+static _Atomic(StatsThread *) g_stats_threads = NULL;
+static atomic_size_t g_stats_next_id = 0;
+static uint32_t g_stats_trace_epoch = 0; // last session started
+static uint64_t g_stats_trace_t0 = 0;
+
+static const char *const g_stats_names[STATS_COUNT] = {
+    "jobs_executed",   "worker_idle_rounds", "worker_parks",
+    "mpmc_send_spins", "mpmc_recv_spins",    "mpmc_full",
+    "mpmc_empty",      "mpmc_depth_max",     "ws_depth_max",
+    "arena_resets",    "arena_reset_ns",     "arena_clears",
+    "arena_clear_ns",  "trace_dropped"};
+
+static inline int _stats_is_max(size_t c) {
+  return c == STATS_MPMC_DEPTH_MAX || c == STATS_WS_DEPTH_MAX;
+}
+
+uint64_t stats_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+StatsThread *_stats_register(void) {
+  // own cache lines: the owner's stores never hit a neighbour's block
+  size_t size = (sizeof(StatsThread) + 63) & ~(size_t)63;
+  StatsThread *t = aligned_alloc(64, size);
+  if (!t) {
+    abort();
+  }
+  memset(t, 0, size);
+  for (size_t c = 0; c < STATS_COUNT; c++) {
+    atomic_init(&t->counters[c], 0);
+    atomic_init(&t->base[c], 0);
+  }
+  atomic_init(&t->label, NULL);
+  atomic_init(&t->index, 0);
+  atomic_init(&t->event_count, 0);
+  atomic_init(&t->trace_epoch, 0);
+  t->events = NULL;
+  t->id = atomic_fetch_add_explicit(&g_stats_next_id, 1, memory_order_relaxed);
+
+  // blocks are never unlinked, readers walk the list without a lock
+  StatsThread *head = atomic_load_explicit(&g_stats_threads,
+                                           memory_order_relaxed);
+  do {
+    t->next = head;
+  } while (!atomic_compare_exchange_weak_explicit(
+      &g_stats_threads, &head, t, memory_order_release, memory_order_relaxed));
+  t_stats = t;
+  return t;
+}
+
+void stats_thread_label(const char *label, size_t index) {
+  StatsThread *t = _stats_local();
+  atomic_store_explicit(&t->index, index, memory_order_relaxed);
+  atomic_store_explicit(&t->label, label, memory_order_release);
+}
+
+static void _stats_copy(const StatsThread *t, StatsSnapshot *out) {
+  out->id = t->id;
+  out->label = atomic_load_explicit(&t->label, memory_order_acquire);
+  out->index = atomic_load_explicit(&t->index, memory_order_relaxed);
+  for (size_t c = 0; c < STATS_COUNT; c++) {
+    uint64_t v = atomic_load_explicit(&t->counters[c], memory_order_relaxed);
+    if (!_stats_is_max(c)) {
+      v -= atomic_load_explicit(&t->base[c], memory_order_relaxed);
+    }
+    out->counters[c] = v;
+  }
+}
+
+size_t stats_snapshot(StatsSnapshot *out, size_t max) {
+  size_t n = 0;
+  StatsThread *t = atomic_load_explicit(&g_stats_threads, memory_order_acquire);
+  for (; t; t = t->next, n++) {
+    if (n < max) {
+      _stats_copy(t, &out[n]);
+    }
+  }
+  return n;
+}
+
+void stats_total(StatsSnapshot *out) {
+  memset(out, 0, sizeof(*out));
+  out->label = "total";
+  StatsThread *t = atomic_load_explicit(&g_stats_threads, memory_order_acquire);
+  for (; t; t = t->next) {
+    StatsSnapshot s;
+    _stats_copy(t, &s);
+    for (size_t c = 0; c < STATS_COUNT; c++) {
+      if (_stats_is_max(c)) {
+        out->counters[c] =
+            s.counters[c] > out->counters[c] ? s.counters[c] : out->counters[c];
+      } else {
+        out->counters[c] += s.counters[c];
+      }
+    }
+  }
+}
+
+void stats_reset(void) {
+  StatsThread *t = atomic_load_explicit(&g_stats_threads, memory_order_acquire);
+  for (; t; t = t->next) {
+    for (size_t c = 0; c < STATS_COUNT; c++) {
+      if (_stats_is_max(c)) {
+        atomic_store_explicit(&t->counters[c], 0, memory_order_relaxed);
+      } else {
+        uint64_t v =
+            atomic_load_explicit(&t->counters[c], memory_order_relaxed);
+        atomic_store_explicit(&t->base[c], v, memory_order_relaxed);
+      }
+    }
+  }
+}
+
+const char *stats_counter_name(StatsCounter c) {
+  return (unsigned)c < STATS_COUNT ? g_stats_names[c] : "unknown";
+}
+
+void stats_trace_start(void) {
+  g_stats_trace_t0 = stats_now_ns();
+  g_stats_trace_epoch = g_stats_trace_epoch + 1 ? g_stats_trace_epoch + 1 : 1;
+  // release: a thread that sees the epoch also sees t0
+  atomic_store_explicit(&g_stats_tracing, g_stats_trace_epoch,
+                        memory_order_release);
+}
+
+void stats_trace_stop(void) {
+  atomic_store_explicit(&g_stats_tracing, 0, memory_order_release);
+}
+
+void _stats_trace_record(uintptr_t fn, const void *job, uint64_t begin_ns) {
+  uint32_t epoch = atomic_load_explicit(&g_stats_tracing, memory_order_acquire);
+  if (epoch == 0) {
+    return;
+  }
+  StatsThread *t = _stats_local();
+  size_t n = atomic_load_explicit(&t->event_count, memory_order_relaxed);
+  if (atomic_load_explicit(&t->trace_epoch, memory_order_relaxed) != epoch) {
+    // first event of this session on this thread
+    if (!t->events) {
+      t->events = malloc(STATS_TRACE_EVENTS * sizeof(StatsTraceEvent));
+    }
+    n = 0;
+    atomic_store_explicit(&t->event_count, 0, memory_order_relaxed);
+    atomic_store_explicit(&t->trace_epoch, epoch, memory_order_relaxed);
+  }
+  if (!t->events || n == STATS_TRACE_EVENTS) {
+    stats_add(STATS_TRACE_DROPPED, 1);
+    return;
+  }
+  StatsTraceEvent *e = &t->events[n];
+  e->begin_ns = begin_ns;
+  e->end_ns = stats_now_ns();
+  e->fn = fn;
+  e->job = job;
+  // publishes the event (and the buffer) to stats_trace_write
+  atomic_store_explicit(&t->event_count, n + 1, memory_order_release);
+}
+
+int stats_trace_write(const char *path) {
+  FILE *f = fopen(path, "w");
+  if (!f) {
+    return -1;
+  }
+  fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  int first = 1;
+  StatsThread *t = atomic_load_explicit(&g_stats_threads, memory_order_acquire);
+  for (; t; t = t->next) {
+    size_t n = atomic_load_explicit(&t->event_count, memory_order_acquire);
+    if (n == 0 || atomic_load_explicit(&t->trace_epoch, memory_order_relaxed) !=
+                      g_stats_trace_epoch) {
+      continue;
+    }
+    const char *label = atomic_load_explicit(&t->label, memory_order_acquire);
+    size_t index = atomic_load_explicit(&t->index, memory_order_relaxed);
+    // track name
+    if (label) {
+      fprintf(f,
+              "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+              "\"tid\":%zu,\"args\":{\"name\":\"%s %zu\"}}",
+              first ? "" : ",\n", t->id, label, index);
+    } else {
+      fprintf(f,
+              "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+              "\"tid\":%zu,\"args\":{\"name\":\"thread %zu\"}}",
+              first ? "" : ",\n", t->id, t->id);
+    }
+    first = 0;
+    for (size_t i = 0; i < n; i++) {
+      const StatsTraceEvent *e = &t->events[i];
+      uint64_t begin = e->begin_ns > g_stats_trace_t0
+                           ? e->begin_ns - g_stats_trace_t0
+                           : 0;
+      uint64_t dur = e->end_ns > e->begin_ns ? e->end_ns - e->begin_ns : 0;
+      // ts / dur are in microseconds
+      fprintf(f,
+              ",\n{\"name\":\"0x%" PRIxPTR "\",\"cat\":\"job\",\"ph\":\"X\","
+              "\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f,"
+              "\"args\":{\"job\":\"%p\"}}",
+              e->fn, t->id, (double)begin / 1e3, (double)dur / 1e3, e->job);
+    }
+  }
+  fprintf(f, "\n]}\n");
+  return fclose(f) == 0 ? 0 : -1;
+}
+
+#endif
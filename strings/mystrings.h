@@ -78,6 +78,7 @@ void ascii_to_uppercase(ascii *string, size_t num_c)
   Notes:
     - Only affects lowercase letters 'a'-'z'.
     - Does not allocate new memory; conversion is in place.
+    - Vectorized (see SIMD), any buffer length.
 
 void ascii_to_lowercase(ascii *string, size_t num_c)
   Converts a null-terminated ASCII string to lowercase in place.
@@ -88,6 +89,62 @@ void ascii_to_lowercase(ascii *string, size_t num_c)
   Notes:
     - Only affects uppercase letters 'A'-'Z'.
     - Does not allocate new memory; conversion is in place.
+    - Vectorized (see SIMD), any buffer length.
+
+const ascii *ascii_find_byte(const ascii *string, size_t num_c, ascii c)
+  Returns a pointer to the first c in string (memchr), NULL if absent.
+
+const ascii *ascii_find_any(const ascii *string, size_t num_c,
+                            const ascii *set, size_t set_len)
+  Returns a pointer to the first byte of string that is one of the set_len
+  bytes of set (e.g. delimiters " \t\r\n:"), NULL if none.
+
+  Notes:
+    - Sets up to ASCII_FIND_ANY_SIMD_MAX (16) bytes are vectorized, larger
+      sets use a 256-bit lookup table.
+
+int ascii_is_valid(const ascii *string, size_t num_c)
+  Returns 1 if every byte is 7-bit ASCII (< 0x80), 0 otherwise.
+
+int ascii_casecmp(const ascii *a, const ascii *b, size_t num_c)
+  Compares num_c bytes ignoring ASCII case (like strncasecmp, but NUL is
+  an ordinary byte).
+
+  Returns 0 if equal, otherwise the difference between the first
+  differing bytes after lowercasing (< 0 if a sorts first).
+
+------------------------------------------------------------------------------
+SIMD
+
+The case conversion and search kernels process 16 (SSE2, NEON) or 32 (AVX2)
+bytes per iteration, with a scalar loop for the tail.
+
+- x86-64: SSE2 is always there, AVX2 is detected once at runtime
+  (__builtin_cpu_supports), no -mavx2 needed.
+- aarch64: NEON.
+- Anything else, or MYSTRINGS_NO_SIMD defined: scalar.
+
+AsciiSimdLevel ascii_simd_level(void)
+  Returns the kernel set in use.
+
+AsciiSimdLevel ascii_simd_select(AsciiSimdLevel level)
+  Forces a kernel set (tests, benchmarks). An unsupported level falls back
+  to the best supported one (AVX2 -> SSE2 on x86, any SIMD level -> NEON on
+  aarch64, scalar when none). Returns the level now in use.
+
+------------------------------------------------------------------------------
+STRING ARENA
+
+When arenas/string_arena.h is included before this header, the kernels also
+run over a whole StringArena, chunk by chunk (terminators are untouched):
+
+void arena_s_to_uppercase(StringArena *arena)
+void arena_s_to_lowercase(StringArena *arena)
+int  arena_s_is_ascii(const StringArena *arena)
+
+  Notes:
+    - Converting in place keeps every StrView valid (lengths don't change),
+      but breaks interning: only convert arenas no HashMap indexes.
 
 ------------------------------------------------------------------------------
 EXAMPLES
@@ -101,6 +158,10 @@ ascii str[] = "Hello, World!";
 ascii_to_uppercase(str, 13); // converts str to "HELLO, WORLD!"
 ascii_to_lowercase(str, 13); // converts back to "hello, world!"
 
+const ascii *colon = ascii_find_byte(line, len, ':');
+const ascii *delim = ascii_find_any(line, len, (const ascii *)" \t;", 3);
+if (ascii_casecmp(key, (const ascii *)"content-type", 12) == 0) { ... }
+
 ------------------------------------------------------------------------------
 WARNINGS
 
@@ -134,9 +195,37 @@ void ascii_to_uppercase(ascii *string, size_t num_c);
 
 void ascii_to_lowercase(ascii *string, size_t num_c);
 
+const ascii *ascii_find_byte(const ascii *string, size_t num_c, ascii c);
+
+const ascii *ascii_find_any(const ascii *string, size_t num_c,
+                            const ascii *set, size_t set_len);
+
+int ascii_is_valid(const ascii *string, size_t num_c);
+
+int ascii_casecmp(const ascii *a, const ascii *b, size_t num_c);
+
+typedef enum AsciiSimdLevel_t {
+  ASCII_SIMD_SCALAR = 0,
+  ASCII_SIMD_SSE2 = 1,
+  ASCII_SIMD_AVX2 = 2,
+  ASCII_SIMD_NEON = 3
+} AsciiSimdLevel;
+
+AsciiSimdLevel ascii_simd_level(void);
+
+AsciiSimdLevel ascii_simd_select(AsciiSimdLevel level);
+
+#ifdef STRING_ARENA_H
+void arena_s_to_uppercase(StringArena *arena);
+void arena_s_to_lowercase(StringArena *arena);
+int arena_s_is_ascii(const StringArena *arena);
+#endif
+
 #define ASCII_START 0x20
 #define ASCII_MAX 0x7E
 
+#define ASCII_FIND_ANY_SIMD_MAX 16
+
 #endif // !MYSTRINGS_H
 
 #if (defined(MYSTRINGS_IMPLEMENTATION))
@@ -156,15 +245,510 @@ void print_ascii_stats(ascii letter) {
   SEAK_PRINT_BITS(8, a_bits);
 }
 
+
+/*-------------------------------------------*/
+/*              Scalar kernels               */
+/*-------------------------------------------*/
+// SIMD kernels return how many leading bytes they covered (the scalar loop
+// does the rest); find kernels return the match index, or the covered
+// length with this bit set when the prefix has no match
+#define _ASCII_NOT_FOUND ((size_t)1 << (sizeof(size_t) * 8 - 1))
+
+static inline ascii _ascii_lower(ascii c) {
+  return (unsigned)(c - 'A') < 26u ? (ascii)(c | 0x20) : c;
+}
+
+// flips bit 5 of the letters in [first, first + 26)
+static void _ascii_case_scalar(ascii *s, size_t n, ascii first) {
+  for (size_t x = 0; x < n; x += 1)
+    if ((unsigned)(s[x] - first) < 26u)
+      s[x] ^= 0x20;
+}
+
+static const ascii *_ascii_find_byte_scalar(const ascii *s, size_t n,
+                                            ascii c) {
+  for (size_t x = 0; x < n; x += 1)
+    if (s[x] == c)
+      return s + x;
+  return NULL;
+}
+
+static const ascii *_ascii_find_table(const ascii *s, size_t n,
+                                      const ascii *set, size_t set_len) {
+  uint64_t table[4] = {0};
+  for (size_t x = 0; x < set_len; x += 1)
+    table[set[x] >> 6] |= 1ull << (set[x] & 63);
+  for (size_t x = 0; x < n; x += 1)
+    if ((table[s[x] >> 6] >> (s[x] & 63)) & 1)
+      return s + x;
+  return NULL;
+}
+
+static int _ascii_is_valid_scalar(const ascii *s, size_t n) {
+  ascii acc = 0;
+  for (size_t x = 0; x < n; x += 1)
+    acc |= s[x];
+  return acc < 0x80;
+}
+
+static int _ascii_casecmp_scalar(const ascii *a, const ascii *b, size_t n) {
+  for (size_t x = 0; x < n; x += 1) {
+    int d = (int)_ascii_lower(a[x]) - (int)_ascii_lower(b[x]);
+    if (d)
+      return d;
+  }
+  return 0;
+}
+
+/*-------------------------------------------*/
+/*          x86: SSE2 / AVX2 kernels         */
+/*-------------------------------------------*/
+#if !defined(MYSTRINGS_NO_SIMD) && defined(__SSE2__)
+#define _ASCII_SSE2 1
+#include <immintrin.h>
+
+// bytes in [first, first + 26) -> 0xFF (signed compare after a shift that
+// maps first to -128)
+static inline __m128i _ascii_range_sse2(__m128i v, ascii first) {
+  __m128i t = _mm_add_epi8(v, _mm_set1_epi8((char)(0x80 - first)));
+  return _mm_cmplt_epi8(t, _mm_set1_epi8((char)(-128 + 26)));
+}
+
+static inline __m128i _ascii_lower_sse2(__m128i v) {
+  return _mm_or_si128(
+      v, _mm_and_si128(_ascii_range_sse2(v, 'A'), _mm_set1_epi8(0x20)));
+}
+
+static size_t _ascii_case_sse2(ascii *s, size_t n, ascii first) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+    __m128i m = _mm_and_si128(_ascii_range_sse2(v, first), _mm_set1_epi8(0x20));
+    _mm_storeu_si128((__m128i *)(s + i), _mm_xor_si128(v, m));
+  }
+  return i;
+}
+
+static size_t _ascii_find_byte_sse2(const ascii *s, size_t n, ascii c) {
+  __m128i needle = _mm_set1_epi8((char)c);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+    int m = _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+    if (m)
+      return i + (size_t)__builtin_ctz((unsigned)m);
+  }
+  return i | _ASCII_NOT_FOUND;
+}
+
+static size_t _ascii_find_any_sse2(const ascii *s, size_t n, const ascii *set,
+                                   size_t set_len) {
+  __m128i needles[ASCII_FIND_ANY_SIMD_MAX];
+  for (size_t k = 0; k < set_len; k++)
+    needles[k] = _mm_set1_epi8((char)set[k]);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+    __m128i hit = _mm_setzero_si128();
+    for (size_t k = 0; k < set_len; k++)
+      hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, needles[k]));
+    int m = _mm_movemask_epi8(hit);
+    if (m)
+      return i + (size_t)__builtin_ctz((unsigned)m);
+  }
+  return i | _ASCII_NOT_FOUND;
+}
+
+static size_t _ascii_is_valid_sse2(const ascii *s, size_t n, int *valid) {
+  __m128i acc = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    acc = _mm_or_si128(acc, _mm_loadu_si128((const __m128i *)(s + i)));
+  *valid = _mm_movemask_epi8(acc) == 0;
+  return i;
+}
+
+static size_t _ascii_casecmp_sse2(const ascii *a, const ascii *b, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i va = _ascii_lower_sse2(_mm_loadu_si128((const __m128i *)(a + i)));
+    __m128i vb = _ascii_lower_sse2(_mm_loadu_si128((const __m128i *)(b + i)));
+    int eq = _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb));
+    if (eq != 0xFFFF)
+      return i + (size_t)__builtin_ctz(~(unsigned)eq);
+  }
+  return i; // equal up to i
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define _ASCII_AVX2 1
+#define _ASCII_AVX2_FN __attribute__((target("avx2")))
+
+_ASCII_AVX2_FN static inline __m256i _ascii_range_avx2(__m256i v,
+                                                       ascii first) {
+  __m256i t = _mm256_add_epi8(v, _mm256_set1_epi8((char)(0x80 - first)));
+  return _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(-128 + 26)), t);
+}
+
+_ASCII_AVX2_FN static inline __m256i _ascii_lower_avx2(__m256i v) {
+  return _mm256_or_si256(
+      v, _mm256_and_si256(_ascii_range_avx2(v, 'A'), _mm256_set1_epi8(0x20)));
+}
+
+_ASCII_AVX2_FN static size_t _ascii_case_avx2(ascii *s, size_t n,
+                                              ascii first) {
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+    __m256i m =
+        _mm256_and_si256(_ascii_range_avx2(v, first), _mm256_set1_epi8(0x20));
+    _mm256_storeu_si256((__m256i *)(s + i), _mm256_xor_si256(v, m));
+  }
+  return i;
+}
+
+_ASCII_AVX2_FN static size_t _ascii_find_byte_avx2(const ascii *s, size_t n,
+                                                   ascii c) {
+  __m256i needle = _mm256_set1_epi8((char)c);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+    unsigned m = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle));
+    if (m)
+      return i + (size_t)__builtin_ctz(m);
+  }
+  return i | _ASCII_NOT_FOUND;
+}
+
+_ASCII_AVX2_FN static size_t _ascii_find_any_avx2(const ascii *s, size_t n,
+                                                  const ascii *set,
+                                                  size_t set_len) {
+  __m256i needles[ASCII_FIND_ANY_SIMD_MAX];
+  for (size_t k = 0; k < set_len; k++)
+    needles[k] = _mm256_set1_epi8((char)set[k]);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+    __m256i hit = _mm256_setzero_si256();
+    for (size_t k = 0; k < set_len; k++)
+      hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, needles[k]));
+    unsigned m = (unsigned)_mm256_movemask_epi8(hit);
+    if (m)
+      return i + (size_t)__builtin_ctz(m);
+  }
+  return i | _ASCII_NOT_FOUND;
+}
+
+_ASCII_AVX2_FN static size_t _ascii_is_valid_avx2(const ascii *s, size_t n,
+                                                  int *valid) {
+  __m256i acc = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32)
+    acc = _mm256_or_si256(acc, _mm256_loadu_si256((const __m256i *)(s + i)));
+  *valid = _mm256_movemask_epi8(acc) == 0;
+  return i;
+}
+
+_ASCII_AVX2_FN static size_t _ascii_casecmp_avx2(const ascii *a,
+                                                 const ascii *b, size_t n) {
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i va =
+        _ascii_lower_avx2(_mm256_loadu_si256((const __m256i *)(a + i)));
+    __m256i vb =
+        _ascii_lower_avx2(_mm256_loadu_si256((const __m256i *)(b + i)));
+    unsigned eq = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb));
+    if (eq != 0xFFFFFFFFu)
+      return i + (size_t)__builtin_ctz(~eq);
+  }
+  return i;
+}
+#endif // avx2
+#endif // sse2
+
+/*-------------------------------------------*/
+/*             aarch64: NEON kernels         */
+/*-------------------------------------------*/
+#if !defined(MYSTRINGS_NO_SIMD) && defined(__aarch64__) &&                     \
+    defined(__ARM_NEON)
+#define _ASCII_NEON 1
+#include <arm_neon.h>
+
+static inline uint8x16_t _ascii_range_neon(uint8x16_t v, ascii first) {
+  return vcltq_u8(vsubq_u8(v, vdupq_n_u8(first)), vdupq_n_u8(26));
+}
+
+static inline uint8x16_t _ascii_lower_neon(uint8x16_t v) {
+  return vorrq_u8(v, vandq_u8(_ascii_range_neon(v, 'A'), vdupq_n_u8(0x20)));
+}
+
+// 4 bits per byte of a 0x00 / 0xFF mask, first match = ctz / 4
+static inline uint64_t _ascii_mask_neon(uint8x16_t m) {
+  return vget_lane_u64(
+      vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+}
+
+static size_t _ascii_case_neon(ascii *s, size_t n, ascii first) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t v = vld1q_u8(s + i);
+    uint8x16_t m = vandq_u8(_ascii_range_neon(v, first), vdupq_n_u8(0x20));
+    vst1q_u8(s + i, veorq_u8(v, m));
+  }
+  return i;
+}
+
+static size_t _ascii_find_byte_neon(const ascii *s, size_t n, ascii c) {
+  uint8x16_t needle = vdupq_n_u8(c);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    uint64_t m = _ascii_mask_neon(vceqq_u8(vld1q_u8(s + i), needle));
+    if (m)
+      return i + (size_t)(__builtin_ctzll(m) >> 2);
+  }
+  return i | _ASCII_NOT_FOUND;
+}
+
+static size_t _ascii_find_any_neon(const ascii *s, size_t n, const ascii *set,
+                                   size_t set_len) {
+  uint8x16_t needles[ASCII_FIND_ANY_SIMD_MAX];
+  for (size_t k = 0; k < set_len; k++)
+    needles[k] = vdupq_n_u8(set[k]);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t v = vld1q_u8(s + i);
+    uint8x16_t hit = vdupq_n_u8(0);
+    for (size_t k = 0; k < set_len; k++)
+      hit = vorrq_u8(hit, vceqq_u8(v, needles[k]));
+    uint64_t m = _ascii_mask_neon(hit);
+    if (m)
+      return i + (size_t)(__builtin_ctzll(m) >> 2);
+  }
+  return i | _ASCII_NOT_FOUND;
+}
+
+static size_t _ascii_is_valid_neon(const ascii *s, size_t n, int *valid) {
+  uint8x16_t acc = vdupq_n_u8(0);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    acc = vorrq_u8(acc, vld1q_u8(s + i));
+  *valid = vmaxvq_u8(acc) < 0x80;
+  return i;
+}
+
+static size_t _ascii_casecmp_neon(const ascii *a, const ascii *b, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t va = _ascii_lower_neon(vld1q_u8(a + i));
+    uint8x16_t vb = _ascii_lower_neon(vld1q_u8(b + i));
+    uint64_t ne = _ascii_mask_neon(vmvnq_u8(vceqq_u8(va, vb)));
+    if (ne)
+      return i + (size_t)(__builtin_ctzll(ne) >> 2);
+  }
+  return i;
+}
+#endif // neon
+
+/*-------------------------------------------*/
+/*                 Dispatch                  */
+/*-------------------------------------------*/
+#include <stdatomic.h>
+
+// -1 until the first call picks the best level
+static _Atomic int g_ascii_simd = -1;
+
+static AsciiSimdLevel _ascii_simd_best(AsciiSimdLevel want) {
+#if defined(_ASCII_AVX2)
+  if (want >= ASCII_SIMD_AVX2 && __builtin_cpu_supports("avx2"))
+    return ASCII_SIMD_AVX2;
+#endif
+#if defined(_ASCII_SSE2)
+  if (want >= ASCII_SIMD_SSE2)
+    return ASCII_SIMD_SSE2;
+#endif
+#if defined(_ASCII_NEON)
+  if (want >= ASCII_SIMD_SSE2)
+    return ASCII_SIMD_NEON;
+#endif
+  (void)want;
+  return ASCII_SIMD_SCALAR;
+}
+
+AsciiSimdLevel ascii_simd_level(void) {
+  int level = atomic_load_explicit(&g_ascii_simd, memory_order_relaxed);
+  if (level < 0) {
+    level = (int)_ascii_simd_best(ASCII_SIMD_NEON);
+    atomic_store_explicit(&g_ascii_simd, level, memory_order_relaxed);
+  }
+  return (AsciiSimdLevel)level;
+}
+
+AsciiSimdLevel ascii_simd_select(AsciiSimdLevel level) {
+  AsciiSimdLevel got = _ascii_simd_best(level);
+  atomic_store_explicit(&g_ascii_simd, (int)got, memory_order_relaxed);
+  return got;
+}
+
+static void _ascii_case(ascii *s, size_t n, ascii first) {
+  size_t done = 0;
+  switch (ascii_simd_level()) {
+#if defined(_ASCII_AVX2)
+  case ASCII_SIMD_AVX2:
+    done = _ascii_case_avx2(s, n, first);
+    break;
+#endif
+#if defined(_ASCII_SSE2)
+  case ASCII_SIMD_SSE2:
+    done = _ascii_case_sse2(s, n, first);
+    break;
+#endif
+#if defined(_ASCII_NEON)
+  case ASCII_SIMD_NEON:
+    done = _ascii_case_neon(s, n, first);
+    break;
+#endif
+  default:
+    break;
+  }
+  _ascii_case_scalar(s + done, n - done, first);
+}
+
 void ascii_to_uppercase(ascii *string, size_t num_c) {
-  for (size_t x = 0; x < num_c; x += 1)
-    if ((string[x] >> 5) & 0b11 && string[x] <= 0x7A)
-      string[x] = (string[x] - 0x20);
+  _ascii_case(string, num_c, 'a');
 }
 
 void ascii_to_lowercase(ascii *string, size_t num_c) {
-  for (size_t x = 0; x < num_c; x += 1)
-    if ((string[x] >> 5) & 0b10 && string[x] <= 0x5A)
-      string[x] = (string[x] + 0x20);
+  _ascii_case(string, num_c, 'A');
 }
+
+const ascii *ascii_find_byte(const ascii *string, size_t num_c, ascii c) {
+  size_t at = _ASCII_NOT_FOUND;
+  switch (ascii_simd_level()) {
+#if defined(_ASCII_AVX2)
+  case ASCII_SIMD_AVX2:
+    at = _ascii_find_byte_avx2(string, num_c, c);
+    break;
+#endif
+#if defined(_ASCII_SSE2)
+  case ASCII_SIMD_SSE2:
+    at = _ascii_find_byte_sse2(string, num_c, c);
+    break;
+#endif
+#if defined(_ASCII_NEON)
+  case ASCII_SIMD_NEON:
+    at = _ascii_find_byte_neon(string, num_c, c);
+    break;
+#endif
+  default:
+    break;
+  }
+  if (!(at & _ASCII_NOT_FOUND))
+    return string + at;
+  at &= ~_ASCII_NOT_FOUND;
+  return _ascii_find_byte_scalar(string + at, num_c - at, c);
+}
+
+const ascii *ascii_find_any(const ascii *string, size_t num_c,
+                            const ascii *set, size_t set_len) {
+  if (set_len == 0)
+    return NULL;
+  if (set_len == 1)
+    return ascii_find_byte(string, num_c, set[0]);
+  if (set_len > ASCII_FIND_ANY_SIMD_MAX)
+    return _ascii_find_table(string, num_c, set, set_len);
+
+  size_t at = _ASCII_NOT_FOUND;
+  switch (ascii_simd_level()) {
+#if defined(_ASCII_AVX2)
+  case ASCII_SIMD_AVX2:
+    at = _ascii_find_any_avx2(string, num_c, set, set_len);
+    break;
+#endif
+#if defined(_ASCII_SSE2)
+  case ASCII_SIMD_SSE2:
+    at = _ascii_find_any_sse2(string, num_c, set, set_len);
+    break;
+#endif
+#if defined(_ASCII_NEON)
+  case ASCII_SIMD_NEON:
+    at = _ascii_find_any_neon(string, num_c, set, set_len);
+    break;
+#endif
+  default:
+    break;
+  }
+  if (!(at & _ASCII_NOT_FOUND))
+    return string + at;
+  at &= ~_ASCII_NOT_FOUND;
+  return _ascii_find_table(string + at, num_c - at, set, set_len);
+}
+
+int ascii_is_valid(const ascii *string, size_t num_c) {
+  size_t done = 0;
+  int valid = 1;
+  switch (ascii_simd_level()) {
+#if defined(_ASCII_AVX2)
+  case ASCII_SIMD_AVX2:
+    done = _ascii_is_valid_avx2(string, num_c, &valid);
+    break;
+#endif
+#if defined(_ASCII_SSE2)
+  case ASCII_SIMD_SSE2:
+    done = _ascii_is_valid_sse2(string, num_c, &valid);
+    break;
+#endif
+#if defined(_ASCII_NEON)
+  case ASCII_SIMD_NEON:
+    done = _ascii_is_valid_neon(string, num_c, &valid);
+    break;
+#endif
+  default:
+    break;
+  }
+  return valid && _ascii_is_valid_scalar(string + done, num_c - done);
+}
+
+int ascii_casecmp(const ascii *a, const ascii *b, size_t num_c) {
+  size_t at = 0;
+  switch (ascii_simd_level()) {
+#if defined(_ASCII_AVX2)
+  case ASCII_SIMD_AVX2:
+    at = _ascii_casecmp_avx2(a, b, num_c);
+    break;
+#endif
+#if defined(_ASCII_SSE2)
+  case ASCII_SIMD_SSE2:
+    at = _ascii_casecmp_sse2(a, b, num_c);
+    break;
+#endif
+#if defined(_ASCII_NEON)
+  case ASCII_SIMD_NEON:
+    at = _ascii_casecmp_neon(a, b, num_c);
+    break;
+#endif
+  default:
+    break;
+  }
+  // either the first difference or the start of the scalar tail
+  return _ascii_casecmp_scalar(a + at, b + at, num_c - at);
+}
+
+#ifdef STRING_ARENA_H
+void arena_s_to_uppercase(StringArena *arena) {
+  for (StringChunk *c = arena->chunks; c; c = c->prev)
+    ascii_to_uppercase((ascii *)c->data, c->used);
+}
+
+void arena_s_to_lowercase(StringArena *arena) {
+  for (StringChunk *c = arena->chunks; c; c = c->prev)
+    ascii_to_lowercase((ascii *)c->data, c->used);
+}
+
+int arena_s_is_ascii(const StringArena *arena) {
+  for (const StringChunk *c = arena->chunks; c; c = c->prev)
+    if (!ascii_is_valid((const ascii *)c->data, c->used))
+      return 0;
+  return 1;
+}
+#endif
 #endif
@@ -40,13 +40,31 @@ Worker:
   - receiver : channel receiver to get jobs
   - sender   : channel sender to propagate jobs if needed
   - chan_ref : reference to the shared MPMC channel
+  - pool     : pool owning this worker
+  - id       : index of the worker inside the pool [0, num_workers)
+  - cpu      : CPU the worker pins itself to, -1 for none
 
 ThreadPool:
   Represents the pool itself.
-  - workers     : array of pthread_t for each thread
-  - num_workers : number of threads in the pool
-  - channel     : shared MPMC channel used for job dispatch
-  - dispatcher  : sender handle used to submit jobs
+  - workers      : array of pthread_t for each thread
+  - num_workers  : number of threads in the pool
+  - channel      : shared MPMC channel used for job dispatch
+  - dispatcher   : sender handle used to submit jobs
+  - local_queues : per-worker work-stealing deques (job system only, NULL
+                   otherwise)
+  - wait         : how idle workers wait for jobs
+  - idle         : parker for workers that don't block inside the channel
+                   (job system work-stealing mode)
+  - memory       : allocator for the job channels (and job scheduler
+                   arenas), NULL for the default
+
+ThreadPoolOptions:
+  - wait     : CHANNEL_WAIT_SPIN (default), CHANNEL_WAIT_YIELD or
+               CHANNEL_WAIT_PARK, forwarded to the job channel
+  - cpus     : worker i is pinned to cpus[i % num_cpus] (NULL = no pinning)
+  - num_cpus : entries in cpus
+  - memory   : MemBackend for the job channel ring buffer (NULL = default),
+               e.g. huge pages on the workers' NUMA node (page_alloc.h)
 
 ------------------------------------------------------------------------------
 FUNCTIONS
@@ -63,6 +81,25 @@ threadpool_init
     - Spawns num_threads worker threads.
     - Each worker listens for jobs via the channel.
     - The thread pool is ready to execute jobs immediately.
+    - Idle workers spin (CHANNEL_WAIT_SPIN), use threadpool_init_opts to let
+      them yield or sleep instead.
+
+threadpool_init_opts
+  Same as threadpool_init, with explicit options (NULL = defaults).
+
+  Notes:
+    - With CHANNEL_WAIT_PARK an idle pool sleeps on a futex and costs no CPU;
+      submitting a job wakes the parked workers.
+
+threadpool_pin_thread
+  Pins the calling thread to one CPU.
+
+  Returns 0 on success, -1 on failure (or when not supported).
+
+  Notes:
+    - Workers of a pool created with ThreadPoolOptions.cpus call it first
+      thing, before touching any queue.
+    - Linux only, uses the sched_setaffinity syscall directly.
 
 threadpool_execute
   Submit a job to the thread pool.
@@ -95,6 +132,7 @@ threadpool_shutdown
 typedef struct ReceiverMpmc_t ReceiverMpmc;
 typedef struct SenderMpmc_t SenderMpmc;
 typedef struct ChannelMpmc_t ChannelMpmc;
+typedef struct WsDeque_t WsDeque;
 
 typedef void *(*__job)(void *);
 
@@ -107,6 +145,11 @@ typedef struct Worker_t {
   ReceiverMpmc *receiver;
   SenderMpmc *sender;
   ChannelMpmc *chan_ref;
+  ReceiverMpmc *prio_receivers[2]; // job scheduler only: high, low
+
+  struct ThreadPool_t *pool;
+  size_t id;
+  int cpu; // pinned CPU, -1 for none
 } Worker;
 
 typedef struct ThreadPool_t {
@@ -116,10 +159,30 @@ typedef struct ThreadPool_t {
   ChannelMpmc *channel;
   SenderMpmc *dispatcher;
 
+  WsDeque **local_queues; // one per worker, NULL if the pool doesn't steal
+
+  // job scheduler only: high / low priority queues, NULL otherwise
+  ChannelMpmc *prio_channels[2];
+  SenderMpmc *prio_dispatchers[2];
+  size_t reserved_workers; // leading workers that only run high priority
+
+  ChanWaitStrategy wait;
+  ChanParker idle;
+  const MemBackend *memory; // NULL = default allocator
 } ThreadPool;
 
+typedef struct ThreadPoolOptions_t {
+  ChanWaitStrategy wait;
+  const int *cpus; // NULL = no pinning
+  size_t num_cpus;
+  const MemBackend *memory;
+} ThreadPoolOptions;
+
 ThreadPool *threadpool_init(size_t num_threads);
+ThreadPool *threadpool_init_opts(size_t num_threads,
+                                 const ThreadPoolOptions *opts);
 void threadpool_execute(ThreadPool *threadpool, __job __func, void *arg);
+int threadpool_pin_thread(int cpu);
 
 void threadpool_shutdown(ThreadPool *threadpool);
 
@@ -131,22 +194,52 @@ void threadpool_shutdown(ThreadPool *threadpool);
 #include <stdio.h>
 #include <stdlib.h>
 
+// counters when stats/stats.h came first, nothing otherwise
+#if defined(STATS_H)
+#define _THREADPOOL_STATS_ADD(c, n) stats_add((c), (n))
+#else
+#define _THREADPOOL_STATS_ADD(c, n) ((void)0)
+#endif
+
 static void *__set_worker(void *arg);
 
 ThreadPool *threadpool_init(size_t num_threads) {
+  return threadpool_init_opts(num_threads, NULL);
+}
+
+ThreadPool *threadpool_init_opts(size_t num_threads,
+                                 const ThreadPoolOptions *opts) {
   ThreadPool *tp = malloc(sizeof(ThreadPool));
 
   tp->workers = malloc(num_threads * sizeof(pthread_t));
   tp->num_workers = num_threads;
+  tp->wait = opts ? opts->wait : CHANNEL_WAIT_SPIN;
+  tp->memory = opts ? opts->memory : NULL;
+  chan_parker_init(&tp->idle);
 
-  tp->channel = channel_create_mpmc(num_threads * 4, sizeof(__Job__));
+  ChannelOptions chan_opts = {.wait = tp->wait, .memory = tp->memory};
+  tp->channel =
+      channel_create_mpmc_opts(num_threads * 4, sizeof(__Job__), &chan_opts);
   tp->dispatcher = mpmc_get_sender(tp->channel);
+  tp->local_queues = NULL;
+  for (size_t i = 0; i < 2; i++) {
+    tp->prio_channels[i] = NULL;
+    tp->prio_dispatchers[i] = NULL;
+  }
+  tp->reserved_workers = 0;
 
   for (size_t i = 0; i < num_threads; i++) {
     Worker *worker = malloc(sizeof(Worker));
     worker->receiver = mpmc_get_receiver(tp->channel);
     worker->sender = mpmc_get_sender(tp->channel);
     worker->chan_ref = tp->channel;
+    worker->prio_receivers[0] = NULL;
+    worker->prio_receivers[1] = NULL;
+    worker->pool = tp;
+    worker->id = i;
+    worker->cpu = opts && opts->cpus && opts->num_cpus
+                      ? opts->cpus[i % opts->num_cpus]
+                      : -1;
 
     pthread_create(&tp->workers[i], NULL, __set_worker, worker);
   }
@@ -165,21 +258,63 @@ void threadpool_execute(ThreadPool *threadpool, __job __func, void *arg) {
 void threadpool_shutdown(ThreadPool *threadpool) {
   mpmc_close_sender(threadpool->dispatcher);
   mpmc_close(threadpool->channel);
+  for (size_t x = 0; x < 2; x++) {
+    if (threadpool->prio_channels[x]) {
+      mpmc_close_sender(threadpool->prio_dispatchers[x]);
+      mpmc_close(threadpool->prio_channels[x]);
+    }
+  }
+  chan_parker_close(&threadpool->idle);
   for (size_t x = 0; x < threadpool->num_workers; x++) {
     pthread_join(threadpool->workers[x], NULL);
   }
   mpmc_destroy(threadpool->channel);
+  for (size_t x = 0; x < 2; x++) {
+    if (threadpool->prio_channels[x]) {
+      mpmc_destroy(threadpool->prio_channels[x]);
+      free(threadpool->prio_dispatchers[x]);
+    }
+  }
   free(threadpool->workers);
   free(threadpool->dispatcher);
   free(threadpool);
 };
 
+#if defined(__linux__)
+#include <sys/syscall.h>
+
+extern long syscall(long number, ...);
+
+int threadpool_pin_thread(int cpu) {
+  unsigned long mask[1024 / (8 * sizeof(unsigned long))] = {0};
+  if (cpu < 0 || cpu >= 1024) {
+    return -1;
+  }
+  mask[cpu / (8 * sizeof(unsigned long))] |=
+      1ul << (cpu % (8 * sizeof(unsigned long)));
+  // pid 0: the calling thread
+  return syscall(SYS_sched_setaffinity, 0, sizeof(mask), mask) == 0 ? 0 : -1;
+}
+#else
+int threadpool_pin_thread(int cpu) {
+  (void)cpu;
+  return -1;
+}
+#endif
+
 static void *__set_worker(void *arg) {
   Worker *worker = (Worker *)arg;
   __Job__ job;
+  if (worker->cpu >= 0) {
+    threadpool_pin_thread(worker->cpu);
+  }
+#if defined(STATS_H)
+  stats_thread_label("threadpool worker", worker->id);
+#endif
   while (1) {
     if (mpmc_recv(worker->receiver, &job) == CHANNEL_OK) {
       job.job(job.arg);
+      _THREADPOOL_STATS_ADD(STATS_JOBS_EXECUTED, 1);
     } else if (mpmc_is_closed(worker->chan_ref) == CLOSED) {
       break;
     }
@@ -0,0 +1,256 @@
+// Copyright 2025 Seaker <seakerone@proton.me>
+
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+/*
+------------------------------------------------------------------------------
+context.h — Directed stackful context switch (x86-64, aarch64)
+
+swap_context(from, to) suspends the running code into `from` and resumes
+`to`, in one call and one stack switch. There is no scheduler in between:
+the caller picks the target, e.g. the task that just became ready, so a
+hand-off costs one switch whatever the number of other tasks.
+
+Only what the ABI says survives a call is saved, on the suspended stack:
+
+- x86-64 (System V): rbx, rbp, r12-r15, plus the MXCSR (SSE rounding /
+  exception masks) and the x87 control word
+- aarch64 (AAPCS64): x19-x29, the link register, d8-d15 and FPCR
+
+Everything else is caller-saved: the compiler already spilled it around the
+call to swap_context, so pushing it again would only cost time. The FP
+control state is per-context: a task that changes its rounding mode
+(fesetround) does not leak it into the tasks it switches to.
+
+context_make prepares a fresh context on a stack (from stack_pool.h or any
+16-byte aligned memory). Its first swap_context calls fn(arg) on that stack.
+fn must never return: it ends by switching to another context for good.
+A new context starts with the FP control state of the thread that made it.
+
+yield.h and green.h switch their tasks with these.
+
+------------------------------------------------------------------------------
+USAGE
+
+In exactly ONE source file:
+
+    #define CONTEXT_IMPLEMENTATION
+    #include "context.h"
+
+    static CoContext main_ctx, task_ctx;
+
+    void task(void *arg) {
+        for (;;) {
+            do_work(arg);
+            swap_context(&task_ctx, &main_ctx); // back to main
+        }
+    }
+
+    CoStack *s = stack_pool_acquire(NULL, 64 * 1024);
+    context_make(&task_ctx, s->top, task, NULL);
+    swap_context(&main_ctx, &task_ctx); // runs task until it switches back
+
+------------------------------------------------------------------------------
+NOTES
+
+- The switch routines are file-scope assembly (ELF symbols), not naked
+  functions: GCC has no naked attribute on aarch64.
+- A context may be resumed by a different thread than the one that
+  suspended it (green.h migrates tasks). Thread-locals are not part of the
+  context.
+- swap_context(c, c) is allowed: it returns right away.
+
+------------------------------------------------------------------------------
+*/
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#if !defined(__x86_64__) && !defined(__aarch64__)
+#error "context.h: only x86-64 and aarch64 are supported"
+#endif
+
+// A suspended context: its registers are saved on its own stack, sp points
+// at them.
+typedef struct CoContext_t {
+  void *sp;
+} CoContext;
+
+/*-----------------------------------------------------------------------------
+  swap_context
+  Saves the running context into from and resumes to.
+
+  Returns once something switches back to from.
+
+  Notes:
+    - to must have been saved by swap_context or set up by context_make, and
+      must not be running.
+-----------------------------------------------------------------------------*/
+void swap_context(CoContext *from, CoContext *to);
+
+/*-----------------------------------------------------------------------------
+  context_make
+  Sets up ctx to call fn(arg) on the stack ending at stack_top the first
+  time it is switched to.
+
+  stack_top : one past the highest usable byte, 16-byte aligned (CoStack.top)
+
+  Notes:
+    - fn must not return (it traps if it does).
+    - About 200 bytes of the stack are used before fn runs.
+-----------------------------------------------------------------------------*/
+void context_make(CoContext *ctx, void *stack_top, void (*fn)(void *),
+                  void *arg);
+
+#endif // !CONTEXT_H
+
+#if (defined(CONTEXT_IMPLEMENTATION))
+#include <stdint.h>
+
+#if defined(__x86_64__)
+// Frame, from sp up: x87 CW (2 bytes) + pad + MXCSR (4 bytes), r15, r14,
+// r13, r12, rbx, rbp, return address.
+__asm__(".text\n"
+        ".globl swap_context\n"
+        ".type swap_context,@function\n"
+        ".p2align 4\n"
+        "swap_context:\n"
+        "  pushq %rbp\n"
+        "  pushq %rbx\n"
+        "  pushq %r12\n"
+        "  pushq %r13\n"
+        "  pushq %r14\n"
+        "  pushq %r15\n"
+        "  subq $8, %rsp\n"
+        "  fnstcw (%rsp)\n"
+        "  stmxcsr 4(%rsp)\n"
+        "  movq %rsp, (%rdi)\n"
+        "  movq (%rsi), %rsp\n"
+        "  fldcw (%rsp)\n"
+        "  ldmxcsr 4(%rsp)\n"
+        "  addq $8, %rsp\n"
+        "  popq %r15\n"
+        "  popq %r14\n"
+        "  popq %r13\n"
+        "  popq %r12\n"
+        "  popq %rbx\n"
+        "  popq %rbp\n"
+        "  ret\n"
+        ".size swap_context, .-swap_context\n"
+        // first frame of a context_make context: r12 = fn, r13 = arg
+        ".globl _context_trampoline\n"
+        ".type _context_trampoline,@function\n"
+        ".p2align 4\n"
+        "_context_trampoline:\n"
+        "  movq %r13, %rdi\n"
+        "  callq *%r12\n"
+        "  ud2\n"
+        ".size _context_trampoline, .-_context_trampoline\n");
+
+void _context_trampoline(void);
+
+void context_make(CoContext *ctx, void *stack_top, void (*fn)(void *),
+                  void *arg) {
+  uint16_t fpcw;
+  uint32_t mxcsr;
+  __asm__ __volatile__("fnstcw %0" : "=m"(fpcw));
+  __asm__ __volatile__("stmxcsr %0" : "=m"(mxcsr));
+
+  // rsp is 16-byte aligned once the ret pops the trampoline, so fn is
+  // entered with the alignment of a normal call
+  uint64_t *sp = (uint64_t *)((uintptr_t)stack_top & ~(uintptr_t)15);
+  *(--sp) = (uint64_t)(uintptr_t)_context_trampoline; // ret
+  *(--sp) = 0;                                        // rbp
+  *(--sp) = 0;                                        // rbx
+  *(--sp) = (uint64_t)(uintptr_t)fn;                  // r12
+  *(--sp) = (uint64_t)(uintptr_t)arg;                 // r13
+  *(--sp) = 0;                                        // r14
+  *(--sp) = 0;                                        // r15
+  *(--sp) = (uint64_t)fpcw | (uint64_t)mxcsr << 32;
+  ctx->sp = sp;
+}
+
+#elif defined(__aarch64__)
+// Frame (176 bytes, sp stays 16-byte aligned): x19-x28, x29, x30, d8-d15,
+// FPCR, pad.
+__asm__(".text\n"
+        ".globl swap_context\n"
+        ".type swap_context,%function\n"
+        ".p2align 4\n"
+        "swap_context:\n"
+        "  sub sp, sp, #176\n"
+        "  stp x19, x20, [sp, #0]\n"
+        "  stp x21, x22, [sp, #16]\n"
+        "  stp x23, x24, [sp, #32]\n"
+        "  stp x25, x26, [sp, #48]\n"
+        "  stp x27, x28, [sp, #64]\n"
+        "  stp x29, x30, [sp, #80]\n"
+        "  stp d8, d9, [sp, #96]\n"
+        "  stp d10, d11, [sp, #112]\n"
+        "  stp d12, d13, [sp, #128]\n"
+        "  stp d14, d15, [sp, #144]\n"
+        "  mrs x9, fpcr\n"
+        "  str x9, [sp, #160]\n"
+        "  mov x9, sp\n"
+        "  str x9, [x0]\n"
+        "  ldr x9, [x1]\n"
+        "  mov sp, x9\n"
+        "  ldp x19, x20, [sp, #0]\n"
+        "  ldp x21, x22, [sp, #16]\n"
+        "  ldp x23, x24, [sp, #32]\n"
+        "  ldp x25, x26, [sp, #48]\n"
+        "  ldp x27, x28, [sp, #64]\n"
+        "  ldp x29, x30, [sp, #80]\n"
+        "  ldp d8, d9, [sp, #96]\n"
+        "  ldp d10, d11, [sp, #112]\n"
+        "  ldp d12, d13, [sp, #128]\n"
+        "  ldp d14, d15, [sp, #144]\n"
+        "  ldr x9, [sp, #160]\n"
+        "  msr fpcr, x9\n"
+        "  add sp, sp, #176\n"
+        "  ret\n"
+        ".size swap_context, .-swap_context\n"
+        // first frame of a context_make context: x19 = fn, x20 = arg
+        ".globl _context_trampoline\n"
+        ".type _context_trampoline,%function\n"
+        ".p2align 4\n"
+        "_context_trampoline:\n"
+        "  mov x0, x20\n"
+        "  blr x19\n"
+        "  brk #0\n"
+        ".size _context_trampoline, .-_context_trampoline\n");
+
+void _context_trampoline(void);
+
+void context_make(CoContext *ctx, void *stack_top, void (*fn)(void *),
+                  void *arg) {
+  uint64_t fpcr;
+  __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+
+  uint64_t *sp = (uint64_t *)((uintptr_t)stack_top & ~(uintptr_t)15) - 22;
+  for (int i = 0; i < 22; i++) {
+    sp[i] = 0;
+  }
+  sp[0] = (uint64_t)(uintptr_t)fn;                   // x19
+  sp[1] = (uint64_t)(uintptr_t)arg;                  // x20
+  sp[11] = (uint64_t)(uintptr_t)_context_trampoline; // x30, x29 = 0
+  sp[20] = fpcr;
+  ctx->sp = sp;
+}
+#endif
+#endif
@@ -0,0 +1,932 @@
+// Copyright 2025 Seaker <seakerone@proton.me>
+
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+/*
+------------------------------------------------------------------------------
+green.h — M:N green threads over a set of worker threads
+
+yield.h runs stackful tasks on the thread that spawned them. green.h spreads
+the same kind of task (a function, a context pointer and its own stack) over
+N worker threads:
+
+- Every worker owns a run queue: a Chase-Lev deque (ws_deque.h) for
+  runnable tasks, plus a private FIFO for tasks that yielded.
+- Idle workers steal from the deques of busy ones.
+- Tasks spawned from outside the runtime go through a shared injection
+  stack. The first worker to find it non-empty moves it into its own deque,
+  where the others can steal from it.
+- A task can move itself to another worker with green_migrate(). The move
+  lands in the target's inbox (an intrusive lock-free list), and the task is
+  guaranteed to resume on that worker.
+- Idle workers wait with a ChanWaitStrategy (channels.h), so with
+  CHANNEL_WAIT_PARK they end up asleep on a futex until work is published.
+- Workers install a chan_await hook: spsc_*_await / mpmc_*_await (or any
+  chan_await) called from a task parks the task off the run queue, and the
+  peer's send / recv puts it back. Scheduling cost follows the number of
+  ready tasks, not the number of waiting ones.
+
+The workers are either threads owned by the runtime, or "hosted": the
+runtime creates no threads, and N threads of a ThreadPool or the job system
+call green_host / green_host_job (or green_worker_run) to lend themselves to
+it until green_destroy.
+
+Scheduling is cooperative: a task runs until it returns, yields or migrates.
+A worker runs tasks from its deque (newest first), then the tasks that
+migrated to it, then its yield FIFO, then its inbox and the injection stack,
+then steals. Every GREEN_FAIR_TICKS picks it serves the migrated tasks and
+the FIFO first, so tasks that keep spawning cannot starve the tasks that
+yielded. If a worker has more than one yielded task queued while another
+worker is idle, the oldest one moves to the deque so it can be stolen.
+Migrated tasks wait in a queue of their own that is never rebalanced, until
+their first resume on the target.
+
+⚠️ A task may resume on a different OS thread than the one it yielded on.
+Do not cache the address of thread-local variables, or hold thread-affine
+resources (mutexes, thread-local arena caches), across green_yield /
+green_migrate. The functions of this module that read thread-local state
+are noinline, so each call sees the thread it is running on.
+
+------------------------------------------------------------------------------
+USAGE
+
+green.h needs channels.h, ws_deque.h, stack_pool.h and context.h first:
+
+    #define CHANNEL_BASICS_IMPLEMENTATION
+    #include "channels/channels.h"
+    #define WS_DEQUE_IMPLEMENTATION
+    #include "data_structures/ws_deque.h"
+    #define STACK_POOL_IMPLEMENTATION
+    #include "yield/stack_pool.h"
+    #define CONTEXT_IMPLEMENTATION
+    #include "yield/context.h"
+    #define GREEN_IMPLEMENTATION
+    #include "yield/green.h"
+
+    void task(void *ctx) {
+        for (int i = 0; i < 3; i++) {
+            printf("worker %d\n", green_worker_id());
+            green_yield();
+        }
+    }
+
+    GreenOptions o = {.wait = CHANNEL_WAIT_PARK};
+    GreenRuntime *rt = green_create(4, &o);
+    for (int i = 0; i < 100; i++) green_spawn(rt, task, NULL);
+    green_wait(rt);
+    green_destroy(rt);
+
+Hosting the workers on an existing pool:
+
+    GreenOptions o = {.hosted = 1};
+    GreenRuntime *rt = green_create(2, &o);
+    threadpool_execute(pool, green_host, rt); // twice, one worker each
+    threadpool_execute(pool, green_host, rt);
+    ...
+    green_destroy(rt); // returns once both hosts are back
+
+------------------------------------------------------------------------------
+CONSTANTS
+
+GREEN_DEFAULT_STACK_SIZE : stack size when GreenOptions.stack_size is 0 (64KB)
+GREEN_QUEUE_CAPACITY     : per-worker deque capacity (4096)
+GREEN_FAIR_TICKS         : picks between two forced FIFO checks (61)
+GREEN_TASK_CACHE         : finished tasks (and stacks) a worker keeps for
+                           reuse (64)
+
+Task stacks are StackPool stacks (stack_pool.h): guard page underneath,
+committed page by page as the task touches them.
+
+------------------------------------------------------------------------------
+*/
+#ifndef GREEN_H
+#define GREEN_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef GREEN_DEFAULT_STACK_SIZE
+#define GREEN_DEFAULT_STACK_SIZE (64 * 1024)
+#endif
+
+#ifndef GREEN_QUEUE_CAPACITY
+#define GREEN_QUEUE_CAPACITY 4096
+#endif
+
+#ifndef GREEN_FAIR_TICKS
+#define GREEN_FAIR_TICKS 61
+#endif
+
+#ifndef GREEN_TASK_CACHE
+#define GREEN_TASK_CACHE 64
+#endif
+
+typedef struct WsDeque_t WsDeque;
+typedef struct CoStack_t CoStack;
+typedef struct GreenRuntime_t GreenRuntime;
+typedef struct GreenWorker_t GreenWorker;
+
+typedef enum GreenTaskState_t {
+  GREEN_TASK_READY = 0,
+  GREEN_TASK_YIELDED = 1,
+  GREEN_TASK_MIGRATING = 2,
+  GREEN_TASK_DONE = 3,
+  GREEN_TASK_PARKING = 4
+} GreenTaskState;
+
+typedef struct GreenWaitNode_t GreenWaitNode;
+
+typedef struct GreenTask_t {
+  CoContext regs;    // saved registers while switched out
+  CoStack *stack;
+  void (*fn)(void *);
+  void *ctx;
+  GreenRuntime *rt;
+  size_t migrate_to; // target worker while GREEN_TASK_MIGRATING
+  GreenWaitNode *wait; // registration while GREEN_TASK_PARKING
+  GreenTaskState state;
+  struct GreenTask_t *next; // inbox / injection / queue / free list link
+} GreenTask;
+
+// Intrusive FIFO of tasks, owner only.
+typedef struct GreenQueue_t {
+  GreenTask *head;
+  GreenTask *tail;
+  size_t len;
+} GreenQueue;
+
+struct GreenWorker_t {
+  GreenRuntime *rt;
+  size_t id;
+  WsDeque *deque;                 // runnable tasks, stealable
+  _Atomic(GreenTask *) inbox;     // migrated tasks, pushed by any thread
+  GreenQueue fifo;                // yielded tasks, may move to the deque
+  GreenQueue pinned;              // taken from the inbox, never moved again
+  GreenTask *current;             // task running on this worker, or NULL
+  CoContext sched;                // scheduler context while a task runs
+  GreenTask *free_tasks;          // finished tasks kept for reuse
+  size_t free_count;
+  uint64_t rng;                   // victim selection
+  uint32_t tick;
+  _Atomic uint8_t claimed;        // hosted: a thread runs this worker
+  pthread_t thread;
+};
+
+typedef struct GreenOptions_t {
+  size_t stack_size;     // per-task stack, 0 = GREEN_DEFAULT_STACK_SIZE,
+                         // rounded up to a StackPool size class
+  ChanWaitStrategy wait; // how idle workers and green_wait wait
+  uint8_t hosted;        // 1 = no threads, workers come from green_host
+} GreenOptions;
+
+struct GreenRuntime_t {
+  GreenWorker *workers;
+  size_t num_workers;
+
+  _Atomic(GreenTask *) inject; // tasks spawned from outside the runtime
+  _Atomic size_t live;         // spawned and not finished
+  _Atomic size_t idle;         // workers currently looking for work
+  _Atomic size_t exited;       // worker loops that returned
+  _Atomic uint8_t stopping;
+
+  ChanParker parker;  // idle workers
+  ChanParker waiters; // green_wait callers
+
+  size_t stack_size;
+  ChanWaitStrategy wait;
+  uint8_t hosted;
+};
+
+/*-----------------------------------------------------------------------------
+  green_create
+  Creates a runtime with num_workers workers.
+
+  opts : NULL = defaults (64KB stacks, CHANNEL_WAIT_SPIN, own threads)
+
+  Returns:
+    - the runtime on success
+    - NULL if num_workers is 0 or an allocation / thread creation failed
+
+  Notes:
+    - With opts->hosted the workers only start once threads enter
+      green_worker_run / green_host / green_host_job.
+-----------------------------------------------------------------------------*/
+GreenRuntime *green_create(size_t num_workers, const GreenOptions *opts);
+
+/*-----------------------------------------------------------------------------
+  green_spawn
+  Spawns a green thread running fn(ctx).
+
+  Returns:
+    - 0  on success
+    - -1 if rt or fn is NULL, or the task / its stack could not be allocated
+
+  Notes:
+    - From inside a task of rt the new task goes to the current worker's
+      deque (and can be stolen from there), from anywhere else to the
+      injection stack.
+    - Finished tasks keep their stack and are reused by the worker that ran
+      them last.
+-----------------------------------------------------------------------------*/
+int green_spawn(GreenRuntime *rt, void (*fn)(void *), void *ctx);
+
+/*-----------------------------------------------------------------------------
+  green_yield
+  Suspends the running green thread and lets its worker run something else.
+
+  Notes:
+    - Outside a green thread this is sched_yield().
+    - The task may be stolen and resume on another worker.
+-----------------------------------------------------------------------------*/
+void green_yield(void);
+
+/*-----------------------------------------------------------------------------
+  green_migrate
+  Moves the running green thread to another worker of its runtime.
+
+  Returns:
+    - 0  once the task runs on worker (immediately if it already did)
+    - -1 if not called from a green thread or worker is out of range
+
+  Notes:
+    - Later yields may let the task be stolen again.
+-----------------------------------------------------------------------------*/
+int green_migrate(size_t worker);
+
+/*-----------------------------------------------------------------------------
+  green_worker_id
+  Returns the index of the worker running the caller, or -1 if the caller
+  is not a green worker.
+-----------------------------------------------------------------------------*/
+int green_worker_id(void);
+
+/*-----------------------------------------------------------------------------
+  green_worker_run
+  Runs worker id of a hosted runtime on the calling thread until
+  green_destroy.
+
+  Returns:
+    - 0  when the runtime stopped
+    - -1 if rt is not hosted, id is out of range or the worker is taken
+-----------------------------------------------------------------------------*/
+int green_worker_run(GreenRuntime *rt, size_t id);
+
+/*-----------------------------------------------------------------------------
+  green_host / green_host_job
+  Claims the next free worker slot of a hosted runtime and runs it, with
+  the signatures of a ThreadPool job (threadpool_execute) and of a job
+  system job (job_spawn).
+
+  Notes:
+    - The hosting thread is busy until green_destroy: give the runtime
+      threads the pool can spare.
+    - Extra calls past num_workers return immediately.
+-----------------------------------------------------------------------------*/
+void *green_host(void *runtime);
+void green_host_job(void *runtime);
+
+/*-----------------------------------------------------------------------------
+  green_wait
+  Waits until every task spawned so far (and every task they spawned) has
+  finished.
+
+  Notes:
+    - Must not be called from a green thread.
+-----------------------------------------------------------------------------*/
+void green_wait(GreenRuntime *rt);
+
+/*-----------------------------------------------------------------------------
+  green_destroy
+  Waits for the remaining tasks, stops the workers and frees the runtime.
+
+  Notes:
+    - Own threads are joined. For a hosted runtime it returns once all
+      num_workers hosts have returned, so every slot must have been hosted.
+-----------------------------------------------------------------------------*/
+void green_destroy(GreenRuntime *rt);
+
+#endif // !GREEN_H
+
+#if (defined(GREEN_IMPLEMENTATION))
+#include <sched.h>
+#include <stdlib.h>
+
+static _Thread_local GreenWorker *t_green_worker = NULL;
+
+// A task parked on a ChanParker. The waiter list and the task each hold a
+// reference, the last one out frees the node. state decides who requeues
+// the task:
+// - WAITING   : registered, task still running (or switching out)
+// - PARKED    : the scheduler took the task off the run queues
+// - WOKEN     : fired; if it was PARKED the waker requeued the task, if it
+//               was WAITING the scheduler requeues it
+// - CANCELLED : the task's re-check succeeded, firing does nothing
+enum {
+  _GREEN_WAIT_WAITING = 0,
+  _GREEN_WAIT_PARKED = 1,
+  _GREEN_WAIT_WOKEN = 2,
+  _GREEN_WAIT_CANCELLED = 3
+};
+
+struct GreenWaitNode_t {
+  ChanWaiter waiter; // first: wake() gets a pointer to it
+  _Atomic uint32_t state;
+  _Atomic uint32_t refs;
+  GreenTask *task;
+};
+
+void _green_task_main(void *task);
+
+static void _green_task_prepare(GreenTask *t, void (*fn)(void *), void *ctx) {
+  t->fn = fn;
+  t->ctx = ctx;
+  t->state = GREEN_TASK_READY;
+  t->next = NULL;
+  context_make(&t->regs, t->stack->top, _green_task_main, t);
+}
+
+static GreenTask *_green_task_new(GreenRuntime *rt) {
+  GreenTask *t = malloc(sizeof(GreenTask));
+  if (!t) {
+    return NULL;
+  }
+  t->stack = stack_pool_acquire(NULL, rt->stack_size);
+  if (!t->stack) {
+    free(t);
+    return NULL;
+  }
+  t->rt = rt;
+  return t;
+}
+
+static void _green_task_free(GreenTask *t) {
+  stack_pool_release(NULL, t->stack);
+  free(t);
+}
+
+// Lock-free push on an intrusive list whose consumer takes it whole
+// (atomic_exchange with NULL), so there is no ABA to worry about.
+static void _green_list_push(_Atomic(GreenTask *) *list, GreenTask *t) {
+  GreenTask *head = atomic_load_explicit(list, memory_order_relaxed);
+  do {
+    t->next = head;
+  } while (!atomic_compare_exchange_weak_explicit(
+      list, &head, t, memory_order_release, memory_order_relaxed));
+}
+
+// Takes the whole list and returns it oldest first.
+static GreenTask *_green_list_take(_Atomic(GreenTask *) *list) {
+  if (atomic_load_explicit(list, memory_order_relaxed) == NULL) {
+    return NULL;
+  }
+  GreenTask *t = atomic_exchange_explicit(list, NULL, memory_order_acquire);
+  GreenTask *ordered = NULL;
+  while (t) {
+    GreenTask *next = t->next;
+    t->next = ordered;
+    ordered = t;
+    t = next;
+  }
+  return ordered;
+}
+
+static void _green_notify(GreenRuntime *rt, int all) {
+  atomic_thread_fence(memory_order_seq_cst);
+  chan_unpark(&rt->parker, all);
+}
+
+static void _green_queue_push(GreenQueue *q, GreenTask *t) {
+  t->next = NULL;
+  if (q->tail) {
+    q->tail->next = t;
+  } else {
+    q->head = t;
+  }
+  q->tail = t;
+  q->len++;
+}
+
+static GreenTask *_green_queue_pop(GreenQueue *q) {
+  GreenTask *t = q->head;
+  if (t) {
+    q->head = t->next;
+    if (!q->head) {
+      q->tail = NULL;
+    }
+    q->len--;
+  }
+  return t;
+}
+
+// Next of the tasks that yielded or migrated here, migrated ones first.
+static GreenTask *_green_local_pop(GreenWorker *w) {
+  GreenTask *t = _green_queue_pop(&w->pinned);
+  return t ? t : _green_queue_pop(&w->fifo);
+}
+
+// Moves the inbox to the pinned queue (migrated tasks must resume here, so
+// they stay out of the rebalanced FIFO) and the injection stack to the
+// deque. Returns the number of tasks moved.
+static size_t _green_refill(GreenWorker *w) {
+  size_t moved = 0;
+  GreenTask *t = _green_list_take(&w->inbox);
+  while (t) {
+    GreenTask *next = t->next;
+    _green_queue_push(&w->pinned, t);
+    moved++;
+    t = next;
+  }
+
+  t = _green_list_take(&w->rt->inject);
+  size_t injected = 0;
+  while (t) {
+    GreenTask *next = t->next;
+    if (ws_deque_push(w->deque, t) != WS_DEQUE_OK) {
+      _green_queue_push(&w->fifo, t);
+    }
+    injected++;
+    t = next;
+  }
+  if (injected > 1) {
+    _green_notify(w->rt, 0);
+  }
+  return moved + injected;
+}
+
+static GreenTask *_green_steal(GreenWorker *w) {
+  GreenRuntime *rt = w->rt;
+  size_t n = rt->num_workers;
+  if (n < 2) {
+    return NULL;
+  }
+  w->rng ^= w->rng << 13;
+  w->rng ^= w->rng >> 7;
+  w->rng ^= w->rng << 17;
+  size_t start = (size_t)(w->rng % n);
+
+  for (size_t i = 0; i < n; i++) {
+    GreenWorker *victim = &rt->workers[(start + i) % n];
+    if (victim == w) {
+      continue;
+    }
+    void *item;
+    int rc;
+    while ((rc = ws_deque_steal(victim->deque, &item)) == WS_DEQUE_ERR_ABORT) {
+      cpu_relax();
+    }
+    if (rc == WS_DEQUE_OK) {
+      return item;
+    }
+  }
+  return NULL;
+}
+
+static GreenTask *_green_find(GreenWorker *w) {
+  GreenTask *t;
+  void *item;
+
+  if (++w->tick % GREEN_FAIR_TICKS == 0) {
+    _green_refill(w);
+    if ((t = _green_local_pop(w))) {
+      return t;
+    }
+  }
+  for (int pass = 0; pass < 2; pass++) {
+    if (ws_deque_pop(w->deque, &item) == WS_DEQUE_OK) {
+      return item;
+    }
+    if ((t = _green_local_pop(w))) {
+      return t;
+    }
+    if (pass == 0 && _green_refill(w) == 0) {
+      break;
+    }
+  }
+  return _green_steal(w);
+}
+
+static int _green_has_work(GreenWorker *w) {
+  GreenRuntime *rt = w->rt;
+  if (atomic_load_explicit(&rt->inject, memory_order_seq_cst) ||
+      atomic_load_explicit(&w->inbox, memory_order_seq_cst)) {
+    return 1;
+  }
+  for (size_t i = 0; i < rt->num_workers; i++) {
+    if (ws_deque_size(rt->workers[i].deque) != 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void _green_finish(GreenWorker *w, GreenTask *t) {
+  GreenRuntime *rt = w->rt;
+  if (w->free_count < GREEN_TASK_CACHE) {
+    t->next = w->free_tasks;
+    w->free_tasks = t;
+    w->free_count++;
+  } else {
+    _green_task_free(t);
+  }
+  if (atomic_fetch_sub_explicit(&rt->live, 1, memory_order_acq_rel) == 1) {
+    atomic_thread_fence(memory_order_seq_cst);
+    chan_unpark(&rt->waiters, 1);
+  }
+}
+
+// Runs t until it yields, migrates or returns, then files it accordingly.
+// Only the scheduler touches a task after the switch back, once its stack
+// is no longer in use.
+static void _green_run(GreenWorker *w, GreenTask *t) {
+  GreenRuntime *rt = w->rt;
+  w->current = t;
+  swap_context(&w->sched, &t->regs);
+  w->current = NULL;
+
+  switch (t->state) {
+  case GREEN_TASK_YIELDED:
+    _green_queue_push(&w->fifo, t);
+    if (w->fifo.len > 1 &&
+        atomic_load_explicit(&rt->idle, memory_order_relaxed) != 0) {
+      GreenTask *oldest = _green_queue_pop(&w->fifo);
+      if (ws_deque_push(w->deque, oldest) == WS_DEQUE_OK) {
+        _green_notify(rt, 0);
+      } else {
+        _green_queue_push(&w->fifo, oldest);
+      }
+    }
+    break;
+  case GREEN_TASK_MIGRATING:
+    _green_list_push(&rt->workers[t->migrate_to].inbox, t);
+    _green_notify(rt, 1); // the target may be any of the sleepers
+    break;
+  case GREEN_TASK_DONE:
+    _green_finish(w, t);
+    break;
+  case GREEN_TASK_PARKING: {
+    uint32_t s = _GREEN_WAIT_WAITING;
+    if (!atomic_compare_exchange_strong_explicit(
+            &t->wait->state, &s, _GREEN_WAIT_PARKED, memory_order_acq_rel,
+            memory_order_acquire)) {
+      _green_queue_push(&w->fifo, t); // fired before it was off the CPU
+    }
+    // once PARKED the waker owns t
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+static GreenWorker *__attribute__((noinline)) _green_self(void) {
+  return t_green_worker;
+}
+
+// Makes a parked task runnable again, from any thread.
+static void _green_ready(GreenTask *t) {
+  GreenRuntime *rt = t->rt;
+  GreenWorker *w = _green_self();
+  if (!w || w->rt != rt || ws_deque_push(w->deque, t) != WS_DEQUE_OK) {
+    _green_list_push(&rt->inject, t);
+  }
+  _green_notify(rt, 0);
+}
+
+static void _green_wait_drop(GreenWaitNode *node) {
+  if (atomic_fetch_sub_explicit(&node->refs, 1, memory_order_acq_rel) == 1) {
+    free(node);
+  }
+}
+
+static int _green_wait_wake(ChanWaiter *waiter) {
+  GreenWaitNode *node = (GreenWaitNode *)waiter;
+  int woke = 0;
+  uint32_t s = atomic_load_explicit(&node->state, memory_order_acquire);
+  while (s == _GREEN_WAIT_WAITING || s == _GREEN_WAIT_PARKED) {
+    if (atomic_compare_exchange_weak_explicit(&node->state, &s,
+                                              _GREEN_WAIT_WOKEN,
+                                              memory_order_acq_rel,
+                                              memory_order_acquire)) {
+      if (s == _GREEN_WAIT_PARKED) {
+        _green_ready(node->task);
+      }
+      woke = 1;
+      break;
+    }
+  }
+  _green_wait_drop(node);
+  return woke;
+}
+
+// chan_await hook of the workers: parks the running task on p.
+static int __attribute__((noinline))
+_green_await_hook(ChanParker *p, ChanAttemptFn attempt, void *arg,
+                  int result) {
+  GreenWorker *w = t_green_worker;
+  if (!w || !w->current) {
+    return -1; // scheduler code, not a task: let the thread park
+  }
+  GreenTask *t = w->current;
+  GreenWaitNode *node =
+      result == CHAN_AWAIT_PARK ? malloc(sizeof(GreenWaitNode)) : NULL;
+  if (!node) {
+    green_yield();
+    return result;
+  }
+  node->waiter.wake = _green_wait_wake;
+  atomic_init(&node->state, _GREEN_WAIT_WAITING);
+  atomic_init(&node->refs, 2);
+  node->task = t;
+  chan_parker_add_waiter(p, &node->waiter);
+
+  int r = attempt(arg);
+  if (r != CHAN_AWAIT_PARK) {
+    uint32_t s = _GREEN_WAIT_WAITING;
+    atomic_compare_exchange_strong_explicit(&node->state, &s,
+                                            _GREEN_WAIT_CANCELLED,
+                                            memory_order_acq_rel,
+                                            memory_order_acquire);
+    _green_wait_drop(node);
+    if (r == CHAN_AWAIT_RETRY) {
+      green_yield();
+    }
+    return r;
+  }
+
+  t->wait = node;
+  t->state = GREEN_TASK_PARKING;
+  swap_context(&t->regs, &w->sched);
+  _green_wait_drop(node);
+  return CHAN_AWAIT_PARK;
+}
+
+static void _green_worker_loop(GreenWorker *w) {
+  GreenRuntime *rt = w->rt;
+  t_green_worker = w;
+  chan_set_await_hook(_green_await_hook);
+
+  for (;;) {
+    GreenTask *t = _green_find(w);
+    if (!t) {
+      uint32_t round = 0;
+      atomic_fetch_add_explicit(&rt->idle, 1, memory_order_relaxed);
+      while (!(t = _green_find(w)) &&
+             !atomic_load_explicit(&rt->stopping, memory_order_acquire)) {
+        if (chan_wait_step(rt->wait, &round)) {
+          uint32_t token = chan_park_begin(&rt->parker);
+          atomic_thread_fence(memory_order_seq_cst);
+          int sleep =
+              !_green_has_work(w) &&
+              !atomic_load_explicit(&rt->stopping, memory_order_acquire);
+          chan_park_end(&rt->parker, token, sleep);
+        }
+      }
+      atomic_fetch_sub_explicit(&rt->idle, 1, memory_order_relaxed);
+      if (!t) {
+        break;
+      }
+    }
+    _green_run(w, t);
+  }
+
+  chan_set_await_hook(NULL);
+  t_green_worker = NULL;
+  atomic_fetch_add_explicit(&rt->exited, 1, memory_order_release);
+}
+
+// First function on the task's own stack (context_make). The task may have
+// migrated, so the worker is looked up again after fn returns.
+void __attribute__((noinline)) _green_task_main(void *task) {
+  GreenTask *t = task;
+  t->fn(t->ctx);
+  t->state = GREEN_TASK_DONE;
+  GreenWorker *w = _green_self();
+  swap_context(&t->regs, &w->sched);
+  __builtin_unreachable();
+}
+
+static void *_green_thread_main(void *arg) {
+  _green_worker_loop(arg);
+  return NULL;
+}
+
+GreenRuntime *green_create(size_t num_workers, const GreenOptions *opts) {
+  if (num_workers == 0) {
+    return NULL;
+  }
+  GreenOptions o = {0};
+  if (opts) {
+    o = *opts;
+  }
+
+  GreenRuntime *rt = malloc(sizeof(GreenRuntime));
+  if (!rt) {
+    return NULL;
+  }
+  rt->workers = calloc(num_workers, sizeof(GreenWorker));
+  if (!rt->workers) {
+    free(rt);
+    return NULL;
+  }
+  rt->num_workers = num_workers;
+  atomic_init(&rt->inject, NULL);
+  atomic_init(&rt->live, 0);
+  atomic_init(&rt->idle, 0);
+  atomic_init(&rt->exited, 0);
+  atomic_init(&rt->stopping, 0);
+  chan_parker_init(&rt->parker);
+  chan_parker_init(&rt->waiters);
+  rt->stack_size = o.stack_size ? o.stack_size : GREEN_DEFAULT_STACK_SIZE;
+  rt->wait = o.wait;
+  rt->hosted = o.hosted;
+
+  for (size_t i = 0; i < num_workers; i++) {
+    GreenWorker *w = &rt->workers[i];
+    w->rt = rt;
+    w->id = i;
+    w->rng = 0x9E3779B97F4A7C15ull * (i + 1);
+    atomic_init(&w->inbox, NULL);
+    atomic_init(&w->claimed, 0);
+    w->deque = ws_deque_new(GREEN_QUEUE_CAPACITY);
+    if (!w->deque) {
+      for (size_t j = 0; j < i; j++) {
+        ws_deque_free(rt->workers[j].deque);
+      }
+      free(rt->workers);
+      free(rt);
+      return NULL;
+    }
+  }
+
+  if (!rt->hosted) {
+    for (size_t i = 0; i < num_workers; i++) {
+      if (pthread_create(&rt->workers[i].thread, NULL, _green_thread_main,
+                         &rt->workers[i]) != 0) {
+        atomic_store(&rt->stopping, 1);
+        chan_parker_close(&rt->parker);
+        for (size_t j = 0; j < i; j++) {
+          pthread_join(rt->workers[j].thread, NULL);
+        }
+        for (size_t j = 0; j < num_workers; j++) {
+          ws_deque_free(rt->workers[j].deque);
+        }
+        free(rt->workers);
+        free(rt);
+        return NULL;
+      }
+    }
+  }
+  return rt;
+}
+
+int __attribute__((noinline))
+green_spawn(GreenRuntime *rt, void (*fn)(void *), void *ctx) {
+  if (!rt || !fn) {
+    return -1;
+  }
+  GreenWorker *w = t_green_worker;
+  if (w && w->rt != rt) {
+    w = NULL;
+  }
+
+  GreenTask *t = NULL;
+  if (w && w->free_tasks) {
+    t = w->free_tasks;
+    w->free_tasks = t->next;
+    w->free_count--;
+  } else {
+    t = _green_task_new(rt);
+    if (!t) {
+      return -1;
+    }
+  }
+  _green_task_prepare(t, fn, ctx);
+  atomic_fetch_add_explicit(&rt->live, 1, memory_order_relaxed);
+
+  if (!w || ws_deque_push(w->deque, t) != WS_DEQUE_OK) {
+    _green_list_push(&rt->inject, t);
+  }
+  _green_notify(rt, 0);
+  return 0;
+}
+
+void __attribute__((noinline)) green_yield(void) {
+  GreenWorker *w = t_green_worker;
+  if (!w || !w->current) {
+    sched_yield();
+    return;
+  }
+  GreenTask *t = w->current;
+  t->state = GREEN_TASK_YIELDED;
+  swap_context(&t->regs, &w->sched);
+}
+
+int __attribute__((noinline)) green_migrate(size_t worker) {
+  GreenWorker *w = t_green_worker;
+  if (!w || !w->current || worker >= w->rt->num_workers) {
+    return -1;
+  }
+  if (worker == w->id) {
+    return 0;
+  }
+  GreenTask *t = w->current;
+  t->migrate_to = worker;
+  t->state = GREEN_TASK_MIGRATING;
+  swap_context(&t->regs, &w->sched);
+  return 0;
+}
+
+int __attribute__((noinline)) green_worker_id(void) {
+  GreenWorker *w = t_green_worker;
+  return w ? (int)w->id : -1;
+}
+
+int green_worker_run(GreenRuntime *rt, size_t id) {
+  if (!rt || !rt->hosted || id >= rt->num_workers) {
+    return -1;
+  }
+  GreenWorker *w = &rt->workers[id];
+  if (atomic_exchange(&w->claimed, 1) != 0) {
+    return -1;
+  }
+  _green_worker_loop(w);
+  return 0;
+}
+
+void *green_host(void *runtime) {
+  GreenRuntime *rt = runtime;
+  for (size_t i = 0; i < rt->num_workers; i++) {
+    if (green_worker_run(rt, i) == 0) {
+      break;
+    }
+  }
+  return NULL;
+}
+
+void green_host_job(void *runtime) { green_host(runtime); }
+
+void green_wait(GreenRuntime *rt) {
+  uint32_t round = 0;
+  while (atomic_load_explicit(&rt->live, memory_order_acquire) != 0) {
+    if (chan_wait_step(rt->wait, &round)) {
+      uint32_t token = chan_park_begin(&rt->waiters);
+      atomic_thread_fence(memory_order_seq_cst);
+      chan_park_end(&rt->waiters, token,
+                    atomic_load_explicit(&rt->live, memory_order_seq_cst) != 0);
+    }
+  }
+}
+
+void green_destroy(GreenRuntime *rt) {
+  if (!rt) {
+    return;
+  }
+  green_wait(rt);
+  atomic_store_explicit(&rt->stopping, 1, memory_order_release);
+  chan_parker_close(&rt->parker);
+
+  if (!rt->hosted) {
+    for (size_t i = 0; i < rt->num_workers; i++) {
+      pthread_join(rt->workers[i].thread, NULL);
+    }
+  } else {
+    uint32_t round = 0;
+    while (atomic_load_explicit(&rt->exited, memory_order_acquire) <
+           rt->num_workers) {
+      chan_wait_step(rt->wait == CHANNEL_WAIT_SPIN ? CHANNEL_WAIT_SPIN
+                                                   : CHANNEL_WAIT_YIELD,
+                     &round);
+    }
+  }
+
+  for (size_t i = 0; i < rt->num_workers; i++) {
+    GreenWorker *w = &rt->workers[i];
+    while (w->free_tasks) {
+      GreenTask *t = w->free_tasks;
+      w->free_tasks = t->next;
+      _green_task_free(t);
+    }
+    ws_deque_free(w->deque);
+  }
+  free(rt->workers);
+  free(rt);
+}
+#endif
@@ -0,0 +1,318 @@
+// Copyright 2025 Seaker <seakerone@proton.me>
+
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+/*
+------------------------------------------------------------------------------
+StackPool — guard-paged, lazily committed coroutine stacks
+
+Stackful tasks (yield.h, green.h) each need a stack. A malloc'd stack has no
+guard page, so an overflow silently corrupts whatever sits below it. StackPool
+gets stacks from mmap instead:
+
+- the lowest page of every stack is PROT_NONE: an overflow faults on it
+  right away.
+- the rest is reserved (MAP_NORESERVE), but the kernel only commits a page
+  the first time it is touched. A 64KB stack that only ever uses 3KB costs
+  one page of RSS.
+- released stacks go on a free list per size class (a power of two of
+  pages), and the next acquire of that class reuses them without a syscall.
+  Past max_cached stacks per class they are unmapped.
+- stack_pool_trim drops the resident pages of cached stacks (madvise),
+  keeping the mappings for reuse.
+
+The CoStack descriptor lives in the top bytes of its own mapping, in the
+page the stack touches first anyway, so a stack costs one mmap and no
+malloc.
+
+A pool is not thread-safe: use one per thread (yield.h keeps one in each
+thread's context anchor). A stack may be released into a different pool
+than the one it came from. Passing a NULL pool maps and unmaps directly.
+
+------------------------------------------------------------------------------
+USAGE
+
+In exactly ONE source file:
+
+    #define STACK_POOL_IMPLEMENTATION
+    #include "stack_pool.h"
+
+    StackPool pool;
+    stack_pool_init(&pool, 64);
+    CoStack *s = stack_pool_acquire(&pool, 16 * 1024);
+    // s->top is the 16-byte aligned initial stack pointer
+    stack_pool_release(&pool, s);
+    stack_pool_free(&pool);
+
+------------------------------------------------------------------------------
+NOTES
+
+- Linux / POSIX mmap. Elsewhere stacks come from malloc, without a guard
+  page or lazy commit.
+- Every guarded stack is two mappings (guard + stack). Linux caps a process
+  at vm.max_map_count mappings (65530 by default), so more than ~32k live
+  stacks need a higher limit, or STACK_POOL_GUARD_PAGES defined to 0.
+- mprotect / madvise go through the libc and syscall() declarations that
+  strict C11 keeps visible.
+
+------------------------------------------------------------------------------
+CONSTANTS
+
+STACK_POOL_PAGE        : page size assumed for rounding and guards (4096)
+STACK_POOL_GUARD_PAGES : PROT_NONE pages under each stack (1)
+STACK_POOL_MIN_SIZE    : smallest stack handed out (16KB)
+STACK_POOL_CLASSES     : size classes, the largest is MIN_SIZE << (CLASSES-1)
+                         (16KB .. 256MB)
+
+------------------------------------------------------------------------------
+*/
+#ifndef STACK_POOL_H
+#define STACK_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef STACK_POOL_PAGE
+#define STACK_POOL_PAGE 4096
+#endif
+
+#ifndef STACK_POOL_GUARD_PAGES
+#define STACK_POOL_GUARD_PAGES 1
+#endif
+
+#ifndef STACK_POOL_MIN_SIZE
+#define STACK_POOL_MIN_SIZE (16 * 1024)
+#endif
+
+#ifndef STACK_POOL_CLASSES
+#define STACK_POOL_CLASSES 15
+#endif
+
+typedef struct CoStack_t {
+  void *map;       // start of the mapping (guard pages first)
+  size_t map_size; // guard + stack
+  void *base;      // lowest usable byte
+  void *top;       // initial stack pointer, 16-byte aligned
+  uint32_t size_class;
+  struct CoStack_t *next; // free list link
+} CoStack;
+
+typedef struct StackPool_t {
+  CoStack *free[STACK_POOL_CLASSES];
+  size_t free_count[STACK_POOL_CLASSES];
+  size_t max_cached; // per class
+} StackPool;
+
+/*-----------------------------------------------------------------------------
+  stack_pool_init
+  Initializes an empty pool.
+
+  max_cached : released stacks kept per size class (0 = never cache)
+-----------------------------------------------------------------------------*/
+void stack_pool_init(StackPool *pool, size_t max_cached);
+
+/*-----------------------------------------------------------------------------
+  stack_pool_acquire
+  Returns a stack from the smallest class of at least size bytes.
+
+  Returns:
+    - the stack on success
+    - NULL if size exceeds the largest class or the mapping failed
+
+  Notes:
+    - size is rounded up to a power of two (at least STACK_POOL_MIN_SIZE).
+      The descriptor takes the top sizeof(CoStack) bytes (rounded to 16)
+      of it, top - base is what the stack can use.
+    - A reused stack keeps whatever it held; only fresh pages read as zero.
+-----------------------------------------------------------------------------*/
+CoStack *stack_pool_acquire(StackPool *pool, size_t size);
+
+/*-----------------------------------------------------------------------------
+  stack_pool_release
+  Returns a stack to the pool, or unmaps it once its class holds max_cached
+  stacks (or pool is NULL).
+
+  Notes:
+    - The stack must not be in use: never release the stack you are
+      running on.
+-----------------------------------------------------------------------------*/
+void stack_pool_release(StackPool *pool, CoStack *stack);
+
+/*-----------------------------------------------------------------------------
+  stack_pool_trim
+  Drops the resident pages of every cached stack (except the top page
+  holding the descriptor). The stacks stay mapped and cached.
+
+  Returns the number of stacks trimmed (0 where madvise is unavailable).
+-----------------------------------------------------------------------------*/
+size_t stack_pool_trim(StackPool *pool);
+
+/*-----------------------------------------------------------------------------
+  stack_pool_free
+  Unmaps every cached stack. Stacks still acquired are not affected and
+  can be released with a NULL pool.
+-----------------------------------------------------------------------------*/
+void stack_pool_free(StackPool *pool);
+
+#endif // !STACK_POOL_H
+
+#if (defined(STACK_POOL_IMPLEMENTATION))
+#include <stdlib.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define _STACK_POOL_MMAP 1
+
+/* strict C11 hides the Linux extensions, the values are the generic ones */
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS 0x20
+#endif
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0x4000
+#endif
+#endif
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#ifndef MADV_DONTNEED
+#define MADV_DONTNEED 4
+#endif
+extern long syscall(long number, ...);
+#endif
+
+static int _stack_pool_class(size_t size, size_t *map_size) {
+  size_t need = size;
+  size_t bytes = STACK_POOL_MIN_SIZE;
+  for (uint32_t c = 0; c < STACK_POOL_CLASSES; c++, bytes <<= 1) {
+    if (bytes >= need) {
+      *map_size = bytes + (size_t)STACK_POOL_GUARD_PAGES * STACK_POOL_PAGE;
+      return (int)c;
+    }
+  }
+  return -1;
+}
+
+static CoStack *_stack_pool_map(size_t map_size, uint32_t size_class) {
+#if defined(_STACK_POOL_MMAP)
+  uint8_t *map = mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (map == MAP_FAILED) {
+    return NULL;
+  }
+  size_t guard = (size_t)STACK_POOL_GUARD_PAGES * STACK_POOL_PAGE;
+  if (guard && mprotect(map, guard, PROT_NONE) != 0) {
+    munmap(map, map_size);
+    return NULL;
+  }
+#else
+  uint8_t *map = malloc(map_size);
+  if (!map) {
+    return NULL;
+  }
+  size_t guard = (size_t)STACK_POOL_GUARD_PAGES * STACK_POOL_PAGE;
+#endif
+  CoStack *s = (CoStack *)(map + map_size - sizeof(CoStack));
+  s->map = map;
+  s->map_size = map_size;
+  s->base = map + guard;
+  s->top = (void *)((uintptr_t)s & ~(uintptr_t)0xF);
+  s->size_class = size_class;
+  s->next = NULL;
+  return s;
+}
+
+static void _stack_pool_unmap(CoStack *s) {
+#if defined(_STACK_POOL_MMAP)
+  munmap(s->map, s->map_size);
+#else
+  free(s->map);
+#endif
+}
+
+void stack_pool_init(StackPool *pool, size_t max_cached) {
+  for (size_t c = 0; c < STACK_POOL_CLASSES; c++) {
+    pool->free[c] = NULL;
+    pool->free_count[c] = 0;
+  }
+  pool->max_cached = max_cached;
+}
+
+CoStack *stack_pool_acquire(StackPool *pool, size_t size) {
+  size_t map_size;
+  int c = _stack_pool_class(size, &map_size);
+  if (c < 0) {
+    return NULL;
+  }
+  if (pool && pool->free[c]) {
+    CoStack *s = pool->free[c];
+    pool->free[c] = s->next;
+    pool->free_count[c]--;
+    s->next = NULL;
+    return s;
+  }
+  return _stack_pool_map(map_size, (uint32_t)c);
+}
+
+void stack_pool_release(StackPool *pool, CoStack *stack) {
+  if (!stack) {
+    return;
+  }
+  uint32_t c = stack->size_class;
+  if (!pool || pool->free_count[c] >= pool->max_cached) {
+    _stack_pool_unmap(stack);
+    return;
+  }
+  stack->next = pool->free[c];
+  pool->free[c] = stack;
+  pool->free_count[c]++;
+}
+
+size_t stack_pool_trim(StackPool *pool) {
+  size_t trimmed = 0;
+#if defined(__linux__)
+  for (size_t c = 0; c < STACK_POOL_CLASSES; c++) {
+    for (CoStack *s = pool->free[c]; s; s = s->next) {
+      uintptr_t top_page = (uintptr_t)s & ~(uintptr_t)(STACK_POOL_PAGE - 1);
+      uintptr_t base = (uintptr_t)s->base;
+      if (top_page > base &&
+          syscall(SYS_madvise, (void *)base, (size_t)(top_page - base),
+                  MADV_DONTNEED) == 0) {
+        trimmed++;
+      }
+    }
+  }
+#else
+  (void)pool;
+#endif
+  return trimmed;
+}
+
+void stack_pool_free(StackPool *pool) {
+  for (size_t c = 0; c < STACK_POOL_CLASSES; c++) {
+    CoStack *s = pool->free[c];
+    while (s) {
+      CoStack *next = s->next;
+      _stack_pool_unmap(s);
+      s = next;
+    }
+    pool->free[c] = NULL;
+    pool->free_count[c] = 0;
+  }
+}
+#endif
@@ -20,10 +20,10 @@
 // WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 /*
 ------------------------------------------------------------------------------
-Yield — Minimal cooperative multitasking (stackful coroutines) for C (x86-64)
+Yield — Minimal cooperative multitasking (stackful coroutines) for C
 
 This module provides a very small cooperative multitasking system implemented
-using manual stack switching and inline x86-64 assembly.
+using manual stack switching (context.h's swap_context).
 
 It allows running multiple "tasks" (stackful coroutines) in a single OS thread,
 explicitly yielding execution between them.
@@ -41,20 +41,30 @@ This module is intended for:
 - async-style workflows
 
 ⚠️ Platform limitations:
-- x86-64 only
-- System V ABI
+- x86-64 (System V) and aarch64 (AAPCS64), see context.h
 - Tested on Linux
-- Requires stack alignment to 16 bytes
+
+Stacks come from a StackPool (stack_pool.h): mmap'd, with a PROT_NONE guard
+page under each one, committed by the kernel page by page as the task
+touches them, and reused from a free list once their task is dead. A task
+that only ever uses 2KB of its 64KB stack costs one page of RSS.
 
 ⚠️ Safety notes:
-- Not thread-safe
-- Uses malloc for stack allocation
+- Each thread has its own context anchor (g_ctxs is thread-local), so tasks
+  never leave the thread that spawned them. See green.h for an M:N runtime
+  that spreads tasks over several threads.
+- A stack overflow faults on the guard page instead of corrupting the
+  neighbouring stack
 
 ------------------------------------------------------------------------------
 USAGE
 
-In exactly ONE source file:
+yield.h needs stack_pool.h and context.h first. In exactly ONE source file:
 
+    #define STACK_POOL_IMPLEMENTATION
+    #include "stack_pool.h"
+    #define CONTEXT_IMPLEMENTATION
+    #include "context.h"
     #define YIELD_IMPLEMENTATION
     #include "yield.h"
 
@@ -66,14 +76,19 @@ Before using any other function, you MUST initialize the global context anchor:
 
     g_anchor_init();
 
-To spawn a task:
+To spawn a task (64KB stack, or an explicit size):
 
     task_run(my_function, my_context);
+    task_run_sized(my_function, my_context, 16 * 1024);
 
 Inside a task, you can cooperatively yield execution:
 
     yield();
 
+yield() is a single swap_context from the running task to the next one
+(round-robin). Code that knows which context should run next (a hand-off to
+the task that just became ready) can call swap_context directly.
+
 To wait until all spawned tasks finish:
 
     wait_for_tasks();
@@ -116,18 +131,18 @@ EXAMPLE
 #include <stdio.h>
 #include <stdlib.h>
 
-// x86-64bits assembly implementation
-
 typedef struct Context_t Context;
 
 typedef struct ContextAnchor_t ContextAnchor;
 
-extern ContextAnchor *g_ctxs;
+// One anchor per thread: g_anchor_init / task_run / yield only touch the
+// calling thread's tasks.
+extern _Thread_local ContextAnchor *g_ctxs;
 
 // Yields execution to the next available task.
 // This function saves the current CPU context and switches to another task.
 // Must only be called from within a running task or main context.
-void __attribute__((naked)) yield(void);
+void yield(void);
 
 // Spawns a new task that will execute `func(ctx)`.
 // The task starts executing the next time a context switch occurs.
@@ -136,12 +151,17 @@ void __attribute__((naked)) yield(void);
 // `func` must have signature: void (*)(void*)
 void task_run(void(*func), void *ctx);
 
+// Same as task_run, with a stack of at least stack_size bytes (rounded up
+// to a StackPool size class).
+// Returns 0 on success, -1 if no stack could be mapped.
+int task_run_sized(void(*func), void *ctx, size_t stack_size);
+
 // Blocks execution until all spawned tasks have completed.
 // Internally yields execution until only the main context remains.
 void wait_for_tasks();
 
-// Initializes the global context anchor.
-// Must be called before any other function in this module.
+// Initializes the calling thread's context anchor.
+// Must be called before any other function in this module, once per thread.
 // Safe to call multiple times (subsequent calls are ignored).
 void g_anchor_init();
 
@@ -159,7 +179,14 @@ void g_anchor_free();
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifndef STACK_SIZE
 #define STACK_SIZE (64 * 1024)
+#endif
+
+// stacks of dead tasks kept per size class for reuse
+#ifndef YIELD_STACK_CACHE
+#define YIELD_STACK_CACHE 256
+#endif
 
 typedef enum {
   CTX_READY,
@@ -167,23 +194,32 @@ typedef enum {
 } ContextState;
 
 typedef struct Context_t {
-  void *rsp;
-  void *stack;
+  CoContext regs; // saved registers while switched out
+  CoStack *stack; // NULL for the main context and unused slots
   ContextState state;
 } Context;
 
+// What a new task runs, stored at the top of its own stack.
+typedef struct YieldStart_t {
+  void (*func)(void *);
+  void *ctx;
+} YieldStart;
+
+// ctxs[0] is the main context, [1, count) are live tasks. Finished tasks are
+// swapped to the end, so the slots right after count hold the stacks of dead
+// tasks until they are reused or released.
 typedef struct ContextAnchor_t {
   Context *ctxs;
   size_t count;
   size_t index;
   size_t cap;
+  StackPool stacks;
 } ContextAnchor;
 
-void __remake_ctx_stack(size_t x) {
-  g_ctxs->ctxs[x].stack = malloc(STACK_SIZE);
-  uintptr_t top = (uintptr_t)g_ctxs->ctxs[x].stack + STACK_SIZE;
-  top &= ~0xF; // align to 16 bytes
-  g_ctxs->ctxs[x].rsp = (void *)top;
+// Returns the stack of a dead task in slot x to the pool.
+static void __release_ctx_stack(size_t x) {
+  stack_pool_release(&g_ctxs->stacks, g_ctxs->ctxs[x].stack);
+  g_ctxs->ctxs[x].stack = NULL;
   g_ctxs->ctxs[x].state = CTX_READY;
 }
 
@@ -198,44 +234,23 @@ void _ctx_anchor_healthcheck() {
     g_ctxs->cap *= 2;
 
     for (size_t x = old_cap; x < g_ctxs->cap; x++) {
-      g_ctxs->ctxs[x].stack = malloc(STACK_SIZE);
-      uintptr_t top = (uintptr_t)g_ctxs->ctxs[x].stack + STACK_SIZE;
-      top &= ~0xF; // align to 16 bytes
-      g_ctxs->ctxs[x].rsp = (void *)top;
+      g_ctxs->ctxs[x].regs.sp = NULL;
+      g_ctxs->ctxs[x].stack = NULL;
       g_ctxs->ctxs[x].state = CTX_READY;
     }
   }
 }
 
-void __attribute__((naked)) yield(void) {
-  __asm__ __volatile__(
-      "pushq %rdi\n" // save context registers on stack (callee + rdi)
-      "pushq %rbp\n"
-      "pushq %rbx\n"
-      "pushq %r12\n"
-      "pushq %r13\n"
-      "pushq %r14\n"
-      "pushq %r15\n"
-      "movq %rsp, %rdi\n" // stack pointer to 1st argument
-      "jmp switch_context\n");
-}
+_Thread_local ContextAnchor *g_ctxs = NULL;
 
-ContextAnchor *g_ctxs = NULL;
-
-void __attribute__((naked)) remake_ctx(void *rsp) {
-  __asm__ __volatile__(
-      "movq %rdi, %rsp \n" // set stack pointer from saved context
-      "popq %r15\n"
-      "popq %r14\n"
-      "popq %r13\n"
-      "popq %r12\n"
-      "popq %rbx\n"
-      "popq %rbp\n"
-      "popq %rdi\n"
-      "ret\n");
+void yield(void) {
+  size_t from = g_ctxs->index;
+  size_t to = from + 1 < g_ctxs->count ? from + 1 : 0;
+  g_ctxs->index = to;
+  swap_context(&g_ctxs->ctxs[from].regs, &g_ctxs->ctxs[to].regs);
 }
 
-void finish_run(void) {
+static void finish_run(void) {
   size_t id = g_ctxs->index;
   size_t last = g_ctxs->count - 1;
   g_ctxs->ctxs[id].state = CTX_DEAD;
@@ -249,49 +264,56 @@ void finish_run(void) {
 
   if (g_ctxs->index >= g_ctxs->count) g_ctxs->index = 0;
 
-  remake_ctx(g_ctxs->ctxs[g_ctxs->index].rsp);
+  // the dead task's registers land in its (now unused) slot, never resumed
+  swap_context(&g_ctxs->ctxs[last].regs, &g_ctxs->ctxs[g_ctxs->index].regs);
 }
 
-void task_run(void(*func), void *ctx) {
+// First function on a new task's stack.
+static void _yield_task_main(void *arg) {
+  YieldStart *start = arg;
+  start->func(start->ctx);
+  finish_run();
+}
+
+int task_run_sized(void(*func), void *ctx, size_t stack_size) {
   // set registers and return calls for stack frame
   size_t id = g_ctxs->count;
+  if (id >= g_ctxs->cap) {
+    return -1;
+  }
 
-  if (g_ctxs->ctxs[id].state == CTX_DEAD) {
-    free(g_ctxs->ctxs[id].stack);
-    __remake_ctx_stack(id);
+  if (g_ctxs->ctxs[id].stack) {
+    __release_ctx_stack(id); // dead task, most likely handed right back
+  }
+  CoStack *stack = stack_pool_acquire(&g_ctxs->stacks, stack_size);
+  if (!stack) {
+    return -1;
   }
-  void **rsp = (void **)g_ctxs->ctxs[id].rsp;
-
-  *(--rsp) = finish_run; // ret after func
-  *(--rsp) = func;       // ret
-  *(--rsp) = ctx;        // arg1 for func
-  *(--rsp) = 0;          // push rbp
-  *(--rsp) = 0;          // push rbx
-  *(--rsp) = 0;          // push r12
-  *(--rsp) = 0;          // push r13
-  *(--rsp) = 0;          // push r14
-  *(--rsp) = 0;          // push r15
-
-  g_ctxs->ctxs[id].rsp = rsp;
+  g_ctxs->ctxs[id].stack = stack;
+  g_ctxs->ctxs[id].state = CTX_READY;
+
+  // 16 bytes at the top hold func / ctx, the task's frames start below
+  YieldStart *start = (YieldStart *)stack->top - 1;
+  start->func = (void (*)(void *))func;
+  start->ctx = ctx;
+  context_make(&g_ctxs->ctxs[id].regs, start, _yield_task_main, start);
   g_ctxs->count++;
 
   _ctx_anchor_healthcheck();
+  return 0;
 }
 
-void switch_context(void *rsp) {
-  g_ctxs->ctxs[g_ctxs->index].rsp = rsp;
-
-  g_ctxs->index++;
-  if (g_ctxs->index >= g_ctxs->count)
-    g_ctxs->index = 0;
-
-  remake_ctx(g_ctxs->ctxs[g_ctxs->index].rsp);
-}
+void task_run(void(*func), void *ctx) { task_run_sized(func, ctx, STACK_SIZE); }
 
 void wait_for_tasks() {
   while (g_ctxs->count > 1) {
     yield();
   }
+  // back on the main stack: the dead tasks' stacks can go to the pool
+  for (size_t x = g_ctxs->count; x < g_ctxs->cap && g_ctxs->ctxs[x].stack;
+       x++) {
+    __release_ctx_stack(x);
+  }
 }
 
 void g_anchor_init() {
@@ -303,10 +325,8 @@ void g_anchor_init() {
   g_ctxs->count = 1; // 0 is reserved for main context
   g_ctxs->index = 0;
   g_ctxs->ctxs = calloc(g_ctxs->cap, sizeof(Context));
-
-  for (size_t x = 0; x < g_ctxs->cap; x++) {
-    __remake_ctx_stack(x);
-  }
+  // stacks are mapped by task_run, not up front
+  stack_pool_init(&g_ctxs->stacks, YIELD_STACK_CACHE);
 }
 
 void g_anchor_free() {
@@ -315,9 +335,10 @@ void g_anchor_free() {
   }
   for (size_t i = 0; i < g_ctxs->cap; i++) {
     if (g_ctxs->ctxs[i].stack != NULL) {
-      free(g_ctxs->ctxs[i].stack);
+      stack_pool_release(NULL, g_ctxs->ctxs[i].stack);
     }
   }
+  stack_pool_free(&g_ctxs->stacks);
   free(g_ctxs->ctxs);
   free(g_ctxs);
   g_ctxs = NULL;